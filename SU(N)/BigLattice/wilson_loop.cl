@@ -61,28 +61,28 @@ lattice_zero3(gpu_su_3* matrix)
 }
 
                     __attribute__((always_inline)) void
-lattice_Lt_store_3(__global hgpu_float4 * lattice_table, gpu_su_3* m, uint gindex){
+lattice_Lt_store_3(__global hgpu_float4 * lattice_table, gpu_su_3* m, lattice_index gindex){
             lattice_table[gindex +  0 * ROWSIZE_LT] = (*m).uv1;
             lattice_table[gindex +  1 * ROWSIZE_LT] = (*m).uv2;
             lattice_table[gindex +  2 * ROWSIZE_LT] = (*m).uv3;
 }
 
                     __attribute__((always_inline)) void
-lattice_Lr2_store_3(__global hgpu_float4 * lattice_table, gpu_su_3* m, uint gindex){
+lattice_Lr2_store_3(__global hgpu_float4 * lattice_table, gpu_su_3* m, lattice_index gindex){
             lattice_table[gindex +  0 * ROWSIZE_LR2] = (*m).uv1;
             lattice_table[gindex +  1 * ROWSIZE_LR2] = (*m).uv2;
             lattice_table[gindex +  2 * ROWSIZE_LR2] = (*m).uv3;
 }
 
                     __attribute__((always_inline)) void
-lattice_L_store_3(__global hgpu_float4 * lattice_table, gpu_su_3* m, uint gindex, int rowsize){
+lattice_L_store_3(__global hgpu_float4 * lattice_table, gpu_su_3* m, lattice_index gindex, int rowsize){
             lattice_table[gindex +  0 * rowsize] = (*m).uv1;
             lattice_table[gindex +  1 * rowsize] = (*m).uv2;
             lattice_table[gindex +  2 * rowsize] = (*m).uv3;
 }
 
                     __attribute__((always_inline)) __private gpu_su_3
-lattice_Lt_get_3(__global hgpu_float4 * lattice_table, uint gindex){
+lattice_Lt_get_3(__global hgpu_float4 * lattice_table, lattice_index gindex){
     gpu_su_3 matrix;
             matrix.uv1 = lattice_table[gindex +  0 * ROWSIZE_LT];
             matrix.uv2 = lattice_table[gindex +  1 * ROWSIZE_LT];
@@ -91,7 +91,7 @@ lattice_Lt_get_3(__global hgpu_float4 * lattice_table, uint gindex){
 }
 
                     __attribute__((always_inline)) __private gpu_su_3
-lattice_Lr2_get_3(__global hgpu_float4 * lattice_table, uint gindex){
+lattice_Lr2_get_3(__global hgpu_float4 * lattice_table, lattice_index gindex){
     gpu_su_3 matrix;
             matrix.uv1 = lattice_table[gindex +  0 * ROWSIZE_LR2];
             matrix.uv2 = lattice_table[gindex +  1 * ROWSIZE_LR2];
@@ -100,7 +100,7 @@ lattice_Lr2_get_3(__global hgpu_float4 * lattice_table, uint gindex){
 }
 
                     __attribute__((always_inline)) __private gpu_su_3
-lattice_L_get_3(__global hgpu_float4 * lattice_table, uint gindex, int rowsize){
+lattice_L_get_3(__global hgpu_float4 * lattice_table, lattice_index gindex, int rowsize){
     gpu_su_3 matrix;
             matrix.uv1 = lattice_table[gindex +  0 * rowsize];
             matrix.uv2 = lattice_table[gindex +  1 * rowsize];
@@ -115,12 +115,12 @@ lattice_zero2(gpu_su_2* matrix)
 }
 
                     __attribute__((always_inline)) void
-lattice_L_store_2(__global hgpu_float4 * lattice_table, gpu_su_2* m, uint gindex){
+lattice_L_store_2(__global hgpu_float4 * lattice_table, gpu_su_2* m, lattice_index gindex){
             lattice_table[gindex] = (*m).uv1;
 }
 
                     __attribute__((always_inline)) __private gpu_su_2
-lattice_L_get_2(__global hgpu_float4 * lattice_table, uint gindex){
+lattice_L_get_2(__global hgpu_float4 * lattice_table, lattice_index gindex){
     gpu_su_2 matrix;
             matrix.uv1 = lattice_table[gindex];
     return matrix;
@@ -142,10 +142,10 @@ lattice_measurement_Lt(__global hgpu_float4  * lattice_table,
         twist.omega = lattice_parameters[2];
 #endif
     coords_4 coord, coord1, coord2;
-    uint gid2;
+    lattice_index gid2;
     int j;
 
-    const uint gid = GID;
+    const lattice_index gid = GID;
     if(GID < (N1 + 1) * N2 * N3 * N4){
     lattice_gid_to_coords(&gid,&coord);
 #if SUN == 2
@@ -191,7 +191,7 @@ lattice_measurement_Lr(__global hgpu_float4  * lattice_table,
 {
     coords_4 coord, coord1, coord2, coord0;
     int M, j, i;
-    uint gid2, gid0;
+    lattice_index gid2, gid0;
 #if SUN == 2
     gpu_su_2 gLr1, gLr3, gLr4, gLr5;
     gpu_su_2 gLr2[WLN];
@@ -206,7 +206,7 @@ lattice_measurement_Lr(__global hgpu_float4  * lattice_table,
         twist.omega = lattice_parameters[2];
 #endif
 
-    const uint gid = GID;
+    const lattice_index gid = GID;
 
     if(GID < SITES){
         lattice_gid_to_coords(&gid,&coord);
@@ -282,7 +282,7 @@ lattice_measurement_Lr1(__global hgpu_float4  * lattice_table,
 {
     coords_4 coord, coord1, coord2;
     int M, j;
-    uint gid2;
+    lattice_index gid2;
 #if SUN == 2
     gpu_su_2 gLr1, gLr3, gLr4;
     su2_twist twist;
@@ -295,7 +295,7 @@ lattice_measurement_Lr1(__global hgpu_float4  * lattice_table,
         twist.omega = lattice_parameters[2];
 #endif
 
-    const uint gid = GID;
+    const lattice_index gid = GID;
 
     if(GID < SITES){
         lattice_gid_to_coords(&gid,&coord);
@@ -337,7 +337,7 @@ lattice_measurement_Lr2(__global hgpu_float4  * lattice_table,
                        __global hgpu_float   * lattice_parameters){
     coords_4 coord1, coord2, coord0;
     int j, i;
-    uint gid2, gid0;
+    lattice_index gid2, gid0;
 #if SUN == 2
     gpu_su_2 gLr3, gLr4, gLr5;
     su2_twist twist;
@@ -398,8 +398,8 @@ lattice_measurement_WLx0(__global hgpu_float4  * Lt,
     gpu_su_3 wlx1, wlx2, wlx3, wlx4;
 #endif
     coords_4 coord;
-    uint gid1;
-    uint gid = GID;
+    lattice_index gid1;
+    lattice_index gid = GID;
     
     if (GID < SITES){
         lattice_gid_to_coords(&gid,&coord);
@@ -492,10 +492,10 @@ lattice_measurement_WLx2(__global hgpu_float4  * WLx,
     int Nxx = (int)lattice_parameters[4];
     int rowsize = (int)lattice_parameters[5];
 
-    uint gid = GID;
+    lattice_index gid = GID;
     coords_4 coord, coord0;
 
-    uint gid1, gid2;
+    lattice_index gid1, gid2;
 
     int l1, l;
 #if SUN == 2
@@ -576,11 +576,11 @@ lattice_measurement_WLx3(__global hgpu_float4  * WLx,
     int Nxx     = lattice_parameters[4];
     int rowsize = lattice_parameters[5];
 
-    uint gid = GID;
+    lattice_index gid = GID;
     coords_4 coord;
 
     int l1;
-    uint gid1;
+    lattice_index gid1;
 #if SUN == 2
     gpu_su_2 gLt, wlx1, wlx2;
 #endif
@@ -669,12 +669,12 @@ lattice_measurement_wilson(__global hgpu_float4  * lattice_table,
 #if SUN == 2
     hgpu_double out  = 0.0;
     hgpu_double out2 = 0.0;
-    uint gdi = GID;
+    lattice_index gdi = GID;
     hgpu_double wilson_loop;
     coords_4 coord,  coord2;
     coords_4 coordX, coordX2;
     coords_4 coord_1,coord_2,coord_4;
-    uint gdi_1,gdi_2,gdi_4,gdiT;
+    lattice_index gdi_1,gdi_2,gdi_4,gdiT;
     gpu_su_2 u1;
     double_su_2 m1, m2, m3, m4, m5, w1;
 
@@ -822,12 +822,12 @@ lattice_measurement_wilson(__global hgpu_float4  * lattice_table,
 #if SUN == 3
     hgpu_double out  = 0.0;
     hgpu_double out2 = 0.0;
-    uint gdi = GID;
+    lattice_index gdi = GID;
     hgpu_double wilson_loop;
     coords_4 coord,  coord2;
     coords_4 coordX, coordX2;
     coords_4 coord_1,coord_2,coord_4;
-    uint gdi_1,gdi_2,gdi_4,gdiT;
+    lattice_index gdi_1,gdi_2,gdi_4,gdiT;
     gpu_su_3 u1;
     double_su_3 m1, m2, m3, m4, m5, w1;
 
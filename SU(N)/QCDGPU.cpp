@@ -94,6 +94,10 @@ setenv("CUDA_CACHE_DISABLE", "1", 1); // disable nVidia cach, if needed
         model0->desired_device   = 0;
         model0->device_select    = true;
         model0->GPU0->GPU_debug.rebuild_binary = false;
+        model0->GPU0->GPU_debug.async_dispatch = false;  // true - enqueue kernels without host synchronization
+        model0->GPU0->GPU_debug.autotune       = false;  // true - benchmark work group sizes of kernels missing in autotune.inf
+        model0->GPU0->GPU_debug.overlap_measurements = false;  // true - run measurements on configuration snapshot in separate queue
+        model0->GPU0->GPU_debug.trace          = false;  // true - write timeline of kernels and transfers into trace.json
 #endif
         model0->PRNG0->PRNG_generator   = PRNG_CL::PRNG::PRNG_generator_RANLUX3;
         model0->PRNG0->PRNG_randseries = 54;//1432996491; // constant random series; 0 <--> system time
@@ -177,6 +181,7 @@ setenv("CUDA_CACHE_DISABLE", "1", 1); // disable nVidia cach, if needed
 
         //model0->precision     = model::model_precision_single;
                         model0->precision = model::model_precision_double;
+        //model0->link_storage  = model::model_link_storage_8;    // SU(3) links by 8 parameters (LINKS = 8)
         model0->INIT          = 1;                  // start simulations (0 - continue, 1 - start)
         model0->NAV           = 0;                  // number of thermalization cycles
         model0->ITER          = 2;                // number of working iterations (note: first measurement is performing on the initial configuration!!!)
@@ -0,0 +1,1063 @@
+/******************************************************************************
+ * @file     clhost.cpp
+ * @author   Vadim Demchik <vadimdi@yahoo.com>,
+ * @author   Natalia Kolomoyets <rknv7@mail.ru>
+ * @version  1.6
+ *
+ * @brief    [QCDGPU]
+ *           Host-native OpenCL-free backend (HOST_RUN):
+ *           programs are translated to C++ and loaded as shared objects,
+ *           NDRanges are executed by work groups on host threads
+ *
+ * @section  LICENSE
+ *
+ * Copyright (c) 2013-2016 Vadim Demchik, Natalia Kolomoyets
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *    Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *****************************************************************************/
+#include "clhost.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+
+#include <dlfcn.h>
+#include <spawn.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <ucontext.h>
+#include <sys/wait.h>
+
+extern char** environ;
+
+// ___ objects ____________________________________________________________________________________
+struct _cl_platform_id   { int dummy; };
+struct _cl_device_id     { int dummy; };
+struct _cl_context       { std::atomic<int> references; };
+struct _cl_command_queue { std::atomic<int> references; cl_context context; cl_command_queue_properties properties; };
+
+struct _cl_mem {
+    void*           data;
+    size_t          size;
+    bool            own_data;           // false for CL_MEM_USE_HOST_PTR
+};
+
+struct _cl_event {
+    std::atomic<int> references;
+    cl_command_queue queue;
+    cl_ulong        queued;
+    cl_ulong        start;
+    cl_ulong        end;
+};
+
+struct _cl_program {
+    std::atomic<int> references;
+    std::string     source;
+    std::string     binary;             // shared object
+    std::string     options;
+    std::string     log;
+    cl_build_status status;
+    void*           handle;             // dlopen handle
+};
+
+typedef struct {
+    unsigned char   value[128];
+    size_t          size;               // value size or size of local memory
+    bool            local;              // __local pointer (value is NULL)
+    bool            pointer;            // __global pointer (value is cl_mem)
+    bool            set;
+} clhost_argument;
+
+struct _cl_kernel {
+    std::atomic<int> references;
+    cl_program      program;
+    std::string     name;
+    clhost_kernel_entry entry;
+    std::vector<clhost_argument> arguments;
+};
+
+typedef int (*clhost_kernel_signature)(char* pointers);
+#define CLHOST_SIGNATURE_PREFIX "clhost_signature_"
+
+static _cl_platform_id  clhost_platform;
+static _cl_device_id    clhost_device;
+static std::string      clhost_include_path;
+
+// ___ helpers ____________________________________________________________________________________
+static cl_ulong clhost_time(void){
+    return (cl_ulong) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static cl_int clhost_info(const void* data, size_t data_size, size_t param_value_size, void* param_value, size_t* param_value_size_ret){
+    if (param_value) {
+        if (param_value_size < data_size) return CL_INVALID_VALUE;
+        memcpy(param_value,data,data_size);
+        memset((char*) param_value + data_size,0,param_value_size - data_size);    // cl_uint queries into size_t
+    }
+    if (param_value_size_ret) *param_value_size_ret = data_size;
+    return CL_SUCCESS;
+}
+
+static cl_int clhost_info_string(const char* data, size_t param_value_size, void* param_value, size_t* param_value_size_ret){
+    return clhost_info(data,strlen(data)+1,param_value_size,param_value,param_value_size_ret);
+}
+
+static cl_event clhost_event(cl_command_queue queue, cl_ulong queued){
+    cl_event event = new _cl_event;
+    event->references = 1;
+    event->queue  = queue;
+    event->queued = queued;
+    event->start  = queued;
+    event->end    = clhost_time();
+    return event;
+}
+
+// commands are executed in order at enqueue time, so wait lists are always complete
+static void clhost_complete(cl_command_queue queue, cl_ulong queued, cl_event* event){
+    if (event) *event = clhost_event(queue,queued);
+}
+
+static unsigned int clhost_threads(void){
+    unsigned int result = std::thread::hardware_concurrency();
+    return (result) ? result : 1;
+}
+
+static std::string clhost_cpu_info(const char* key){
+    std::string result;
+    FILE* stream = fopen("/proc/cpuinfo","r");
+    if (!stream) return result;
+    char line[1024];
+    while (fgets(line,sizeof(line),stream)) {
+        if (strncmp(line,key,strlen(key))) continue;
+        char* value = strchr(line,':');
+        if (!value) continue;
+        value++;
+        while (*value==' ') value++;
+        result = value;
+        while ((!result.empty()) && ((result.back()=='\n') || (result.back()==' '))) result.pop_back();
+        break;
+    }
+    fclose(stream);
+    return result;
+}
+
+// ___ platform and device ________________________________________________________________________
+cl_int clGetPlatformIDs(cl_uint num_entries, cl_platform_id* platforms, cl_uint* num_platforms){
+    if ((platforms) && (num_entries>0)) platforms[0] = &clhost_platform;
+    if (num_platforms) *num_platforms = 1;
+    return CL_SUCCESS;
+}
+
+cl_int clGetPlatformInfo(cl_platform_id platform, cl_platform_info param_name, size_t param_value_size, void* param_value, size_t* param_value_size_ret){
+    switch (param_name) {
+        case CL_PLATFORM_PROFILE:    return clhost_info_string("FULL_PROFILE",param_value_size,param_value,param_value_size_ret);
+        case CL_PLATFORM_VERSION:    return clhost_info_string("OpenCL 1.2 " HOST_RUN_VERSION,param_value_size,param_value,param_value_size_ret);
+        case CL_PLATFORM_NAME:       return clhost_info_string("QCDGPU host backend",param_value_size,param_value,param_value_size_ret);
+        case CL_PLATFORM_VENDOR:     return clhost_info_string("QCDGPU",param_value_size,param_value,param_value_size_ret);
+        case CL_PLATFORM_EXTENSIONS: return clhost_info_string("cl_khr_fp64",param_value_size,param_value,param_value_size_ret);
+    }
+    return CL_INVALID_VALUE;
+}
+
+cl_int clGetDeviceIDs(cl_platform_id platform, cl_device_type device_type, cl_uint num_entries, cl_device_id* devices, cl_uint* num_devices){
+    if (!(device_type & CL_DEVICE_TYPE_CPU)) {
+        if (num_devices) *num_devices = 0;
+        return CL_DEVICE_NOT_FOUND;
+    }
+    if ((devices) && (num_entries>0)) devices[0] = &clhost_device;
+    if (num_devices) *num_devices = 1;
+    return CL_SUCCESS;
+}
+
+cl_int clGetDeviceInfo(cl_device_id device, cl_device_info param_name, size_t param_value_size, void* param_value, size_t* param_value_size_ret){
+    cl_uint  value_uint;
+    cl_ulong value_ulong;
+    size_t   value_size[3];
+    long     pages     = sysconf(_SC_PHYS_PAGES);
+    long     page_size = sysconf(_SC_PAGESIZE);
+    cl_ulong memory    = ((pages>0) && (page_size>0)) ? (cl_ulong) pages * (cl_ulong) page_size : ((cl_ulong) 1 << 32);
+    std::string name;
+    switch (param_name) {
+        case CL_DEVICE_TYPE:
+            value_ulong = CL_DEVICE_TYPE_CPU;
+            return clhost_info(&value_ulong,sizeof(value_ulong),param_value_size,param_value,param_value_size_ret);
+        case CL_DEVICE_MAX_COMPUTE_UNITS:
+            value_uint = clhost_threads();
+            return clhost_info(&value_uint,sizeof(value_uint),param_value_size,param_value,param_value_size_ret);
+        case CL_DEVICE_MAX_WORK_ITEM_DIMENSIONS:
+            value_uint = 3;
+            return clhost_info(&value_uint,sizeof(value_uint),param_value_size,param_value,param_value_size_ret);
+        case CL_DEVICE_MAX_WORK_GROUP_SIZE:
+            value_size[0] = HOST_RUN_WORK_GROUP_MAX;
+            return clhost_info(value_size,sizeof(size_t),param_value_size,param_value,param_value_size_ret);
+        case CL_DEVICE_MAX_WORK_ITEM_SIZES:
+            value_size[0] = value_size[1] = value_size[2] = HOST_RUN_WORK_GROUP_MAX;
+            return clhost_info(value_size,sizeof(value_size),param_value_size,param_value,param_value_size_ret);
+        case CL_DEVICE_MAX_CLOCK_FREQUENCY:
+            value_uint = (cl_uint) atof(clhost_cpu_info("cpu MHz").c_str());
+            return clhost_info(&value_uint,sizeof(value_uint),param_value_size,param_value,param_value_size_ret);
+        case CL_DEVICE_MAX_MEM_ALLOC_SIZE:
+            value_ulong = memory / 2;
+            return clhost_info(&value_ulong,sizeof(value_ulong),param_value_size,param_value,param_value_size_ret);
+        case CL_DEVICE_GLOBAL_MEM_SIZE:
+            value_ulong = memory;
+            return clhost_info(&value_ulong,sizeof(value_ulong),param_value_size,param_value,param_value_size_ret);
+        case CL_DEVICE_IMAGE2D_MAX_WIDTH:
+            value_size[0] = 8192;   // OpenCL 1.2 minimums (used for sizing, images are not supported)
+            return clhost_info(value_size,sizeof(size_t),param_value_size,param_value,param_value_size_ret);
+        case CL_DEVICE_IMAGE3D_MAX_WIDTH:
+            value_size[0] = 2048;
+            return clhost_info(value_size,sizeof(size_t),param_value_size,param_value,param_value_size_ret);
+        case CL_DEVICE_MAX_CONSTANT_BUFFER_SIZE:
+        case CL_DEVICE_LOCAL_MEM_SIZE:
+            value_ulong = HOST_RUN_LOCAL_MEM_SIZE;
+            return clhost_info(&value_ulong,sizeof(value_ulong),param_value_size,param_value,param_value_size_ret);
+        case CL_DEVICE_NAME:
+            name = clhost_cpu_info("model name");
+            if (name.empty()) name = "host CPU";
+            return clhost_info_string(name.c_str(),param_value_size,param_value,param_value_size_ret);
+        case CL_DEVICE_VENDOR:      return clhost_info_string("QCDGPU host",param_value_size,param_value,param_value_size_ret);
+        case CL_DRIVER_VERSION:     return clhost_info_string(HOST_RUN_VERSION,param_value_size,param_value,param_value_size_ret);
+        case CL_DEVICE_VERSION:     return clhost_info_string("OpenCL 1.2 " HOST_RUN_VERSION,param_value_size,param_value,param_value_size_ret);
+        case CL_DEVICE_EXTENSIONS:  return clhost_info_string("cl_khr_fp64",param_value_size,param_value,param_value_size_ret);
+    }
+    return CL_INVALID_VALUE;
+}
+
+void clHostSetIncludePath(const char* path){
+    clhost_include_path = (path) ? path : "";
+}
+
+// ___ context and queue __________________________________________________________________________
+cl_context clCreateContext(const cl_context_properties* properties, cl_uint num_devices, const cl_device_id* devices, void (CL_CALLBACK* pfn_notify)(const char*, const void*, size_t, void*), void* user_data, cl_int* errcode_ret){
+    cl_context context = new _cl_context;
+    context->references = 1;
+    if (errcode_ret) *errcode_ret = CL_SUCCESS;
+    return context;
+}
+
+cl_int clReleaseContext(cl_context context){
+    if (--context->references == 0) delete context;
+    return CL_SUCCESS;
+}
+
+cl_command_queue clCreateCommandQueue(cl_context context, cl_device_id device, cl_command_queue_properties properties, cl_int* errcode_ret){
+    cl_command_queue queue = new _cl_command_queue;
+    queue->references = 1;
+    queue->context    = context;
+    queue->properties = properties;
+    if (errcode_ret) *errcode_ret = CL_SUCCESS;
+    return queue;
+}
+
+cl_int clReleaseCommandQueue(cl_command_queue command_queue){
+    if (--command_queue->references == 0) delete command_queue;
+    return CL_SUCCESS;
+}
+
+cl_int clFlush(cl_command_queue command_queue){
+    return CL_SUCCESS;
+}
+
+cl_int clFinish(cl_command_queue command_queue){
+    return CL_SUCCESS;
+}
+
+// ___ buffers ____________________________________________________________________________________
+cl_mem clCreateBuffer(cl_context context, cl_mem_flags flags, size_t size, void* host_ptr, cl_int* errcode_ret){
+    cl_mem buffer = new _cl_mem;
+    buffer->size = size;
+    if ((flags & CL_MEM_USE_HOST_PTR) && (host_ptr)) {
+        buffer->data     = host_ptr;
+        buffer->own_data = false;
+    } else {
+        buffer->data     = NULL;
+        buffer->own_data = true;
+        if (posix_memalign(&buffer->data,128,(size) ? size : 1)) {
+            delete buffer;
+            if (errcode_ret) *errcode_ret = CL_OUT_OF_HOST_MEMORY;
+            return NULL;
+        }
+        if ((flags & CL_MEM_COPY_HOST_PTR) && (host_ptr)) memcpy(buffer->data,host_ptr,size);
+        else memset(buffer->data,0,size);
+    }
+    if (errcode_ret) *errcode_ret = CL_SUCCESS;
+    return buffer;
+}
+
+cl_int clReleaseMemObject(cl_mem memobj){
+    if (!memobj) return CL_INVALID_MEM_OBJECT;
+    if (memobj->own_data) free(memobj->data);
+    delete memobj;
+    return CL_SUCCESS;
+}
+
+cl_int clEnqueueReadBuffer(cl_command_queue command_queue, cl_mem buffer, cl_bool blocking_read, size_t offset, size_t size, void* ptr, cl_uint num_events_in_wait_list, const cl_event* event_wait_list, cl_event* event){
+    if ((!buffer) || (offset + size > buffer->size)) return CL_INVALID_MEM_OBJECT;
+    cl_ulong queued = clhost_time();
+    memcpy(ptr,(char*) buffer->data + offset,size);
+    clhost_complete(command_queue,queued,event);
+    return CL_SUCCESS;
+}
+
+cl_int clEnqueueWriteBuffer(cl_command_queue command_queue, cl_mem buffer, cl_bool blocking_write, size_t offset, size_t size, const void* ptr, cl_uint num_events_in_wait_list, const cl_event* event_wait_list, cl_event* event){
+    if ((!buffer) || (offset + size > buffer->size)) return CL_INVALID_MEM_OBJECT;
+    cl_ulong queued = clhost_time();
+    memcpy((char*) buffer->data + offset,ptr,size);
+    clhost_complete(command_queue,queued,event);
+    return CL_SUCCESS;
+}
+
+cl_int clEnqueueCopyBuffer(cl_command_queue command_queue, cl_mem src_buffer, cl_mem dst_buffer, size_t src_offset, size_t dst_offset, size_t size, cl_uint num_events_in_wait_list, const cl_event* event_wait_list, cl_event* event){
+    if ((!src_buffer) || (!dst_buffer) || (src_offset + size > src_buffer->size) || (dst_offset + size > dst_buffer->size)) return CL_INVALID_MEM_OBJECT;
+    cl_ulong queued = clhost_time();
+    memmove((char*) dst_buffer->data + dst_offset,(char*) src_buffer->data + src_offset,size);
+    clhost_complete(command_queue,queued,event);
+    return CL_SUCCESS;
+}
+
+void* clEnqueueMapBuffer(cl_command_queue command_queue, cl_mem buffer, cl_bool blocking_map, cl_map_flags map_flags, size_t offset, size_t size, cl_uint num_events_in_wait_list, const cl_event* event_wait_list, cl_event* event, cl_int* errcode_ret){
+    if ((!buffer) || (offset + size > buffer->size)) {
+        if (errcode_ret) *errcode_ret = CL_INVALID_MEM_OBJECT;
+        return NULL;
+    }
+    clhost_complete(command_queue,clhost_time(),event);
+    if (errcode_ret) *errcode_ret = CL_SUCCESS;
+    return (char*) buffer->data + offset;     // buffers are in host memory already
+}
+
+cl_int clEnqueueUnmapMemObject(cl_command_queue command_queue, cl_mem memobj, void* mapped_ptr, cl_uint num_events_in_wait_list, const cl_event* event_wait_list, cl_event* event){
+    if (!memobj) return CL_INVALID_MEM_OBJECT;
+    clhost_complete(command_queue,clhost_time(),event);
+    return CL_SUCCESS;
+}
+
+// ___ programs ___________________________________________________________________________________
+static bool clhost_is_identifier(char c){
+    return ((c>='a')&&(c<='z')) || ((c>='A')&&(c<='Z')) || ((c>='0')&&(c<='9')) || (c=='_');
+}
+
+static bool clhost_is_vector_type(const std::string& name){
+    static const char* types[] = {"char","uchar","short","ushort","int","uint","long","ulong","float","double"};
+    static const char* sizes[] = {"2","3","4","8","16"};
+    for (unsigned int i=0; i<sizeof(types)/sizeof(types[0]); i++)
+        for (unsigned int j=0; j<sizeof(sizes)/sizeof(sizes[0]); j++)
+            if (name == std::string(types[i]) + sizes[j]) return true;
+    return false;
+}
+
+// indices of swizzle (.xyz, .s012), empty if name is not a swizzle
+static std::string clhost_swizzle(const std::string& name){
+    std::string result;
+    if ((name.size()>=2) && (name.size()<=4) && (name.find_first_not_of("xyzw")==std::string::npos)) {
+        for (size_t i=0; i<name.size(); i++) {
+            int index = (name[i]=='w') ? 3 : name[i]-'x';
+            result += (i ? "," : "") + std::to_string(index);
+        }
+    } else if ((name.size()>=3) && ((name[0]=='s')||(name[0]=='S')) && (name.find_first_not_of("0123456789abcdefABCDEF",1)==std::string::npos)) {
+        for (size_t i=1; i<name.size(); i++) {
+            int index = (int) strtol(name.substr(i,1).c_str(),NULL,16);
+            result += (i>1 ? "," : "") + std::to_string(index);
+        }
+    }
+    return result;
+}
+
+// translate preprocessed OpenCL C to C++ (vector literals, swizzles) and collect kernel names
+static std::string clhost_translate(const std::string& source, std::vector<std::string>& kernels){
+    std::string result;
+    result.reserve(source.size() + source.size() / 8);
+    size_t n = source.size();
+    size_t i = 0;
+    bool line_start = true;
+    bool kernel_pending = false;
+    while (i<n) {
+        char c = source[i];
+        if (line_start && (c=='#')) {                               // line marker or pragma
+            size_t e = source.find('\n',i);
+            if (e==std::string::npos) e = n;
+            result.append(source,i,e-i);
+            i = e;
+            continue;
+        }
+        if ((c=='"')||(c=='\'')) {                                  // literal
+            size_t e = i + 1;
+            while ((e<n) && (source[e]!=c)) e += (source[e]=='\\') ? 2 : 1;
+            e = (e<n) ? e+1 : n;
+            result.append(source,i,e-i);
+            i = e;
+            line_start = false;
+            continue;
+        }
+        if (clhost_is_identifier(c)) {
+            size_t e = i;
+            while ((e<n) && clhost_is_identifier(source[e])) e++;
+            std::string word = source.substr(i,e-i);
+            if ((c>='0')&&(c<='9')) {                               // number (with exponent and fraction)
+                while ((e<n) && (clhost_is_identifier(source[e]) || (source[e]=='.') ||
+                       (((source[e]=='+')||(source[e]=='-')) && ((source[e-1]=='e')||(source[e-1]=='E'))))) e++;
+                result.append(source,i,e-i);
+                i = e;
+                line_start = false;
+                continue;
+            }
+            if (word=="__local") {                                  // kernel-scope __local variable is shared by work items
+                size_t p = result.find_last_not_of(" \t\r\n");         // of work group, which run as fibers of one thread
+                while (p!=std::string::npos) {                      // skip line markers
+                    size_t b = result.rfind('\n',p);
+                    b = (b==std::string::npos) ? 0 : b + 1;
+                    if (result[result.find_first_not_of(" \t",b)]!='#') break;
+                    p = (b>0) ? result.find_last_not_of(" \t\r\n",b-1) : std::string::npos;
+                }
+                if ((p!=std::string::npos) && ((result[p]==';')||(result[p]=='{')||(result[p]=='}'))) word = "static thread_local";
+            }
+            if (word=="__kernel") kernel_pending = true;
+            else if (kernel_pending && (word!="__attribute__")) {
+                size_t p = e;
+                while ((p<n) && isspace((unsigned char) source[p])) p++;
+                if ((p<n) && (source[p]=='(')) {
+                    kernels.push_back(word);
+                    kernel_pending = false;
+                }
+            }
+            result += word;
+            i = e;
+            line_start = false;
+            continue;
+        }
+        if (c=='(') {                                               // (float4)(a,b,c,d) -> float4(a,b,c,d)
+            size_t p = i + 1;
+            while ((p<n) && isspace((unsigned char) source[p])) p++;
+            size_t b = p;
+            while ((p<n) && clhost_is_identifier(source[p])) p++;
+            std::string word = source.substr(b,p-b);
+            while ((p<n) && isspace((unsigned char) source[p])) p++;
+            if ((p<n) && (source[p]==')') && clhost_is_vector_type(word)) {
+                size_t q = p + 1;
+                while ((q<n) && isspace((unsigned char) source[q])) q++;
+                if ((q<n) && (source[q]=='(')) {
+                    result += word;
+                    i = q;
+                    line_start = false;
+                    continue;
+                }
+            }
+        }
+        if ((c=='.') || ((c=='-') && (i+1<n) && (source[i+1]=='>'))) {  // swizzles
+            size_t b = (c=='.') ? i+1 : i+2;
+            size_t e = b;
+            while ((e<n) && clhost_is_identifier(source[e])) e++;
+            std::string indices = ((e>b) && !((source[b]>='0')&&(source[b]<='9'))) ? clhost_swizzle(source.substr(b,e-b)) : "";
+            if (!indices.empty()) {
+                size_t p = e;
+                while ((p<n) && isspace((unsigned char) source[p])) p++;
+                bool assignment = ((p<n) && (source[p]=='=') && !((p+1<n) && (source[p+1]=='='))) ||
+                                  ((p+1<n) && (strchr("+-*/",source[p])) && (source[p+1]=='='));
+                result.append(source,i,b-i);
+                result += (assignment ? "ref<" : "get<") + indices + ">()";
+                i = e;
+                line_start = false;
+                continue;
+            }
+        }
+        result += c;
+        line_start = (c=='\n') || (line_start && isspace((unsigned char) c));
+        i++;
+    }
+    return result;
+}
+
+static std::vector<std::string> clhost_split(const std::string& text){
+    std::vector<std::string> result;
+    size_t i = 0;
+    while (i<text.size()) {
+        while ((i<text.size()) && isspace((unsigned char) text[i])) i++;
+        size_t e = i;
+        while ((e<text.size()) && !isspace((unsigned char) text[e])) e++;
+        if (e>i) result.push_back(text.substr(i,e-i));
+        i = e;
+    }
+    return result;
+}
+
+static bool clhost_read_file(const std::string& file_name, std::string& data){
+    FILE* stream = fopen(file_name.c_str(),"rb");
+    if (!stream) return false;
+    data.clear();
+    char buffer[65536];
+    size_t length;
+    while ((length = fread(buffer,1,sizeof(buffer),stream)) > 0) data.append(buffer,length);
+    fclose(stream);
+    return true;
+}
+
+static bool clhost_write_file(const std::string& file_name, const std::string& data){
+    FILE* stream = fopen(file_name.c_str(),"wb");
+    if (!stream) return false;
+    bool result = (fwrite(data.data(),1,data.size(),stream) == data.size());
+    fclose(stream);
+    return result;
+}
+
+// run compiler without shell (paths may contain spaces and brackets), output goes to log
+static bool clhost_execute(const std::vector<std::string>& arguments, const std::string& log_file, std::string& log){
+    std::vector<char*> argv;
+    for (size_t i=0; i<arguments.size(); i++) argv.push_back((char*) arguments[i].c_str());
+    argv.push_back(NULL);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions,1,log_file.c_str(),O_WRONLY|O_CREAT|O_TRUNC,0644);
+    posix_spawn_file_actions_adddup2(&actions,1,2);
+
+    pid_t pid;
+    int status = -1;
+    int error = posix_spawnp(&pid,argv[0],&actions,NULL,argv.data(),environ);
+    posix_spawn_file_actions_destroy(&actions);
+    if (error) {
+        log += "can not start " + arguments[0] + "\n";
+        return false;
+    }
+    while (waitpid(pid,&status,0) < 0) {}
+
+    std::string output;
+    if (clhost_read_file(log_file,output)) log += output;
+    unlink(log_file.c_str());
+    return (WIFEXITED(status)) && (WEXITSTATUS(status)==0);
+}
+
+static std::string clhost_temporary_directory(void){
+    const char* root = getenv("TMPDIR");
+    std::string pattern = std::string((root) ? root : "/tmp") + "/qcdgpu_host_XXXXXX";
+    std::vector<char> buffer(pattern.begin(),pattern.end());
+    buffer.push_back(0);
+    return (mkdtemp(buffer.data())) ? std::string(buffer.data()) : std::string();
+}
+
+static cl_int clhost_load(cl_program program, const std::string& directory){
+    std::string library = directory + "/program.so";
+    if ((program->binary.empty()) || (!clhost_write_file(library,program->binary))) return CL_INVALID_BINARY;
+    program->handle = dlopen(library.c_str(),RTLD_NOW|RTLD_LOCAL);
+    unlink(library.c_str());
+    if (!program->handle) {
+        const char* error = dlerror();
+        program->log += std::string((error) ? error : "dlopen failed") + "\n";
+        return CL_INVALID_BINARY;
+    }
+    return CL_SUCCESS;
+}
+
+static cl_int clhost_compile(cl_program program, const std::string& directory){
+    std::string source_file = directory + "/program.cl";
+    std::string preprocessed_file = directory + "/program.i";
+    std::string cpp_file = directory + "/program.cpp";
+    std::string library = directory + "/program.so";
+    std::string log_file = directory + "/build.log";
+
+    if (!clhost_write_file(source_file,program->source)) return CL_OUT_OF_RESOURCES;
+
+    // preprocess with OpenCL build options (-D and -I only)
+    std::vector<std::string> compiler = clhost_split(HOST_RUN_CXX);
+    std::vector<std::string> arguments = compiler;
+    arguments.push_back("-E");
+    arguments.push_back("-x");
+    arguments.push_back("c++");
+    arguments.push_back("-D");
+    arguments.push_back("cl_khr_fp64=1");
+    arguments.push_back("-D");
+    arguments.push_back("__OPENCL_VERSION__=120");
+    arguments.push_back("-D");
+    arguments.push_back("HOST_RUN");
+    std::vector<std::string> options = clhost_split(program->options);
+    for (size_t i=0; i<options.size(); i++) {
+        if ((options[i]=="-D") || (options[i]=="-I")) {
+            if (i+1<options.size()) {
+                arguments.push_back(options[i]);
+                arguments.push_back(options[++i]);
+            }
+        } else if ((options[i].compare(0,2,"-D")==0) || (options[i].compare(0,2,"-I")==0))
+            arguments.push_back(options[i]);
+    }
+    arguments.push_back(source_file);
+    arguments.push_back("-o");
+    arguments.push_back(preprocessed_file);
+    bool result = clhost_execute(arguments,log_file,program->log);
+    unlink(source_file.c_str());
+    if (!result) return CL_BUILD_PROGRAM_FAILURE;
+
+    // translate to C++ and add entries of kernels
+    std::string preprocessed;
+    result = clhost_read_file(preprocessed_file,preprocessed);
+    unlink(preprocessed_file.c_str());
+    if (!result) return CL_BUILD_PROGRAM_FAILURE;
+    std::vector<std::string> kernels;
+    std::string cpp = "#include \"clhost_kernel.h\"\n" + clhost_translate(preprocessed,kernels) + "\n";
+    for (size_t i=0; i<kernels.size(); i++) cpp += "CLHOST_KERNEL(" + kernels[i] + ")\n";
+    if (!clhost_write_file(cpp_file,cpp)) return CL_OUT_OF_RESOURCES;
+
+    // compile shared object
+    arguments = compiler;
+    std::vector<std::string> flags = clhost_split(HOST_RUN_CXXFLAGS);
+    arguments.insert(arguments.end(),flags.begin(),flags.end());
+    arguments.push_back("-I");
+    arguments.push_back(clhost_include_path.empty() ? std::string(".") : clhost_include_path);
+    arguments.push_back(cpp_file);
+    arguments.push_back("-o");
+    arguments.push_back(library);
+    result = clhost_execute(arguments,log_file,program->log);
+    unlink(cpp_file.c_str());
+    if (result) result = clhost_read_file(library,program->binary);
+    unlink(library.c_str());
+
+    return (result) ? CL_SUCCESS : CL_BUILD_PROGRAM_FAILURE;
+}
+
+cl_program clCreateProgramWithSource(cl_context context, cl_uint count, const char** strings, const size_t* lengths, cl_int* errcode_ret){
+    cl_program program = new _cl_program;
+    program->references = 1;
+    program->status = CL_BUILD_NONE;
+    program->handle = NULL;
+    for (cl_uint i=0; i<count; i++) {
+        if ((lengths) && (lengths[i])) program->source.append(strings[i],lengths[i]);
+        else program->source.append(strings[i]);
+    }
+    if (errcode_ret) *errcode_ret = CL_SUCCESS;
+    return program;
+}
+
+cl_program clCreateProgramWithBinary(cl_context context, cl_uint num_devices, const cl_device_id* device_list, const size_t* lengths, const unsigned char** binaries, cl_int* binary_status, cl_int* errcode_ret){
+    cl_program program = new _cl_program;
+    program->references = 1;
+    program->status = CL_BUILD_NONE;
+    program->handle = NULL;
+    program->binary.assign((const char*) binaries[0],lengths[0]);
+    if (binary_status) binary_status[0] = CL_SUCCESS;
+    if (errcode_ret) *errcode_ret = CL_SUCCESS;
+    return program;
+}
+
+cl_int clReleaseProgram(cl_program program){
+    if (!program) return CL_INVALID_VALUE;
+    if (--program->references == 0) {
+        if (program->handle) dlclose(program->handle);
+        delete program;
+    }
+    return CL_SUCCESS;
+}
+
+cl_int clBuildProgram(cl_program program, cl_uint num_devices, const cl_device_id* device_list, const char* options, void (CL_CALLBACK* pfn_notify)(cl_program, void*), void* user_data){
+    program->options = (options) ? options : "";
+    program->status  = CL_BUILD_IN_PROGRESS;
+    std::string directory = clhost_temporary_directory();
+    if (directory.empty()) {
+        program->status = CL_BUILD_ERROR;
+        return CL_OUT_OF_RESOURCES;
+    }
+    cl_int result = CL_SUCCESS;
+    if (!program->source.empty()) result = clhost_compile(program,directory);
+    if (result==CL_SUCCESS) result = clhost_load(program,directory);
+    rmdir(directory.c_str());
+    program->status = (result==CL_SUCCESS) ? CL_BUILD_SUCCESS : CL_BUILD_ERROR;
+    return result;
+}
+
+cl_int clGetProgramInfo(cl_program program, cl_program_info param_name, size_t param_value_size, void* param_value, size_t* param_value_size_ret){
+    cl_uint num_devices = 1;
+    cl_device_id device = &clhost_device;
+    size_t binary_size  = program->binary.size();
+    switch (param_name) {
+        case CL_PROGRAM_NUM_DEVICES:    return clhost_info(&num_devices,sizeof(num_devices),param_value_size,param_value,param_value_size_ret);
+        case CL_PROGRAM_DEVICES:        return clhost_info(&device,sizeof(device),param_value_size,param_value,param_value_size_ret);
+        case CL_PROGRAM_SOURCE:         return clhost_info_string(program->source.c_str(),param_value_size,param_value,param_value_size_ret);
+        case CL_PROGRAM_BINARY_SIZES:   return clhost_info(&binary_size,sizeof(binary_size),param_value_size,param_value,param_value_size_ret);
+        case CL_PROGRAM_BINARIES:
+            if (param_value) {
+                if (param_value_size < sizeof(unsigned char*)) return CL_INVALID_VALUE;
+                unsigned char* binary = ((unsigned char**) param_value)[0];
+                if (binary) memcpy(binary,program->binary.data(),binary_size);
+            }
+            if (param_value_size_ret) *param_value_size_ret = sizeof(unsigned char*);
+            return CL_SUCCESS;
+    }
+    return CL_INVALID_VALUE;
+}
+
+cl_int clGetProgramBuildInfo(cl_program program, cl_device_id device, cl_program_build_info param_name, size_t param_value_size, void* param_value, size_t* param_value_size_ret){
+    switch (param_name) {
+        case CL_PROGRAM_BUILD_STATUS:   return clhost_info(&program->status,sizeof(program->status),param_value_size,param_value,param_value_size_ret);
+        case CL_PROGRAM_BUILD_OPTIONS:  return clhost_info_string(program->options.c_str(),param_value_size,param_value,param_value_size_ret);
+        case CL_PROGRAM_BUILD_LOG:      return clhost_info_string(program->log.c_str(),param_value_size,param_value,param_value_size_ret);
+    }
+    return CL_INVALID_VALUE;
+}
+
+// ___ kernels ____________________________________________________________________________________
+cl_kernel clCreateKernel(cl_program program, const char* kernel_name, cl_int* errcode_ret){
+    if ((!program) || (!program->handle)) {
+        if (errcode_ret) *errcode_ret = CL_INVALID_PROGRAM_EXECUTABLE;
+        return NULL;
+    }
+    clhost_kernel_entry entry = (clhost_kernel_entry) dlsym(program->handle,(std::string(CLHOST_KERNEL_PREFIX) + kernel_name).c_str());
+    if (!entry) {
+        if (errcode_ret) *errcode_ret = CL_INVALID_KERNEL_NAME;
+        return NULL;
+    }
+    cl_kernel kernel = new _cl_kernel;
+    kernel->references = 1;
+    kernel->program = program;
+    kernel->name    = kernel_name;
+    kernel->entry   = entry;
+
+    // pointer arguments are cl_mem on host side
+    int arguments_number = entry(NULL,NULL,0,0);
+    std::vector<char> pointers(arguments_number + 1,0);
+    clhost_kernel_signature signature = (clhost_kernel_signature) dlsym(program->handle,(std::string(CLHOST_SIGNATURE_PREFIX) + kernel_name).c_str());
+    if (signature) signature(pointers.data());
+    kernel->arguments.resize(arguments_number);
+    for (int i=0; i<arguments_number; i++) {
+        memset(&kernel->arguments[i],0,sizeof(clhost_argument));
+        kernel->arguments[i].pointer = (pointers[i]!=0);
+    }
+    program->references++;
+    if (errcode_ret) *errcode_ret = CL_SUCCESS;
+    return kernel;
+}
+
+cl_int clReleaseKernel(cl_kernel kernel){
+    if (!kernel) return CL_INVALID_KERNEL;
+    if (--kernel->references == 0) {
+        clReleaseProgram(kernel->program);
+        delete kernel;
+    }
+    return CL_SUCCESS;
+}
+
+cl_int clSetKernelArg(cl_kernel kernel, cl_uint arg_index, size_t arg_size, const void* arg_value){
+    if (!kernel) return CL_INVALID_KERNEL;
+    if (arg_index >= kernel->arguments.size()) return CL_INVALID_ARG_INDEX;
+    clhost_argument* argument = &kernel->arguments[arg_index];
+    if (arg_value==NULL) {
+        if ((!argument->pointer) || (arg_size==0) || (arg_size > HOST_RUN_LOCAL_MEM_SIZE)) return CL_INVALID_ARG_SIZE;
+        argument->local = true;
+        argument->size  = arg_size;
+    } else {
+        if (arg_size > sizeof(argument->value)) return CL_INVALID_ARG_SIZE;
+        argument->local = false;
+        argument->size  = arg_size;
+        memcpy(argument->value,arg_value,arg_size);
+    }
+    argument->set = true;
+    return CL_SUCCESS;
+}
+
+cl_int clGetKernelWorkGroupInfo(cl_kernel kernel, cl_device_id device, cl_kernel_work_group_info param_name, size_t param_value_size, void* param_value, size_t* param_value_size_ret){
+    size_t   value_size[3] = {HOST_RUN_WORK_GROUP_MAX, 0, 0};
+    cl_ulong value_ulong   = 0;
+    switch (param_name) {
+        case CL_KERNEL_WORK_GROUP_SIZE:         return clhost_info(value_size,sizeof(size_t),param_value_size,param_value,param_value_size_ret);
+        case CL_KERNEL_COMPILE_WORK_GROUP_SIZE:
+            value_size[0] = 0;
+            return clhost_info(value_size,sizeof(value_size),param_value_size,param_value,param_value_size_ret);
+        case CL_KERNEL_LOCAL_MEM_SIZE:          return clhost_info(&value_ulong,sizeof(value_ulong),param_value_size,param_value,param_value_size_ret);
+        case CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE:
+            value_size[0] = 1;
+            return clhost_info(value_size,sizeof(size_t),param_value_size,param_value,param_value_size_ret);
+    }
+    return CL_INVALID_VALUE;
+}
+
+// ___ execution __________________________________________________________________________________
+// Work groups are distributed between host threads. The first work item of each group runs
+// on its own stack: if it returns without reaching barrier, the rest of the group runs as a
+// plain loop; otherwise every work item gets a stack and they are switched at barriers.
+struct clhost_launch {
+    cl_kernel       kernel;
+    clhost_item     item;               // sizes of NDRange
+    size_t          groups;             // total number of work groups
+    std::vector<void*> buffers;         // data of __global arguments
+    std::atomic<size_t> next_group;
+};
+
+struct clhost_worker {
+    clhost_launch*  launch;
+    std::vector<void*>  arguments;      // argument pointers passed to kernel entry
+    std::vector<void*>  locals;         // __local arguments of this worker
+    std::vector<std::vector<char> > local_memory;
+    std::vector<clhost_item> items;
+    std::vector<ucontext_t>  contexts;
+    std::vector<char*>       stacks;
+    std::vector<char>        done;
+    ucontext_t      scheduler;
+    size_t          starting;           // work item started by clhost_fiber
+    size_t          finished;
+
+    clhost_worker() : launch(NULL), starting(0), finished(0) {}
+    ~clhost_worker(){ for (size_t i=0; i<stacks.size(); i++) free(stacks[i]); }
+};
+
+static thread_local clhost_worker* clhost_this_worker = NULL;
+
+static void clhost_barrier(clhost_item* item){
+    clhost_worker* worker = (clhost_worker*) item->worker;
+    size_t index = (size_t) (item - worker->items.data());
+    if ((!worker->stacks.size()) || (index >= worker->items.size()) || (!worker->contexts.size())) {
+        fprintf(stderr,"barrier outside of work group\n");
+        abort();
+    }
+    swapcontext(&worker->contexts[index],&worker->scheduler);
+}
+
+static void clhost_fiber(void){
+    clhost_worker* worker = clhost_this_worker;
+    size_t index = worker->starting;
+    worker->launch->kernel->entry(worker->arguments.data(),&worker->items[index],index,index+1);
+    worker->done[index] = 1;
+    worker->finished++;
+}   // returns to worker->scheduler (uc_link)
+
+static void clhost_fiber_start(clhost_worker* worker, size_t index){
+    if (worker->stacks[index]==NULL) worker->stacks[index] = (char*) malloc(HOST_RUN_STACK_SIZE);
+    getcontext(&worker->contexts[index]);
+    worker->contexts[index].uc_stack.ss_sp   = worker->stacks[index];
+    worker->contexts[index].uc_stack.ss_size = HOST_RUN_STACK_SIZE;
+    worker->contexts[index].uc_link          = &worker->scheduler;
+    makecontext(&worker->contexts[index],clhost_fiber,0);
+    worker->starting = index;
+    swapcontext(&worker->scheduler,&worker->contexts[index]);
+}
+
+static void clhost_run_group(clhost_worker* worker, size_t group){
+    clhost_launch* launch = worker->launch;
+    clhost_item item = launch->item;
+    item.group_id[0] = group % item.num_groups[0];
+    item.group_id[1] = (group / item.num_groups[0]) % item.num_groups[1];
+    item.group_id[2] = group / (item.num_groups[0] * item.num_groups[1]);
+    item.worker  = worker;
+    item.barrier = clhost_barrier;
+    size_t items = item.local_size[0] * item.local_size[1] * item.local_size[2];
+
+    if (worker->items.size() < items) {
+        worker->items.resize(items);
+        worker->contexts.resize(items);
+        worker->stacks.resize(items,NULL);
+        worker->done.resize(items);
+    }
+    worker->finished = 0;
+    worker->done[0]  = 0;
+    worker->items[0] = item;
+    clhost_fiber_start(worker,0);
+    if (worker->done[0]) {
+        // no barriers: rest of work group in a loop
+        if (items>1) launch->kernel->entry(worker->arguments.data(),&item,1,items);
+        return;
+    }
+    for (size_t l=1; l<items; l++) {
+        worker->done[l]  = 0;
+        worker->items[l] = item;
+        clhost_fiber_start(worker,l);
+    }
+    while (worker->finished < items)
+        for (size_t l=0; l<items; l++)
+            if (!worker->done[l]) swapcontext(&worker->scheduler,&worker->contexts[l]);
+}
+
+static void clhost_work(clhost_worker* worker, clhost_launch* launch){
+    clhost_this_worker = worker;
+    worker->launch = launch;
+    cl_kernel kernel = launch->kernel;
+    size_t arguments_number = kernel->arguments.size();
+    worker->arguments.resize(arguments_number);
+    worker->locals.resize(arguments_number);
+    worker->local_memory.resize(arguments_number);
+    for (size_t i=0; i<arguments_number; i++) {
+        clhost_argument* argument = &kernel->arguments[i];
+        if (argument->local) {
+            if (worker->local_memory[i].size() < argument->size + 64) worker->local_memory[i].resize(argument->size + 64);
+            worker->locals[i] = (void*) (((uintptr_t) worker->local_memory[i].data() + 63) & ~((uintptr_t) 63));
+            worker->arguments[i] = &worker->locals[i];
+        } else if (argument->pointer)
+            worker->arguments[i] = &launch->buffers[i];
+        else
+            worker->arguments[i] = argument->value;
+    }
+    size_t group;
+    while ((group = launch->next_group++) < launch->groups) clhost_run_group(worker,group);
+}
+
+class clhost_pool {
+    public:
+        clhost_pool() : launch(NULL), generation(0), active(0), stop(false) {
+            unsigned int threads_number = clhost_threads();
+            workers.resize(threads_number);
+            for (unsigned int i=1; i<threads_number; i++) threads.push_back(std::thread(&clhost_pool::thread,this,i));
+        }
+        ~clhost_pool(){
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stop = true;
+            }
+            start.notify_all();
+            for (size_t i=0; i<threads.size(); i++) threads[i].join();
+        }
+        void run(clhost_launch* job){
+            std::lock_guard<std::mutex> run_lock(run_mutex);     // several GPU_CL::GPU objects may share the pool
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                launch = job;
+                active = (unsigned int) threads.size();
+                generation++;
+            }
+            start.notify_all();
+            clhost_work(&workers[0],job);
+            std::unique_lock<std::mutex> lock(mutex);
+            done.wait(lock,[this]{ return active==0; });
+            launch = NULL;
+        }
+    private:
+        void thread(unsigned int index){
+            size_t seen = 0;
+            while (true) {
+                clhost_launch* job;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    start.wait(lock,[this,seen]{ return stop || (generation!=seen); });
+                    if (stop) return;
+                    seen = generation;
+                    job  = launch;
+                }
+                clhost_work(&workers[index],job);
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (--active == 0) done.notify_one();
+                }
+            }
+        }
+        std::vector<clhost_worker> workers;
+        std::vector<std::thread>   threads;
+        std::mutex                 mutex;
+        std::mutex                 run_mutex;
+        std::condition_variable    start;
+        std::condition_variable    done;
+        clhost_launch*             launch;
+        size_t                     generation;
+        unsigned int               active;
+        bool                       stop;
+};
+
+static clhost_pool* clhost_get_pool(void){
+    static clhost_pool pool;
+    return &pool;
+}
+
+cl_int clEnqueueNDRangeKernel(cl_command_queue command_queue, cl_kernel kernel, cl_uint work_dim, const size_t* global_work_offset, const size_t* global_work_size, const size_t* local_work_size, cl_uint num_events_in_wait_list, const cl_event* event_wait_list, cl_event* event){
+    if (!kernel) return CL_INVALID_KERNEL;
+    if ((work_dim<1) || (work_dim>3) || (!global_work_size)) return CL_INVALID_WORK_DIMENSION;
+    for (size_t i=0; i<kernel->arguments.size(); i++) if (!kernel->arguments[i].set) return CL_INVALID_KERNEL_ARGS;
+
+    clhost_launch launch;
+    launch.kernel = kernel;
+    memset(&launch.item,0,sizeof(launch.item));
+    launch.item.work_dim = work_dim;
+    size_t group_size = 1;
+    launch.groups = 1;
+    for (cl_uint d=0; d<3; d++) {
+        size_t global = (d<work_dim) ? global_work_size[d] : 1;
+        size_t local  = 1;
+        if (d<work_dim) {
+            if (local_work_size) local = local_work_size[d];
+            else {
+                local = (d==0) ? HOST_RUN_WORK_GROUP_MAX : 1;
+                while ((local>1) && (global % local)) local >>= 1;
+            }
+        }
+        if ((local==0) || (global % local)) return CL_INVALID_WORK_GROUP_SIZE;
+        group_size *= local;
+        launch.item.global_offset[d] = ((global_work_offset) && (d<work_dim)) ? global_work_offset[d] : 0;
+        launch.item.global_size[d] = global;
+        launch.item.local_size[d]  = local;
+        launch.item.num_groups[d]  = global / local;
+        launch.groups *= launch.item.num_groups[d];
+    }
+    if (group_size > HOST_RUN_WORK_GROUP_MAX) return CL_INVALID_WORK_GROUP_SIZE;
+
+    launch.buffers.resize(kernel->arguments.size(),NULL);
+    for (size_t i=0; i<kernel->arguments.size(); i++)
+        if ((kernel->arguments[i].pointer) && (!kernel->arguments[i].local)) {
+            cl_mem buffer;
+            memcpy(&buffer,kernel->arguments[i].value,sizeof(buffer));
+            launch.buffers[i] = (buffer) ? buffer->data : NULL;
+        }
+    launch.next_group = 0;
+
+    cl_ulong queued = clhost_time();
+    if (launch.groups) clhost_get_pool()->run(&launch);
+    clhost_complete(command_queue,queued,event);
+    return CL_SUCCESS;
+}
+
+// ___ events _____________________________________________________________________________________
+cl_int clWaitForEvents(cl_uint num_events, const cl_event* event_list){
+    for (cl_uint i=0; i<num_events; i++) if (!event_list[i]) return CL_INVALID_EVENT;
+    return CL_SUCCESS;
+}
+
+cl_int clGetEventInfo(cl_event event, cl_event_info param_name, size_t param_value_size, void* param_value, size_t* param_value_size_ret){
+    cl_int status = CL_COMPLETE;
+    if (!event) return CL_INVALID_EVENT;
+    switch (param_name) {
+        case CL_EVENT_COMMAND_QUEUE:            return clhost_info(&event->queue,sizeof(event->queue),param_value_size,param_value,param_value_size_ret);
+        case CL_EVENT_COMMAND_EXECUTION_STATUS: return clhost_info(&status,sizeof(status),param_value_size,param_value,param_value_size_ret);
+    }
+    return CL_INVALID_VALUE;
+}
+
+cl_int clGetEventProfilingInfo(cl_event event, cl_profiling_info param_name, size_t param_value_size, void* param_value, size_t* param_value_size_ret){
+    if (!event) return CL_INVALID_EVENT;
+    switch (param_name) {
+        case CL_PROFILING_COMMAND_QUEUED:
+        case CL_PROFILING_COMMAND_SUBMIT:   return clhost_info(&event->queued,sizeof(cl_ulong),param_value_size,param_value,param_value_size_ret);
+        case CL_PROFILING_COMMAND_START:    return clhost_info(&event->start,sizeof(cl_ulong),param_value_size,param_value,param_value_size_ret);
+        case CL_PROFILING_COMMAND_END:      return clhost_info(&event->end,sizeof(cl_ulong),param_value_size,param_value,param_value_size_ret);
+    }
+    return CL_INVALID_VALUE;
+}
+
+cl_int clRetainEvent(cl_event event){
+    if (!event) return CL_INVALID_EVENT;
+    event->references++;
+    return CL_SUCCESS;
+}
+
+cl_int clReleaseEvent(cl_event event){
+    if (!event) return CL_INVALID_EVENT;
+    if (--event->references == 0) delete event;
+    return CL_SUCCESS;
+}
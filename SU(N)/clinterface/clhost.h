@@ -0,0 +1,264 @@
+/******************************************************************************
+ * @file     clhost.h
+ * @author   Vadim Demchik <vadimdi@yahoo.com>,
+ * @author   Natalia Kolomoyets <rknv7@mail.ru>
+ * @version  1.6
+ *
+ * @brief    [QCDGPU]
+ *           Host-native OpenCL-free backend (HOST_RUN):
+ *           subset of OpenCL 1.2 API used by GPU_CL::GPU, kernels are compiled as C++
+ *
+ * @section  LICENSE
+ *
+ * Copyright (c) 2013-2016 Vadim Demchik, Natalia Kolomoyets
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *    Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *****************************************************************************/
+#ifndef clhost_h
+#define clhost_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// compiler for kernels (program sources are preprocessed, translated to C++ and built as shared objects)
+#ifndef HOST_RUN_CXX
+#define HOST_RUN_CXX            "g++"
+#endif
+#ifndef HOST_RUN_CXXFLAGS
+#define HOST_RUN_CXXFLAGS       "-std=c++17 -O3 -march=native -fPIC -shared -fvisibility=hidden -w"
+#endif
+#define HOST_RUN_VERSION        "QCDGPU host 1.0"   // part of program cache key (binaries are shared objects)
+#define HOST_RUN_WORK_GROUP_MAX 256                 // max number of work items in work group
+#define HOST_RUN_LOCAL_MEM_SIZE 65536               // local memory per work group (bytes)
+#define HOST_RUN_STACK_SIZE     (256*1024)          // stack of work item, which reaches barrier (bytes)
+
+// ___ scalar and vector types (layout of cl_platform.h) __________________________________________
+typedef int8_t      cl_char;
+typedef uint8_t     cl_uchar;
+typedef int16_t     cl_short;
+typedef uint16_t    cl_ushort;
+typedef int32_t     cl_int;
+typedef uint32_t    cl_uint;
+typedef int64_t     cl_long;
+typedef uint64_t    cl_ulong;
+typedef float       cl_float;
+typedef double      cl_double;
+typedef cl_uint     cl_bool;
+typedef cl_ulong    cl_bitfield;
+
+#define CLHOST_VECTOR2(type)    typedef union { type s[2]; struct { type x, y; };       struct { type s0, s1; };         } type##2;
+#define CLHOST_VECTOR4(type)    typedef union { type s[4]; struct { type x, y, z, w; }; struct { type s0, s1, s2, s3; }; } type##4; \
+                                typedef type##4 type##3;
+CLHOST_VECTOR2(cl_char)   CLHOST_VECTOR4(cl_char)
+CLHOST_VECTOR2(cl_uchar)  CLHOST_VECTOR4(cl_uchar)
+CLHOST_VECTOR2(cl_short)  CLHOST_VECTOR4(cl_short)
+CLHOST_VECTOR2(cl_ushort) CLHOST_VECTOR4(cl_ushort)
+CLHOST_VECTOR2(cl_int)    CLHOST_VECTOR4(cl_int)
+CLHOST_VECTOR2(cl_uint)   CLHOST_VECTOR4(cl_uint)
+CLHOST_VECTOR2(cl_long)   CLHOST_VECTOR4(cl_long)
+CLHOST_VECTOR2(cl_ulong)  CLHOST_VECTOR4(cl_ulong)
+CLHOST_VECTOR2(cl_float)  CLHOST_VECTOR4(cl_float)
+CLHOST_VECTOR2(cl_double) CLHOST_VECTOR4(cl_double)
+#undef CLHOST_VECTOR2
+#undef CLHOST_VECTOR4
+
+// ___ objects ____________________________________________________________________________________
+typedef struct _cl_platform_id*     cl_platform_id;
+typedef struct _cl_device_id*       cl_device_id;
+typedef struct _cl_context*         cl_context;
+typedef struct _cl_command_queue*   cl_command_queue;
+typedef struct _cl_mem*             cl_mem;
+typedef struct _cl_program*         cl_program;
+typedef struct _cl_kernel*          cl_kernel;
+typedef struct _cl_event*           cl_event;
+
+typedef cl_bitfield cl_device_type;
+typedef cl_uint     cl_platform_info;
+typedef cl_uint     cl_device_info;
+typedef cl_bitfield cl_command_queue_properties;
+typedef intptr_t    cl_context_properties;
+typedef cl_bitfield cl_mem_flags;
+typedef cl_bitfield cl_map_flags;
+typedef cl_uint     cl_program_info;
+typedef cl_uint     cl_program_build_info;
+typedef cl_int      cl_build_status;
+typedef cl_uint     cl_kernel_work_group_info;
+typedef cl_uint     cl_event_info;
+typedef cl_uint     cl_profiling_info;
+
+// ___ constants __________________________________________________________________________________
+#define CL_SUCCESS                                  0
+#define CL_DEVICE_NOT_FOUND                         -1
+#define CL_OUT_OF_RESOURCES                         -5
+#define CL_OUT_OF_HOST_MEMORY                       -6
+#define CL_BUILD_PROGRAM_FAILURE                    -11
+#define CL_INVALID_VALUE                            -30
+#define CL_INVALID_DEVICE                           -33
+#define CL_INVALID_MEM_OBJECT                       -38
+#define CL_INVALID_BINARY                           -42
+#define CL_INVALID_PROGRAM_EXECUTABLE               -45
+#define CL_INVALID_KERNEL_NAME                      -46
+#define CL_INVALID_KERNEL                           -48
+#define CL_INVALID_ARG_INDEX                        -49
+#define CL_INVALID_ARG_SIZE                         -51
+#define CL_INVALID_KERNEL_ARGS                      -52
+#define CL_INVALID_WORK_DIMENSION                   -53
+#define CL_INVALID_WORK_GROUP_SIZE                  -54
+#define CL_INVALID_EVENT                            -58
+
+#define CL_FALSE                                    0
+#define CL_TRUE                                     1
+
+#define CL_PLATFORM_PROFILE                         0x0900
+#define CL_PLATFORM_VERSION                         0x0901
+#define CL_PLATFORM_NAME                            0x0902
+#define CL_PLATFORM_VENDOR                          0x0903
+#define CL_PLATFORM_EXTENSIONS                      0x0904
+
+#define CL_DEVICE_TYPE_CPU                          (1 << 1)
+#define CL_DEVICE_TYPE_ALL                          0xFFFFFFFF
+
+#define CL_DEVICE_TYPE                              0x1000
+#define CL_DEVICE_MAX_COMPUTE_UNITS                 0x1002
+#define CL_DEVICE_MAX_WORK_ITEM_DIMENSIONS          0x1003
+#define CL_DEVICE_MAX_WORK_GROUP_SIZE               0x1004
+#define CL_DEVICE_MAX_WORK_ITEM_SIZES               0x1005
+#define CL_DEVICE_MAX_CLOCK_FREQUENCY               0x100C
+#define CL_DEVICE_MAX_MEM_ALLOC_SIZE                0x1010
+#define CL_DEVICE_IMAGE2D_MAX_WIDTH                 0x1011
+#define CL_DEVICE_IMAGE3D_MAX_WIDTH                 0x1013
+#define CL_DEVICE_GLOBAL_MEM_SIZE                   0x101F
+#define CL_DEVICE_MAX_CONSTANT_BUFFER_SIZE          0x1020
+#define CL_DEVICE_LOCAL_MEM_SIZE                    0x1023
+#define CL_DEVICE_NAME                              0x102B
+#define CL_DEVICE_VENDOR                            0x102C
+#define CL_DRIVER_VERSION                           0x102D
+#define CL_DEVICE_VERSION                           0x102F
+#define CL_DEVICE_EXTENSIONS                        0x1030
+
+#define CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE      (1 << 0)
+#define CL_QUEUE_PROFILING_ENABLE                   (1 << 1)
+
+#define CL_MEM_READ_WRITE                           (1 << 0)
+#define CL_MEM_WRITE_ONLY                           (1 << 1)
+#define CL_MEM_READ_ONLY                            (1 << 2)
+#define CL_MEM_USE_HOST_PTR                         (1 << 3)
+#define CL_MEM_ALLOC_HOST_PTR                       (1 << 4)
+#define CL_MEM_COPY_HOST_PTR                        (1 << 5)
+
+#define CL_MAP_READ                                 (1 << 0)
+#define CL_MAP_WRITE                                (1 << 1)
+
+#define CL_PROGRAM_NUM_DEVICES                      0x1162
+#define CL_PROGRAM_DEVICES                          0x1163
+#define CL_PROGRAM_SOURCE                           0x1164
+#define CL_PROGRAM_BINARY_SIZES                     0x1165
+#define CL_PROGRAM_BINARIES                         0x1166
+
+#define CL_PROGRAM_BUILD_STATUS                     0x1181
+#define CL_PROGRAM_BUILD_OPTIONS                    0x1182
+#define CL_PROGRAM_BUILD_LOG                        0x1183
+
+#define CL_BUILD_SUCCESS                            0
+#define CL_BUILD_NONE                               -1
+#define CL_BUILD_ERROR                              -2
+#define CL_BUILD_IN_PROGRESS                        -3
+
+#define CL_KERNEL_WORK_GROUP_SIZE                   0x11B0
+#define CL_KERNEL_COMPILE_WORK_GROUP_SIZE           0x11B1
+#define CL_KERNEL_LOCAL_MEM_SIZE                    0x11B2
+#define CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE 0x11B3
+
+#define CL_EVENT_COMMAND_QUEUE                      0x11D0
+#define CL_EVENT_COMMAND_EXECUTION_STATUS           0x11D3
+#define CL_COMPLETE                                 0x0
+
+#define CL_PROFILING_COMMAND_QUEUED                 0x1280
+#define CL_PROFILING_COMMAND_SUBMIT                 0x1281
+#define CL_PROFILING_COMMAND_START                  0x1282
+#define CL_PROFILING_COMMAND_END                    0x1283
+
+#define CL_CALLBACK
+
+// ___ work item state (shared with kernels compiled by clhost_kernel.h) __________________________
+typedef struct _clhost_item {
+    size_t  global_offset[3];
+    size_t  global_size[3];
+    size_t  local_size[3];
+    size_t  num_groups[3];
+    size_t  group_id[3];
+    size_t  local_id[3];
+    cl_uint work_dim;
+    void  (*barrier)(struct _clhost_item* item);    // switches to next work item of work group
+    void*   worker;                                 // host thread, which executes work group
+} clhost_item;
+
+// kernel entry in compiled program: runs work items [first,last) of work group, returns number of kernel arguments
+typedef int (*clhost_kernel_entry)(void** arguments, clhost_item* item, size_t first, size_t last);
+#define CLHOST_KERNEL_PREFIX    "clhost_kernel_"
+
+// ___ API ________________________________________________________________________________________
+cl_int              clGetPlatformIDs(cl_uint num_entries, cl_platform_id* platforms, cl_uint* num_platforms);
+cl_int              clGetPlatformInfo(cl_platform_id platform, cl_platform_info param_name, size_t param_value_size, void* param_value, size_t* param_value_size_ret);
+cl_int              clGetDeviceIDs(cl_platform_id platform, cl_device_type device_type, cl_uint num_entries, cl_device_id* devices, cl_uint* num_devices);
+cl_int              clGetDeviceInfo(cl_device_id device, cl_device_info param_name, size_t param_value_size, void* param_value, size_t* param_value_size_ret);
+
+cl_context          clCreateContext(const cl_context_properties* properties, cl_uint num_devices, const cl_device_id* devices, void (CL_CALLBACK* pfn_notify)(const char*, const void*, size_t, void*), void* user_data, cl_int* errcode_ret);
+cl_int              clReleaseContext(cl_context context);
+cl_command_queue    clCreateCommandQueue(cl_context context, cl_device_id device, cl_command_queue_properties properties, cl_int* errcode_ret);
+cl_int              clReleaseCommandQueue(cl_command_queue command_queue);
+cl_int              clFlush(cl_command_queue command_queue);
+cl_int              clFinish(cl_command_queue command_queue);
+
+cl_mem              clCreateBuffer(cl_context context, cl_mem_flags flags, size_t size, void* host_ptr, cl_int* errcode_ret);
+cl_int              clReleaseMemObject(cl_mem memobj);
+cl_int              clEnqueueReadBuffer(cl_command_queue command_queue, cl_mem buffer, cl_bool blocking_read, size_t offset, size_t size, void* ptr, cl_uint num_events_in_wait_list, const cl_event* event_wait_list, cl_event* event);
+cl_int              clEnqueueWriteBuffer(cl_command_queue command_queue, cl_mem buffer, cl_bool blocking_write, size_t offset, size_t size, const void* ptr, cl_uint num_events_in_wait_list, const cl_event* event_wait_list, cl_event* event);
+cl_int              clEnqueueCopyBuffer(cl_command_queue command_queue, cl_mem src_buffer, cl_mem dst_buffer, size_t src_offset, size_t dst_offset, size_t size, cl_uint num_events_in_wait_list, const cl_event* event_wait_list, cl_event* event);
+void*               clEnqueueMapBuffer(cl_command_queue command_queue, cl_mem buffer, cl_bool blocking_map, cl_map_flags map_flags, size_t offset, size_t size, cl_uint num_events_in_wait_list, const cl_event* event_wait_list, cl_event* event, cl_int* errcode_ret);
+cl_int              clEnqueueUnmapMemObject(cl_command_queue command_queue, cl_mem memobj, void* mapped_ptr, cl_uint num_events_in_wait_list, const cl_event* event_wait_list, cl_event* event);
+
+cl_program          clCreateProgramWithSource(cl_context context, cl_uint count, const char** strings, const size_t* lengths, cl_int* errcode_ret);
+cl_program          clCreateProgramWithBinary(cl_context context, cl_uint num_devices, const cl_device_id* device_list, const size_t* lengths, const unsigned char** binaries, cl_int* binary_status, cl_int* errcode_ret);
+cl_int              clReleaseProgram(cl_program program);
+cl_int              clBuildProgram(cl_program program, cl_uint num_devices, const cl_device_id* device_list, const char* options, void (CL_CALLBACK* pfn_notify)(cl_program, void*), void* user_data);
+cl_int              clGetProgramInfo(cl_program program, cl_program_info param_name, size_t param_value_size, void* param_value, size_t* param_value_size_ret);
+cl_int              clGetProgramBuildInfo(cl_program program, cl_device_id device, cl_program_build_info param_name, size_t param_value_size, void* param_value, size_t* param_value_size_ret);
+
+cl_kernel           clCreateKernel(cl_program program, const char* kernel_name, cl_int* errcode_ret);
+cl_int              clReleaseKernel(cl_kernel kernel);
+cl_int              clSetKernelArg(cl_kernel kernel, cl_uint arg_index, size_t arg_size, const void* arg_value);
+cl_int              clGetKernelWorkGroupInfo(cl_kernel kernel, cl_device_id device, cl_kernel_work_group_info param_name, size_t param_value_size, void* param_value, size_t* param_value_size_ret);
+cl_int              clEnqueueNDRangeKernel(cl_command_queue command_queue, cl_kernel kernel, cl_uint work_dim, const size_t* global_work_offset, const size_t* global_work_size, const size_t* local_work_size, cl_uint num_events_in_wait_list, const cl_event* event_wait_list, cl_event* event);
+
+cl_int              clWaitForEvents(cl_uint num_events, const cl_event* event_list);
+cl_int              clGetEventInfo(cl_event event, cl_event_info param_name, size_t param_value_size, void* param_value, size_t* param_value_size_ret);
+cl_int              clGetEventProfilingInfo(cl_event event, cl_profiling_info param_name, size_t param_value_size, void* param_value, size_t* param_value_size_ret);
+cl_int              clRetainEvent(cl_event event);
+cl_int              clReleaseEvent(cl_event event);
+
+// directory of clhost_kernel.h (set by GPU_CL::GPU from .cl root path)
+void                clHostSetIncludePath(const char* path);
+
+#endif
@@ -0,0 +1,318 @@
+/******************************************************************************
+ * @file     clhost_kernel.h
+ * @author   Vadim Demchik <vadimdi@yahoo.com>,
+ * @author   Natalia Kolomoyets <rknv7@mail.ru>
+ * @version  1.6
+ *
+ * @brief    [QCDGPU]
+ *           OpenCL C compatibility header for kernels compiled as C++ (HOST_RUN)
+ *
+ * @section  LICENSE
+ *
+ * Copyright (c) 2013-2016 Vadim Demchik, Natalia Kolomoyets
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *    Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *****************************************************************************/
+// Program sources are preprocessed first, then vector literals "(float4)(a,b,c,d)" are
+// rewritten to "float4(a,b,c,d)" and swizzles ".xyz" to ".get<0,1,2>()" (".ref<0,1,2>()" if assigned)
+#ifndef clhost_kernel_h
+#define clhost_kernel_h
+
+#include "clhost.h"
+#include <cmath>
+#include <cstring>
+#include <utility>
+#include <type_traits>
+
+// ___ address spaces and qualifiers ______________________________________________________________
+#define __kernel
+#define __global
+#define __local                 // kernel-scope __local variables are translated to static thread_local
+#define __constant  const
+#define __private
+#define restrict    __restrict__
+
+#define CLK_LOCAL_MEM_FENCE     1
+#define CLK_GLOBAL_MEM_FENCE    2
+
+#define MAXFLOAT    3.402823466e+38F
+#define M_PI_F      3.14159265358979323846f
+
+// ___ scalar types _______________________________________________________________________________
+typedef unsigned char   uchar;
+typedef unsigned short  ushort;
+typedef unsigned int    uint;
+typedef unsigned long   ulong;          // OpenCL long is 64-bit (LP64 host)
+
+// ___ vector types _______________________________________________________________________________
+template<typename T,int N> struct clhost_storage;
+template<typename T> struct clhost_storage<T,2>{ union { T s[2]; struct { T x, y; };       struct { T s0, s1; };         }; };
+template<typename T> struct clhost_storage<T,3>{ union { T s[4]; struct { T x, y, z; };    struct { T s0, s1, s2; };     }; };
+template<typename T> struct clhost_storage<T,4>{ union { T s[4]; struct { T x, y, z, w; }; struct { T s0, s1, s2, s3; }; }; };
+
+template<typename T,int N> struct clhost_vector;
+
+template<typename T> struct clhost_is_vector                       : std::false_type {};
+template<typename T,int N> struct clhost_is_vector<clhost_vector<T,N> > : std::true_type {};
+template<typename S> struct clhost_is_scalar : std::integral_constant<bool,std::is_arithmetic<S>::value> {};
+
+// integer type of comparison result (same size as components)
+template<typename T> struct clhost_mask { typedef typename std::conditional<sizeof(T)==8,int64_t,typename std::conditional<sizeof(T)==4,int32_t,typename std::conditional<sizeof(T)==2,int16_t,int8_t>::type>::type>::type type; };
+
+// assignable swizzle (left side of assignment)
+template<typename T,int N,int... I> struct clhost_swizzle {
+    clhost_vector<T,N>* v;
+    clhost_swizzle& operator=(const clhost_vector<T,sizeof...(I)>& a){
+        const int index[] = {I...};
+        for (int i=0; i<(int) sizeof...(I); i++) v->s[index[i]] = a.s[i];
+        return *this;
+    }
+#define CLHOST_SWIZZLE_ASSIGN(op) \
+    clhost_swizzle& operator op##=(const clhost_vector<T,sizeof...(I)>& a){ \
+        const int index[] = {I...}; \
+        for (int i=0; i<(int) sizeof...(I); i++) v->s[index[i]] op##= a.s[i]; \
+        return *this; \
+    }
+    CLHOST_SWIZZLE_ASSIGN(+) CLHOST_SWIZZLE_ASSIGN(-) CLHOST_SWIZZLE_ASSIGN(*) CLHOST_SWIZZLE_ASSIGN(/)
+#undef CLHOST_SWIZZLE_ASSIGN
+};
+
+template<typename T,typename S> inline typename std::enable_if<clhost_is_scalar<S>::value>::type clhost_fill(T* s,int& k,const S& a){ s[k++] = (T) a; }
+template<typename T,int M> inline void clhost_fill(T* s,int& k,const clhost_vector<T,M>& a){ for (int i=0; i<M; i++) s[k++] = a.s[i]; }
+template<typename T,typename A,typename... B> inline void clhost_fill(T* s,int& k,const A& a,const B&... b){ clhost_fill(s,k,a); clhost_fill(s,k,b...); }
+
+template<typename T,int N> struct clhost_vector : clhost_storage<T,N> {
+    typedef T scalar_type;
+
+    clhost_vector() = default;
+    template<typename S,typename = typename std::enable_if<clhost_is_scalar<S>::value>::type>
+    clhost_vector(S a){ for (int i=0; i<N; i++) this->s[i] = (T) a; }      // (float4) 0.0f
+    template<typename A,typename B,typename... C>
+    clhost_vector(const A& a,const B& b,const C&... c){ int k = 0; clhost_fill(this->s,k,a,b,c...); }   // (float4)(a,b,c,d)
+
+    T&       operator[](int i)       { return this->s[i]; }
+    const T& operator[](int i) const { return this->s[i]; }
+
+    template<int... I> clhost_vector<T,sizeof...(I)> get() const {
+        clhost_vector<T,sizeof...(I)> r; const int index[] = {I...};
+        for (int i=0; i<(int) sizeof...(I); i++) r.s[i] = this->s[index[i]];
+        return r;
+    }
+    template<int... I> clhost_swizzle<T,N,I...> ref(){ clhost_swizzle<T,N,I...> r; r.v = this; return r; }
+
+#define CLHOST_VECTOR_ASSIGN(op) \
+    clhost_vector& operator op##=(const clhost_vector& a){ for (int i=0; i<N; i++) this->s[i] op##= a.s[i]; return *this; } \
+    template<typename S> typename std::enable_if<clhost_is_scalar<S>::value,clhost_vector&>::type \
+    operator op##=(const S& a){ for (int i=0; i<N; i++) this->s[i] op##= (T) a; return *this; }
+    CLHOST_VECTOR_ASSIGN(+) CLHOST_VECTOR_ASSIGN(-) CLHOST_VECTOR_ASSIGN(*) CLHOST_VECTOR_ASSIGN(/)
+    CLHOST_VECTOR_ASSIGN(%) CLHOST_VECTOR_ASSIGN(&) CLHOST_VECTOR_ASSIGN(|) CLHOST_VECTOR_ASSIGN(^)
+    CLHOST_VECTOR_ASSIGN(<<) CLHOST_VECTOR_ASSIGN(>>)
+#undef CLHOST_VECTOR_ASSIGN
+};
+
+// arithmetic and bitwise operators: vector-vector, vector-scalar, scalar-vector
+#define CLHOST_VECTOR_OPERATOR(op) \
+template<typename T,int N> inline clhost_vector<T,N> operator op(const clhost_vector<T,N>& a,const clhost_vector<T,N>& b){ \
+    clhost_vector<T,N> r; for (int i=0; i<N; i++) r.s[i] = a.s[i] op b.s[i]; return r; } \
+template<typename T,int N,typename S> inline typename std::enable_if<clhost_is_scalar<S>::value,clhost_vector<T,N> >::type \
+operator op(const clhost_vector<T,N>& a,const S& b){ \
+    clhost_vector<T,N> r; for (int i=0; i<N; i++) r.s[i] = a.s[i] op (T) b; return r; } \
+template<typename T,int N,typename S> inline typename std::enable_if<clhost_is_scalar<S>::value,clhost_vector<T,N> >::type \
+operator op(const S& a,const clhost_vector<T,N>& b){ \
+    clhost_vector<T,N> r; for (int i=0; i<N; i++) r.s[i] = (T) a op b.s[i]; return r; }
+CLHOST_VECTOR_OPERATOR(+) CLHOST_VECTOR_OPERATOR(-) CLHOST_VECTOR_OPERATOR(*) CLHOST_VECTOR_OPERATOR(/)
+CLHOST_VECTOR_OPERATOR(%) CLHOST_VECTOR_OPERATOR(&) CLHOST_VECTOR_OPERATOR(|) CLHOST_VECTOR_OPERATOR(^)
+CLHOST_VECTOR_OPERATOR(<<) CLHOST_VECTOR_OPERATOR(>>)
+#undef CLHOST_VECTOR_OPERATOR
+
+template<typename T,int N> inline clhost_vector<T,N> operator-(const clhost_vector<T,N>& a){ clhost_vector<T,N> r; for (int i=0; i<N; i++) r.s[i] = -a.s[i]; return r; }
+template<typename T,int N> inline clhost_vector<T,N> operator+(const clhost_vector<T,N>& a){ return a; }
+template<typename T,int N> inline clhost_vector<T,N> operator~(const clhost_vector<T,N>& a){ clhost_vector<T,N> r; for (int i=0; i<N; i++) r.s[i] = ~a.s[i]; return r; }
+
+// relational operators: -1 (all bits set) for true, 0 for false
+#define CLHOST_VECTOR_RELATION(op) \
+template<typename T,int N> inline clhost_vector<typename clhost_mask<T>::type,N> operator op(const clhost_vector<T,N>& a,const clhost_vector<T,N>& b){ \
+    clhost_vector<typename clhost_mask<T>::type,N> r; for (int i=0; i<N; i++) r.s[i] = (a.s[i] op b.s[i]) ? -1 : 0; return r; } \
+template<typename T,int N,typename S> inline typename std::enable_if<clhost_is_scalar<S>::value,clhost_vector<typename clhost_mask<T>::type,N> >::type \
+operator op(const clhost_vector<T,N>& a,const S& b){ return a op clhost_vector<T,N>(b); } \
+template<typename T,int N,typename S> inline typename std::enable_if<clhost_is_scalar<S>::value,clhost_vector<typename clhost_mask<T>::type,N> >::type \
+operator op(const S& a,const clhost_vector<T,N>& b){ return clhost_vector<T,N>(a) op b; }
+CLHOST_VECTOR_RELATION(==) CLHOST_VECTOR_RELATION(!=) CLHOST_VECTOR_RELATION(<)
+CLHOST_VECTOR_RELATION(>)  CLHOST_VECTOR_RELATION(<=) CLHOST_VECTOR_RELATION(>=)
+#undef CLHOST_VECTOR_RELATION
+
+#define CLHOST_VECTOR_TYPES(type) \
+typedef clhost_vector<type,2> type##2; \
+typedef clhost_vector<type,3> type##3; \
+typedef clhost_vector<type,4> type##4;
+CLHOST_VECTOR_TYPES(char)
+CLHOST_VECTOR_TYPES(uchar)
+CLHOST_VECTOR_TYPES(short)
+CLHOST_VECTOR_TYPES(ushort)
+CLHOST_VECTOR_TYPES(int)
+CLHOST_VECTOR_TYPES(uint)
+CLHOST_VECTOR_TYPES(long)
+CLHOST_VECTOR_TYPES(ulong)
+CLHOST_VECTOR_TYPES(float)
+CLHOST_VECTOR_TYPES(double)
+#undef CLHOST_VECTOR_TYPES
+
+// ___ built-in functions _________________________________________________________________________
+using std::sin;   using std::cos;   using std::tan;   using std::asin;  using std::acos;  using std::atan;
+using std::sinh;  using std::cosh;  using std::tanh;  using std::exp;   using std::log;   using std::log10;
+using std::sqrt;  using std::fabs;  using std::floor; using std::ceil;  using std::trunc; using std::round;
+using std::rint;  using std::cbrt;  using std::atan2; using std::pow;   using std::fmod;  using std::fmin;
+using std::fmax;  using std::hypot; using std::fma;   using std::exp2;  using std::log2;
+
+template<typename T> inline T rsqrt(T a){ return (T) 1 / sqrt(a); }
+
+#define CLHOST_VECTOR_FUNCTION1(name) \
+template<typename T,int N> inline clhost_vector<T,N> name(const clhost_vector<T,N>& a){ \
+    clhost_vector<T,N> r; for (int i=0; i<N; i++) r.s[i] = name(a.s[i]); return r; }
+#define CLHOST_VECTOR_FUNCTION2(name) \
+template<typename T,int N> inline clhost_vector<T,N> name(const clhost_vector<T,N>& a,const clhost_vector<T,N>& b){ \
+    clhost_vector<T,N> r; for (int i=0; i<N; i++) r.s[i] = name(a.s[i],b.s[i]); return r; } \
+template<typename T,int N,typename S> inline typename std::enable_if<clhost_is_scalar<S>::value,clhost_vector<T,N> >::type \
+name(const clhost_vector<T,N>& a,const S& b){ clhost_vector<T,N> r; for (int i=0; i<N; i++) r.s[i] = name(a.s[i],(T) b); return r; }
+CLHOST_VECTOR_FUNCTION1(sin)   CLHOST_VECTOR_FUNCTION1(cos)   CLHOST_VECTOR_FUNCTION1(tan)
+CLHOST_VECTOR_FUNCTION1(asin)  CLHOST_VECTOR_FUNCTION1(acos)  CLHOST_VECTOR_FUNCTION1(atan)
+CLHOST_VECTOR_FUNCTION1(exp)   CLHOST_VECTOR_FUNCTION1(log)   CLHOST_VECTOR_FUNCTION1(sqrt)
+CLHOST_VECTOR_FUNCTION1(fabs)  CLHOST_VECTOR_FUNCTION1(floor) CLHOST_VECTOR_FUNCTION1(ceil)
+CLHOST_VECTOR_FUNCTION1(trunc) CLHOST_VECTOR_FUNCTION1(round) CLHOST_VECTOR_FUNCTION1(rint)
+CLHOST_VECTOR_FUNCTION1(rsqrt)
+CLHOST_VECTOR_FUNCTION2(pow)   CLHOST_VECTOR_FUNCTION2(fmod)  CLHOST_VECTOR_FUNCTION2(fmin)
+CLHOST_VECTOR_FUNCTION2(fmax)  CLHOST_VECTOR_FUNCTION2(atan2) CLHOST_VECTOR_FUNCTION2(hypot)
+#undef CLHOST_VECTOR_FUNCTION1
+#undef CLHOST_VECTOR_FUNCTION2
+
+#define native_sin      sin
+#define native_cos      cos
+#define native_exp      exp
+#define native_log      log
+#define native_sqrt     sqrt
+#define native_rsqrt    rsqrt
+#define native_divide(a,b)  ((a) / (b))
+#define half_sin        sin
+#define half_cos        cos
+#define half_exp        exp
+#define half_log        log
+#define half_sqrt       sqrt
+#define half_rsqrt      rsqrt
+
+template<typename A,typename B> inline typename std::common_type<A,B>::type min(A a,B b){ return (b < a) ? b : a; }
+template<typename A,typename B> inline typename std::common_type<A,B>::type max(A a,B b){ return (a < b) ? b : a; }
+template<typename T,int N> inline clhost_vector<T,N> min(const clhost_vector<T,N>& a,const clhost_vector<T,N>& b){ clhost_vector<T,N> r; for (int i=0; i<N; i++) r.s[i] = min(a.s[i],b.s[i]); return r; }
+template<typename T,int N> inline clhost_vector<T,N> max(const clhost_vector<T,N>& a,const clhost_vector<T,N>& b){ clhost_vector<T,N> r; for (int i=0; i<N; i++) r.s[i] = max(a.s[i],b.s[i]); return r; }
+template<typename T,typename L,typename H> inline T clamp(T a,L lo,H hi){ return min(max(a,(T) lo),(T) hi); }
+template<typename T> inline T mad(T a,T b,T c){ return a * b + c; }
+template<typename T,typename S> inline T mix(T a,T b,S t){ return a + (b - a) * t; }
+inline uint mul24(uint a,uint b){ return a * b; }
+inline uint mad24(uint a,uint b,uint c){ return a * b + c; }
+inline uint mul_hi(uint a,uint b){ return (uint) (((ulong) a * b) >> 32); }
+inline ulong mul_hi(ulong a,ulong b){ return (ulong) (((unsigned __int128) a * b) >> 64); }
+inline uint atomic_max(volatile uint* p,uint v){ uint old = __atomic_load_n(p,__ATOMIC_RELAXED); while ((old < v) && (!__atomic_compare_exchange_n(p,&old,v,false,__ATOMIC_RELAXED,__ATOMIC_RELAXED))); return old; }
+inline uint atomic_inc(volatile uint* p){ return __atomic_fetch_add(p,1u,__ATOMIC_RELAXED); }
+
+template<typename T,int N> inline T dot(const clhost_vector<T,N>& a,const clhost_vector<T,N>& b){ T r = 0; for (int i=0; i<N; i++) r += a.s[i] * b.s[i]; return r; }
+inline float  dot(float a,float b)   { return a * b; }
+inline double dot(double a,double b) { return a * b; }
+template<typename T,int N> inline T length(const clhost_vector<T,N>& a){ return sqrt(dot(a,a)); }
+template<typename T,int N> inline clhost_vector<T,N> normalize(const clhost_vector<T,N>& a){ return a * (1 / length(a)); }
+template<typename T> inline clhost_vector<T,4> cross(const clhost_vector<T,4>& a,const clhost_vector<T,4>& b){
+    return clhost_vector<T,4>(a.y*b.z - a.z*b.y, a.z*b.x - a.x*b.z, a.x*b.y - a.y*b.x, (T) 0); }
+template<typename T> inline clhost_vector<T,3> cross(const clhost_vector<T,3>& a,const clhost_vector<T,3>& b){
+    return clhost_vector<T,3>(a.y*b.z - a.z*b.y, a.z*b.x - a.x*b.z, a.x*b.y - a.y*b.x); }
+
+// select: component of b where most significant bit of c is set, otherwise component of a
+template<typename T,int N,typename M> inline clhost_vector<T,N> select(const clhost_vector<T,N>& a,const clhost_vector<T,N>& b,const clhost_vector<M,N>& c){
+    clhost_vector<T,N> r; for (int i=0; i<N; i++) r.s[i] = (c.s[i] < 0) ? b.s[i] : a.s[i]; return r; }
+template<typename T,int N,typename S,typename M> inline typename std::enable_if<clhost_is_scalar<S>::value,clhost_vector<T,N> >::type
+select(const clhost_vector<T,N>& a,const S& b,const clhost_vector<M,N>& c){ return select(a,clhost_vector<T,N>(b),c); }
+template<typename T,typename M> inline typename std::enable_if<clhost_is_scalar<T>::value,T>::type select(T a,T b,M c){ return c ? b : a; }
+
+template<typename T,int N> inline int any(const clhost_vector<T,N>& a){ for (int i=0; i<N; i++) if (a.s[i] < 0) return 1; return 0; }
+template<typename T,int N> inline int all(const clhost_vector<T,N>& a){ for (int i=0; i<N; i++) if (a.s[i] >= 0) return 0; return 1; }
+
+template<typename R,typename T> inline R clhost_as(const T& a){ static_assert(sizeof(R)==sizeof(T),"as_type: size mismatch"); R r; memcpy(&r,&a,sizeof(R)); return r; }
+#define as_float(a)     clhost_as<float>(a)
+#define as_uint(a)      clhost_as<uint>(a)
+#define as_int(a)       clhost_as<int>(a)
+#define as_double(a)    clhost_as<double>(a)
+#define as_ulong(a)     clhost_as<ulong>(a)
+#define as_float4(a)    clhost_as<float4>(a)
+#define as_uint4(a)     clhost_as<uint4>(a)
+
+// ___ work items _________________________________________________________________________________
+static thread_local clhost_item* clhost_current = NULL;
+
+inline uint   get_work_dim(void)        { return clhost_current->work_dim; }
+inline size_t get_global_size(uint d)   { return (d<3) ? clhost_current->global_size[d] : 1; }
+inline size_t get_local_size(uint d)    { return (d<3) ? clhost_current->local_size[d]  : 1; }
+inline size_t get_num_groups(uint d)    { return (d<3) ? clhost_current->num_groups[d]  : 1; }
+inline size_t get_group_id(uint d)      { return (d<3) ? clhost_current->group_id[d]    : 0; }
+inline size_t get_local_id(uint d)      { return (d<3) ? clhost_current->local_id[d]    : 0; }
+inline size_t get_global_offset(uint d) { return (d<3) ? clhost_current->global_offset[d] : 0; }
+inline size_t get_global_id(uint d)     { return (d<3) ? clhost_current->global_offset[d] + clhost_current->group_id[d] * clhost_current->local_size[d] + clhost_current->local_id[d] : 0; }
+
+inline void   barrier(int flags){
+    clhost_item* item = clhost_current;
+    item->barrier(item);                // other work items of work group run until the same barrier
+    clhost_current = item;
+}
+inline void   mem_fence(int flags)      {}
+inline void   read_mem_fence(int flags) {}
+inline void   write_mem_fence(int flags){}
+
+// ___ kernel entries _____________________________________________________________________________
+template<typename... A,size_t... I>
+inline int clhost_run(void (*kernel)(A...),void** arguments,clhost_item* item,size_t first,size_t last,std::index_sequence<I...>){
+    if (!arguments) return (int) sizeof...(A);
+    clhost_current = item;
+    for (size_t l=first; l<last; l++){
+        item->local_id[0] = l % item->local_size[0];
+        item->local_id[1] = (l / item->local_size[0]) % item->local_size[1];
+        item->local_id[2] = l / (item->local_size[0] * item->local_size[1]);
+        kernel(*((typename std::remove_reference<A>::type*) arguments[I])...);
+    }
+    return (int) sizeof...(A);
+}
+
+template<typename... A>
+inline int clhost_run(void (*kernel)(A...),void** arguments,clhost_item* item,size_t first,size_t last){
+    return clhost_run(kernel,arguments,item,first,last,std::index_sequence_for<A...>());
+}
+
+// flags pointer arguments (__global or __local), which are cl_mem or local memory on host side
+template<typename... A>
+inline int clhost_signature(void (*kernel)(A...),char* pointers){
+    char flags[] = {(char) std::is_pointer<typename std::remove_reference<A>::type>::value..., 0};
+    if (pointers) memcpy(pointers,flags,sizeof...(A));
+    return (int) sizeof...(A);
+}
+
+#define CLHOST_KERNEL(name) \
+extern "C" __attribute__((visibility("default"))) int clhost_kernel_##name(void** arguments,clhost_item* item,size_t first,size_t last){ return clhost_run(name,arguments,item,first,last); } \
+extern "C" __attribute__((visibility("default"))) int clhost_signature_##name(char* pointers){ return clhost_signature(name,pointers); }
+
+#endif
@@ -57,6 +57,12 @@ namespace GPU_CL{
 using GPU_CL::GPU;
 
     char GPU::current_path[FILENAME_MAX]= "\0";     // FILENAME_MAX is definned by <stdio.h>
+    char GPU::cache_path[CACHE_PATH_MAX]  = "\0";     // program binaries are cached in current directory by default
+    unsigned int GPU::cache_size        = PROGRAM_CACHE_SIZE;
+    char GPU::trace_path[FILENAME_MAX]  = TRACE_FILE;   // timeline is written into current directory by default
+    FILE* GPU::trace_file               = NULL;
+    int  GPU::trace_users               = 0;
+    std::mutex GPU::trace_mutex;
 
     GPU::GPU_debug_flags GPU::GPU_debug;
 
@@ -69,14 +75,23 @@ using GPU_CL::GPU;
     GPU_debug.show_stage        = false;
     GPU_debug.local_run         = false;
     GPU_debug.rebuild_binary    = false;
+    GPU_debug.async_dispatch    = false;
+    GPU_debug.autotune          = false;
+    GPU_debug.overlap_measurements = false;
+    GPU_debug.trace             = false;
     
     GPU_info.device_name        = NULL;
+    GPU_info.driver_version     = NULL;
     GPU_info.local_memory_size  = 0;
     GPU_info.max_constant_size  = 0;
     GPU_info.max_memory_size    = 0;
     GPU_info.max_memory_width   = 0;
     GPU_info.max_workgroup_size = 0;
     GPU_info.memory_align_factor= 0;
+    GPU_info.compute_units      = 0;
+    GPU_info.max_clock_frequency= 0;
+    GPU_info.peak_bandwidth     = 0.0;
+    GPU_info.peak_gflops        = 0.0;
     GPU_info.platform_vendor    = GPU::GPU_vendor_None;
     GPU_info.device_vendor      = GPU::GPU_vendor_None;
 
@@ -88,7 +103,7 @@ using GPU_CL::GPU;
     GPU_platform_id             = 0;    // GPU platform to be used (0 = first, 1 = second, etc)
     GPU_device_id               = 0;    // GPU device to be used   (0 = first, 1 = second, etc)
 
-    GPU_inf_max_n               = 0;    // max number in .inf-filenames
+    GPU_autotune_parameters     = NULL; // tuned work group sizes
  
     GPU_platforms_number        = 0;    // number of available platforms
     GPU_devices_number          = 0;    // number of available devices
@@ -101,6 +116,18 @@ using GPU_CL::GPU;
     GPU_device                  = 0;    // utilized device
     GPU_context                 = NULL; // utilized context
     GPU_queue                   = NULL; // utilized command queue
+    GPU_measurement_queue       = NULL; // command queue for measurements
+    GPU_active_queue            = queue_type_main;
+
+    GPU_last_event              = NULL; // event of the last asynchronously enqueued kernel
+    GPU_pending_number          = 0;    // number of pending kernel events
+    GPU_unflushed_number        = 0;    // number of kernels enqueued since the last clFlush
+    GPU_measurement_last_event  = NULL; // event of the last kernel in measurement queue
+    GPU_snapshot_event          = NULL; // event of the last snapshot copy
+
+    GPU_trace_pid               = 0;    // process id of device in timeline
+    GPU_trace_origin            = 0;    // device time of the first traced event
+    GPU_trace_iteration         = 0;    // current sweep number
 
     CPU_timers                  = 32;   // total number of reserved timers
     CPU_timer                   = NULL; // setup CPU timers
@@ -110,6 +137,10 @@ using GPU_CL::GPU;
 
     CPU_timer = (int*) calloc((CPU_timers+1),sizeof(int));
 
+    GPU_pending_events  = (cl_event*) calloc(EVENTS_PENDING_MAX,sizeof(cl_event));
+    GPU_pending_kernels = (int*)      calloc(EVENTS_PENDING_MAX,sizeof(int));
+    GPU_pending_iterations = (unsigned int*) calloc(EVENTS_PENDING_MAX,sizeof(unsigned int));
+
     GPU_kernels = new kernels_hash[HASHES_SIZE];  // Hash for kernels
     GPU_buffers = new buffers_hash[HASHES_SIZE];  // Hash for buffers pointers 
     GPU_programs= new programs_hash[HASHES_SIZE]; // Hash for programs pointers
@@ -129,6 +160,10 @@ using GPU_CL::GPU;
 
     free(cl_root_path);
     free(CPU_timer);
+    free(GPU_pending_events);
+    free(GPU_pending_kernels);
+    free(GPU_pending_iterations);
+    free(GPU_autotune_parameters);
 }
 
                 GPU::kernels_hash::kernels_hash(void)
@@ -140,16 +175,25 @@ using GPU_CL::GPU;
     argument_id                 = 0;
     work_dimensions             = 0;    // work dimensions
     kernel_local_mem_size       = 0;    // local memory size
+    kernel_bytes                = 0.0;  // bytes moved per work item (derived from argument buffers)
+    kernel_flops                = 0.0;  // floating-point operations per work item
     program_id                  = 0;    // program_id for GPU_programs array
     kernel_number_of_starts     = 0;    // total number of kernel starts - for deviation calculation
     kernel_elapsed_time         = 0.0;  // total kernel execution time (in nanoseconds)
     kernel_elapsed_time_squared = 0.0;  // total kernel execution time squared (in nanoseconds) - for deviation calculation
+    kernel_autotune             = false;// kernel has to be benchmarked at the next start
+    kernel_single_group         = false;// global size equals local size
+    kernel_autotune_key         = NULL; // key of kernel launch geometry
+    argument_buffers            = NULL; // buffer ids passed as kernel arguments
+    argument_buffers_number     = 0;    // number of buffers passed as kernel arguments
 }
                 GPU::kernels_hash::~kernels_hash(void)
 {
       free((void*) (kernel_name));
       free(global_size);
       free(local_size);
+      free(kernel_autotune_key);
+      free(argument_buffers);
 }
 
                 GPU::buffers_hash::buffers_hash(void)
@@ -159,6 +203,10 @@ using GPU_CL::GPU;
       size                              = 0;
       size_in_bytes                     = 0;        // buffer size in bytes ( size*sizeof(...) )
       mapped_ptr                        = NULL;     // ptr to corresponding host memory after mapping
+      staging                           = NULL;     // pinned staging area for asynchronous readback
+      staging_ptr                       = NULL;     // ptr to host memory of asynchronous readback
+      staging_read_event                = NULL;     // event of asynchronous readback transfer
+      staging_map_event                 = NULL;     // event of asynchronous readback mapping
                 // profiling data __________________________
       buffer_write_elapsed_time         = 0.0;      // total buffer write time (in nanoseconds)
       buffer_write_elapsed_time_squared = 0.0;      // total buffer write time squared (in nanoseconds) - for deviation calculation
@@ -183,16 +231,24 @@ using GPU_CL::GPU;
       datetime      = NULL;     // datetime of kernel compiling
       device        = NULL;     // device
       build_log     = NULL;     // program build log
+      cache_key     = NULL;     // key of program binary in cache
+      build_thread  = NULL;     // background thread of clBuildProgram
+      build_error   = CL_SUCCESS;
+      build_pending = false;    // build is started, but program_wait is not called yet
+      build_from_binary = false;// program is created from cached binary
+      build_start   = 0;        // build start time
       source_length = 0;
 }
                 GPU::programs_hash::~programs_hash(void)
 {
+      if (build_thread) {build_thread->join(); delete build_thread;}
       free((void*) (source_ptr));
       free((void*) (options));
       free((void*) (md5));
       free((void*) (datetime));
       free((void*) (device));
       free((void*) (build_log));
+      free((void*) (cache_key));
 }
 
 char*           GPU::trim(char* str)
@@ -383,6 +439,13 @@ int             GPU::device_initialize(void)
 #endif
     }
 
+#ifdef HOST_RUN
+    // host backend compiles kernels against clinterface/clhost_kernel.h
+    char* host_include_path = (char*) calloc(FNAME_MAX_LENGTH,sizeof(char));
+    sprintf_s(host_include_path,FNAME_MAX_LENGTH,"%sclinterface",cl_root_path);
+    clHostSetIncludePath(host_include_path);
+    free(host_include_path);
+#endif
 
     // select desired device
     device_select(GPU_platform_id,GPU_device_id);
@@ -407,10 +470,15 @@ int             GPU::device_initialize(void)
     GPU_context = clCreateContext(NULL,1,&GPU_device,NULL, NULL, &GPU_error);
     OpenCL_Check_Error(GPU_error,"clCreateContext failed");
 
+    if (GPU_debug.trace) GPU_debug.profiling = true;    // timeline is built from profiling data
     cl_command_queue_properties profiling_properties = 0;
-    if (GPU_debug.profiling) profiling_properties = (CL_QUEUE_PROFILING_ENABLE);    // enable profiling for debuging
+    if ((GPU_debug.profiling)||(GPU_debug.autotune)) profiling_properties = (CL_QUEUE_PROFILING_ENABLE);    // enable profiling for debuging and work group size tuning
     GPU_queue = clCreateCommandQueue(GPU_context,GPU_device,profiling_properties,&GPU_error);
     OpenCL_Check_Error(GPU_error,"clCreateCommandQueue failed");
+    if (GPU_debug.overlap_measurements) {
+        GPU_measurement_queue = clCreateCommandQueue(GPU_context,GPU_device,profiling_properties,&GPU_error);
+        OpenCL_Check_Error(GPU_error,"clCreateCommandQueue failed");
+    }
 
 
     GPU_info.local_memory_size  =          clGetDeviceInfoUlong(GPU_device,CL_DEVICE_LOCAL_MEM_SIZE);
@@ -420,31 +488,26 @@ int             GPU::device_initialize(void)
 
     if (!GPU_info.max_memory_width)  GPU_info.max_memory_width  = 32;
 
+    GPU_info.compute_units       = clGetDeviceInfoUint(GPU_device,CL_DEVICE_MAX_COMPUTE_UNITS);
+    GPU_info.max_clock_frequency = clGetDeviceInfoUint(GPU_device,CL_DEVICE_MAX_CLOCK_FREQUENCY);
+
     GPU_info.device_name = device_get_name(GPU_device);
+    GPU_info.driver_version = device_get_driver(GPU_device);
 #ifdef BIGLAT
     GPU_info.device_ocl = device_get_OCL(GPU_device);
 #endif
 
-    // GPU_debug.rebuild_binary
-    if (GPU_debug.rebuild_binary) {
-        // kill all .inf and .bin files
-        int err = 0;
-        int file_idx = 1;
-        while (!err) {
 #ifdef BIGLAT
-            err = inf_file_delete(k + 1, file_idx);
+    if (GPU_debug.trace) trace_open(k);
 #else
-            err = inf_file_delete(file_idx);
-#endif
-            file_idx++;
-        }
-    } else
-#ifdef BIGLAT
-    GPU_inf_max_n = inf_file_get_max_n(k);
-#else
-    GPU_inf_max_n = inf_file_get_max_n();
+    if (GPU_debug.trace) trace_open((int) GPU_device_id);
 #endif
 
+    // load tuned work group sizes
+    char buffer_autotune[FILENAME_MAX];
+    sprintf_s(buffer_autotune,FILENAME_MAX,"%s%s",cache_path,AUTOTUNE_FILE);   // autotune.inf is kept next to program binaries
+    if (is_file_exist(buffer_autotune)) GPU_autotune_parameters = get_init_file(buffer_autotune);
+
 #ifndef IGNORE_INTEL
     if (GPU_info.device_vendor == GPU_vendor_Intel) {
         GPU_info.max_workgroup_size = 64;
@@ -462,9 +525,30 @@ int             GPU::device_finalize(int error_code)
 {
     free(GPU_max_work_item_sizes);
 
+    // wait for asynchronously dispatched kernels and release their events
+    if (GPU_queue) clFinish(GPU_queue);
+    if (GPU_measurement_queue) clFinish(GPU_measurement_queue);
+    for (int i=0; i<GPU_pending_number; i++) {
+        if (GPU_debug.trace) trace_kernel(GPU_pending_kernels[i],GPU_pending_events[i],GPU_pending_iterations[i]);
+        clReleaseEvent(GPU_pending_events[i]);
+    }
+    GPU_pending_number = 0;
+    if (GPU_debug.trace) trace_close();
+    if (GPU_last_event) clReleaseEvent(GPU_last_event);
+    GPU_last_event = NULL;
+    if (GPU_measurement_last_event) clReleaseEvent(GPU_measurement_last_event);
+    GPU_measurement_last_event = NULL;
+    if (GPU_snapshot_event) clReleaseEvent(GPU_snapshot_event);
+    GPU_snapshot_event = NULL;
+
     // clean GPU_kernels and programms
 
     for (int i=1; i<=GPU_current_program; i++){
+            if (GPU_programs[i].build_thread) {
+                GPU_programs[i].build_thread->join();
+                delete GPU_programs[i].build_thread;
+                GPU_programs[i].build_thread = NULL;
+            }
             if (GPU_programs[i].program)
                 clReleaseProgram(GPU_programs[i].program);
     }
@@ -480,6 +564,7 @@ int             GPU::device_finalize(int error_code)
 #endif
 
     // clean command queue and context
+    if (GPU_measurement_queue) clReleaseCommandQueue(GPU_measurement_queue);
     if (GPU_queue) clReleaseCommandQueue(GPU_queue);
     if (GPU_context) clReleaseContext(GPU_context);
 
@@ -487,6 +572,27 @@ int             GPU::device_finalize(int error_code)
 
     return error_code;
 }
+int             GPU::device_synchronize(void)
+{
+    // wait for all enqueued commands and collect profiling data of asynchronously dispatched kernels
+    OpenCL_Check_Error(clFinish(GPU_queue),"clFinish failed");
+    if (GPU_measurement_queue) OpenCL_Check_Error(clFinish(GPU_measurement_queue),"clFinish failed");
+    for (int i=0; i<GPU_pending_number; i++){
+        kernel_get_profiling(GPU_pending_kernels[i],GPU_pending_events[i]);
+        if (GPU_debug.trace) trace_kernel(GPU_pending_kernels[i],GPU_pending_events[i],GPU_pending_iterations[i]);
+        OpenCL_Check_Error(clReleaseEvent(GPU_pending_events[i]),"clReleaseEvent failed");
+    }
+    GPU_pending_number   = 0;
+    GPU_unflushed_number = 0;
+    if (GPU_last_event) OpenCL_Check_Error(clReleaseEvent(GPU_last_event),"clReleaseEvent failed");
+    GPU_last_event = NULL;
+    if (GPU_measurement_last_event) OpenCL_Check_Error(clReleaseEvent(GPU_measurement_last_event),"clReleaseEvent failed");
+    GPU_measurement_last_event = NULL;
+    if (GPU_snapshot_event) OpenCL_Check_Error(clReleaseEvent(GPU_snapshot_event),"clReleaseEvent failed");
+    GPU_snapshot_event = NULL;
+
+    return 0;
+}
 bool            GPU::device_auto_select(int platform_vendor,int vendor)
 {
     bool supported_platform = false;    // is there supported platform?
@@ -663,6 +769,18 @@ char*           GPU::device_get_OCL(cl_device_id device){
     return result;
 }
 
+char*           GPU::device_get_driver(cl_device_id device){
+    size_t result_length = 4096;
+    size_t result_actual_size;
+
+        char* result = (char*) calloc(result_length,sizeof(char));
+        OpenCL_Check_Error(clGetDeviceInfo(device, CL_DRIVER_VERSION, result_length, (void*) result, &result_actual_size),"clGetDeviceInfo failed");
+        result = trim(result);
+        result = (char*) realloc(result,result_actual_size * sizeof(char));
+
+    return result;
+}
+
 // ___ source _____________________________________________________________________________________
 char*           GPU::source_read(const char* file_name)
 {
@@ -718,17 +836,19 @@ int             GPU::program_create(const char* source){
 
 #ifdef BIGLAT
 int             GPU::program_create_ndev(const char* source,const char* options, int ndev){
-    start_timer_CPU(10);
+    // program binaries are addressed by content (device and driver are the part of key), so all devices share the same cache
+    return program_create(source,options);
+}
+#endif
 
+int             GPU::program_create(const char* source,const char* options){
+    // program is built in background, program_wait (called by kernel_init) finishes it
     FILE * cl_program_file = NULL;
-    char buffer[FNAME_MAX_LENGTH];
-    char buffer_inf[FNAME_MAX_LENGTH];
+    char buffer[FILENAME_MAX];
 
     GPU_current_program++;
     GPU_active_program = GPU_current_program;
 
-    int GPU_active_file = 0;
-
     // setup reserve kernel's source
     int source_length = (int) strlen(source) + 1;
     char* temporary_source = (char*) calloc(source_length + 1, sizeof(char));
@@ -744,375 +864,152 @@ int             GPU::program_create_ndev(const char* source,const char* options,
     } else {
        GPU_programs[GPU_active_program].options        = NULL;
     }
-    
+
     GPU_programs[GPU_active_program].md5      = MD5(source);
     GPU_programs[GPU_active_program].device   = device_get_name(GPU_device);
     GPU_programs[GPU_active_program].platform = platform_get_name(GPU_platform);
     GPU_programs[GPU_active_program].datetime = get_current_datetime();
+    GPU_programs[GPU_active_program].cache_key= program_cache_get_key(GPU_active_program,source);
 
-    for (int i = 1; i <= GPU_inf_max_n; i++){
-       sprintf_s(buffer_inf,FNAME_MAX_LENGTH,"program%u-%i.inf",i, ndev);
-       // get .inf-file
-       int parameters_items = 0;
-       GPU_init_parameters* parameters = get_init_file(buffer_inf);
-       if (parameters==NULL) {delete[] &buffer_inf; return 1;}
-       bool inf_number  = false;
-       bool inf_md5     = false;
-       bool inf_device  = false;
-       bool inf_platform= false;
-       bool inf_options = false;
-       int  inf_idx_md5     = 0;
-       int  inf_idx_device  = 0;
-       int  inf_idx_platform= 0;
-       int  inf_idx_options = 0;
-       bool parameters_flag = false;
-       while(!parameters_flag){
-          if (!strcmp(parameters[parameters_items].Variable,"NUMBER"))  {
-             if(parameters[parameters_items].iVarVal == GPU_active_program) {inf_number = true; 
-             }
-           }
-          if (!strcmp(parameters[parameters_items].Variable,"MD5"))  {
-             inf_md5 = true;
-             inf_idx_md5 = parameters_items;
-           }
-          if (!strcmp(parameters[parameters_items].Variable,"DEVICE"))  {
-             inf_device = true;
-             inf_idx_device = parameters_items;
-           }
-          if (!strcmp(parameters[parameters_items].Variable,"PLATFORM"))  {
-             inf_platform = true;
-             inf_idx_platform = parameters_items;
-           }
-          if (!strcmp(parameters[parameters_items].Variable,"OPTIONS"))  {
-             inf_options = true;
-             inf_idx_options = parameters_items;
-           }
-          parameters_flag = parameters[parameters_items].final;
-          parameters_items++;
-        }
-       // check parameters        
-       //inf_number = 1;
-       if (inf_number){
-            // check MD5
-            if (!strcmp(parameters[inf_idx_md5].txtVarVal,GPU_programs[GPU_active_program].md5)){
-                // check device and options
-                if ((!strcmp(parameters[inf_idx_device].txtVarVal,  GPU_programs[GPU_active_program].device))&&
-                    (!strcmp(parameters[inf_idx_platform].txtVarVal,GPU_programs[GPU_active_program].platform))&&
-                    (((GPU_programs[GPU_active_program].options==NULL)&&(!inf_options))||
-                     ((GPU_programs[GPU_active_program].options!=NULL)&&(!strcmp(parameters[inf_idx_options].txtVarVal,GPU_programs[GPU_active_program].options)))))
-                    {
-                        GPU_active_file = i;
-                        i = GPU_inf_max_n;
-                    }
-            // skip current .inf-file
-            } else {
-                // MD5 does not match
-                // kill current .inf-file and rename last .inf-file into current
-                //inf_file_delete(i);
-                inf_file_delete(ndev, i);
-                if (i < GPU_inf_max_n) inf_file_rename(ndev, GPU_inf_max_n, i);    // check if file is last
-                GPU_inf_max_n--;
-                i--;
-            }            
-        }
-     }
-
-    // if GPU_active_file == 0 then create files
-    if (GPU_active_file == 0) GPU_active_file = GPU_inf_max_n + 1;
-
-    int j = sprintf_s(buffer,    FNAME_MAX_LENGTH,"program%u-%i.bin",GPU_active_file, ndev);
-        j = sprintf_s(buffer_inf,FNAME_MAX_LENGTH,"program%u-%i.inf",GPU_active_file, ndev);
-    if (GPU_active_file <= GPU_inf_max_n)  {
-        // try to open .bin-file
-        fopen_s(&cl_program_file,buffer,"rb");
-     }
-
-    if((GPU_active_file > GPU_inf_max_n)||(!cl_program_file)){
-        printf("\nprogram%u-%i.bin is being compiled... \n",GPU_active_program, ndev);
-        GPU_programs[GPU_active_program].program = clCreateProgramWithSource(GPU_context, 1,&GPU_programs[GPU_active_program].source_ptr, NULL, &GPU_error);
-        OpenCL_Check_Error(GPU_error,"clCreateProgramWithSource failed");
-        OpenCL_Check_Error(clBuildProgram(GPU_programs[GPU_active_program].program, 1, &GPU_device, GPU_programs[GPU_active_program].options, NULL, NULL),"clBuildProgram failed");
-
-        cl_uint num_devices;
-        OpenCL_Check_Error(clGetProgramInfo(GPU_programs[GPU_active_program].program, CL_PROGRAM_NUM_DEVICES, sizeof(cl_uint), &num_devices, NULL),"clGetProgramInfo1 failed");
-
-        cl_device_id* devices = (cl_device_id*) calloc(num_devices, sizeof(cl_device_id));
-        OpenCL_Check_Error(clGetProgramInfo(GPU_programs[GPU_active_program].program, CL_PROGRAM_DEVICES, num_devices * sizeof(cl_device_id), devices, 0),"clGetProgramInfo2 failed");
-
-        size_t* binary_sizes = (size_t*) calloc(num_devices, sizeof(size_t));    
-        OpenCL_Check_Error(clGetProgramInfo(GPU_programs[GPU_active_program].program, CL_PROGRAM_BINARY_SIZES, num_devices * sizeof(size_t), binary_sizes, NULL),"clGetProgramInfo3 failed");
-
-        char** binary = (char**) calloc(num_devices, sizeof(char*));
-        for( unsigned int i=0; i<num_devices; ++i) binary[i]= (char*) malloc(binary_sizes[i]);
-
-        OpenCL_Check_Error(clGetProgramInfo(GPU_programs[GPU_active_program].program, CL_PROGRAM_BINARIES, num_devices * sizeof(size_t), binary, NULL),"clGetProgramInfo4 failed");
-
-                size_t size;
-                OpenCL_Check_Error(clGetProgramBuildInfo(GPU_programs[GPU_active_program].program, GPU_device, CL_PROGRAM_BUILD_LOG, 0, NULL, &size),"clGetProgramBuildInfo failed");
-                if (size>4) {
-                   GPU_programs[GPU_active_program].build_log = (char*) calloc(size,sizeof(char));
-                   OpenCL_Check_Error(clGetProgramBuildInfo(GPU_programs[GPU_active_program].program, GPU_device, CL_PROGRAM_BUILD_LOG, size, GPU_programs[GPU_active_program].build_log, NULL),"clGetProgramBuildInfo failed");
-                   if (GPU_debug.brief_report) printf("Program buid log: [%s]\n", GPU_programs[GPU_active_program].build_log);
-                 }
+    sprintf_s(buffer,FILENAME_MAX,"%s%s.bin",cache_path,GPU_programs[GPU_active_program].cache_key);
 
-        unsigned int idx = 0;
-        while( idx<num_devices && devices[idx] != GPU_device ) ++idx;
-
-        // save inf file
-        fopen_s(&cl_program_file,buffer_inf,"wb");
-        if ( (cl_program_file) && (idx < num_devices) && (binary_sizes[idx]>0) ){
-            fprintf(cl_program_file,"NUMBER=%u\n",GPU_active_program);
-            fprintf(cl_program_file,"MD5=%s\n",GPU_programs[GPU_active_program].md5);
-            if (GPU_programs[GPU_active_program].options!=NULL)
-                fprintf(cl_program_file,"OPTIONS=%s\n",GPU_programs[GPU_active_program].options);
-            fprintf(cl_program_file,"DEVICE=%s\n",GPU_programs[GPU_active_program].device);
-            fprintf(cl_program_file,"PLATFORM=%s\n",GPU_programs[GPU_active_program].platform);
-            fprintf(cl_program_file,"DATE=%s",GPU_programs[GPU_active_program].datetime);
-            if ( fclose(cl_program_file) ) printf( "The file was not closed!\n" );
-        }
-
-        printf("program%u-%i.bin compilation done (%f seconds)!\n",GPU_active_program, ndev, get_timer_CPU(10));
-
-        // save binary file
-        fopen_s(&cl_program_file,buffer,"wb");
-        if ( (cl_program_file) && (idx < num_devices) && (binary_sizes[idx]>0) ){
-           fwrite(binary[idx],1,binary_sizes[idx],cl_program_file);
-           if ( fclose(cl_program_file) ) printf( "The file was not closed!\n" );
-        }
-        free(devices);
-        free(binary_sizes);
-        for( unsigned int i=0; i<num_devices; ++i) free(binary[i]);
-        free(binary);
-        GPU_inf_max_n++;
-    } else {
-
-        // load binary file
+    // try to load binary file from cache
+    GPU_programs[GPU_active_program].program = NULL;
+    if (!GPU_debug.rebuild_binary) fopen_s(&cl_program_file,buffer,"rb");
+    if (cl_program_file){
         fseek (cl_program_file, 0, SEEK_END);
         const size_t binary_size = ftell(cl_program_file);
         rewind(cl_program_file);
         unsigned char* binary;
         binary = (unsigned char*) malloc (binary_size);
-        fread(binary, 1, binary_size, cl_program_file);
+        size_t binary_read = fread(binary, 1, binary_size, cl_program_file);
         fclose(cl_program_file);
 
-        cl_int status;
-        GPU_programs[GPU_active_program].program = clCreateProgramWithBinary(GPU_context, 1, &GPU_device, &binary_size, (const unsigned char**)&binary, &status, &GPU_error);
-        OpenCL_Check_Error(status,"clCreateProgramWithBinary failed");
-        OpenCL_Check_Error(GPU_error,"clCreateProgramWithBinary failed");
-
-        OpenCL_Check_Error(clBuildProgram(GPU_programs[GPU_active_program].program, 1, &GPU_device, GPU_programs[GPU_active_program].options, NULL, NULL),"clBuildProgram failed");
-
-                size_t size;
-                OpenCL_Check_Error(clGetProgramBuildInfo(GPU_programs[GPU_active_program].program, GPU_device, CL_PROGRAM_BUILD_LOG, 0, NULL, &size),"clGetProgramBuildInfo failed");
-                if (size>4) {
-                   GPU_programs[GPU_active_program].build_log = (char*) calloc(size,sizeof(char));
-                   OpenCL_Check_Error(clGetProgramBuildInfo(GPU_programs[GPU_active_program].program, GPU_device, CL_PROGRAM_BUILD_LOG, size, GPU_programs[GPU_active_program].build_log, NULL),"clGetProgramBuildInfo failed");
-                   if (GPU_debug.brief_report) printf("Program buid log: [%s]\n", GPU_programs[GPU_active_program].build_log);
-                 }
+        cl_int status = CL_SUCCESS;
+        GPU_error = CL_SUCCESS;
+        if ((binary_size > 0) && (binary_read == binary_size))
+            GPU_programs[GPU_active_program].program = clCreateProgramWithBinary(GPU_context, 1, &GPU_device, &binary_size, (const unsigned char**)&binary, &status, &GPU_error);
+        if ((GPU_programs[GPU_active_program].program) && ((status != CL_SUCCESS) || (GPU_error != CL_SUCCESS))) {
+            // damaged or incompatible binary file - recompile program
+            clReleaseProgram(GPU_programs[GPU_active_program].program);
+            GPU_programs[GPU_active_program].program = NULL;
+        }
+        GPU_error = CL_SUCCESS;
         free(binary);
     }
 
-    // setup program
+    if (GPU_programs[GPU_active_program].program) {
+        GPU_programs[GPU_active_program].build_from_binary = true;
+        FileTouch(buffer);  // mark cache entry as recently used
+    } else {
+        GPU_programs[GPU_active_program].build_from_binary = false;
+        printf("\nprogram%u (%s.bin) is being compiled... \n",GPU_active_program,GPU_programs[GPU_active_program].cache_key);
+        GPU_programs[GPU_active_program].program = clCreateProgramWithSource(GPU_context, 1,&GPU_programs[GPU_active_program].source_ptr, NULL, &GPU_error);
+        OpenCL_Check_Error(GPU_error,"clCreateProgramWithSource failed");
+    }
+
+    // start clBuildProgram in background
+    GPU_programs[GPU_active_program].build_start   = clock();
+    GPU_programs[GPU_active_program].build_error   = CL_SUCCESS;
+    GPU_programs[GPU_active_program].build_pending = true;
+    GPU_programs[GPU_active_program].build_thread  = new std::thread(program_build,GPU_programs[GPU_active_program].program,GPU_device,GPU_programs[GPU_active_program].options,&GPU_programs[GPU_active_program].build_error);
 
     return GPU_active_program;
 }
-#endif
-
-int             GPU::program_create(const char* source,const char* options){
-    start_timer_CPU(10);
 
-    FILE * cl_program_file = NULL;
-    char buffer[FNAME_MAX_LENGTH];
-    char buffer_inf[FNAME_MAX_LENGTH];
+void            GPU::program_build(cl_program program, cl_device_id device, const char* options, cl_int* result){
+    *result = clBuildProgram(program, 1, &device, options, NULL, NULL);
+}
 
-    GPU_current_program++;
-    GPU_active_program = GPU_current_program;
+int             GPU::program_wait(int program_id){
+    if ((program_id<=0)||(program_id>GPU_current_program)||(!GPU_programs[program_id].build_pending)) return 0;
 
-    int GPU_active_file = 0;
+    GPU_programs[program_id].build_thread->join();
+    delete GPU_programs[program_id].build_thread;
+    GPU_programs[program_id].build_thread  = NULL;
+    GPU_programs[program_id].build_pending = false;
 
-    // setup reserve kernel's source
-    int source_length = (int) strlen(source) + 1;
-    char* temporary_source = (char*) calloc(source_length + 1, sizeof(char));
-    
-    strncpy_s(temporary_source, source_length, source, source_length);
-    GPU_programs[GPU_active_program].source_ptr     = temporary_source;
-    GPU_programs[GPU_active_program].source_length  = source_length;
-    if (options!=NULL){
-       int options_length = (int) strlen(options) + 1;
-       char* temporary_options = (char*) calloc(options_length + 1, sizeof(char));
-       strncpy_s(temporary_options, options_length, options, options_length);
-        GPU_programs[GPU_active_program].options        = temporary_options;
-    } else {
-       GPU_programs[GPU_active_program].options        = NULL;
+    if ((GPU_programs[program_id].build_error != CL_SUCCESS) && (GPU_programs[program_id].build_from_binary)) {
+        // cached binary can not be built - recompile program
+        clReleaseProgram(GPU_programs[program_id].program);
+        GPU_programs[program_id].build_from_binary = false;
+        printf("\nprogram%u (%s.bin) is being compiled... \n",program_id,GPU_programs[program_id].cache_key);
+        GPU_programs[program_id].program = clCreateProgramWithSource(GPU_context, 1,&GPU_programs[program_id].source_ptr, NULL, &GPU_error);
+        OpenCL_Check_Error(GPU_error,"clCreateProgramWithSource failed");
+        GPU_programs[program_id].build_error = clBuildProgram(GPU_programs[program_id].program, 1, &GPU_device, GPU_programs[program_id].options, NULL, NULL);
     }
 
-    GPU_programs[GPU_active_program].md5      = MD5(source);
-    GPU_programs[GPU_active_program].device   = device_get_name(GPU_device);
-    GPU_programs[GPU_active_program].platform = platform_get_name(GPU_platform);
-    GPU_programs[GPU_active_program].datetime = get_current_datetime();
+    // OpenCL_Check_Error reports build log of active program
+    int active_program = GPU_active_program;
+    GPU_active_program = program_id;
+    OpenCL_Check_Error(GPU_programs[program_id].build_error,"clBuildProgram failed");
+    GPU_active_program = active_program;
 
-    for (int i = 1; i <= GPU_inf_max_n; i++){
-       sprintf_s(buffer_inf,FNAME_MAX_LENGTH,"program%u.inf",i);
-       // get .inf-file
-       int parameters_items = 0;
-       GPU_init_parameters* parameters = get_init_file(buffer_inf);
-       if (parameters==NULL) {delete[] &buffer_inf; return 1;}
-       bool inf_number  = false;
-       bool inf_md5     = false;
-       bool inf_device  = false;
-       bool inf_platform= false;
-       bool inf_options = false;
-       int  inf_idx_md5     = 0;
-       int  inf_idx_device  = 0;
-       int  inf_idx_platform= 0;
-       int  inf_idx_options = 0;
-       bool parameters_flag = false;
-       while(!parameters_flag){
-          if (!strcmp(parameters[parameters_items].Variable,"NUMBER"))  {
-             if(parameters[parameters_items].iVarVal == GPU_active_program) inf_number = true;
-           }
-          if (!strcmp(parameters[parameters_items].Variable,"MD5"))  {
-             inf_md5 = true;
-             inf_idx_md5 = parameters_items;
-           }
-          if (!strcmp(parameters[parameters_items].Variable,"DEVICE"))  {
-             inf_device = true;
-             inf_idx_device = parameters_items;
-           }
-          if (!strcmp(parameters[parameters_items].Variable,"PLATFORM"))  {
-             inf_platform = true;
-             inf_idx_platform = parameters_items;
-           }
-          if (!strcmp(parameters[parameters_items].Variable,"OPTIONS"))  {
-             inf_options = true;
-             inf_idx_options = parameters_items;
-           }
-          parameters_flag = parameters[parameters_items].final;
-          parameters_items++;
-        }
-       // check parameters        
-       if (inf_number){
-            // check MD5
-            if (!strcmp(parameters[inf_idx_md5].txtVarVal,GPU_programs[GPU_active_program].md5)){
-                // check device and options
-                if ((!strcmp(parameters[inf_idx_device].txtVarVal,  GPU_programs[GPU_active_program].device))&&
-                    (!strcmp(parameters[inf_idx_platform].txtVarVal,GPU_programs[GPU_active_program].platform))&&
-                    (((GPU_programs[GPU_active_program].options==NULL)&&(!inf_options))||
-                     ((GPU_programs[GPU_active_program].options!=NULL)&&(!strcmp(parameters[inf_idx_options].txtVarVal,GPU_programs[GPU_active_program].options)))))
-                    {
-                        GPU_active_file = i;
-                        i = GPU_inf_max_n;
-                    }
-            // skip current .inf-file
-            } else {
-                // MD5 does not match
-                // kill current .inf-file and rename last .inf-file into current
-                inf_file_delete(i);
-                if (i < GPU_inf_max_n) inf_file_rename(GPU_inf_max_n,i);    // check if file is last
-                GPU_inf_max_n--;
-                i--;
-            }            
-        }
-     }
+                size_t size;
+                OpenCL_Check_Error(clGetProgramBuildInfo(GPU_programs[program_id].program, GPU_device, CL_PROGRAM_BUILD_LOG, 0, NULL, &size),"clGetProgramBuildInfo failed");
+                if (size>4) {
+                   GPU_programs[program_id].build_log = (char*) calloc(size,sizeof(char));
+                   OpenCL_Check_Error(clGetProgramBuildInfo(GPU_programs[program_id].program, GPU_device, CL_PROGRAM_BUILD_LOG, size, GPU_programs[program_id].build_log, NULL),"clGetProgramBuildInfo failed");
+                   if (GPU_debug.brief_report) printf("Program buid log: [%s]\n", GPU_programs[program_id].build_log);
+                 }
 
-    // if GPU_active_file == 0 then create files
-    if (GPU_active_file == 0) GPU_active_file = GPU_inf_max_n + 1;
+    if (!GPU_programs[program_id].build_from_binary) {
+        printf("program%u compilation done (%f seconds)!\n",program_id,(clock() - GPU_programs[program_id].build_start) * 1.0 / CLOCKS_PER_SEC);
+        program_cache_store(program_id);
+    }
 
-    int j = sprintf_s(buffer,    FNAME_MAX_LENGTH,"program%u.bin",GPU_active_file);
-        j = sprintf_s(buffer_inf,FNAME_MAX_LENGTH,"program%u.inf",GPU_active_file);
-    if (GPU_active_file <= GPU_inf_max_n)  {
-        // try to open .bin-file
-        fopen_s(&cl_program_file,buffer,"rb");
-     }
+    return 0;
+}
 
-    if((GPU_active_file > GPU_inf_max_n)||(!cl_program_file)){
-        printf("\nprogram%u.bin is being compiled... \n",GPU_active_program);
-        GPU_programs[GPU_active_program].program = clCreateProgramWithSource(GPU_context, 1,&GPU_programs[GPU_active_program].source_ptr, NULL, &GPU_error);
-        OpenCL_Check_Error(GPU_error,"clCreateProgramWithSource failed");
-        OpenCL_Check_Error(clBuildProgram(GPU_programs[GPU_active_program].program, 1, &GPU_device, GPU_programs[GPU_active_program].options, NULL, NULL),"clBuildProgram failed");
+int             GPU::program_cache_store(int program_id){
+    char buffer[FILENAME_MAX];
+    char buffer_inf[FILENAME_MAX];
+    sprintf_s(buffer,    FILENAME_MAX,"%s%s.bin",cache_path,GPU_programs[program_id].cache_key);
+    sprintf_s(buffer_inf,FILENAME_MAX,"%s%s.inf",cache_path,GPU_programs[program_id].cache_key);
 
         cl_uint num_devices;
-        OpenCL_Check_Error(clGetProgramInfo(GPU_programs[GPU_active_program].program, CL_PROGRAM_NUM_DEVICES, sizeof(cl_uint), &num_devices, NULL),"clGetProgramInfo1 failed");
+        OpenCL_Check_Error(clGetProgramInfo(GPU_programs[program_id].program, CL_PROGRAM_NUM_DEVICES, sizeof(cl_uint), &num_devices, NULL),"clGetProgramInfo1 failed");
 
         cl_device_id* devices = (cl_device_id*) calloc(num_devices, sizeof(cl_device_id));
-        OpenCL_Check_Error(clGetProgramInfo(GPU_programs[GPU_active_program].program, CL_PROGRAM_DEVICES, num_devices * sizeof(cl_device_id), devices, 0),"clGetProgramInfo2 failed");
+        OpenCL_Check_Error(clGetProgramInfo(GPU_programs[program_id].program, CL_PROGRAM_DEVICES, num_devices * sizeof(cl_device_id), devices, 0),"clGetProgramInfo2 failed");
 
         size_t* binary_sizes = (size_t*) calloc(num_devices, sizeof(size_t));    
-        OpenCL_Check_Error(clGetProgramInfo(GPU_programs[GPU_active_program].program, CL_PROGRAM_BINARY_SIZES, num_devices * sizeof(size_t), binary_sizes, NULL),"clGetProgramInfo3 failed");
+        OpenCL_Check_Error(clGetProgramInfo(GPU_programs[program_id].program, CL_PROGRAM_BINARY_SIZES, num_devices * sizeof(size_t), binary_sizes, NULL),"clGetProgramInfo3 failed");
 
         char** binary = (char**) calloc(num_devices, sizeof(char*));
         for( unsigned int i=0; i<num_devices; ++i) binary[i]= (char*) malloc(binary_sizes[i]);
 
-        OpenCL_Check_Error(clGetProgramInfo(GPU_programs[GPU_active_program].program, CL_PROGRAM_BINARIES, num_devices * sizeof(size_t), binary, NULL),"clGetProgramInfo4 failed");
-
-                size_t size;
-                OpenCL_Check_Error(clGetProgramBuildInfo(GPU_programs[GPU_active_program].program, GPU_device, CL_PROGRAM_BUILD_LOG, 0, NULL, &size),"clGetProgramBuildInfo failed");
-                if (size>4) {
-                   GPU_programs[GPU_active_program].build_log = (char*) calloc(size,sizeof(char));
-                   OpenCL_Check_Error(clGetProgramBuildInfo(GPU_programs[GPU_active_program].program, GPU_device, CL_PROGRAM_BUILD_LOG, size, GPU_programs[GPU_active_program].build_log, NULL),"clGetProgramBuildInfo failed");
-                   if (GPU_debug.brief_report) printf("Program buid log: [%s]\n", GPU_programs[GPU_active_program].build_log);
-                 }
+        OpenCL_Check_Error(clGetProgramInfo(GPU_programs[program_id].program, CL_PROGRAM_BINARIES, num_devices * sizeof(size_t), binary, NULL),"clGetProgramInfo4 failed");
 
         unsigned int idx = 0;
         while( idx<num_devices && devices[idx] != GPU_device ) ++idx;
 
-        // save inf file
-        fopen_s(&cl_program_file,buffer_inf,"wb");
-        if ( (cl_program_file) && (idx < num_devices) && (binary_sizes[idx]>0) ){
-            fprintf(cl_program_file,"NUMBER=%u\n",GPU_active_program);
-            fprintf(cl_program_file,"MD5=%s\n",GPU_programs[GPU_active_program].md5);
-            if (GPU_programs[GPU_active_program].options!=NULL)
-                fprintf(cl_program_file,"OPTIONS=%s\n",GPU_programs[GPU_active_program].options);
-            fprintf(cl_program_file,"DEVICE=%s\n",GPU_programs[GPU_active_program].device);
-            fprintf(cl_program_file,"PLATFORM=%s\n",GPU_programs[GPU_active_program].platform);
-            fprintf(cl_program_file,"DATE=%s",GPU_programs[GPU_active_program].datetime);
-            if ( fclose(cl_program_file) ) printf( "The file was not closed!\n" );
-        }
-
-        printf("program%u.bin compilation done (%f seconds)!\n",GPU_active_program,get_timer_CPU(10));
-
-        // save binary file
-        fopen_s(&cl_program_file,buffer,"wb");
-        if ( (cl_program_file) && (idx < num_devices) && (binary_sizes[idx]>0) ){
-           fwrite(binary[idx],1,binary_sizes[idx],cl_program_file);
-           if ( fclose(cl_program_file) ) printf( "The file was not closed!\n" );
+        if ( (idx < num_devices) && (binary_sizes[idx]>0) ){
+            // save inf file
+            const char* program_options = (GPU_programs[program_id].options!=NULL) ? GPU_programs[program_id].options : "";
+            size_t inf_length = strlen(GPU_programs[program_id].md5) + strlen(program_options) + strlen(GPU_programs[program_id].device) +
+                                strlen(GPU_programs[program_id].platform) + strlen(GPU_info.driver_version) + strlen(GPU_programs[program_id].datetime) + 128;
+            char* inf = (char*) calloc(inf_length,sizeof(char));
+            int k = sprintf_s(inf,inf_length,"MD5=%s\n",GPU_programs[program_id].md5);
+            if (GPU_programs[program_id].options!=NULL)
+                k += sprintf_s(inf+k,inf_length-k,"OPTIONS=%s\n",program_options);
+            k += sprintf_s(inf+k,inf_length-k,"DEVICE=%s\n",GPU_programs[program_id].device);
+            k += sprintf_s(inf+k,inf_length-k,"PLATFORM=%s\n",GPU_programs[program_id].platform);
+            k += sprintf_s(inf+k,inf_length-k,"DRIVER=%s\n",GPU_info.driver_version);
+            k += sprintf_s(inf+k,inf_length-k,"DATE=%s",GPU_programs[program_id].datetime);
+            program_cache_save(buffer_inf,inf,strlen(inf));
+            free(inf);
+
+            // save binary file
+            program_cache_save(buffer,binary[idx],binary_sizes[idx]);
+            program_cache_evict();
         }
         free(devices);
         free(binary_sizes);
         for( unsigned int i=0; i<num_devices; ++i) free(binary[i]);
         free(binary);
-        GPU_inf_max_n++;
-    } else {
 
-        // load binary file
-        fseek (cl_program_file, 0, SEEK_END);
-        const size_t binary_size = ftell(cl_program_file);
-        rewind(cl_program_file);
-        unsigned char* binary;
-        binary = (unsigned char*) malloc (binary_size);
-        fread(binary, 1, binary_size, cl_program_file);
-        fclose(cl_program_file);
-
-        cl_int status;
-        GPU_programs[GPU_active_program].program = clCreateProgramWithBinary(GPU_context, 1, &GPU_device, &binary_size, (const unsigned char**)&binary, &status, &GPU_error);
-        OpenCL_Check_Error(status,"clCreateProgramWithBinary failed");
-        OpenCL_Check_Error(GPU_error,"clCreateProgramWithBinary failed");
-
-        OpenCL_Check_Error(clBuildProgram(GPU_programs[GPU_active_program].program, 1, &GPU_device, GPU_programs[GPU_active_program].options, NULL, NULL),"clBuildProgram failed");
-
-                size_t size;
-                OpenCL_Check_Error(clGetProgramBuildInfo(GPU_programs[GPU_active_program].program, GPU_device, CL_PROGRAM_BUILD_LOG, 0, NULL, &size),"clGetProgramBuildInfo failed");
-                if (size>4) {
-                   GPU_programs[GPU_active_program].build_log = (char*) calloc(size,sizeof(char));
-                   OpenCL_Check_Error(clGetProgramBuildInfo(GPU_programs[GPU_active_program].program, GPU_device, CL_PROGRAM_BUILD_LOG, size, GPU_programs[GPU_active_program].build_log, NULL),"clGetProgramBuildInfo failed");
-                   if (GPU_debug.brief_report) printf("Program buid log: [%s]\n", GPU_programs[GPU_active_program].build_log);
-                 }
-        free(binary);
-    }
-
-    // setup program
-
-    return GPU_active_program;
+    return 0;
 }
 
 int             GPU::program_set_active(int program_id){
@@ -1128,9 +1025,22 @@ int             GPU::program_get_active(void){
     return GPU_active_program;
 }
 
+int             GPU::queue_set_active(int queue_type){
+    // kernels started by kernel_run go to the main queue, or to the measurement queue if it exists
+    GPU_active_queue = queue_type;
+    return GPU_active_queue;
+}
+
 // ___ kernel _____________________________________________________________________________________
 int             GPU::kernel_init(const char* kernel_name, unsigned int work_dimensions, const size_t* global_size, const size_t* local_size)
 {
+    return kernel_init(kernel_name, work_dimensions, global_size, local_size, true);
+}
+
+int             GPU::kernel_init(const char* kernel_name, unsigned int work_dimensions, const size_t* global_size, const size_t* local_size, bool autotune)
+{
+    program_wait(GPU_active_program);   // finish background build of program
+
     GPU_current_kernel++;
 
     // setup program
@@ -1175,6 +1085,20 @@ int             GPU::kernel_init(const char* kernel_name, unsigned int work_dime
     GPU_kernels[GPU_current_kernel].local_size                  = temporary_local_size;
     GPU_kernels[GPU_current_kernel].work_dimensions             = work_dimensions;
 
+    // setup tuned work group size (autotune = false for kernels, which data layout depends on work group size)
+    GPU_kernels[GPU_current_kernel].kernel_single_group         = (temporary_global_size[0] == temporary_local_size[0]);
+    GPU_kernels[GPU_current_kernel].kernel_autotune             = false;
+    if (autotune) {
+        GPU_kernels[GPU_current_kernel].kernel_autotune_key     = autotune_get_key(GPU_current_kernel);
+        size_t tuned_local_size = autotune_get_local_size(GPU_kernels[GPU_current_kernel].kernel_autotune_key);
+        if ((tuned_local_size) && (tuned_local_size <= GPU_info.max_workgroup_size) &&
+            ((GPU_kernels[GPU_current_kernel].kernel_single_group) || (temporary_global_size[0] % tuned_local_size == 0))) {
+                temporary_local_size[0] = tuned_local_size;
+                if (GPU_kernels[GPU_current_kernel].kernel_single_group) temporary_global_size[0] = tuned_local_size;
+        } else
+                GPU_kernels[GPU_current_kernel].kernel_autotune = GPU_debug.autotune;
+    }
+
     // setup profiling data __________________________________________
     GPU_kernels[GPU_current_kernel].kernel_start                = 0;
     GPU_kernels[GPU_current_kernel].kernel_finish               = 0;
@@ -1195,6 +1119,10 @@ int             GPU::kernel_init_buffer(int kernel_id,int buffer_id)
      }
     GPU_kernels[kernel_id].argument_id++;
 
+    // keep buffer id for backup during work group size tuning
+    GPU_kernels[kernel_id].argument_buffers = (int*) realloc(GPU_kernels[kernel_id].argument_buffers, (GPU_kernels[kernel_id].argument_buffers_number + 1) * sizeof(int));
+    GPU_kernels[kernel_id].argument_buffers[GPU_kernels[kernel_id].argument_buffers_number++] = buffer_id;
+
     return GPU_kernels[kernel_id].argument_id;
 }
 
@@ -1210,6 +1138,7 @@ int             GPU::kernel_init_buffer_Buf(int kernel_id, cl_mem buffer, int bu
        printf(":::::::::::::::::::::::::::::::\n");
      }
     GPU_kernels[kernel_id].argument_id++;
+    GPU_kernels[kernel_id].kernel_autotune = false;     // buffer can not be restored after tuning
 
     return GPU_kernels[kernel_id].argument_id;
 }
@@ -1235,6 +1164,12 @@ int             GPU::kernel_init_constant(int kernel_id,cl_uint4* host_ptr)
         return GPU_kernels[kernel_id].argument_id;
 }
 
+int             GPU::kernel_init_constant_reset(int kernel_id,cl_uint4* host_ptr, int argument_id)
+{
+        OpenCL_Check_Error(clSetKernelArg(GPU_kernels[kernel_id].kernel, argument_id, sizeof(cl_uint4), (void*) host_ptr),"clSetKernelArg failed");
+        return argument_id;
+}
+
 int             GPU::kernel_init_constant(int kernel_id,float*  host_ptr)
 {
         OpenCL_Check_Error(clSetKernelArg(GPU_kernels[kernel_id].kernel, GPU_kernels[kernel_id].argument_id, sizeof(float), (void*) host_ptr),"clSetKernelArg failed");
@@ -1242,41 +1177,122 @@ int             GPU::kernel_init_constant(int kernel_id,float*  host_ptr)
         return GPU_kernels[kernel_id].argument_id;
 }
 
+int             GPU::kernel_init_constant_reset(int kernel_id,float* host_ptr, int argument_id)
+{
+        OpenCL_Check_Error(clSetKernelArg(GPU_kernels[kernel_id].kernel, argument_id, sizeof(float), (void*) host_ptr),"clSetKernelArg failed");
+        return argument_id;
+}
+
 int             GPU::kernel_init_constant(int kernel_id,double* host_ptr)
 {
         OpenCL_Check_Error(clSetKernelArg(GPU_kernels[kernel_id].kernel, GPU_kernels[kernel_id].argument_id, sizeof(double), (void*) host_ptr),"clSetKernelArg failed");
         GPU_kernels[kernel_id].argument_id++;
         return GPU_kernels[kernel_id].argument_id;
 }
+
+int             GPU::kernel_init_constant_reset(int kernel_id,double* host_ptr, int argument_id)
+{
+        OpenCL_Check_Error(clSetKernelArg(GPU_kernels[kernel_id].kernel, argument_id, sizeof(double), (void*) host_ptr),"clSetKernelArg failed");
+        return argument_id;
+}
 int             GPU::kernel_run(int kernel_id)
 {
+    if (GPU_kernels[kernel_id].kernel_autotune) kernel_autotune(kernel_id);
+
     cl_event kernel_event;
-    if (GPU_debug.profiling){
-        // run with profiling
-        cl_ulong kernel_start, kernel_finish;
-        OpenCL_Check_Error(clEnqueueNDRangeKernel(GPU_queue,GPU_kernels[kernel_id].kernel,GPU_kernels[kernel_id].work_dimensions,NULL,GPU_kernels[kernel_id].global_size,GPU_kernels[kernel_id].local_size, 0, NULL, &kernel_event),"clEnqueueNDRangeKernel failed");
-        OpenCL_Check_Error(clWaitForEvents(1, &kernel_event),"clWaitForEvents failed");
-        OpenCL_Check_Error(clGetEventProfilingInfo(kernel_event, CL_PROFILING_COMMAND_END,   sizeof(cl_ulong), &kernel_finish, 0),"clGetEventProfilingInfo failed");
-        OpenCL_Check_Error(clGetEventProfilingInfo(kernel_event, CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &kernel_start,  0),"clGetEventProfilingInfo failed");
-        double elapsed_time = (double) (kernel_finish-kernel_start);
-        GPU_kernels[kernel_id].kernel_elapsed_time          += elapsed_time;
-        GPU_kernels[kernel_id].kernel_elapsed_time_squared  += elapsed_time * elapsed_time;
-        GPU_kernels[kernel_id].kernel_start                  = kernel_start;
-        GPU_kernels[kernel_id].kernel_finish                 = kernel_finish;
-        GPU_kernels[kernel_id].kernel_number_of_starts++;
-    } else {
-        // run without profiling
-        size_t local_workgroup_size;
-        OpenCL_Check_Error(clGetKernelWorkGroupInfo(GPU_kernels[kernel_id].kernel,GPU_device,CL_KERNEL_WORK_GROUP_SIZE,sizeof(size_t),&local_workgroup_size,NULL),"clGetKernelWorkGroupInfo failed");
-        
-        OpenCL_Check_Error(clEnqueueNDRangeKernel(GPU_queue,GPU_kernels[kernel_id].kernel,GPU_kernels[kernel_id].work_dimensions,NULL,GPU_kernels[kernel_id].global_size,GPU_kernels[kernel_id].local_size, 0, NULL, &kernel_event),"clEnqueueNDRangeKernel failed");
-        //printf("AAAAAAAAAAAA\n");
-        OpenCL_Check_Error(clWaitForEvents(1, &kernel_event),"clWaitForEvents failed");
+    if ((GPU_active_queue==queue_type_measurement)&&(GPU_measurement_queue)){
+        // run in measurement queue after the snapshot copy, host and main queue do not wait for it
+        cl_uint events_to_wait = (GPU_snapshot_event) ? 1 : 0;
+        OpenCL_Check_Error(clEnqueueNDRangeKernel(GPU_measurement_queue,GPU_kernels[kernel_id].kernel,GPU_kernels[kernel_id].work_dimensions,NULL,GPU_kernels[kernel_id].global_size,GPU_kernels[kernel_id].local_size, events_to_wait, (events_to_wait) ? &GPU_snapshot_event : NULL, &kernel_event),"clEnqueueNDRangeKernel failed");
+        if (GPU_snapshot_event) OpenCL_Check_Error(clReleaseEvent(GPU_snapshot_event),"clReleaseEvent failed");
+        GPU_snapshot_event = NULL;
+        if (GPU_measurement_last_event) OpenCL_Check_Error(clReleaseEvent(GPU_measurement_last_event),"clReleaseEvent failed");
+        GPU_measurement_last_event = kernel_event;
+
+        if (GPU_debug.profiling) kernel_defer_profiling(kernel_id,kernel_event);
+        OpenCL_Check_Error(clFlush(GPU_measurement_queue),"clFlush failed");
+        return kernel_id;
     }
+
+    if (GPU_debug.async_dispatch){
+        // run without host synchronization: chain the launch on the previous one and return immediately
+        cl_uint events_to_wait = (GPU_last_event) ? 1 : 0;
+        OpenCL_Check_Error(clEnqueueNDRangeKernel(GPU_queue,GPU_kernels[kernel_id].kernel,GPU_kernels[kernel_id].work_dimensions,NULL,GPU_kernels[kernel_id].global_size,GPU_kernels[kernel_id].local_size, events_to_wait, (events_to_wait) ? &GPU_last_event : NULL, &kernel_event),"clEnqueueNDRangeKernel failed");
+        if (GPU_last_event) OpenCL_Check_Error(clReleaseEvent(GPU_last_event),"clReleaseEvent failed");
+        GPU_last_event = kernel_event;
+
+        if (GPU_debug.profiling) kernel_defer_profiling(kernel_id,kernel_event);
+
+        GPU_unflushed_number++;
+        if (GPU_unflushed_number >= EVENTS_FLUSH_STEP) {
+            OpenCL_Check_Error(clFlush(GPU_queue),"clFlush failed");
+            GPU_unflushed_number = 0;
+        }
+        return kernel_id;
+    }
+
+    OpenCL_Check_Error(clEnqueueNDRangeKernel(GPU_queue,GPU_kernels[kernel_id].kernel,GPU_kernels[kernel_id].work_dimensions,NULL,GPU_kernels[kernel_id].global_size,GPU_kernels[kernel_id].local_size, 0, NULL, &kernel_event),"clEnqueueNDRangeKernel failed");
+    OpenCL_Check_Error(clWaitForEvents(1, &kernel_event),"clWaitForEvents failed");
+    if (GPU_debug.profiling) kernel_get_profiling(kernel_id,kernel_event);
+    if (GPU_debug.trace) trace_kernel(kernel_id,kernel_event,GPU_trace_iteration);
+    OpenCL_Check_Error(clReleaseEvent(kernel_event),"clReleaseEvent failed");
     OpenCL_Check_Error(clFinish(GPU_queue),"clFinish failed");
     return kernel_id;
 }
 
+void            GPU::kernel_defer_profiling(int kernel_id,cl_event kernel_event)
+{
+    // keep the event, profiling info is collected at the next synchronization point
+    OpenCL_Check_Error(clRetainEvent(kernel_event),"clRetainEvent failed");
+    GPU_pending_events[GPU_pending_number]  = kernel_event;
+    GPU_pending_kernels[GPU_pending_number] = kernel_id;
+    GPU_pending_iterations[GPU_pending_number] = GPU_trace_iteration;
+    GPU_pending_number++;
+    if (GPU_pending_number >= EVENTS_PENDING_MAX) device_synchronize();
+}
+
+void            GPU::kernel_get_profiling(int kernel_id,cl_event kernel_event)
+{
+    cl_ulong kernel_start, kernel_finish;
+    OpenCL_Check_Error(clGetEventProfilingInfo(kernel_event, CL_PROFILING_COMMAND_END,   sizeof(cl_ulong), &kernel_finish, 0),"clGetEventProfilingInfo failed");
+    OpenCL_Check_Error(clGetEventProfilingInfo(kernel_event, CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &kernel_start,  0),"clGetEventProfilingInfo failed");
+    double elapsed_time = (double) (kernel_finish-kernel_start);
+    GPU_kernels[kernel_id].kernel_elapsed_time          += elapsed_time;
+    GPU_kernels[kernel_id].kernel_elapsed_time_squared  += elapsed_time * elapsed_time;
+    GPU_kernels[kernel_id].kernel_start                  = kernel_start;
+    GPU_kernels[kernel_id].kernel_finish                 = kernel_finish;
+    GPU_kernels[kernel_id].kernel_number_of_starts++;
+}
+
+int             GPU::kernel_set_cost(int kernel_id,double bytes_per_item,double flops_per_item)
+{
+    // declare global memory traffic and floating-point operations of one work item for roofline report
+    if ((kernel_id<=0)||(kernel_id>GPU_current_kernel)) return 0;
+    GPU_kernels[kernel_id].kernel_bytes = bytes_per_item;
+    GPU_kernels[kernel_id].kernel_flops = flops_per_item;
+    return kernel_id;
+}
+
+double          GPU::kernel_get_items(int kernel_id)
+{
+    double result = 1.0;
+    for (unsigned int i=0; i<GPU_kernels[kernel_id].work_dimensions; i++) result *= (double) GPU_kernels[kernel_id].global_size[i];
+    return result;
+}
+
+double          GPU::kernel_get_bytes(int kernel_id)
+{
+    // bytes per work item: declared by kernel_set_cost, otherwise every argument buffer is assumed to be touched once
+    if (GPU_kernels[kernel_id].kernel_bytes > 0.0) return GPU_kernels[kernel_id].kernel_bytes;
+    double result = 0.0;
+    for (int i=0; i<GPU_kernels[kernel_id].argument_buffers_number; i++){
+        int buffer_id = GPU_kernels[kernel_id].argument_buffers[i];
+        if (GPU_buffers[buffer_id].buffer_type!=buffer_type_LDS) result += (double) GPU_buffers[buffer_id].size_in_bytes;
+    }
+    double items = kernel_get_items(kernel_id);
+    return (items > 0.0) ? result / items : 0.0;
+}
+
 int             GPU::kernel_get_worksize(int kernel_id){
         size_t result;
 
@@ -1287,13 +1303,97 @@ int             GPU::kernel_get_worksize(int kernel_id){
     return (int) result;
 }
 
+int             GPU::kernel_autotune(int kernel_id)
+{
+    // benchmark power-of-two work group sizes and save the fastest one into autotune.inf
+    // current launch geometry is kept, the tuned one is applied by kernel_init at the next run
+    GPU_kernels[kernel_id].kernel_autotune = false;
+
+    unsigned int work_dimensions = GPU_kernels[kernel_id].work_dimensions;
+    bool single_group = GPU_kernels[kernel_id].kernel_single_group;
+
+    size_t kernel_work_group_size = 0;
+    OpenCL_Check_Error(clGetKernelWorkGroupInfo(GPU_kernels[kernel_id].kernel,GPU_device,CL_KERNEL_WORK_GROUP_SIZE,sizeof(size_t),&kernel_work_group_size,NULL),"clGetKernelWorkGroupInfo failed");
+    if (kernel_work_group_size > GPU_info.max_workgroup_size) kernel_work_group_size = GPU_info.max_workgroup_size;
+
+    size_t candidate_min = AUTOTUNE_LOCAL_SIZE_MIN;
+    while (candidate_min < GPU_kernels[kernel_id].kernel_preferred_workgroup_size_multiple) candidate_min <<= 1;
+
+    size_t* candidate_global_size = (size_t*) calloc(work_dimensions+1,sizeof(size_t));
+    size_t* candidate_local_size  = (size_t*) calloc(work_dimensions+1,sizeof(size_t));
+    for (unsigned int i=0; i<work_dimensions; i++) {
+        candidate_global_size[i] = GPU_kernels[kernel_id].global_size[i];
+        candidate_local_size[i]  = GPU_kernels[kernel_id].local_size[i];
+    }
+
+    device_synchronize();
+
+    // backup buffers, which may be modified by kernel
+    int buffers_number = GPU_kernels[kernel_id].argument_buffers_number;
+    cl_mem* buffers_backup = (cl_mem*) calloc(buffers_number+1,sizeof(cl_mem));
+    for (int i=0; i<buffers_number; i++){
+        int buffer_id = GPU_kernels[kernel_id].argument_buffers[i];
+        int buffer_type = GPU_buffers[buffer_id].buffer_type;
+        if ((buffer_type==buffer_type_LDS)||(buffer_type==buffer_type_Input)||(buffer_type==buffer_type_Constant)||(!GPU_buffers[buffer_id].buffer)) continue;
+        buffers_backup[i] = clCreateBuffer(GPU_context,CL_MEM_READ_WRITE,GPU_buffers[buffer_id].size_in_bytes,NULL,&GPU_error);
+        OpenCL_Check_Error(GPU_error,"clCreateBuffer failed");
+        OpenCL_Check_Error(clEnqueueCopyBuffer(GPU_queue,GPU_buffers[buffer_id].buffer,buffers_backup[i],0,0,GPU_buffers[buffer_id].size_in_bytes,0,NULL,NULL),"clEnqueueCopyBuffer failed");
+    }
+
+    size_t best_local_size = GPU_kernels[kernel_id].local_size[0];
+    double best_time = 0.0;
+    for (size_t candidate = candidate_min; candidate <= kernel_work_group_size; candidate <<= 1){
+        if ((!single_group) && (GPU_kernels[kernel_id].global_size[0] % candidate)) continue;
+        candidate_local_size[0] = candidate;
+        if (single_group) candidate_global_size[0] = candidate;
+
+        double candidate_time = 0.0;
+        for (int r=0; r<AUTOTUNE_REPEATS; r++){
+            cl_event kernel_event;
+            cl_ulong kernel_start, kernel_finish;
+            // kernel may fail to start with some work group sizes - skip such candidates
+            GPU_error = clEnqueueNDRangeKernel(GPU_queue,GPU_kernels[kernel_id].kernel,work_dimensions,NULL,candidate_global_size,candidate_local_size, 0, NULL, &kernel_event);
+            if (GPU_error != CL_SUCCESS) {candidate_time = 0.0; break;}
+            OpenCL_Check_Error(clWaitForEvents(1, &kernel_event),"clWaitForEvents failed");
+            OpenCL_Check_Error(clGetEventProfilingInfo(kernel_event, CL_PROFILING_COMMAND_END,   sizeof(cl_ulong), &kernel_finish, 0),"clGetEventProfilingInfo failed");
+            OpenCL_Check_Error(clGetEventProfilingInfo(kernel_event, CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &kernel_start,  0),"clGetEventProfilingInfo failed");
+            OpenCL_Check_Error(clReleaseEvent(kernel_event),"clReleaseEvent failed");
+            double elapsed_time = (double) (kernel_finish-kernel_start);
+            if ((r==0)||(elapsed_time < candidate_time)) candidate_time = elapsed_time;
+        }
+        GPU_error = CL_SUCCESS;
+        if ((candidate_time > 0.0) && ((best_time == 0.0) || (candidate_time < best_time))) {
+            best_time       = candidate_time;
+            best_local_size = candidate;
+        }
+    }
+
+    // restore buffers
+    for (int i=0; i<buffers_number; i++){
+        if (!buffers_backup[i]) continue;
+        int buffer_id = GPU_kernels[kernel_id].argument_buffers[i];
+        OpenCL_Check_Error(clEnqueueCopyBuffer(GPU_queue,buffers_backup[i],GPU_buffers[buffer_id].buffer,0,0,GPU_buffers[buffer_id].size_in_bytes,0,NULL,NULL),"clEnqueueCopyBuffer failed");
+    }
+    OpenCL_Check_Error(clFinish(GPU_queue),"clFinish failed");
+    for (int i=0; i<buffers_number; i++)
+        if (buffers_backup[i]) OpenCL_Check_Error(clReleaseMemObject(buffers_backup[i]),"clReleaseMemObject failed");
+
+    free(buffers_backup);
+    free(candidate_global_size);
+    free(candidate_local_size);
+
+    if (best_time > 0.0) autotune_file_save(kernel_id, best_local_size, best_time);
+
+    return (int) best_local_size;
+}
+
 GPU::GPU_time_deviation  GPU::kernel_get_execution_time(int kernel_id){
     GPU_time_deviation execution_time = time_get_deviation(GPU_kernels[kernel_id].kernel_elapsed_time,GPU_kernels[kernel_id].kernel_elapsed_time_squared,GPU_kernels[kernel_id].kernel_number_of_starts);
     return execution_time;
 }
 
 // ___ buffer _____________________________________________________________________________________
-int             GPU::buffer_init(int buffer_type, int size, void* host_ptr, int size_of)
+int             GPU::buffer_init(int buffer_type, lattice_index size, void* host_ptr, int size_of)
 {
     GPU_current_buffer++;
 
@@ -1318,17 +1418,18 @@ int             GPU::buffer_init(int buffer_type, int size, void* host_ptr, int
                 case buffer_type_IO:         { flags = CL_MEM_READ_WRITE; flags2 = CL_MEM_COPY_HOST_PTR; break;}
                 case buffer_type_Output:     { flags = CL_MEM_WRITE_ONLY;                                break;}
                 case buffer_type_Global:     { flags = CL_MEM_READ_WRITE;                                break;}
+                case buffer_type_Pinned:     { flags = CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR; if (host_ptr) flags2 = CL_MEM_COPY_HOST_PTR; break;}
         }
         GPU_buffers[GPU_current_buffer].buffer_type = buffer_type;
         GPU_buffers[GPU_current_buffer].size = size;
-        GPU_buffers[GPU_current_buffer].size_in_bytes = size * size_of;
+        GPU_buffers[GPU_current_buffer].size_in_bytes = (size_t) size * size_of;
         GPU_buffers[GPU_current_buffer].host_ptr = host_ptr;
         GPU_buffers[GPU_current_buffer].mapped_ptr = NULL;
 
     if (buffer_type!=buffer_type_LDS){
        flags = flags | flags2;
 
-       GPU_buffers[GPU_current_buffer].buffer = clCreateBuffer( GPU_context,flags,size * size_of,host_ptr, &GPU_error );
+       GPU_buffers[GPU_current_buffer].buffer = clCreateBuffer( GPU_context,flags,GPU_buffers[GPU_current_buffer].size_in_bytes,host_ptr, &GPU_error );
        OpenCL_Check_Error(GPU_error,"clCreateKernel failed");
        GPU_error = buffer_write(GPU_current_buffer);
     } else {
@@ -1339,7 +1440,7 @@ int             GPU::buffer_init(int buffer_type, int size, void* host_ptr, int
 }
 
 #ifdef BIGLAT
-int             GPU::buffer_init(int buffer_type, int size, void* host_ptr, int size_of, int offset)
+int             GPU::buffer_init(int buffer_type, lattice_index size, void* host_ptr, int size_of, int offset)
 {
     //GPU_current_buffer++;
     GPU_current_buffer += offset * BUFF_STEP;
@@ -1369,17 +1470,18 @@ int             GPU::buffer_init(int buffer_type, int size, void* host_ptr, int
 #endif
                 case buffer_type_Output:     { flags = CL_MEM_WRITE_ONLY;                                break;}
                 case buffer_type_Global:     { flags = CL_MEM_READ_WRITE;                                break;}
+                case buffer_type_Pinned:     { flags = CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR; if (host_ptr) flags2 = CL_MEM_COPY_HOST_PTR; break;}
         }
         GPU_buffers[GPU_current_buffer].buffer_type = buffer_type;
         GPU_buffers[GPU_current_buffer].size = size;
-        GPU_buffers[GPU_current_buffer].size_in_bytes = size * size_of;
+        GPU_buffers[GPU_current_buffer].size_in_bytes = (size_t) size * size_of;
         GPU_buffers[GPU_current_buffer].host_ptr = host_ptr;
         GPU_buffers[GPU_current_buffer].mapped_ptr = NULL;
 
     if (buffer_type!=buffer_type_LDS){
        flags = flags | flags2;
 
-       GPU_buffers[GPU_current_buffer].buffer = clCreateBuffer( GPU_context,flags,size * size_of,host_ptr, &GPU_error );
+       GPU_buffers[GPU_current_buffer].buffer = clCreateBuffer( GPU_context,flags,GPU_buffers[GPU_current_buffer].size_in_bytes,host_ptr, &GPU_error );
        OpenCL_Check_Error(GPU_error,"clCreateKernel failed");
        GPU_error = buffer_write(GPU_current_buffer);
     } else {
@@ -1392,9 +1494,19 @@ int             GPU::buffer_init(int buffer_type, int size, void* host_ptr, int
 
 int             GPU::buffer_write(int buffer_id)
 {
+    return buffer_write(buffer_id,true);
+}
+
+int             GPU::buffer_write(int buffer_id,bool blocking)
+{
+    // non-blocking write: host data must not be changed until the queue passes the write
     cl_event buffer_event;
     cl_ulong buffer_write_start, buffer_write_finish;
-    OpenCL_Check_Error(clEnqueueWriteBuffer( GPU_queue, GPU_buffers[buffer_id].buffer, CL_TRUE, 0, GPU_buffers[buffer_id].size_in_bytes, GPU_buffers[buffer_id].host_ptr, 0, NULL, &buffer_event),"clEnqueueWriteBuffer failed");
+    // buffers without host data are filled with zeros
+    void* data = (GPU_buffers[buffer_id].host_ptr) ? GPU_buffers[buffer_id].host_ptr : calloc(GPU_buffers[buffer_id].size_in_bytes,1);
+    cl_bool blocking_write = ((blocking)||(!GPU_buffers[buffer_id].host_ptr)) ? CL_TRUE : CL_FALSE;
+    OpenCL_Check_Error(clEnqueueWriteBuffer( GPU_queue, GPU_buffers[buffer_id].buffer, blocking_write, 0, GPU_buffers[buffer_id].size_in_bytes, data, 0, NULL, &buffer_event),"clEnqueueWriteBuffer failed");
+    if (!GPU_buffers[buffer_id].host_ptr) free(data);
     if (GPU_debug.profiling){
         OpenCL_Check_Error(clWaitForEvents(1, &buffer_event),"clWaitForEvents failed");
         OpenCL_Check_Error(clGetEventProfilingInfo(buffer_event, CL_PROFILING_COMMAND_END,   sizeof(cl_ulong), &buffer_write_finish, 0),"clGetEventProfilingInfo failed");
@@ -1405,10 +1517,57 @@ int             GPU::buffer_write(int buffer_id)
         GPU_buffers[buffer_id].buffer_write_finish                  = buffer_write_finish;
         GPU_buffers[buffer_id].buffer_write_elapsed_time_squared   += elapsed_time*elapsed_time;
         GPU_buffers[buffer_id].buffer_write_number_of++;
+        if (GPU_debug.trace) trace_transfer(buffer_id,"write",buffer_write_start,buffer_write_finish);
     }
     return (int) GPU_error;
 }
 
+int             GPU::buffer_snapshot_init(int buffer_id)
+{
+    // device-only copy of buffer, is filled by buffer_snapshot
+    GPU_current_buffer++;
+
+    GPU_buffers[GPU_current_buffer].buffer_write_start                  = 0;
+    GPU_buffers[GPU_current_buffer].buffer_write_finish                 = 0;
+    GPU_buffers[GPU_current_buffer].buffer_write_elapsed_time           = 0.0;
+    GPU_buffers[GPU_current_buffer].buffer_write_elapsed_time_squared   = 0.0;
+    GPU_buffers[GPU_current_buffer].buffer_write_number_of              = 0;
+
+    GPU_buffers[GPU_current_buffer].buffer_read_start                   = 0;
+    GPU_buffers[GPU_current_buffer].buffer_read_finish                  = 0;
+    GPU_buffers[GPU_current_buffer].buffer_read_elapsed_time            = 0.0;
+    GPU_buffers[GPU_current_buffer].buffer_read_elapsed_time_squared    = 0.0;
+    GPU_buffers[GPU_current_buffer].buffer_read_number_of               = 0;
+
+    GPU_buffers[GPU_current_buffer].buffer_type   = buffer_type_Global;
+    GPU_buffers[GPU_current_buffer].size          = GPU_buffers[buffer_id].size;
+    GPU_buffers[GPU_current_buffer].size_in_bytes = GPU_buffers[buffer_id].size_in_bytes;
+    GPU_buffers[GPU_current_buffer].host_ptr      = NULL;
+    GPU_buffers[GPU_current_buffer].mapped_ptr    = NULL;
+
+    GPU_buffers[GPU_current_buffer].buffer = clCreateBuffer(GPU_context,CL_MEM_READ_WRITE,GPU_buffers[buffer_id].size_in_bytes,NULL,&GPU_error);
+    OpenCL_Check_Error(GPU_error,"clCreateBuffer failed");
+
+    return GPU_current_buffer;
+}
+
+int             GPU::buffer_snapshot(int snapshot_id,int buffer_id)
+{
+    // copy buffer in main queue after the last enqueued kernel, copy waits until the previous measurement has released the snapshot
+    cl_uint events_to_wait = (GPU_measurement_last_event) ? 1 : 0;
+    if (GPU_snapshot_event) OpenCL_Check_Error(clReleaseEvent(GPU_snapshot_event),"clReleaseEvent failed");
+    OpenCL_Check_Error(clEnqueueCopyBuffer(GPU_queue,GPU_buffers[buffer_id].buffer,GPU_buffers[snapshot_id].buffer,0,0,GPU_buffers[buffer_id].size_in_bytes, events_to_wait, (events_to_wait) ? &GPU_measurement_last_event : NULL, &GPU_snapshot_event),"clEnqueueCopyBuffer failed");
+    OpenCL_Check_Error(clFlush(GPU_queue),"clFlush failed");
+    return snapshot_id;
+}
+
+int             GPU::buffer_copy(int destination_id,int buffer_id)
+{
+    // device copy of buffer in main queue, in order with kernels (measurement queue and snapshot are not involved)
+    OpenCL_Check_Error(clEnqueueCopyBuffer(GPU_queue,GPU_buffers[buffer_id].buffer,GPU_buffers[destination_id].buffer,0,0,GPU_buffers[buffer_id].size_in_bytes,0,NULL,NULL),"clEnqueueCopyBuffer failed");
+    return destination_id;
+}
+
 unsigned int*   GPU::buffer_map(int buffer_id)
 {
     cl_uint *ptr;
@@ -1426,6 +1585,7 @@ unsigned int*   GPU::buffer_map(int buffer_id)
         GPU_buffers[buffer_id].buffer_read_start           = buffer_read_start;
         GPU_buffers[buffer_id].buffer_read_finish          = buffer_read_finish;
         GPU_buffers[buffer_id].buffer_read_number_of++;
+        if (GPU_debug.trace) trace_transfer(buffer_id,"map",buffer_read_start,buffer_read_finish);
     }
     GPU_buffers[buffer_id].mapped_ptr = ptr;
     return ptr;
@@ -1449,6 +1609,7 @@ unsigned int*   GPU::buffer_map(int buffer_id, size_t offset, size_t size)
         GPU_buffers[buffer_id].buffer_read_start = buffer_read_start;
         GPU_buffers[buffer_id].buffer_read_finish = buffer_read_finish;
         GPU_buffers[buffer_id].buffer_read_number_of++;
+        if (GPU_debug.trace) trace_transfer(buffer_id,"map",buffer_read_start,buffer_read_finish);
     }
     GPU_buffers[buffer_id].mapped_ptr = ptr;
     return ptr;
@@ -1469,6 +1630,7 @@ void*   GPU::buffer_map_void(int buffer_id)
         GPU_buffers[buffer_id].buffer_read_start           = buffer_read_start;
         GPU_buffers[buffer_id].buffer_read_finish          = buffer_read_finish;
         GPU_buffers[buffer_id].buffer_read_number_of++;
+        if (GPU_debug.trace) trace_transfer(buffer_id,"map",buffer_read_start,buffer_read_finish);
     }
     GPU_buffers[buffer_id].mapped_ptr_void = ptr;
     return ptr;
@@ -1489,6 +1651,7 @@ void*   GPU::buffer_map_part(int buffer_id, size_t start, size_t size)
         GPU_buffers[buffer_id].buffer_read_start           = buffer_read_start;
         GPU_buffers[buffer_id].buffer_read_finish          = buffer_read_finish;
         GPU_buffers[buffer_id].buffer_read_number_of++;
+        if (GPU_debug.trace) trace_transfer(buffer_id,"map",buffer_read_start,buffer_read_finish);
     }
     GPU_buffers[buffer_id].mapped_ptr = (cl_uint*) ptr;
     return ptr;
@@ -1512,10 +1675,78 @@ void    GPU::buffer_unmap(int buffer_id, void *ptr)
         GPU_buffers[buffer_id].buffer_read_start           = buffer_read_start;
         GPU_buffers[buffer_id].buffer_read_finish          = buffer_read_finish;
         GPU_buffers[buffer_id].buffer_read_number_of++;
+        if (GPU_debug.trace) trace_transfer(buffer_id,"unmap",buffer_read_start,buffer_read_finish);
     }
 }
 #endif
 
+int             GPU::buffer_read_async(int buffer_id)
+{
+    // start readback without waiting: pinned buffers are mapped directly, others are copied into pinned staging area
+    // host pointer is returned by buffer_read_wait and stays valid up to buffer_read_release or the next buffer_read_async
+    if (GPU_buffers[buffer_id].staging_ptr) buffer_read_release(buffer_id);
+
+    if (GPU_buffers[buffer_id].buffer_type == buffer_type_Pinned) {
+        GPU_buffers[buffer_id].staging_ptr = clEnqueueMapBuffer(GPU_queue,GPU_buffers[buffer_id].buffer,CL_FALSE,CL_MAP_READ,0,GPU_buffers[buffer_id].size_in_bytes,0,NULL,&GPU_buffers[buffer_id].staging_map_event,&GPU_error);
+        OpenCL_Check_Error(GPU_error,"clEnqueueMapBuffer failed");
+    } else {
+        if (!GPU_buffers[buffer_id].staging) {
+            GPU_buffers[buffer_id].staging = clCreateBuffer(GPU_context,CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR,GPU_buffers[buffer_id].size_in_bytes,NULL,&GPU_error);
+            OpenCL_Check_Error(GPU_error,"clCreateBuffer failed");
+        }
+        OpenCL_Check_Error(clEnqueueCopyBuffer(GPU_queue,GPU_buffers[buffer_id].buffer,GPU_buffers[buffer_id].staging,0,0,GPU_buffers[buffer_id].size_in_bytes,0,NULL,&GPU_buffers[buffer_id].staging_read_event),"clEnqueueCopyBuffer failed");
+        GPU_buffers[buffer_id].staging_ptr = clEnqueueMapBuffer(GPU_queue,GPU_buffers[buffer_id].staging,CL_FALSE,CL_MAP_READ,0,GPU_buffers[buffer_id].size_in_bytes,0,NULL,&GPU_buffers[buffer_id].staging_map_event,&GPU_error);
+        OpenCL_Check_Error(GPU_error,"clEnqueueMapBuffer failed");
+    }
+    OpenCL_Check_Error(clFlush(GPU_queue),"clFlush failed");
+
+    return buffer_id;
+}
+
+void*           GPU::buffer_read_wait(int buffer_id)
+{
+    cl_ulong buffer_read_start, buffer_read_finish;
+    if (!GPU_buffers[buffer_id].staging_map_event) return GPU_buffers[buffer_id].staging_ptr;
+
+    OpenCL_Check_Error(clWaitForEvents(1, &GPU_buffers[buffer_id].staging_map_event),"clWaitForEvents failed");
+    cl_event buffer_event = (GPU_buffers[buffer_id].staging_read_event) ? GPU_buffers[buffer_id].staging_read_event : GPU_buffers[buffer_id].staging_map_event;
+    if (GPU_debug.profiling){
+        OpenCL_Check_Error(clGetEventProfilingInfo(buffer_event, CL_PROFILING_COMMAND_END,   sizeof(cl_ulong), &buffer_read_finish, 0),"clGetEventProfilingInfo failed");
+        OpenCL_Check_Error(clGetEventProfilingInfo(buffer_event, CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &buffer_read_start,  0),"clGetEventProfilingInfo failed");
+        GPU_buffers[buffer_id].buffer_read_elapsed_time   += (double) (buffer_read_finish-buffer_read_start);
+        GPU_buffers[buffer_id].buffer_read_start           = buffer_read_start;
+        GPU_buffers[buffer_id].buffer_read_finish          = buffer_read_finish;
+        GPU_buffers[buffer_id].buffer_read_number_of++;
+        if (GPU_debug.trace) trace_transfer(buffer_id,"read",buffer_read_start,buffer_read_finish);
+    }
+    if (GPU_buffers[buffer_id].staging_read_event) OpenCL_Check_Error(clReleaseEvent(GPU_buffers[buffer_id].staging_read_event),"clReleaseEvent failed");
+    OpenCL_Check_Error(clReleaseEvent(GPU_buffers[buffer_id].staging_map_event),"clReleaseEvent failed");
+    GPU_buffers[buffer_id].staging_read_event = NULL;
+    GPU_buffers[buffer_id].staging_map_event  = NULL;
+
+    return GPU_buffers[buffer_id].staging_ptr;
+}
+
+bool            GPU::buffer_read_ready(int buffer_id)
+{
+    // asynchronous readback has completed (buffer_read_wait will not block)
+    cl_int status;
+    if (!GPU_buffers[buffer_id].staging_map_event) return true;
+    OpenCL_Check_Error(clGetEventInfo(GPU_buffers[buffer_id].staging_map_event,CL_EVENT_COMMAND_EXECUTION_STATUS,sizeof(cl_int),&status,NULL),"clGetEventInfo failed");
+    return (status == CL_COMPLETE);
+}
+
+int             GPU::buffer_read_release(int buffer_id)
+{
+    // unmap host memory of readback without waiting, staging area is kept for the next readback
+    if (!GPU_buffers[buffer_id].staging_ptr) return 0;
+    buffer_read_wait(buffer_id);
+    cl_mem mapped = (GPU_buffers[buffer_id].buffer_type == buffer_type_Pinned) ? GPU_buffers[buffer_id].buffer : GPU_buffers[buffer_id].staging;
+    OpenCL_Check_Error(clEnqueueUnmapMemObject(GPU_queue,mapped,GPU_buffers[buffer_id].staging_ptr,0,NULL,NULL),"clEnqueueUnmapMemObject failed");
+    GPU_buffers[buffer_id].staging_ptr = NULL;
+    return 0;
+}
+
 cl_float4*      GPU::buffer_map_float4(int buffer_id)
 {
     cl_float4* ptr;
@@ -1531,6 +1762,7 @@ cl_float4*      GPU::buffer_map_float4(int buffer_id)
         GPU_buffers[buffer_id].buffer_read_start           = buffer_read_start;
         GPU_buffers[buffer_id].buffer_read_finish          = buffer_read_finish;
         GPU_buffers[buffer_id].buffer_read_number_of++;
+        if (GPU_debug.trace) trace_transfer(buffer_id,"map",buffer_read_start,buffer_read_finish);
     }
     GPU_buffers[buffer_id].mapped_ptr = (unsigned int*) ptr;
     return ptr;
@@ -1551,6 +1783,7 @@ cl_float4*      GPU::buffer_read_float4(int buffer_id)
         GPU_buffers[buffer_id].buffer_read_start           = buffer_read_start;
         GPU_buffers[buffer_id].buffer_read_finish          = buffer_read_finish;
         GPU_buffers[buffer_id].buffer_read_number_of++;
+        if (GPU_debug.trace) trace_transfer(buffer_id,"read",buffer_read_start,buffer_read_finish);
     }
     return ptr;
 }
@@ -1558,6 +1791,11 @@ cl_float4*      GPU::buffer_read_float4(int buffer_id)
 int             GPU::buffer_kill(int buffer_id)
 {
     cl_int result = CL_SUCCESS;
+    if (GPU_buffers[buffer_id].staging_ptr) buffer_read_release(buffer_id);
+    if (GPU_buffers[buffer_id].staging) {
+        clReleaseMemObject(GPU_buffers[buffer_id].staging);
+        GPU_buffers[buffer_id].staging = NULL;
+    }
     if (GPU_buffers[buffer_id].buffer) {
         result = clReleaseMemObject(GPU_buffers[buffer_id].buffer);
         if(result) printf("ERROR %i\n", result);
@@ -1577,14 +1815,14 @@ GPU::GPU_time_deviation  GPU::buffer_read_get_time(int buffer_id){
     return execution_time;
 }
 
-unsigned int    GPU::buffer_size_align(unsigned int size)
+lattice_index   GPU::buffer_size_align(lattice_index size)
 {
     // align buffer size to memory_align_factor
-    unsigned int result = buffer_size_align(size,(unsigned int) GPU_info.max_workgroup_size);
+    lattice_index result = buffer_size_align(size,(lattice_index) GPU_info.max_workgroup_size);
     return result;
 }
 
-unsigned int    GPU::buffer_size_align(unsigned int size,unsigned int step)
+lattice_index   GPU::buffer_size_align(lattice_index size,lattice_index step)
 {
     return (1 + (size-1) / step) * step;
 }
@@ -1625,6 +1863,7 @@ void            GPU::print_memory_utilized(void){
 
 int             GPU::print_time_detailed(void){
     GPU_time_deviation elapsed_time, elapsed_time_read, elapsed_time_write;
+    if (GPU_queue) device_synchronize();    // collect deferred profiling data
     printf("--------------------------------------------------------\n");
     for (int i=1; i<=GPU_current_kernel; i++){
         elapsed_time = kernel_get_execution_time(i);
@@ -1662,6 +1901,38 @@ int             GPU::print_time_detailed(void){
     }
     printf("--------------------------------------------------------\n");
 
+    print_roofline();
+
+    return 0;
+}
+
+int             GPU::print_roofline(void){
+    // achieved bandwidth and floating-point rate of kernels in terms of their cost model
+    double machine_balance = ((GPU_info.peak_bandwidth > 0.0) && (GPU_info.peak_gflops > 0.0)) ? GPU_info.peak_gflops / GPU_info.peak_bandwidth : 0.0;
+    printf("roofline (%u compute units, %u MHz",GPU_info.compute_units,GPU_info.max_clock_frequency);
+    if (GPU_info.peak_bandwidth > 0.0) printf(", peak %.1f GB/s",GPU_info.peak_bandwidth);
+    if (GPU_info.peak_gflops > 0.0)    printf(", peak %.1f GFLOP/s",GPU_info.peak_gflops);
+    printf("):\n");
+    for (int i=1; i<=GPU_current_kernel; i++){
+        if (GPU_kernels[i].kernel_number_of_starts==0) continue;
+        GPU_time_deviation elapsed_time = kernel_get_execution_time(i);
+        double items = kernel_get_items(i);
+        double bytes = kernel_get_bytes(i) * items;
+        double flops = GPU_kernels[i].kernel_flops * items;
+        double gbytes_per_second = (elapsed_time.mean > 0.0) ? bytes / elapsed_time.mean : 0.0;    // bytes/ns = GB/s
+        double gflops_per_second = (elapsed_time.mean > 0.0) ? flops / elapsed_time.mean : 0.0;    // flop/ns = GFLOP/s
+
+        printf("[%2u] %-32s %9.2f GB/s",i,GPU_kernels[i].kernel_name,gbytes_per_second);
+        if (GPU_info.peak_bandwidth > 0.0) printf(" (%5.1f%%)",100.0 * gbytes_per_second / GPU_info.peak_bandwidth);
+        if (flops > 0.0) {
+            printf(" %9.2f GFLOP/s",gflops_per_second);
+            if (GPU_info.peak_gflops > 0.0) printf(" (%5.1f%%)",100.0 * gflops_per_second / GPU_info.peak_gflops);
+            printf(" %6.2f flop/byte",(bytes > 0.0) ? flops / bytes : 0.0);
+            if (machine_balance > 0.0) printf(" %s",((bytes > 0.0) && (flops / bytes < machine_balance)) ? "memory-bound" : "compute-bound");
+        }
+        printf("\n");
+    }
+    printf("--------------------------------------------------------\n");
 
     return 0;
 }
@@ -2149,7 +2420,7 @@ GPU::GPU_init_parameters*    GPU::get_init_file(char finitf[])
       fclose( stream );
     }
 
-    if (struc_length == 0) free(result);
+    if (struc_length == 0) {free(result); result = NULL;}
     return result;
 }
 
@@ -2219,114 +2490,324 @@ void            GPU::make_finish_file(char* path)
     }
 }
 
-int             GPU::inf_file_delete(int index){
-        int err;
-        char* buffer_inf = (char*) calloc(FNAME_MAX_LENGTH,sizeof(char));
+char*           GPU::program_cache_hash_file(char* path, char* digests, const char* options){
+    // appends "path:md5|" of the file to digests (if not yet there) and descends into its includes
+    if (strstr(digests,path)) return digests;
+    char* file_source = source_read(path);
+    if (!file_source) return digests;
+    char* file_md5 = MD5(file_source);
+    size_t digests_length = strlen(digests) + strlen(path) + strlen(file_md5) + 4;
+    digests = (char*) realloc(digests,digests_length * sizeof(char));
+    sprintf_s(digests + strlen(digests),digests_length - strlen(digests),"%s:%s|",path,file_md5);
+    free(file_md5);
+
+    char base_path[FILENAME_MAX];
+    sprintf_s(base_path,sizeof(base_path),"%s",path);
+    char* base_end = strrchr(base_path,'/');
+    if (base_end) *base_end = '\0'; else base_path[0] = '\0';
+    digests = program_cache_hash_includes(file_source,digests,options,base_path);
+    free(file_source);
+    return digests;
+}
+
+char*           GPU::program_cache_hash_includes(const char* source, char* digests, const char* options, const char* base_path){
+    // included files are searched in directory of including file and in -I directories of options
+    const char* line = source;
+    while (line){
+        const char* c = line;
+        while ((*c==' ')||(*c=='\t')) c++;
+        if (*c=='#'){
+            c++;
+            while ((*c==' ')||(*c=='\t')) c++;
+            if (!strncmp(c,"include",7)){
+                c += 7;
+                while ((*c==' ')||(*c=='\t')) c++;
+                char closing = (*c=='<') ? '>' : '"';
+                if ((*c=='"')||(*c=='<')){
+                    char name[FILENAME_MAX];
+                    int name_length = 0;
+                    c++;
+                    while ((*c)&&(*c!=closing)&&(*c!='\n')&&(name_length<FILENAME_MAX-1)) name[name_length++] = *c++;
+                    name[name_length] = '\0';
+
+                    char path[FILENAME_MAX];
+                    bool found = false;
+                    if ((base_path)&&(base_path[0])){
+                        found = (snprintf(path,sizeof(path),"%s/%s",base_path,name) < (int) sizeof(path)) && is_file_exist(path);
+                    }
+                    const char* option = options;
+                    while ((!found)&&(option)&&((option = strstr(option,"-I"))!=NULL)){
+                        option += 2;
+                        while (*option==' ') option++;
+                        int dir_length = 0;
+                        while ((option[dir_length])&&(option[dir_length]!=' ')) dir_length++;
+                        found = (snprintf(path,sizeof(path),"%.*s/%s",dir_length,option,name) < (int) sizeof(path)) && is_file_exist(path);
+                    }
+                    if (found) digests = program_cache_hash_file(path,digests,options);
+                }
+            }
+        }
+        line = strchr(line,'\n');
+        if (line) line++;
+    }
+    return digests;
+}
+
+char*           GPU::program_cache_get_key(int program_id, const char* source){
+    // key depends on program source (with all included files) and options, device, platform and driver
+    const char* options = (GPU_programs[program_id].options) ? GPU_programs[program_id].options : "";
+    char* digests = (char*) calloc(1,sizeof(char));
+    digests = program_cache_hash_includes(source,digests,options,NULL);
+#ifdef HOST_RUN
+    // host backend prepends clhost_kernel.h to every program
+    char host_header[FILENAME_MAX];
+    sprintf_s(host_header,sizeof(host_header),"%sclinterface/clhost_kernel.h",cl_root_path);
+    digests = program_cache_hash_file(host_header,digests,options);
+#endif
+    size_t key_length = strlen(GPU_programs[program_id].md5) + strlen(digests) + strlen(options) + strlen(GPU_programs[program_id].device) +
+                        strlen(GPU_programs[program_id].platform) + strlen(GPU_info.driver_version) + 16;
+    char* key = (char*) calloc(key_length,sizeof(char));
+
+    sprintf_s(key,key_length,"%s|%s|%s|%s|%s|%s",GPU_programs[program_id].md5,digests,options,GPU_programs[program_id].device,GPU_programs[program_id].platform,GPU_info.driver_version);
 
-        // kill .inf-file
-        int j  = sprintf_s(buffer_inf,FNAME_MAX_LENGTH,"program%u.inf",index);
-        err = remove(buffer_inf);
-        if (err) {delete[] buffer_inf; return err;}
-        j = sprintf_s(buffer_inf,FNAME_MAX_LENGTH,"program%u.bin",index);
-        // kill .bin-file
-        err = remove(buffer_inf);
-        delete[] buffer_inf;
-        return err;
+    char* result = MD5(key);
+    free(digests);
+    free(key);
+    return result;
 }
 
-#ifdef BIGLAT
-int             GPU::inf_file_delete(int k, int index){
-        int err;
-        char* buffer_inf = (char*) calloc(FNAME_MAX_LENGTH,sizeof(char));
-
-        // kill .inf-file
-        int j  = sprintf_s(buffer_inf,FNAME_MAX_LENGTH,"program%u-%i.inf", index, k);
-        err = remove(buffer_inf);
-        if (err) {delete[] buffer_inf; return err;}
-        j = sprintf_s(buffer_inf,FNAME_MAX_LENGTH,"program%u-%i.bin", index, k);
-        // kill .bin-file
-        err = remove(buffer_inf);
-        delete[] buffer_inf;
-        return err;
+void            GPU::program_cache_set_path(const char* path){
+    // path is cut to leave room for separator and file name in cache_path
+    int j = (int) strlen(path);
+    if (j > CACHE_PATH_MAX - 2) j = CACHE_PATH_MAX - 2;
+    memcpy(cache_path,path,j);
+    cache_path[j] = '\0';
+    if ((j > 0) && (cache_path[j-1] != '/') && (cache_path[j-1] != '\\')) sprintf_s(cache_path+j,CACHE_PATH_MAX-j,"%s",PATH_SEPARATOR);
+    if (j > 0) MakeDir(cache_path);     // existing directory is kept untouched
+}
+
+int             GPU::program_cache_save(const char* file_name, const char* data, size_t size){
+    // write into temporary file and rename it, so concurrent runs never see partially written file
+    FILE * cache_file = NULL;
+    char buffer_tmp[FILENAME_MAX];
+    sprintf_s(buffer_tmp,FILENAME_MAX,"%s.%u.tmp",file_name,(unsigned int) GetPid());
+
+    fopen_s(&cache_file,buffer_tmp,"wb");
+    if (!cache_file) return 1;
+    size_t written = fwrite(data,1,size,cache_file);
+    if ( fclose(cache_file) ) printf( "The file was not closed!\n" );
+    if (written != size) {remove(buffer_tmp); return 1;}
+
+    if (rename(buffer_tmp,file_name)) {
+        // file is already in cache (Windows does not replace existing files)
+        if (GPU_debug.rebuild_binary) {remove(file_name); if (!rename(buffer_tmp,file_name)) return 0;}
+        remove(buffer_tmp);
+    }
+    return 0;
 }
+
+bool            GPU::program_cache_is_entry(const char* file_name){
+    // cache entries are named as <md5>.bin
+    if (strlen(file_name) != 36) return false;
+    if (strcmp(file_name + 32,".bin")) return false;
+    for (int i = 0; i < 32; i++)
+        if (!(((file_name[i]>='0')&&(file_name[i]<='9'))||((file_name[i]>='a')&&(file_name[i]<='f')))) return false;
+    return true;
+}
+
+int             GPU::program_cache_evict(void){
+    // remove least recently used binaries above cache_size (last use time is the modification time of .bin-file)
+    int     files_number = 0;
+    char*   files_key    = NULL;    // 33 chars per entry
+    time_t* files_time   = NULL;
+    char    buffer[FILENAME_MAX];
+
+    if (!cache_size) return 0;
+
+#ifdef _WIN32
+    sprintf_s(buffer,FILENAME_MAX,"%s*.bin",cache_path);
+    struct _finddata_t file_info;
+    intptr_t handle = _findfirst(buffer,&file_info);
+    if (handle != -1) {
+        do {
+            if (program_cache_is_entry(file_info.name)) {
+                files_key  = (char*)   realloc(files_key, (files_number + 1) * 33 * sizeof(char));
+                files_time = (time_t*) realloc(files_time,(files_number + 1) * sizeof(time_t));
+                strncpy_s(files_key + files_number * 33, 33, file_info.name, 32);
+                files_key[files_number * 33 + 32] = 0;
+                files_time[files_number++] = file_info.time_write;
+            }
+        } while (_findnext(handle,&file_info) == 0);
+        _findclose(handle);
+    }
+#else
+    DIR* directory = opendir((cache_path[0]) ? cache_path : ".");
+    if (directory) {
+        struct dirent* entry;
+        while ((entry = readdir(directory)) != NULL) {
+            if (program_cache_is_entry(entry->d_name)) {
+                struct stat file_stat;
+                sprintf_s(buffer,FILENAME_MAX,"%s%.36s",cache_path,entry->d_name);
+                if (stat(buffer,&file_stat)) continue;
+                files_key  = (char*)   realloc(files_key, (files_number + 1) * 33 * sizeof(char));
+                files_time = (time_t*) realloc(files_time,(files_number + 1) * sizeof(time_t));
+                memcpy(files_key + files_number * 33, entry->d_name, 32);
+                files_key[files_number * 33 + 32] = 0;
+                files_time[files_number++] = file_stat.st_mtime;
+            }
+        }
+        closedir(directory);
+    }
 #endif
 
-int             GPU::inf_file_rename(int index_old,int index_new){
-        int j;
-        int err;
-        char* buffer_old = (char*) calloc(FNAME_MAX_LENGTH,sizeof(char));
-        char* buffer_new = (char*) calloc(FNAME_MAX_LENGTH,sizeof(char));
+    int result = 0;
+    while (files_number - result > (int) cache_size) {
+        int oldest = -1;
+        for (int i = 0; i < files_number; i++)
+            if ((files_key[i * 33]) && ((oldest < 0) || (files_time[i] < files_time[oldest]))) oldest = i;
+        // another run may have removed the file already - ignore errors
+        sprintf_s(buffer,FILENAME_MAX,"%s%s.bin",cache_path,files_key + oldest * 33);
+        remove(buffer);
+        sprintf_s(buffer,FILENAME_MAX,"%s%s.inf",cache_path,files_key + oldest * 33);
+        remove(buffer);
+        files_key[oldest * 33] = 0;
+        result++;
+    }
+
+    free(files_key);
+    free(files_time);
+    return result;
+}
 
-            j = sprintf_s(buffer_old,FNAME_MAX_LENGTH,"program%u.inf",index_old);
-            j = sprintf_s(buffer_new,FNAME_MAX_LENGTH,"program%u.inf",index_new);
-        // rename .inf-file
-        err = rename(buffer_old,buffer_new);
-        if (err) {delete[] buffer_old; delete[] buffer_new; return err;}
+char*           GPU::autotune_get_key(int kernel_id){
+    // key depends on device, driver, program source and options (lattice size, precision, etc.), kernel and its global size
+    int program_id = GPU_kernels[kernel_id].program_id;
+    const char* options = (GPU_programs[program_id].options) ? GPU_programs[program_id].options : "";
+    size_t key_length = strlen(GPU_info.device_name) + strlen(GPU_info.driver_version) + strlen(GPU_programs[program_id].md5) +
+                        strlen(options) + strlen(GPU_kernels[kernel_id].kernel_name) + 64 * (GPU_kernels[kernel_id].work_dimensions + 1);
+    char* key = (char*) calloc(key_length,sizeof(char));
 
-            j = sprintf_s(buffer_old,FNAME_MAX_LENGTH,"program%u.bin",index_old);
-            j = sprintf_s(buffer_new,FNAME_MAX_LENGTH,"program%u.bin",index_new);
-        // rename .bin-file
-        err = rename(buffer_old,buffer_new);
-        delete[] buffer_old;
-        delete[] buffer_new;
+    int j = sprintf_s(key,key_length,"%s|%s|%s|%s|%s",GPU_info.device_name,GPU_info.driver_version,GPU_programs[program_id].md5,options,GPU_kernels[kernel_id].kernel_name);
+    for (unsigned int i=0; i<GPU_kernels[kernel_id].work_dimensions; i++)
+        j += sprintf_s(key+j,key_length-j,"|%u",(unsigned int) GPU_kernels[kernel_id].global_size[i]);
 
-        return err;
+    char* result = MD5(key);
+    free(key);
+    return result;
 }
 
-#ifdef BIGLAT
-int             GPU::inf_file_rename(int k, int index_old,int index_new){
-        int j;
-        int err;
-        char* buffer_old = (char*) calloc(FNAME_MAX_LENGTH,sizeof(char));
-        char* buffer_new = (char*) calloc(FNAME_MAX_LENGTH,sizeof(char));
-
-            j = sprintf_s(buffer_old,FNAME_MAX_LENGTH,"program%u-%i.inf", index_old, k);
-            j = sprintf_s(buffer_new,FNAME_MAX_LENGTH,"program%u-%i.inf", index_new, k);
-        // rename .inf-file
-        err = rename(buffer_old,buffer_new);
-        if (err) {delete[] buffer_old; delete[] buffer_new; return err;}
-
-            j = sprintf_s(buffer_old,FNAME_MAX_LENGTH,"program%u-%i.bin", index_old, k);
-            j = sprintf_s(buffer_new,FNAME_MAX_LENGTH,"program%u-%i.bin", index_new, k);
-        // rename .bin-file
-        err = rename(buffer_old,buffer_new);
-        delete[] buffer_old;
-        delete[] buffer_new;
-
-        return err;
-}
-
-int             GPU::inf_file_get_max_n(int k){
-        char* buffer_inf = (char*) calloc(FNAME_MAX_LENGTH,sizeof(char));
-        int j = 0;
+size_t          GPU::autotune_get_local_size(const char* key){
+    // the latest record for key in autotune.inf wins
+    size_t result = 0;
+    if ((!key)||(!GPU_autotune_parameters)) return result;
 
-        int result = 1;
-        bool flag = true;
-        while(flag){
-            j = sprintf_s(buffer_inf,FNAME_MAX_LENGTH,"program%u-%i.inf",result, k+1);
-            flag = is_file_exist(buffer_inf);
-            result++;
-        }
-        result -= 2;
-        free(buffer_inf);
-        return result;
+    int parameters_items = 0;
+    bool parameters_flag = false;
+    while(!parameters_flag){
+        if (!strcmp(GPU_autotune_parameters[parameters_items].Variable,key)) result = (size_t) GPU_autotune_parameters[parameters_items].iVarVal;
+        parameters_flag = GPU_autotune_parameters[parameters_items].final;
+        parameters_items++;
+    }
+    return result;
 }
-#endif
 
-int             GPU::inf_file_get_max_n(void){
-        char* buffer_inf = (char*) calloc(FNAME_MAX_LENGTH,sizeof(char));
-        int j = 0;
+int             GPU::autotune_file_save(int kernel_id, size_t local_size, double elapsed_time){
+    FILE * autotune_file = NULL;
+    char buffer_autotune[FILENAME_MAX];
+    sprintf_s(buffer_autotune,FILENAME_MAX,"%s%s",cache_path,AUTOTUNE_FILE);
+    fopen_s(&autotune_file,buffer_autotune,"a");
+    if (!autotune_file) return 1;
 
-        int result = 1;
-        bool flag = true;
-        while(flag){
-            j = sprintf_s(buffer_inf,FNAME_MAX_LENGTH,"program%u.inf",result);
-            flag = is_file_exist(buffer_inf);
-            result++;
+    fprintf(autotune_file,"%s=%u    # %s, global size %u, %f ms, %s\n",GPU_kernels[kernel_id].kernel_autotune_key,(unsigned int) local_size,
+            GPU_kernels[kernel_id].kernel_name,(unsigned int) GPU_kernels[kernel_id].global_size[0],elapsed_time / 1000000.0,GPU_info.device_name);
+    if ( fclose(autotune_file) ) printf( "The file was not closed!\n" );
+
+    if (GPU_debug.brief_report) printf("%s: tuned work group size = %u (%f ms)\n",GPU_kernels[kernel_id].kernel_name,(unsigned int) local_size,elapsed_time / 1000000.0);
+    return 0;
+}
+
+// ___ trace ______________________________________________________________________________________
+void            GPU::trace_set_path(const char* path){
+    sprintf_s(trace_path,FILENAME_MAX,"%s",path);
+}
+
+void            GPU::trace_set_iteration(unsigned int iteration){
+    GPU_trace_iteration = iteration;
+}
+
+int             GPU::trace_open(int pid){
+    // timeline is written in Chrome trace event format (chrome://tracing, Perfetto): one "X" event per kernel or transfer
+    // every device is a separate process, command queues are its threads; device times are counted from the first event of device
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    GPU_trace_pid    = pid;
+    GPU_trace_origin = 0;
+    if (!trace_file) {
+        fopen_s(&trace_file,trace_path,"w");
+        if (!trace_file) {
+            printf("Cannot open trace file %s\n",trace_path);
+            GPU_debug.trace = false;
+            return 1;
         }
-        result -= 2;
-        free(buffer_inf);
-        return result;
+        fprintf(trace_file,"[\n");
+    }
+    trace_users++;
+
+    fprintf(trace_file,"{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%i,\"args\":{\"name\":\"[%i] %s\"}},\n",GPU_trace_pid,GPU_trace_pid,GPU_info.device_name);
+    fprintf(trace_file,"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%i,\"tid\":%i,\"args\":{\"name\":\"main queue\"}},\n",GPU_trace_pid,(int) queue_type_main);
+    if (GPU_measurement_queue)
+        fprintf(trace_file,"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%i,\"tid\":%i,\"args\":{\"name\":\"measurement queue\"}},\n",GPU_trace_pid,(int) queue_type_measurement);
+    return 0;
+}
+
+int             GPU::trace_close(void){
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    if (!trace_file) return 0;
+    trace_users--;
+    if (trace_users > 0) return 0;
+
+    // the last record has no trailing comma
+    fprintf(trace_file,"{\"name\":\"trace_end\",\"ph\":\"M\",\"pid\":%i,\"args\":{}}\n]\n",GPU_trace_pid);
+    if ( fclose(trace_file) ) printf( "The file was not closed!\n" );
+    trace_file = NULL;
+    if (GPU_debug.brief_report) printf("timeline saved into %s\n",trace_path);
+    return 0;
+}
+
+void            GPU::trace_kernel(int kernel_id, cl_event kernel_event, unsigned int iteration){
+    cl_ulong kernel_start, kernel_finish;
+    cl_command_queue queue;
+    OpenCL_Check_Error(clGetEventProfilingInfo(kernel_event, CL_PROFILING_COMMAND_END,   sizeof(cl_ulong), &kernel_finish, 0),"clGetEventProfilingInfo failed");
+    OpenCL_Check_Error(clGetEventProfilingInfo(kernel_event, CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &kernel_start,  0),"clGetEventProfilingInfo failed");
+    OpenCL_Check_Error(clGetEventInfo(kernel_event, CL_EVENT_COMMAND_QUEUE, sizeof(cl_command_queue), &queue, 0),"clGetEventInfo failed");
+    int queue_type = ((GPU_measurement_queue) && (queue == GPU_measurement_queue)) ? queue_type_measurement : queue_type_main;
+
+    char args[256];
+    int j = 0;
+    j += sprintf_s(args+j,sizeof(args)-j,"\"global\":\"");
+    for (unsigned int i=0; i<GPU_kernels[kernel_id].work_dimensions; i++)
+        j += sprintf_s(args+j,sizeof(args)-j,(i) ? "x%u" : "%u",(unsigned int) GPU_kernels[kernel_id].global_size[i]);
+    j += sprintf_s(args+j,sizeof(args)-j,"\",\"local\":\"");
+    for (unsigned int i=0; i<GPU_kernels[kernel_id].work_dimensions; i++)
+        j += sprintf_s(args+j,sizeof(args)-j,(i) ? "x%u" : "%u",(GPU_kernels[kernel_id].local_size) ? (unsigned int) GPU_kernels[kernel_id].local_size[i] : 0);
+    j += sprintf_s(args+j,sizeof(args)-j,"\",\"iteration\":%u",iteration);
+
+    trace_write(GPU_kernels[kernel_id].kernel_name,"kernel",queue_type,kernel_start,kernel_finish,args);
+}
+
+void            GPU::trace_transfer(int buffer_id, const char* transfer_name, cl_ulong start, cl_ulong finish){
+    char name[64];
+    char args[128];
+    sprintf_s(name,sizeof(name),"%s [%i]",transfer_name,buffer_id);
+    sprintf_s(args,sizeof(args),"\"bytes\":%.0f,\"iteration\":%u",(double) GPU_buffers[buffer_id].size_in_bytes,GPU_trace_iteration);
+    trace_write(name,"transfer",queue_type_main,start,finish,args);
+}
+
+void            GPU::trace_write(const char* name, const char* category, int queue_type, cl_ulong start, cl_ulong finish, const char* args){
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    if (!trace_file) return;
+    if (!GPU_trace_origin) GPU_trace_origin = start;
+    fprintf(trace_file,"{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%i,\"tid\":%i,\"ts\":%.3f,\"dur\":%.3f,\"args\":{%s}},\n",
+            name,category,GPU_trace_pid,queue_type,(double) ((cl_long) (start - GPU_trace_origin)) * 1.0E-3,(double) (finish - start) * 1.0E-3,args);
 }
 
 bool            GPU::is_file_exist(char* path){
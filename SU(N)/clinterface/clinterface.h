@@ -37,9 +37,15 @@
 #ifndef clinterface_h
 #define clinterface_h
 
+#ifdef HOST_RUN
+#include "clhost.h"
+#else
 #include <CL/cl.h>
 #include <CL/cl_ext.h>
+#endif
 #include "platform.h"
+#include <thread>
+#include <mutex>
 
 #ifdef BIGLAT
 #define BUFF_STEP 64
@@ -49,6 +55,14 @@
 #endif
 
 #define LENGTH 384
+#define EVENTS_PENDING_MAX  256     // max number of kernel events kept for deferred profiling (asynchronous dispatch)
+#define EVENTS_FLUSH_STEP   16      // number of asynchronously enqueued kernels between clFlush calls
+#define PROGRAM_CACHE_SIZE  64      // default max number of program binaries kept in cache (0 - unlimited)
+#define AUTOTUNE_FILE       "autotune.inf"  // cache of tuned work group sizes (in directory of program binaries cache)
+#define CACHE_PATH_MAX      (FILENAME_MAX - 64)     // directory of program binaries cache leaves room for <md5>.bin
+#define AUTOTUNE_REPEATS    5       // number of kernel starts per candidate work group size
+#define AUTOTUNE_LOCAL_SIZE_MIN 32  // minimal candidate work group size (measurement buffers are sized for 32 work items per group)
+#define TRACE_FILE          "trace.json"    // default timeline of kernels and transfers (Chrome trace event format)
 
 namespace GPU_CL{
 class GPU {
@@ -78,9 +92,15 @@ class GPU {
                 buffer_type_Output,         // Output buffer type
                 buffer_type_Constant,       // Constant buffer type
                 buffer_type_LDS,            // Local buffer type
-                buffer_type_UAV             // UAV buffer type
+                buffer_type_UAV,            // UAV buffer type
+                buffer_type_Pinned          // Like IO buffer, but in pinned host memory (zero-copy on CPU/APU devices)
             } GPU_buffer_types;
 
+            typedef enum enum_GPU_queue_types{
+                queue_type_main,            // queue for updates, PRNG and transfers
+                queue_type_measurement      // queue for measurements on configuration snapshot
+            } GPU_queue_types;
+
 
             typedef enum enum_GPU_storage_type{
                 GPU_storage_none,           // default unknown storage type
@@ -105,7 +125,11 @@ class GPU {
                 bool brief_report           : 1; /**< Turn on/off brief report about quantitative characteristics of run (worgroup size, sizes of buffers, number pseudorandom numbers to produce, etc.)*/
                 bool show_stage             : 1; /**< Enable/disable the output of run stages*/
                 bool local_run              : 1; /**< Enable/disable local run option*/
-                bool rebuild_binary         : 1; /**< Enable/disable rebuilding of binary files for each run*/
+                bool rebuild_binary         : 1; /**< Enable/disable rebuilding of cached program binaries for each run*/
+                bool async_dispatch         : 1; /**< Enable/disable asynchronous kernel dispatch (host waits only at device_synchronize and blocking transfers)*/
+                bool autotune               : 1; /**< Enable/disable benchmarking of work group sizes for kernels missing in autotune.inf*/
+                bool overlap_measurements   : 1; /**< Enable/disable running of measurements on configuration snapshot in separate queue (overlapped with updates)*/
+                bool trace                  : 1; /**< Enable/disable export of every kernel launch and buffer transfer into timeline file (requires profiling)*/
             } GPU_debug_flags;
             /**
             * Defines initial conditions for simulation, as physical as hardware
@@ -126,12 +150,17 @@ class GPU {
             */
             typedef struct _GPU_device_info{
                 char*       device_name;                    /**< The name of desired compute device*/   // CL_DEVICE_NAME                          
+                char*       driver_version;                 /**< The version of OpenCL driver of desired compute device*/   // CL_DRIVER_VERSION
                 cl_ulong    local_memory_size;              /**< The local memory size of desired compute device (in bytes)*/   // CL_DEVICE_LOCAL_MEM_SIZE                
                 cl_ulong    max_constant_size;              /**< The maximal size of the constant memory buffer of the desired device*/   // CL_DEVICE_MAX_CONSTANT_BUFFER_SIZE
                 cl_ulong    max_memory_size;                /**< The maximal size of memory can be allocated on the desired device*/   // CL_DEVICE_MAX_MEM_ALLOC_SIZE
                 size_t      max_memory_width;               /**< The number of PRNG instances*/   // CL_DEVICE_IMAGE2D_MAX_WIDTH
                 size_t      max_workgroup_size;             /**< The greatest of the maximal numbers of OpenCL work items in work group for each compute dimension */   // max(CL_DEVICE_MAX_WORK_ITEM_SIZES)
                 size_t      memory_align_factor;            /**< The factor for buffers aligment*/   // memory align factor for buffers
+                cl_uint     compute_units;                  /**< The number of compute units of desired device*/   // CL_DEVICE_MAX_COMPUTE_UNITS
+                cl_uint     max_clock_frequency;            /**< The maximal clock frequency of desired device (in MHz)*/   // CL_DEVICE_MAX_CLOCK_FREQUENCY
+                double      peak_bandwidth;                 /**< The peak memory bandwidth of desired device (in GB/s, 0 - unknown)*/   // PEAKBANDWIDTH in init file
+                double      peak_gflops;                    /**< The peak floating-point performance of desired device (in GFLOP/s, 0 - unknown)*/   // PEAKGFLOPS in init file
              GPU_vendors    platform_vendor;                /**< The vendor of the platform containing the desired device*/   // active platform vendor
 #ifdef BIGLAT
                     char*   device_ocl;
@@ -142,6 +171,12 @@ class GPU {
 // ___________________________________________________________ static variables
             static GPU_debug_flags GPU_debug;              // structure for debuging 
             static char current_path[FILENAME_MAX];        // FILENAME_MAX is definned by <stdio.h>
+            static char cache_path[CACHE_PATH_MAX];          // directory of program binaries cache
+            static unsigned int cache_size;                // max number of program binaries in cache
+            static char trace_path[FILENAME_MAX];          // timeline file (trace option)
+            static FILE* trace_file;                       // timeline file, shared by all devices
+            static int  trace_users;                       // number of devices writing into trace_file
+            static std::mutex trace_mutex;                 // serializes writing into trace_file
                   char* cl_root_path;                      // FILENAME_MAX is definned by <stdio.h>
 
 // end of static variables ___________________________________
@@ -155,7 +190,7 @@ class GPU {
             int GPU_current_program;                        // current program counter
             int GPU_active_program;                         // current program counter
 
-            int GPU_inf_max_n;                              // max number in .inf-filenames
+            GPU_init_parameters* GPU_autotune_parameters;   // tuned work group sizes loaded from autotune.inf
 
             unsigned int GPU_platform_id;                  // GPU platform to be used (0 = first, 1 = second, etc)
             unsigned int GPU_device_id;                    // GPU device to be used   (0 = first, 1 = second, etc)
@@ -171,6 +206,21 @@ class GPU {
             cl_device_id     GPU_device;                   // utilized platform
             cl_context       GPU_context;                  // utilized context
             cl_command_queue GPU_queue;                    // utilized command queue
+            cl_command_queue GPU_measurement_queue;        // command queue for measurements (overlap_measurements)
+            int              GPU_active_queue;             // queue for kernel_run (queue_type_main or queue_type_measurement)
+
+            cl_event  GPU_last_event;                      // event of the last asynchronously enqueued kernel
+            cl_event* GPU_pending_events;                  // kernel events waiting for profiling collection
+            int*      GPU_pending_kernels;                 // kernel ids of GPU_pending_events
+            int       GPU_pending_number;                  // number of pending kernel events
+            int       GPU_unflushed_number;                // number of kernels enqueued since the last clFlush
+            cl_event  GPU_measurement_last_event;          // event of the last kernel enqueued into GPU_measurement_queue
+            cl_event  GPU_snapshot_event;                  // event of the last snapshot copy (first measurement kernel waits for it)
+            unsigned int* GPU_pending_iterations;          // iterations of GPU_pending_events (trace option)
+
+            int          GPU_trace_pid;                    // process id of device in timeline (sublattice for BIGLAT)
+            cl_ulong     GPU_trace_origin;                 // device time of the first traced event
+            unsigned int GPU_trace_iteration;              // current sweep number, is attached to traced events
 
             cl_int GPU_error;
 
@@ -199,11 +249,13 @@ class GPU {
 #endif
             int     device_initialize(void);
             int     device_finalize(int error_code);
+            int     device_synchronize(void);
             bool    device_auto_select(int platform_vendor,int vendor);
             bool    device_select(unsigned int platform_id,unsigned int device_id);
             char*   device_get_name(cl_device_id device);
             char*   platform_get_name(cl_platform_id platform);
             char*   device_get_OCL(cl_device_id device);
+            char*   device_get_driver(cl_device_id device);
 
             char*   source_read(const char* file_name);
             char*   source_add(char* source, const char* file_name);
@@ -213,10 +265,17 @@ class GPU {
 #ifdef BIGLAT
             int     program_create_ndev(const char* source,const char* options, int ndev);
 #endif
+            int     program_wait(int program_id);
             int     program_set_active(int program_id);
+            void    program_cache_set_path(const char* path);
+            void    trace_set_path(const char* path);
+            void    trace_set_iteration(unsigned int iteration);
             int     program_get_active(void);
 
+            int     queue_set_active(int queue_type);
+
             int     kernel_init(const char* kernel_name, unsigned int work_dimensions, const size_t* global_size, const size_t* local_size);
+            int     kernel_init(const char* kernel_name, unsigned int work_dimensions, const size_t* global_size, const size_t* local_size, bool autotune);
             int     kernel_init_buffer(int kernel_id,int buffer_id);
 #ifdef BIGLAT
             int     kernel_init_buffer_Buf(int kernel_id, cl_mem buffer, int buffer_type, size_t buffer_size);
@@ -224,17 +283,34 @@ class GPU {
             int     kernel_init_constant(int kernel_id,int* host_ptr);
             int     kernel_init_constant_reset(int kernel_id,int* host_ptr,int argument_id);
             int     kernel_init_constant(int kernel_id,cl_uint4* host_ptr);
+            int     kernel_init_constant_reset(int kernel_id,cl_uint4* host_ptr,int argument_id);
             int     kernel_init_constant(int kernel_id,float* host_ptr);
+            int     kernel_init_constant_reset(int kernel_id,float* host_ptr,int argument_id);
             int     kernel_init_constant(int kernel_id,double* host_ptr);
+            int     kernel_init_constant_reset(int kernel_id,double* host_ptr,int argument_id);
             int     kernel_run(int kernel_id);
+            void    kernel_get_profiling(int kernel_id,cl_event kernel_event);
+            void    kernel_defer_profiling(int kernel_id,cl_event kernel_event);
+            int     kernel_set_cost(int kernel_id,double bytes_per_item,double flops_per_item);
+            double  kernel_get_bytes(int kernel_id);
+            double  kernel_get_items(int kernel_id);
             int     kernel_get_worksize(int kernel_id);
+            int     kernel_autotune(int kernel_id);
  GPU_time_deviation kernel_get_execution_time(int kernel_id);
 
-            int     buffer_init(int buffer_type, int size, void* host_ptr, int size_of);
+            int     buffer_init(int buffer_type, lattice_index size, void* host_ptr, int size_of);
 #ifdef BIGLAT
-            int     buffer_init(int buffer_type, int size, void* host_ptr, int size_of, int offset);
+            int     buffer_init(int buffer_type, lattice_index size, void* host_ptr, int size_of, int offset);
 #endif
             int     buffer_write(int buffer_id);
+            int     buffer_write(int buffer_id, bool blocking);
+            int     buffer_snapshot_init(int buffer_id);
+            int     buffer_snapshot(int snapshot_id,int buffer_id);
+            int     buffer_copy(int destination_id,int buffer_id);
+            int     buffer_read_async(int buffer_id);
+           void*    buffer_read_wait(int buffer_id);
+           bool     buffer_read_ready(int buffer_id);
+            int     buffer_read_release(int buffer_id);
    unsigned int*    buffer_map(int buffer_id);
 #ifdef BIGLAT
    unsigned int*    buffer_map(int buffer_id, size_t offset, size_t size);
@@ -247,8 +323,8 @@ class GPU {
             int     buffer_kill(int buffer_id);
  GPU_time_deviation buffer_write_get_time(int buffer_id);
  GPU_time_deviation buffer_read_get_time(int buffer_id);
-   unsigned int     buffer_size_align(unsigned int size);
-   unsigned int     buffer_size_align(unsigned int size,unsigned int step);
+  lattice_index     buffer_size_align(lattice_index size);
+  lattice_index     buffer_size_align(lattice_index size,lattice_index step);
  GPU_init_parameters* get_init_file(char finitf[]);
             void    make_start_file(char* path);
             void    make_finish_file(char* path);
@@ -277,6 +353,7 @@ class GPU {
             int     print_mapped_buffer_double4(int buffer_id,unsigned int number_of_elements);
             int     print_mapped_buffer_double4(int buffer_id,unsigned int number_of_elements, unsigned int offset);
             int     print_time_detailed(void);
+            int     print_roofline(void);
 
             int     start_timer_CPU(void);
             int     start_timer_CPU(int timer);
@@ -308,6 +385,15 @@ class GPU {
                 int          kernel_number_of_starts;       // total number of kernel starts - for deviation calculation
                 size_t       kernel_preferred_workgroup_size_multiple; // kernel preferred work group size multiple
                 cl_ulong     kernel_local_mem_size;         // kernel local memory size
+                // cost model (roofline report) ____________
+                double       kernel_bytes;                  // global memory bytes moved per work item (0 - derived from argument buffers)
+                double       kernel_flops;                  // floating-point operations per work item
+                // autotuning data _________________________
+                bool         kernel_autotune;               // kernel has to be benchmarked at the next start
+                bool         kernel_single_group;           // global size equals local size (single work group reduction)
+                char*        kernel_autotune_key;           // key of kernel launch geometry in autotune.inf
+                int*         argument_buffers;              // buffer ids passed as kernel arguments
+                int          argument_buffers_number;       // number of buffers passed as kernel arguments
 
                 kernels_hash(void);
                ~kernels_hash(void);
@@ -319,12 +405,16 @@ class GPU {
                 cl_mem       buffer;
                 int          buffer_type;
                 void*        host_ptr;
-                int          size;
+                lattice_index size;                             // buffer size in elements
                 size_t       size_in_bytes;                     // buffer size in bytes ( size*sizeof(...) )
 #ifdef BIGLAT
                 void*        mapped_ptr_void;                        // ptr to corresponding host memory after mapping
 #endif
                 unsigned int*  mapped_ptr;                        // ptr to corresponding host memory after mapping
+                cl_mem       staging;                           // pinned staging area for asynchronous readback (reused)
+                void*        staging_ptr;                       // ptr to host memory of asynchronous readback
+                cl_event     staging_read_event;                // event of asynchronous readback transfer
+                cl_event     staging_map_event;                 // event of asynchronous readback mapping
                 // profiling data __________________________
                 cl_ulong     buffer_write_start;                // buffer start write time
                 cl_ulong     buffer_write_finish;               // buffer finish write time
@@ -351,6 +441,12 @@ class GPU {
                       char*  build_log;              // program build log
                 const char*  device;                 // device
                 const char*  platform;               // platform
+                const char*  cache_key;              // key of program binary in cache (md5 for source, options, device, platform and driver)
+                std::thread* build_thread;           // background thread of clBuildProgram
+                cl_int       build_error;            // result of clBuildProgram
+                bool         build_pending;          // build is started, but program_wait is not called yet
+                bool         build_from_binary;      // program is created from cached binary
+                int          build_start;            // build start time (clock)
                 int          source_length;
 
                 programs_hash(void);
@@ -403,14 +499,22 @@ class GPU {
    GPU_time_deviation   time_get_deviation(double elapsed_time, double elapsed_time_squared, int number);
             double      time_gigabytes_per_second(double elapsed_time,double size);
             double      time_megabytes_per_second(double elapsed_time,double size);
-            int         inf_file_delete(int index);
-            int         inf_file_rename(int index_old,int index_new);
-#ifdef BIGLAT
-            int         inf_file_delete(int k, int index);
-            int         inf_file_rename(int k, int index_old,int index_new);
-            int         inf_file_get_max_n(int k);
-#endif
-            int         inf_file_get_max_n(void);
+     static void        program_build(cl_program program, cl_device_id device, const char* options, cl_int* result);
+            char*       program_cache_get_key(int program_id, const char* source);
+            char*       program_cache_hash_includes(const char* source, char* digests, const char* options, const char* base_path);
+            char*       program_cache_hash_file(char* path, char* digests, const char* options);
+            int         program_cache_store(int program_id);
+            int         program_cache_save(const char* file_name, const char* data, size_t size);
+            bool        program_cache_is_entry(const char* file_name);
+            int         program_cache_evict(void);
+            char*       autotune_get_key(int kernel_id);
+            size_t      autotune_get_local_size(const char* key);
+            int         autotune_file_save(int kernel_id, size_t local_size, double elapsed_time);
+            int         trace_open(int pid);
+            int         trace_close(void);
+            void        trace_kernel(int kernel_id, cl_event kernel_event, unsigned int iteration);
+            void        trace_transfer(int buffer_id, const char* transfer_name, cl_ulong start, cl_ulong finish);
+            void        trace_write(const char* name, const char* category, int queue_type, cl_ulong start, cl_ulong finish, const char* args);
 
 };
 };
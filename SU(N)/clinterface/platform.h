@@ -43,14 +43,29 @@
   #include <windows.h>
   #include <conio.h>
   #include <direct.h>
+  #include <io.h>
+  #include <process.h>
+  #include <sys/types.h>
+  #include <sys/stat.h>
+  #include <sys/utime.h>
   #define GetCurrentDir _getcwd
+  #define GetPid _getpid
+  #define MakeDir(path) _mkdir(path)
+  #define FileTouch(path) _utime((path),NULL)
   static const char slash[]="\\"; 
   #define snprintf(b,size,fmt,...) _snprintf_s((b),(size),_TRUNCATE,(fmt),##__VA_ARGS__)
 #else
   #include <string.h>
   #include <cstdlib>
   #include <unistd.h>
+  #include <dirent.h>
+  #include <sys/types.h>
+  #include <sys/stat.h>
+  #include <utime.h>
   #define GetCurrentDir getcwd
+  #define GetPid getpid
+  #define MakeDir(path) mkdir((path),0775)
+  #define FileTouch(path) utime((path),NULL)
   static const char slash[]="/";
   
   #define   sprintf_s(b,size,fmt,...) sprintf((b),(fmt),##__VA_ARGS__)
@@ -75,5 +90,16 @@
 #include <time.h>
 #include <malloc.h>
 
+// lattice sizes and indices (buffer element counts, offsets)
+#ifdef INDEX64
+  typedef unsigned long long lattice_index;     // 64-bit path for lattices beyond 4G elements
+  #define LATTICE_INDEX_FMT "%llu"
+  #define LATTICE_INDEX_CL_FMT "%lluUL"                 // literal in OpenCL build options
+#else
+  typedef unsigned int       lattice_index;     // 32-bit fast path (default)
+  #define LATTICE_INDEX_FMT "%u"
+  #define LATTICE_INDEX_CL_FMT "%u"
+#endif
+
 
 #endif
@@ -112,6 +112,24 @@
 #define hgpu_prng_float4  float4
 #endif
 
+#ifdef PRNG_PHILOX
+#ifdef GID_UPD
+#error "GID_UPD debug mode requires PRNs buffer, it is incompatible with PRNG_PHILOX"
+#endif
+#include "prngcl_philox.cl"
+#define hgpu_prng_buffer        const uint4                     // key and counter of Philox PRNG
+#ifdef PRNG_PRECISION_DOUBLE
+#define prng_load4(prns,index)  philox_double4((prns),(index))
+#else
+#define prng_load4(prns,index)  philox_float4((prns),(index))
+#endif
+#define prng_offset(prns,offset)    ((uint4) ((prns).x, (prns).y, (prns).z, (prns).w + (uint) (offset)))  // offset word of counter
+#else
+#define hgpu_prng_buffer        __global hgpu_prng_float4 *             // GID_UPD start writes site index into buffer
+#define prng_load4(prns,index)  ((prns)[(index)])
+#define prng_offset(prns,offset)    ((prns) + (offset))                 // PRNs of work-items shifted by offset
+#endif
+
 #define hgpu_single  float
 #define hgpu_single4 float4
 /**
@@ -0,0 +1,398 @@
+/******************************************************************************
+ * @file     prngbench.cpp
+ *
+ * @brief    [QCDGPU]
+ *           PRNG benchmark: throughput of generators on OpenCL device and on CPU
+ *           and a battery of fast statistical tests of produced PRNs
+ *
+ *           usage: prngbench [-p platform] [-d device] [-g generator] [-i instances,...]
+ *                            [-l nskip,...] [-n prns] [-t seconds] [-s prns] [-r randseries]
+ *                            [-b cl|cpu] [-o file.csv]
+ *
+ *           one CSV row per backend, generator, precision, number of instances and RANLUX level:
+ *           backend,generator,precision,instances,nskip,prns,seconds,prns_per_s,bytes_per_s,
+ *           frequency_p,serial_p,gap_p,birthday_p,result
+ *           p-values are uniform for a good generator, -1 - not enough PRNs for the test,
+ *           result is "pass" if every p-value lies in [alpha,1-alpha], alpha = PRNGBENCH_ALPHA / (number of p-values in run),
+ *           so PRNGBENCH_ALPHA bounds the chance of any false failure in the whole run (Bonferroni correction)
+ *           (birthday spacings take the year from output resolution: 2^22 days for single, 2^24 for double precision)
+ *           CPU generators produce single precision PRNs, CPU double PRNs are built of two of them (23 + 23 bits)
+ *****************************************************************************/
+#include <chrono>
+#include <algorithm>
+#include "../clinterface/clinterface.h"
+#include "random.h"
+
+using PRNG_CL::PRNG;
+
+#define PRNGBENCH_ALPHA         0.001       // significance level of whole run (both tails of all tests)
+#define PRNGBENCH_MAX_LIST      16          // max number of items in -i and -l lists
+
+typedef struct {
+    const char*           name;
+    PRNG::PRNG_generators generator;
+    int                   nskip;            // RANLUX luxury level (RL_nskip), 0 - not RANLUX
+    bool                  opencl;           // OpenCL kernels are included into random.cl
+    bool                  precision_double; // double precision output on OpenCL device
+    int                   bits_double;      // bits of double precision output on OpenCL device
+} prngbench_generator;
+
+static const prngbench_generator prngbench_generators[] = {
+    {"XOR128",   PRNG::PRNG_generator_XOR128,     0, true,  true, 52},
+    {"RANLUX0",  PRNG::PRNG_generator_RANLUX0,   24, true,  true, 48},
+    {"RANLUX1",  PRNG::PRNG_generator_RANLUX1,   48, true,  true, 48},
+    {"RANLUX2",  PRNG::PRNG_generator_RANLUX2,   97, true,  true, 48},
+    {"RANLUX3",  PRNG::PRNG_generator_RANLUX3,  223, true,  true, 48},
+    {"RANLUX4",  PRNG::PRNG_generator_RANLUX4,  389, true,  true, 48},
+    {"RANMAR",   PRNG::PRNG_generator_RANMAR,     0, false, false,  0},
+    {"PM",       PRNG::PRNG_generator_PM,         0, false, false,  0},
+    {"XOR7",     PRNG::PRNG_generator_XOR7,       0, false, false,  0},
+    {"RANECU",   PRNG::PRNG_generator_RANECU,     0, true,  true, 52},
+    {"PHILOX",   PRNG::PRNG_generator_PHILOX,     0, true,  true, 52},
+    {"RANLUXPP", PRNG::PRNG_generator_RANLUXPP,   0, true,  true, 48},
+    {"MRG32K3A", PRNG::PRNG_generator_MRG32K3A,   0, true,  true, 52}
+};
+#define PRNGBENCH_GENERATORS    (int) (sizeof(prngbench_generators) / sizeof(prngbench_generators[0]))
+
+typedef struct {
+    int                   platform;
+    int                   device;
+    const char*           generator;        // NULL - all generators
+    unsigned int          instances[PRNGBENCH_MAX_LIST];
+    int                   instances_number;
+    int                   nskip[PRNGBENCH_MAX_LIST];
+    int                   nskip_number;
+    unsigned int          prns;             // PRNs per pass
+    double                seconds;          // min time of measurement
+    unsigned int          stat_prns;        // max PRNs for statistical battery
+    int                   randseries;
+    bool                  run_cl;
+    bool                  run_cpu;
+    double                alpha;            // significance level of each tail of each test
+    FILE*                 output;
+} prngbench_parameters;
+
+typedef struct {
+    double frequency;
+    double serial;
+    double gap;
+    double birthday;
+} prngbench_battery;
+
+static double  prngbench_time(void)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//_____________________________________________ statistical battery
+static double  prngbench_gamma_q(double a,double x)
+{
+    // regularized upper incomplete gamma function Q(a,x)
+    if ((x <= 0.0) || (a <= 0.0)) return 1.0;
+    double gln = lgamma(a);
+    if (x < a + 1.0) {
+        double ap = a, sum = 1.0 / a, del = sum;
+        for (int n=0; n<1000; n++) {
+            ap  += 1.0;
+            del *= x / ap;
+            sum += del;
+            if (fabs(del) < fabs(sum) * 1e-15) break;
+        }
+        return 1.0 - sum * exp(-x + a * log(x) - gln);
+    }
+    double b = x + 1.0 - a, c = 1.0 / 1e-300, d = 1.0 / b, h = d;
+    for (int i=1; i<1000; i++) {
+        double an = -i * (i - a);
+        b += 2.0;
+        d = an * d + b; if (fabs(d) < 1e-300) d = 1e-300;
+        c = b + an / c; if (fabs(c) < 1e-300) c = 1e-300;
+        d = 1.0 / d;
+        double del = d * c;
+        h *= del;
+        if (fabs(del - 1.0) < 1e-15) break;
+    }
+    return exp(-x + a * log(x) - gln) * h;
+}
+static double  prngbench_chi2(const double* observed,const double* expected,int bins)
+{
+    double chi2 = 0.0;
+    for (int i=0; i<bins; i++) chi2 += (observed[i] - expected[i]) * (observed[i] - expected[i]) / expected[i];
+    return prngbench_gamma_q(0.5 * (bins - 1),0.5 * chi2);
+}
+static double  prngbench_frequency(const double* u,size_t n)
+{
+    // equidistribution: 64 bins, chi2 with 63 degrees of freedom
+    const int bins = 64;
+    if (n < 5 * bins) return -1.0;
+    double observed[bins] = {0}, expected[bins];
+    for (size_t i=0; i<n; i++) observed[std::min((int) (u[i] * bins),bins - 1)]++;
+    for (int i=0; i<bins; i++) expected[i] = (double) n / bins;
+    return prngbench_chi2(observed,expected,bins);
+}
+static double  prngbench_serial(const double* u,size_t n)
+{
+    // non-overlapping pairs in 16x16 cells, chi2 with 255 degrees of freedom
+    const int d = 16, bins = d * d;
+    if (n < 10 * bins) return -1.0;
+    double observed[bins] = {0}, expected[bins];
+    for (size_t i=0; i+1<n; i+=2) observed[std::min((int) (u[i] * d),d - 1) * d + std::min((int) (u[i + 1] * d),d - 1)]++;
+    for (int i=0; i<bins; i++) expected[i] = (double) (n / 2) / bins;
+    return prngbench_chi2(observed,expected,bins);
+}
+static double  prngbench_gap(const double* u,size_t n)
+{
+    // gaps between PRNs in [0,1/2): length r has probability 2^-(r+1), lengths >= t are joined
+    int t = 0;
+    while ((t < 16) && ((double) n / 4.0 * pow(0.5,t + 1) >= 5.0)) t++;
+    if (t < 4) return -1.0;
+    double observed[17] = {0}, expected[17];
+    int r = 0;
+    double gaps = 0.0;
+    for (size_t i=0; i<n; i++) {
+        if (u[i] < 0.5) {
+            observed[std::min(r,t)]++;
+            gaps++;
+            r = 0;
+        } else r++;
+    }
+    for (int i=0; i<t; i++) expected[i] = gaps * pow(0.5,i + 1);
+    expected[t] = gaps * pow(0.5,t);
+    return prngbench_chi2(observed,expected,t + 1);
+}
+static double  prngbench_birthday(const double* u,size_t n,int bits)
+{
+    // Marsaglia's birthday spacings: m birthdays in a year of 2^(bits-1) days (at most 2^24), duplicate spacings ~ Poisson(m^3/(4*days))
+    // a year finer than output resolution leaves days which are never hit and fails good generators
+    const int year = std::min(bits - 1,24);
+    const int m = (year >= 24) ? 1024 : 512;        // lambda = 16 for 2^24 days, 8 for 2^22 days
+    const double days = ldexp(1.0,year), lambda = (double) m * m * m / (4.0 * days);
+    size_t samples = std::min(n / m,(size_t) 256);
+    if (samples < 4) return -1.0;
+    unsigned int birthday[1024], spacing[1024];
+    double duplicates = 0.0;
+    for (size_t k=0; k<samples; k++) {
+        for (int i=0; i<m; i++) birthday[i] = (unsigned int) (u[k * m + i] * days);
+        std::sort(birthday,birthday + m);
+        spacing[0] = birthday[0];
+        for (int i=1; i<m; i++) spacing[i] = birthday[i] - birthday[i - 1];
+        std::sort(spacing,spacing + m);
+        for (int i=1; i<m; i++) if (spacing[i] == spacing[i - 1]) duplicates++;
+    }
+    return prngbench_gamma_q(duplicates + 1.0,lambda * samples);     // P(X <= duplicates), X ~ Poisson(lambda * samples)
+}
+static void    prngbench_battery_run(const double* u,size_t n,int bits,prngbench_battery* result)
+{
+    // bits - resolution of PRNs (23 for single precision, up to 52 for double)
+    result->frequency = prngbench_frequency(u,n);
+    result->serial    = prngbench_serial(u,n);
+    result->gap       = prngbench_gap(u,n);
+    result->birthday  = prngbench_birthday(u,n,bits);
+}
+static bool    prngbench_battery_passed(const prngbench_battery* result,double alpha)
+{
+    const double p[] = {result->frequency,result->serial,result->gap,result->birthday};
+    for (int i=0; i<4; i++)
+        if ((p[i] >= 0.0) && ((p[i] < alpha) || (p[i] > 1.0 - alpha))) return false;
+    return true;
+}
+
+//_____________________________________________ output
+static void    prngbench_report(prngbench_parameters* parameters,const char* backend,const char* generator,bool precision_double,
+                                unsigned int instances,int nskip,double prns,double seconds,prngbench_battery* battery)
+{
+    double rate = (seconds > 0.0) ? prns / seconds : 0.0;
+    int    size = (precision_double) ? (int) sizeof(double) : (int) sizeof(float);
+    bool   passed = prngbench_battery_passed(battery,parameters->alpha);
+    fprintf(parameters->output,"%s,%s,%s,%u,%d,%.0f,%.6f,%.6e,%.6e,%.6f,%.6f,%.6f,%.6f,%s\n",
+            backend,generator,(precision_double) ? "double" : "single",instances,nskip,prns,seconds,rate,rate * size,
+            battery->frequency,battery->serial,battery->gap,battery->birthday,(passed) ? "pass" : "fail");
+    fflush(parameters->output);
+    printf("%-4s %-9s %-6s %7u instances: %10.3f Mprns/s, %10.3f MB/s, battery %s\n",
+           backend,generator,(precision_double) ? "double" : "single",instances,rate * 1e-6,rate * size * 1e-6,(passed) ? "passed" : "FAILED");
+}
+
+//_____________________________________________ OpenCL device
+static void    prngbench_cl(prngbench_parameters* parameters,const prngbench_generator* generator,int nskip,bool precision_double,unsigned int instances)
+{
+    GPU_CL::GPU* GPU0 = new GPU_CL::GPU;
+    GPU0->GPU_debug.local_run = true;
+    GPU0->device_select(parameters->platform,parameters->device);
+    GPU0->device_initialize();
+
+    PRNG* PRNG0 = new PRNG;
+    PRNG0->GPU0            = GPU0;
+    PRNG0->PRNG_generator  = generator->generator;
+    PRNG0->PRNG_randseries = parameters->randseries;
+    PRNG0->PRNG_precision  = (precision_double) ? PRNG::PRNG_precision_double : PRNG::PRNG_precision_single;
+    PRNG0->PRNG_instances  = instances;
+    PRNG0->PRNG_samples    = (instances) ? std::max(1u,parameters->prns / (4 * instances)) : std::max(1u,parameters->prns / 4); // PRNs (quads) per instance or in whole
+    if (nskip) PRNG0->RL_nskip = nskip;
+    PRNG0->initialize();        // includes first pass (kernels are built and warmed up)
+    GPU0->device_synchronize();
+
+    double passes = 0.0;
+    double start  = prngbench_time(), seconds = 0.0;
+    while ((seconds < parameters->seconds) || (passes < 3.0)) {
+        PRNG0->produce();
+        passes++;
+        if ((passes >= 3.0) || (seconds == 0.0)) {
+            GPU0->device_synchronize();
+            seconds = prngbench_time() - start;
+        }
+    }
+    GPU0->device_synchronize();
+    seconds = prngbench_time() - start;
+    double prns = passes * 4.0 * PRNG0->PRNG_instances * PRNG0->PRNG_samples;
+
+    // battery on the last pass as consumer kernels see it (instances are interleaved)
+    size_t n = std::min((size_t) parameters->stat_prns,(size_t) 4 * PRNG0->PRNG_instances * PRNG0->PRNG_samples);
+    double* u = (double*) calloc(n,sizeof(double));
+    GPU0->buffer_read_async(PRNG0->PRNG_randoms_id);
+    void* randoms = GPU0->buffer_read_wait(PRNG0->PRNG_randoms_id);
+    for (size_t i=0; i<n; i++) u[i] = (precision_double) ? ((double*) randoms)[i] : (double) ((float*) randoms)[i];
+    GPU0->buffer_read_release(PRNG0->PRNG_randoms_id);
+    prngbench_battery battery;
+    prngbench_battery_run(u,n,(precision_double) ? generator->bits_double : 23,&battery);
+    free(u);
+
+    prngbench_report(parameters,"cl",generator->name,precision_double,PRNG0->PRNG_instances,(nskip) ? nskip : generator->nskip,prns,seconds,&battery);
+
+    GPU0->device_finalize(0);
+    delete PRNG0;
+    delete GPU0;
+}
+
+//_____________________________________________ CPU
+static void    prngbench_cpu(prngbench_parameters* parameters,const prngbench_generator* generator,int nskip,bool precision_double,unsigned int instances)
+{
+    // instances = 1: scalar generator (produce_CPU), otherwise vectorized batch (batch_produce_CPU)
+    // double PRN is built of two consecutive single PRNs: 23 bits of the first one and the second one as low bits
+    PRNG* PRNG0 = new PRNG;
+    PRNG0->PRNG_generator  = generator->generator;
+    PRNG0->PRNG_randseries = parameters->randseries;
+    if (nskip) PRNG0->RL_nskip = nskip;
+    PRNG0->initialize_CPU();
+    if ((instances > 1) && (!PRNG0->batch_initialize_CPU(instances))) {
+        delete PRNG0;
+        return;
+    }
+
+    int per_instance = (int) std::max(1u,parameters->prns / instances);
+    size_t size = (size_t) per_instance * instances;
+    int floats_per_prn = (precision_double) ? 2 : 1;
+    float*  randoms        = (float*)  calloc(size * floats_per_prn,sizeof(float));
+    double* randoms_double = (precision_double) ? (double*) calloc(size,sizeof(double)) : NULL;
+
+    double passes = 0.0;
+    double start  = prngbench_time(), seconds = 0.0;
+    while ((seconds < parameters->seconds) || (passes < 3.0)) {
+        if (instances > 1) PRNG0->batch_produce_CPU(randoms,per_instance * floats_per_prn);
+        else               PRNG0->produce_CPU(randoms,per_instance * floats_per_prn);
+        if (precision_double)
+            for (size_t i=0; i<size; i++)
+                randoms_double[i] = (floor((double) randoms[2 * i] * 8388608.0) + (double) randoms[2 * i + 1]) / 8388608.0;
+        passes++;
+        seconds = prngbench_time() - start;
+    }
+    double prns = passes * size;
+
+    size_t n = std::min((size_t) parameters->stat_prns,size);
+    double* u = (double*) calloc(n,sizeof(double));
+    for (size_t i=0; i<n; i++) u[i] = (precision_double) ? randoms_double[i] : (double) randoms[i];
+    prngbench_battery battery;
+    prngbench_battery_run(u,n,(precision_double) ? 46 : 23,&battery);
+    free(u);
+    free(randoms);
+    if (randoms_double) free(randoms_double);
+
+    prngbench_report(parameters,"cpu",generator->name,precision_double,instances,(nskip) ? nskip : generator->nskip,prns,seconds,&battery);
+
+    delete PRNG0;
+}
+
+//_____________________________________________ main
+static void    prngbench_run(prngbench_parameters* parameters,int* rows)
+{
+    // rows != NULL: rows of the run are counted only
+    // RANLUX with arbitrary luxury levels (-l) goes after fixed generators
+    prngbench_generator ranlux = {"RANLUX", PRNG::PRNG_generator_RANLUX, 0, true, true, 48};
+    for (int g=0; g<PRNGBENCH_GENERATORS+parameters->nskip_number; g++) {
+        const prngbench_generator* generator = (g < PRNGBENCH_GENERATORS) ? &prngbench_generators[g] : &ranlux;
+        int nskip = (g < PRNGBENCH_GENERATORS) ? 0 : parameters->nskip[g - PRNGBENCH_GENERATORS];
+        if ((parameters->generator) && (strcmp(parameters->generator,generator->name))) continue;
+
+        for (int i=0; i<parameters->instances_number; i++) {
+            if ((parameters->run_cl) && (generator->opencl)) {
+                if (rows) (*rows) += (generator->precision_double) ? 2 : 1;
+                else {
+                    prngbench_cl(parameters,generator,nskip,false,parameters->instances[i]);
+                    if (generator->precision_double) prngbench_cl(parameters,generator,nskip,true,parameters->instances[i]);
+                }
+            }
+            if (parameters->run_cpu) {
+                unsigned int batch = (parameters->instances[i]) ? parameters->instances[i] : 1024;
+                for (int d=0; d<2; d++) {
+                    if (i == 0)     {if (rows) (*rows)++; else prngbench_cpu(parameters,generator,nskip,(d == 1),1);}
+                    if (batch != 1) {if (rows) (*rows)++; else prngbench_cpu(parameters,generator,nskip,(d == 1),batch);}
+                }
+            }
+        }
+    }
+}
+static int     prngbench_list(char* text,unsigned int* list)
+{
+    int number = 0;
+    for (char* item = strtok(text,","); (item) && (number < PRNGBENCH_MAX_LIST); item = strtok(NULL,","))
+        list[number++] = (unsigned int) strtoul(item,NULL,10);
+    return number;
+}
+int main(int argc, char** argv)
+{
+    prngbench_parameters parameters;
+    parameters.platform         = 0;
+    parameters.device           = 0;
+    parameters.generator        = NULL;
+    parameters.instances[0]     = 0;        // auto-select on device, 1024 on CPU
+    parameters.instances_number = 1;
+    parameters.nskip_number     = 0;
+    parameters.prns             = 1 << 22;
+    parameters.seconds          = 0.5;
+    parameters.stat_prns        = 1 << 22;
+    parameters.randseries       = 1;
+    parameters.run_cl           = true;
+    parameters.run_cpu          = true;
+    parameters.alpha            = PRNGBENCH_ALPHA;
+    const char* output_file     = "prngbench.csv";
+
+    for (int i=1; i<argc; i++) {
+        char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if ((argv[i][0] != '-') || (!value)) {printf("usage: %s [-p platform] [-d device] [-g generator] [-i instances,...] [-l nskip,...] [-n prns] [-t seconds] [-s prns] [-r randseries] [-b cl|cpu] [-o file.csv]\n",argv[0]); return 1;}
+        switch (argv[i][1]) {
+            case 'p': parameters.platform   = atoi(value); break;
+            case 'd': parameters.device     = atoi(value); break;
+            case 'g': parameters.generator  = value; break;
+            case 'i': parameters.instances_number = prngbench_list(value,parameters.instances); break;
+            case 'l': parameters.nskip_number     = prngbench_list(value,(unsigned int*) parameters.nskip); break;
+            case 'n': parameters.prns       = (unsigned int) strtoul(value,NULL,10); break;
+            case 't': parameters.seconds    = atof(value); break;
+            case 's': parameters.stat_prns  = (unsigned int) strtoul(value,NULL,10); break;
+            case 'r': parameters.randseries = atoi(value); break;
+            case 'b': parameters.run_cl     = (!strcmp(value,"cl")); parameters.run_cpu = (!strcmp(value,"cpu")); break;
+            case 'o': output_file           = value; break;
+        }
+        i++;
+    }
+    parameters.output = fopen(output_file,"w");
+    if (!parameters.output) {printf("Can not create file %s\n",output_file); return 1;}
+    fprintf(parameters.output,"backend,generator,precision,instances,nskip,prns,seconds,prns_per_s,bytes_per_s,frequency_p,serial_p,gap_p,birthday_p,result\n");
+
+    // Bonferroni correction: each tail of each of 4 tests in each row takes its share of PRNGBENCH_ALPHA
+    int rows = 0;
+    prngbench_run(&parameters,&rows);
+    parameters.alpha = PRNGBENCH_ALPHA / (2.0 * 4.0 * std::max(rows,1));
+    printf("Significance level of each test tail: %e (%i rows)\n",parameters.alpha,rows);
+    prngbench_run(&parameters,NULL);
+    fclose(parameters.output);
+    printf("Results are written to %s\n",output_file);
+    return 0;
+}
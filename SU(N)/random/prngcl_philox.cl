@@ -0,0 +1,142 @@
+/******************************************************************************
+ * @file     prngcl_philox.cl
+ * @author   Vadim Demchik <vadimdi@yahoo.com>
+ * @version  1.0
+ *
+ * @brief    [PRNGCL library]
+ *           contains OpenCL implementation of Philox4x32-10 counter-based
+ *           pseudo-random number generator
+ *
+ *
+ * @section  CREDITS
+ *
+ *   John K. Salmon, Mark A. Moraes, Ron O. Dror, David E. Shaw,
+ *   "Parallel random numbers: as easy as 1, 2, 3",
+ *   Proceedings of SC'11 (2011), 16:1--16:12.
+ *
+ *
+ * @section  LICENSE
+ *
+ * Copyright (c) 2013-2016 Vadim Demchik
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *    Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ *****************************************************************************/
+
+#ifndef PRNGCL_PHILOX_CL
+#define PRNGCL_PHILOX_CL
+
+// Philox4x32-10 is stateless: quad of PRNs is a bijection of 128-bit counter under 64-bit key.
+// Counter layout is (index.lo, PRNG_counter, index.hi + block * 2^31, offset), key is (state.x, state.y),
+// offset (state.w) has a word of its own, so substreams of kernels never overlap (index < 2^63);
+// any kernel may compute its PRNs in place instead of reading them from a buffer.
+// This file does not depend on prngcl_common.cl and may be included into any program.
+
+#define PHILOX_M0     0xD2511F53
+#define PHILOX_M1     0xCD9E8D57
+#define PHILOX_W0     0x9E3779B9
+#define PHILOX_W1     0xBB67AE85
+#define PHILOX_twom23 (1.0f/8388608.0f)                         // 2^-23
+#define PHILOX_twom53 (1.0/9007199254740992.0)                  // 2^-53
+
+
+//________________________________________________________________________________________________________ Philox PRNG
+inline uint4 philox_round(uint4 ctr, uint2 key)
+{
+    uint hi0 = mul_hi((uint) PHILOX_M0, ctr.x);
+    uint lo0 = PHILOX_M0 * ctr.x;
+    uint hi1 = mul_hi((uint) PHILOX_M1, ctr.z);
+    uint lo1 = PHILOX_M1 * ctr.z;
+    return (uint4) (hi1 ^ ctr.y ^ key.x, lo1, hi0 ^ ctr.w ^ key.y, lo0);
+}
+
+inline uint4 philox4x32_10(uint4 ctr, uint2 key)
+{
+    ctr = philox_round(ctr, key); key.x += PHILOX_W0; key.y += PHILOX_W1;
+    ctr = philox_round(ctr, key); key.x += PHILOX_W0; key.y += PHILOX_W1;
+    ctr = philox_round(ctr, key); key.x += PHILOX_W0; key.y += PHILOX_W1;
+    ctr = philox_round(ctr, key); key.x += PHILOX_W0; key.y += PHILOX_W1;
+    ctr = philox_round(ctr, key); key.x += PHILOX_W0; key.y += PHILOX_W1;
+    ctr = philox_round(ctr, key); key.x += PHILOX_W0; key.y += PHILOX_W1;
+    ctr = philox_round(ctr, key); key.x += PHILOX_W0; key.y += PHILOX_W1;
+    ctr = philox_round(ctr, key); key.x += PHILOX_W0; key.y += PHILOX_W1;
+    ctr = philox_round(ctr, key); key.x += PHILOX_W0; key.y += PHILOX_W1;
+    ctr = philox_round(ctr, key);
+    return ctr;
+}
+
+inline uint4 philox_uint4(uint4 state, ulong index, uint block)
+{
+    return philox4x32_10((uint4) ((uint) index, state.z, (uint) (index >> 32) | (block << 31), state.w), (uint2) (state.x, state.y));
+}
+
+// 23-bit PRNs in (0,1), exactly representable in single precision
+inline float4 philox_float4(uint4 state, ulong index)
+{
+    uint4 rnd = philox_uint4(state, index, 0);
+    float4 result;
+    result.x = ((float) (rnd.x >> 9) + 0.5f) * PHILOX_twom23;
+    result.y = ((float) (rnd.y >> 9) + 0.5f) * PHILOX_twom23;
+    result.z = ((float) (rnd.z >> 9) + 0.5f) * PHILOX_twom23;
+    result.w = ((float) (rnd.w >> 9) + 0.5f) * PHILOX_twom23;
+    return result;
+}
+
+#if defined(cl_khr_fp64)
+// 53-bit PRNs in (0,1), built from two consecutive blocks of the same index
+inline double4 philox_double4(uint4 state, ulong index)
+{
+    uint4 rnd1 = philox_uint4(state, index, 0);
+    uint4 rnd2 = philox_uint4(state, index, 1);
+    double4 result;
+    result.x = ((double) (rnd1.x >> 5) * 67108864.0 + (double) (rnd2.x >> 6) + 0.5) * PHILOX_twom53;
+    result.y = ((double) (rnd1.y >> 5) * 67108864.0 + (double) (rnd2.y >> 6) + 0.5) * PHILOX_twom53;
+    result.z = ((double) (rnd1.z >> 5) * 67108864.0 + (double) (rnd2.z >> 6) + 0.5) * PHILOX_twom53;
+    result.w = ((double) (rnd1.w >> 5) * 67108864.0 + (double) (rnd2.w >> 6) + 0.5) * PHILOX_twom53;
+    return result;
+}
+#endif
+
+#ifdef PRNGCL_COMMON_CL
+__kernel void
+philox(__global hgpu_float4* randoms,
+                     const uint4 state,
+                     const uint N,
+                     const uint instances)
+{
+    // PRNs of instance GID are written for counter indices GID, GID+instances, ... (instances may exceed GID_SIZE)
+    uint giddst = GID;
+    uint index  = GID;
+    for (uint i = 0; i < N; i++) {
+#ifdef PRECISION_DOUBLE  // if double precision is defined
+        randoms[giddst] = philox_double4(state, index);
+#else
+        randoms[giddst] = philox_float4(state, index);
+#endif
+        giddst += GID_SIZE;
+        index  += instances;
+    }
+}
+#endif
+
+#endif
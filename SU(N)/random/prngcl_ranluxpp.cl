@@ -0,0 +1,208 @@
+/******************************************************************************
+ * @file     prngcl_ranluxpp.cl
+ * @author   Vadim Demchik <vadimdi@yahoo.com>
+ * @version  1.0
+ *
+ * @brief    [PRNGCL library]
+ *           contains OpenCL implementation of RANLUX++ pseudo-random number generator
+ *
+ *
+ * @section  CREDITS
+ *
+ *   Alexei Sibidanov,
+ *   "A revision of the subtract-with-borrow random number generators",
+ *   Computer Physics Communications, 221 (2017), 299--303.
+ *
+ *   Jonas Hahnfeldt, Lorenzo Moneta,
+ *   "A Portable Implementation of RANLUX++",
+ *   EPJ Web of Conferences, 251 (2021), 03008.
+ *
+ *
+ * @section  LICENSE
+ *
+ * Copyright (c) 2013-2016 Vadim Demchik
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ *    Redistributions of source code must retain the above copyright notice,
+ *      this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright notice,
+ *      this list of conditions and the following disclaimer in the documentation
+ *      and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * 
+ *****************************************************************************/
+
+#ifndef PRNGCL_RANLUXPP_CL
+#define PRNGCL_RANLUXPP_CL
+
+#include "prngcl_common.cl"
+
+// RANLUX++ is RANLUX written as LCG x' = A * x mod m, m = 2^576 - 2^240 + 1,
+// A = a^2048, where a is the RANLUX multiplier (luxury above RANLUX4, see Sibidanov).
+// State of each instance: 9 words of x and position of next 24-bit number (seedtable[GID + k * GID_SIZE], k = 0..9)
+#define RLPP_numbers  24                    // 24-bit numbers in one state
+#define RLPP_twom23   (1.0f/8388608.0f)     // 2^-23
+#define RLPP_twom48   (1.0/281474976710656.0) // 2^-48
+
+__constant ulong RLPP_A[9] = {
+    0xed7faa90747aaad9UL, 0x4cec2c78af55c101UL, 0xe64dcb31c48228ecUL,
+    0x6d8a15a13bee7cb0UL, 0x20b2ca60cb78c509UL, 0x256c3d3c662ea36cUL,
+    0xff74e54107684ed2UL, 0x492edfcc0cc8e753UL, 0xb48c187cf5b22097UL
+};
+
+__constant ulong RLPP_m[9] = {
+    0x0000000000000001UL, 0x0000000000000000UL, 0x0000000000000000UL,
+    0xffff000000000000UL, 0xffffffffffffffffUL, 0xffffffffffffffffUL,
+    0xffffffffffffffffUL, 0xffffffffffffffffUL, 0xffffffffffffffffUL
+};
+
+
+//________________________________________________________________________________________________________ RANLUX++ PRNG
+// p = p_low + p_high * 2^576 -> p_low + p_high * 2^240 - p_high (2^576 = 2^240 - 1 mod m)
+inline void ranluxpp_fold(ulong* p)
+{
+    ulong h[9];
+    for (int k = 0; k < 9; k++) {h[k] = p[k + 9]; p[k + 9] = 0;}
+
+    ulong carry = 0;
+    for (int k = 0; k < 10; k++) {
+        ulong w  = ((k < 9) ? (h[k] << 48) : 0) | ((k > 0) ? (h[k - 1] >> 16) : 0);
+        ulong s  = p[k + 3] + w;
+        ulong c1 = (s < w);
+        ulong s2 = s + carry;
+        ulong c2 = (s2 < carry);
+        p[k + 3] = s2;
+        carry = c1 + c2;
+    }
+    for (int k = 13; k < 18; k++) {
+        ulong s = p[k] + carry;
+        carry = (s < carry);
+        p[k] = s;
+    }
+
+    ulong borrow = 0;
+    for (int k = 0; k < 18; k++) {
+        ulong hk = (k < 9) ? h[k] : 0;
+        ulong d  = p[k] - hk;
+        ulong b1 = (p[k] < hk);
+        ulong d2 = d - borrow;
+        ulong b2 = (d < borrow);
+        p[k] = d2;
+        borrow = b1 | b2;
+    }
+}
+
+// x = RLPP_A * x mod m
+inline void ranluxpp_advance(ulong* x)
+{
+    ulong p[18];
+    for (int k = 0; k < 18; k++) p[k] = 0;
+
+    for (int i = 0; i < 9; i++) {
+        ulong carry = 0;
+        for (int j = 0; j < 9; j++) {
+            ulong lo = RLPP_A[i] * x[j];
+            ulong hi = mul_hi(RLPP_A[i], x[j]);
+            ulong s  = p[i + j] + lo;
+            ulong c1 = (s < lo);
+            s += carry;
+            ulong c2 = (s < carry);
+            p[i + j] = s;
+            carry = hi + c1 + c2;
+        }
+        p[i + 9] = carry;
+    }
+    ranluxpp_fold(p);
+    ranluxpp_fold(p);
+    ranluxpp_fold(p);
+
+    int ge = 1;
+    for (int k = 8; k >= 0; k--)
+        if (p[k] != RLPP_m[k]) {ge = (p[k] > RLPP_m[k]); break;}
+    ulong borrow = 0;
+    for (int k = 0; k < 9; k++) {
+        ulong mk = (ge) ? RLPP_m[k] : 0;
+        ulong d  = p[k] - mk;
+        ulong b1 = (p[k] < mk);
+        ulong d2 = d - borrow;
+        ulong b2 = (d < borrow);
+        x[k] = d2;
+        borrow = b1 | b2;
+    }
+}
+
+inline uint ranluxpp_next(ulong* x, uint* position)
+{
+    if ((*position) >= RLPP_numbers) {
+        ranluxpp_advance(x);
+        (*position) = 0;
+    }
+    uint bit  = (*position) * 24;
+    uint idx  = bit >> 6;
+    uint offs = bit & 63;
+    ulong bits = x[idx] >> offs;
+    if (offs > 40) bits |= x[idx + 1] << (64 - offs);
+    (*position)++;
+    return (uint) (bits & 0xffffff);
+}
+
+inline float ranluxpp_float(ulong* x, uint* position)
+{
+    return ((float) (ranluxpp_next(x, position) >> 1) + 0.5f) * RLPP_twom23;
+}
+
+#ifdef PRECISION_DOUBLE
+inline double ranluxpp_double(ulong* x, uint* position)
+{
+    double hi = (double) ranluxpp_next(x, position);
+    double lo = (double) ranluxpp_next(x, position);
+    return (hi * 16777216.0 + lo + 0.5) * RLPP_twom48;
+}
+#endif
+
+__kernel void
+ranluxpp(__global ulong* seedtable,
+                     __global hgpu_float4* randoms,
+                     const uint N)
+{
+    uint giddst = GID;
+    ulong x[9];
+    for (int k = 0; k < 9; k++) x[k] = seedtable[GID + k * GID_SIZE];
+    uint position = (uint) seedtable[GID + 9 * GID_SIZE];
+
+    for (uint i = 0; i < N; i++) {
+        hgpu_float4 result;
+#ifdef PRECISION_DOUBLE  // if double precision is defined
+        result.x = ranluxpp_double(x, &position);
+        result.y = ranluxpp_double(x, &position);
+        result.z = ranluxpp_double(x, &position);
+        result.w = ranluxpp_double(x, &position);
+#else
+        result.x = ranluxpp_float(x, &position);
+        result.y = ranluxpp_float(x, &position);
+        result.z = ranluxpp_float(x, &position);
+        result.w = ranluxpp_float(x, &position);
+#endif
+        randoms[giddst] = result;
+        giddst += GID_SIZE;
+    }
+
+    for (int k = 0; k < 9; k++) seedtable[GID + k * GID_SIZE] = x[k];
+    seedtable[GID + 9 * GID_SIZE] = position;
+}
+
+#endif
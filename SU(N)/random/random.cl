@@ -3,12 +3,14 @@
 
 #include "prngcl_common.cl"
 // #include "prngcl_constant.cl"
-// #include "prngcl_mrg32k3a.cl"
+#include "prngcl_mrg32k3a.cl"
 // #include "prngcl_pm.cl"
-// #include "prngcl_ranecu.cl"
+#include "prngcl_ranecu.cl"
 #include "prngcl_ranlux.cl"
+#include "prngcl_philox.cl"
+#include "prngcl_ranluxpp.cl"
 // #include "prngcl_ranmar.cl"
 // #include "prngcl_xor7.cl"
-// #include "prngcl_xor128.cl"
+#include "prngcl_xor128.cl"
 
 #endif
@@ -14,6 +14,11 @@ using PRNG_CL::PRNG;
 //#endif
 
 #define FNAME_MAX_LENGTH     250  // max length of filename with path
+#if (defined SIMD) || (defined _OPENMP)
+#define PRNG_SIMD_LOOP       _Pragma("omp simd")    // vectorized batch loops (make SIMD=1 or USE_OPENMP=1)
+#else
+#define PRNG_SIMD_LOOP
+#endif
 
 
                     PRNG::PRNG(void)	
@@ -38,7 +43,23 @@ using PRNG_CL::PRNG;
     PRNG_precision  = PRNG_precision_single; // precision to be used for PRNGs
 
     PRNG_counter      = 0;   // counter runs of subroutine PRNG_produce 
+    PRNG_stream       = 0;   // stream number (for disjoint streams of several PRNGs)
+    PRNG_in_kernels   = false;
+    PRNG_adaptive     = false; // production sized to PRNs demand
+    PRNG_samples_active = PRNG_samples;
+    batch_instances   = 0;   // CPU batch of independent instances
+    batch_state       = NULL;
 #ifndef CPU_RUN
+    PRNG_consumers           = 0;    // kernels with PRNs argument by value
+    PRNG_samples_argument    = 0;
+    PRNG_demand_id           = 0;    // PRNs demand buffer ID
+    PRNG_demand              = NULL;
+    PRNG_demand_step         = 0;
+    PRNG_demand_worst        = 0;
+    PRNG_demand_budget       = 0;
+    PRNG_demand_passes       = 0;
+    PRNG_demand_pending      = false;
+    for (int i=0; i<PRNG_DEMAND_BINS; i++) PRNG_demand_histogram[i] = 0;
     PRNG_seeds               = NULL;
     PRNG_seed_id             = 0;    // input seeds ID
     PRNG_seed_table_id       = 0;    // seed table ID
@@ -46,6 +67,7 @@ using PRNG_CL::PRNG;
     PRNG_seeds4              = NULL;
     PRNG_seed_table_uint4    = NULL;
     PRNG_seed_table_float4   = NULL;
+    PRNG_seed_table_ulong    = NULL;
     PRNG_randoms             = NULL;
     PRNG_randoms_kernel_id   = 0;    // kernel ID
     PRNG_randoms_seed_id     = 0;    // kernel for seed ID
@@ -84,20 +106,37 @@ using PRNG_CL::PRNG;
     // XORSeven parameters_________________________________
     for (int i=0; i<8; i++) XOR7_state[i] = 0;
     XOR7_index = 0;
-#ifndef CPU_RUN
     // XOR128 parameters___________________________________
     XOR128_state.s[0] = 0;
     XOR128_state.s[1] = 0;
     XOR128_state.s[2] = 0;
     XOR128_state.s[3] = 0;
-#endif
     // RANECU parameters___________________________________
     RANECU_jseed1 = RANECU_seed1;
     RANECU_jseed2 = RANECU_seed2;
+
+    // Philox parameters___________________________________
+    PHILOX_key[0] = 0;
+    PHILOX_key[1] = 0;
+    PHILOX_index  = 0;
+#ifndef CPU_RUN
+    PHILOX_state.s[0] = 0;
+    PHILOX_state.s[1] = 0;
+    PHILOX_state.s[2] = 0;
+    PHILOX_state.s[3] = 0;
+#endif
+
+    // RANLUX++ parameters_________________________________
+    for (int i=0; i<RLPP_words; i++) RLPP_state[i] = 0;
+    RLPP_seed     = 0;
+    RLPP_position = 0;
+
+    // MRG32k3a parameters_________________________________
+    for (int i=0; i<6; i++) MRG32K3A_state[i] = 12345;
 }
                     PRNG::~PRNG(void)	
 {
-
+    batch_finalize_CPU();
 }
     
 double              PRNG::trunc(double x)
@@ -119,6 +158,9 @@ unsigned int PRNG::convert_generator_to_uint(PRNG::PRNG_generators generator){
     if (generator == PRNG::PRNG_generator_PM)      return  9;
     if (generator == PRNG::PRNG_generator_XOR7)    return 10;
     if (generator == PRNG::PRNG_generator_RANECU)  return 11;
+    if (generator == PRNG::PRNG_generator_PHILOX)  return 12;
+    if (generator == PRNG::PRNG_generator_RANLUXPP)return 13;
+    if (generator == PRNG::PRNG_generator_MRG32K3A)return 14;
     return 5; // return RANLUX3 generator otherwise
 }
 PRNG::PRNG_generators PRNG::convert_uint_to_generator(unsigned int generator){
@@ -133,12 +175,18 @@ PRNG::PRNG_generators PRNG::convert_uint_to_generator(unsigned int generator){
     if (generator == 9) return PRNG::PRNG_generator_PM;
     if (generator ==10) return PRNG::PRNG_generator_XOR7;
     if (generator ==11) return PRNG::PRNG_generator_RANECU;
+    if (generator ==12) return PRNG::PRNG_generator_PHILOX;
+    if (generator ==13) return PRNG::PRNG_generator_RANLUXPP;
+    if (generator ==14) return PRNG::PRNG_generator_MRG32K3A;
     return PRNG::PRNG_generator_RANLUX3; // return RANLUX3 generator otherwise
 }
 
 
 void                PRNG::parameters_setup(char* parameter,int ivalue,char* text_value){
             if (!strcmp(parameter,"RANDSERIES"))   PRNG_randseries = ivalue;
+            if (!strcmp(parameter,"PRNGSTREAM"))   PRNG_stream     = ivalue;
+            if (!strcmp(parameter,"PRNGADAPT"))    PRNG_adaptive   = (ivalue != 0);
+            if (!strcmp(parameter,"PRNGPRECISION"))PRNG_precision  = (ivalue == 2) ? PRNG_precision_double : PRNG_precision_single;
             if (!strcmp(parameter,"PRNG"))  {
                 if (!strcmp(text_value,"RANLUX0")) PRNG_generator   = PRNG_generator_RANLUX0;
                 if (!strcmp(text_value,"RANLUX1")) PRNG_generator   = PRNG_generator_RANLUX1;
@@ -151,6 +199,10 @@ void                PRNG::parameters_setup(char* parameter,int ivalue,char* text
                 if (!strcmp(text_value,"RANMAR"))  PRNG_generator   = PRNG_generator_RANMAR;
                 if (!strcmp(text_value,"RANECU"))  PRNG_generator   = PRNG_generator_RANECU;
                 if (!strcmp(text_value,"PM"))      PRNG_generator   = PRNG_generator_PM;
+                if (!strcmp(text_value,"PHILOX"))  PRNG_generator   = PRNG_generator_PHILOX;
+                if (!strcmp(text_value,"RANLUXPP"))PRNG_generator   = PRNG_generator_RANLUXPP;
+                if (!strcmp(text_value,"RANLUX++"))PRNG_generator   = PRNG_generator_RANLUXPP;
+                if (!strcmp(text_value,"MRG32K3A"))PRNG_generator   = PRNG_generator_MRG32K3A;
             }
 }
 int                 PRNG::print_generator(char* header,int header_size){
@@ -167,6 +219,12 @@ int                 PRNG::print_generator(char* header,int header_size){
     if (PRNG_generator == PRNG_CL::PRNG::PRNG_generator_RANECU)      j  += sprintf_s(header+j,header_size-j, " PRN generator               : RANECU\n");
     if (PRNG_generator == PRNG_CL::PRNG::PRNG_generator_RANMAR)      j  += sprintf_s(header+j,header_size-j, " PRN generator               : RANMAR\n");
     if (PRNG_generator == PRNG_CL::PRNG::PRNG_generator_XOR7)        j  += sprintf_s(header+j,header_size-j, " PRN generator               : XOR7\n");
+    if (PRNG_generator == PRNG_CL::PRNG::PRNG_generator_PHILOX)      j  += sprintf_s(header+j,header_size-j, " PRN generator               : PHILOX\n");
+    if (PRNG_generator == PRNG_CL::PRNG::PRNG_generator_RANLUXPP)    j  += sprintf_s(header+j,header_size-j, " PRN generator               : RANLUX++\n");
+    if (PRNG_generator == PRNG_CL::PRNG::PRNG_generator_MRG32K3A)    j  += sprintf_s(header+j,header_size-j, " PRN generator               : MRG32k3a\n");
+    if (PRNG_stream)                                                 j  += sprintf_s(header+j,header_size-j, " PRN stream                  : %u\n",PRNG_stream);
+    if (PRNG_adaptive)                                               j  += sprintf_s(header+j,header_size-j, " PRN production              : adaptive\n");
+    if (PRNG_precision == PRNG_precision_double)                     j  += sprintf_s(header+j,header_size-j, " PRN precision               : double\n");
 
     return j;
 }
@@ -180,11 +238,9 @@ void                PRNG::initialize_CPU(void){
     }
     
     srand(PRNG_srandtime);
-#ifndef CPU_RUN
     if (PRNG_generator==PRNG_generator_XOR128)
         // XOR128
             XOR128_initialize_CPU();
-#endif
     if ((PRNG_generator==PRNG_generator_RANLUX0)||(PRNG_generator==PRNG_generator_RANLUX1)||
             (PRNG_generator==PRNG_generator_RANLUX2)||(PRNG_generator==PRNG_generator_RANLUX3)||
             (PRNG_generator==PRNG_generator_RANLUX4)||(PRNG_generator==PRNG_generator_RANLUX)){
@@ -211,6 +267,18 @@ void                PRNG::initialize_CPU(void){
         if (PRNG_generator==PRNG_generator_RANECU)
             // RANECU
             RANECU_initialize_CPU();
+
+        if (PRNG_generator==PRNG_generator_PHILOX)
+            // Philox
+            PHILOX_initialize_CPU();
+
+        if (PRNG_generator==PRNG_generator_RANLUXPP)
+            // RANLUX++
+            RLPP_initialize_CPU();
+
+        if (PRNG_generator==PRNG_generator_MRG32K3A)
+            // MRG32k3a
+            MRG32K3A_initialize_CPU();
 }
 #ifndef CPU_RUN
 void                PRNG::initialize(void)
@@ -273,21 +341,275 @@ void                PRNG::initialize(void)
             RANECU_initialize_CPU();
             RANECU_initialize();
         }
+
+        if (PRNG_generator==PRNG_generator_PHILOX){
+            // Philox
+            PHILOX_initialize_CPU();
+            PHILOX_initialize();
+        }
+
+        if (PRNG_generator==PRNG_generator_RANLUXPP){
+            // RANLUX++
+            RLPP_initialize_CPU();
+            RLPP_initialize();
+        }
+
+        if (PRNG_generator==PRNG_generator_MRG32K3A){
+            // MRG32k3a
+            MRG32K3A_initialize_CPU();
+            MRG32K3A_initialize();
+        }
+        PRNG_samples_active = PRNG_samples;
         produce();
 }
 void                PRNG::produce(void)
 {
+        if (PRNG_generator==PRNG_generator_PHILOX){
+            // counter-based generator: produce() only moves consumers to the next block of counters
+            PRNG_counter++;
+            PHILOX_index = 0;
+            PHILOX_state.s[2] = PRNG_counter;
+            for (int i=0; i<PRNG_consumers; i++)
+                GPU0->kernel_init_constant_reset(PRNG_consumer_kernel[i],&PHILOX_state,PRNG_consumer_argument[i]);
+            if (PRNG_in_kernels) return;
+            GPU0->kernel_run(PRNG_randoms_kernel_id);
+            randoms_produced += PRNG_samples * 4;
+            return;
+        }
+        if ((PRNG_demand_id)&&(++PRNG_demand_passes >= PRNG_DEMAND_PERIOD)) demand_adapt();
 //        int result = 
         GPU0->kernel_run(PRNG_randoms_kernel_id);
-        randoms_produced += PRNG_samples * 4;
+        randoms_produced += PRNG_samples_active * 4;
         PRNG_counter++;
 }
+void                PRNG::fill(void)
+{
+        // in-kernel PRNs are not produced in advance: write the current block into PRNG_randoms
+        if ((PRNG_generator==PRNG_generator_PHILOX)&&(PRNG_in_kernels))
+            GPU0->kernel_run(PRNG_randoms_kernel_id);
+}
+void                PRNG::demand_initialize(unsigned int step,unsigned int worst)
+{
+        // consumer work-item takes float4 PRNs at GID, GID+step, ... - production may be cut to the largest demand observed
+        if ((!PRNG_adaptive)||(PRNG_generator==PRNG_generator_PHILOX)||(!step)) {
+            PRNG_adaptive = false;
+            return;
+        }
+        PRNG_demand_step   = step;
+        PRNG_demand_worst  = (unsigned int) (((unsigned long long) PRNG_samples * PRNG_instances) / step);
+        if ((worst)&&(worst < PRNG_demand_worst)) PRNG_demand_worst = worst;
+        PRNG_demand_budget = PRNG_demand_worst;
+        PRNG_demand_passes = 0;
+
+        PRNG_demand = (cl_uint*) calloc(3 + PRNG_DEMAND_BINS,sizeof(cl_uint));
+        PRNG_demand[0] = PRNG_demand_budget;
+        PRNG_demand[1] = 0;
+        PRNG_demand[2] = PRNG_demand_worst / PRNG_DEMAND_BINS + 1;     // last bin also takes work-items beyond worst case
+        PRNG_demand_id = GPU0->buffer_init(GPU0->buffer_type_IO, 3 + PRNG_DEMAND_BINS, PRNG_demand, sizeof(cl_uint));
+        demand_resize();    // size production for worst case
+}
+void                PRNG::demand_adapt(void)
+{
+        // readback is started at the end of period and taken at the first pass it has completed, so host never waits for update kernels;
+        // passes between readback and rewrite are not counted (histogram is sampled)
+        // budget = observed maximum + 1/8 margin; on overflow (work-item went on with secondary stream) return to worst case
+        if (!PRNG_demand_pending) {
+            GPU0->buffer_read_async(PRNG_demand_id);
+            PRNG_demand_pending = true;
+            return;
+        }
+        if (!GPU0->buffer_read_ready(PRNG_demand_id)) return;
+        PRNG_demand_pending = false;
+        PRNG_demand_passes = 0;
+        cl_uint* demand = (cl_uint*) GPU0->buffer_read_wait(PRNG_demand_id);
+        unsigned int observed = demand[1];
+        for (int i=0; i<PRNG_DEMAND_BINS; i++) PRNG_demand_histogram[i] += demand[3 + i];
+        GPU0->buffer_read_release(PRNG_demand_id);
+        if (observed) {
+            if (observed > PRNG_demand_budget)
+                PRNG_demand_budget = PRNG_demand_worst;
+            else
+                PRNG_demand_budget = observed + observed / 8 + 2;
+            if (PRNG_demand_budget > PRNG_demand_worst) PRNG_demand_budget = PRNG_demand_worst;
+            PRNG_demand[0] = PRNG_demand_budget;
+            PRNG_demand[1] = 0;
+            for (int i=0; i<PRNG_DEMAND_BINS; i++) PRNG_demand[3 + i] = 0;
+            GPU0->buffer_write(PRNG_demand_id,false);
+        }
+        demand_resize();
+}
+void                PRNG::demand_resize(void)
+{
+        unsigned long long prns = (unsigned long long) PRNG_demand_budget * PRNG_demand_step;
+        int samples = (int) ((prns + PRNG_instances - 1) / PRNG_instances);
+        if (samples > PRNG_samples) samples = PRNG_samples;
+        if (samples < 1) samples = 1;
+        if (samples != PRNG_samples_active) {
+            PRNG_samples_active = samples;
+            GPU0->kernel_init_constant_reset(PRNG_randoms_kernel_id,&PRNG_samples_active,PRNG_samples_argument);
+        }
+}
+void                PRNG::demand_collect(void)
+{
+        // device is idle at the end of run: the counts since the last rewrite are read directly
+        if (!PRNG_demand_id) return;
+        if (!PRNG_demand_pending) GPU0->buffer_read_async(PRNG_demand_id);
+        PRNG_demand_pending = false;
+        cl_uint* demand = (cl_uint*) GPU0->buffer_read_wait(PRNG_demand_id);
+        for (int i=0; i<PRNG_DEMAND_BINS; i++) PRNG_demand_histogram[i] += demand[3 + i];
+        GPU0->buffer_read_release(PRNG_demand_id);
+        for (int i=0; i<PRNG_DEMAND_BINS; i++) PRNG_demand[3 + i] = 0;
+        PRNG_demand[1] = 0;
+        GPU0->buffer_write(PRNG_demand_id);
+}
+int                 PRNG::print_demand(char* header,int header_size)
+{
+        int j = 0;
+        if (!PRNG_demand_id) return j;
+        unsigned long long total = 0;
+        for (int i=0; i<PRNG_DEMAND_BINS; i++) total += PRNG_demand_histogram[i];
+        if (!total) return j;
+        unsigned int width = PRNG_demand[2];
+        j  += sprintf_s(header+j,header_size-j, " PRNs demand (float4 per work-item, budget %u, worst %u):\n",PRNG_demand_budget,PRNG_demand_worst);
+        for (int i=0; i<PRNG_DEMAND_BINS; i++) {
+            if (!PRNG_demand_histogram[i]) continue;
+            if (i < PRNG_DEMAND_BINS - 1)
+                j  += sprintf_s(header+j,header_size-j, "   [%4u..%4u]           : % 16.13e\n",i * width,(i + 1) * width - 1,(double) PRNG_demand_histogram[i] / total);
+            else
+                j  += sprintf_s(header+j,header_size-j, "   [%4u..    ]           : % 16.13e\n",i * width,(double) PRNG_demand_histogram[i] / total);
+        }
+        return j;
+}
+int                 PRNG::kernel_init_demand(int kernel_id)
+{
+        if (!PRNG_demand_id) return 0;
+        return GPU0->kernel_init_buffer(kernel_id,PRNG_demand_id);
+}
+int                 PRNG::kernel_init_prns(int kernel_id)
+{
+        if ((PRNG_generator!=PRNG_generator_PHILOX)||(!PRNG_in_kernels))
+            return GPU0->kernel_init_buffer(kernel_id,PRNG_randoms_id);
+
+        // Philox key and counter are passed by value, kernel computes its PRNs
+        int argument_id = GPU0->kernel_init_constant(kernel_id,&PHILOX_state);
+        if (PRNG_consumers < PRNG_MAX_CONSUMERS) {
+            PRNG_consumer_kernel[PRNG_consumers]   = kernel_id;
+            PRNG_consumer_argument[PRNG_consumers] = argument_id - 1;
+            PRNG_consumers++;
+        } else
+            printf("PRNG: too many consumer kernels (%u)\n",PRNG_consumers);
+        return argument_id;
+}
+void*               PRNG::state_seed_table(unsigned int* size_in_bytes)
+{
+        // Philox has no seed table
+        (*size_in_bytes) = 0;
+        if (!PRNG_seed_table_id) return NULL;
+        if ((PRNG_generator==PRNG_generator_RANLUX0)||(PRNG_generator==PRNG_generator_RANLUX1)||
+            (PRNG_generator==PRNG_generator_RANLUX2)||(PRNG_generator==PRNG_generator_RANLUX3)||
+            (PRNG_generator==PRNG_generator_RANLUX4)||(PRNG_generator==PRNG_generator_RANLUX)||
+            (PRNG_generator==PRNG_generator_RANMAR)){
+                (*size_in_bytes) = seed_table_size * sizeof(cl_float4);
+                return PRNG_seed_table_float4;
+        }
+        if (PRNG_generator==PRNG_generator_RANLUXPP){
+                (*size_in_bytes) = seed_table_size * sizeof(cl_ulong);
+                return PRNG_seed_table_ulong;
+        }
+        (*size_in_bytes) = seed_table_size * sizeof(cl_uint4);
+        return PRNG_seed_table_uint4;
+}
+unsigned int        PRNG::state_CPU(unsigned char* data,bool save)
+{
+        // CPU state of all generators in fixed order (data = NULL: size only)
+        struct {void* ptr; size_t size;} fields[] = {
+            {&PRNG_counter,     sizeof(PRNG_counter)},
+            {&randoms_produced, sizeof(randoms_produced)},
+            {RL_seeds,          sizeof(RL_seeds)},
+            {&RL_i24,           sizeof(RL_i24)},
+            {&RL_j24,           sizeof(RL_j24)},
+            {&RL_in24,          sizeof(RL_in24)},
+            {&RL_carry,         sizeof(RL_carry)},
+            {&XOR128_state,     sizeof(XOR128_state)},
+            {RM_seeds,          sizeof(RM_seeds)},
+            {&RM_I97,           sizeof(RM_I97)},
+            {&RM_J97,           sizeof(RM_J97)},
+            {&RM_C,             sizeof(RM_C)},
+            {&PMseedFP,         sizeof(PMseedFP)},
+            {&PMseed,           sizeof(PMseed)},
+            {XOR7_state,        sizeof(XOR7_state)},
+            {&XOR7_index,       sizeof(XOR7_index)},
+            {&RANECU_jseed1,    sizeof(RANECU_jseed1)},
+            {&RANECU_jseed2,    sizeof(RANECU_jseed2)},
+            {PHILOX_key,        sizeof(PHILOX_key)},
+            {&PHILOX_index,     sizeof(PHILOX_index)},
+            {&PHILOX_state,     sizeof(PHILOX_state)},
+            {RLPP_state,        sizeof(RLPP_state)},
+            {&RLPP_position,    sizeof(RLPP_position)},
+            {MRG32K3A_state,    sizeof(MRG32K3A_state)}
+        };
+        unsigned int result = 0;
+        for (unsigned int i=0; i<sizeof(fields)/sizeof(fields[0]); i++) {
+            if (data) {
+                if (save) memcpy(data+result,fields[i].ptr,fields[i].size);
+                else      memcpy(fields[i].ptr,data+result,fields[i].size);
+            }
+            result += (unsigned int) fields[i].size;
+        }
+        return result;
+}
+unsigned int        PRNG::state_size(void)
+{
+        unsigned int table_size;
+        state_seed_table(&table_size);
+        return 3 * sizeof(unsigned int) + table_size + state_CPU(NULL,true);
+}
+void                PRNG::state_save(FILE* stream)
+{
+        // header (generator, instances, seed table size), GPU seed table as is, CPU state
+        unsigned int table_size;
+        state_seed_table(&table_size);
+        unsigned int head[3] = {convert_generator_to_uint(PRNG_generator),(unsigned int) PRNG_instances,table_size};
+        fwrite(head,sizeof(unsigned int),3,stream);
+        if (table_size) {
+            GPU0->buffer_read_async(PRNG_seed_table_id);
+            fwrite(GPU0->buffer_read_wait(PRNG_seed_table_id),1,table_size,stream);
+            GPU0->buffer_read_release(PRNG_seed_table_id);
+        }
+        unsigned int cpu_size = state_CPU(NULL,true);
+        unsigned char* cpu_state = (unsigned char*) calloc(cpu_size,sizeof(unsigned char));
+        state_CPU(cpu_state,true);
+        fwrite(cpu_state,1,cpu_size,stream);
+        free(cpu_state);
+}
+bool                PRNG::state_load(FILE* stream)
+{
+        // whole state is read and checked before anything is changed
+        unsigned int table_size;
+        void* table = state_seed_table(&table_size);
+        unsigned int size = state_size();
+        unsigned char* data = (unsigned char*) calloc(size,sizeof(unsigned char));
+        bool result = (fread(data,1,size,stream)==size);
+        unsigned int* head = (unsigned int*) data;
+        if (result) result = ((head[0]==convert_generator_to_uint(PRNG_generator))&&(head[1]==(unsigned int) PRNG_instances)&&(head[2]==table_size));
+        if (result) {
+            if (table_size) {
+                memcpy(table,data+3*sizeof(unsigned int),table_size);
+                GPU0->buffer_write(PRNG_seed_table_id);
+            }
+            state_CPU(data+3*sizeof(unsigned int)+table_size,false);
+            // kernels with PRNG state passed by value get restored state
+            if (PRNG_generator==PRNG_generator_PHILOX)
+                for (int i=0; i<PRNG_consumers; i++)
+                    GPU0->kernel_init_constant_reset(PRNG_consumer_kernel[i],&PHILOX_state,PRNG_consumer_argument[i]);
+        }
+        free(data);
+        return result;
+}
 #endif
 void                PRNG::produce_CPU(float* randoms_cpu)
 {
-#ifndef CPU_RUN
     if (PRNG_generator==PRNG_generator_XOR128) XOR128_produce_CPU(randoms_cpu);
-#endif
     if ((PRNG_generator==PRNG_generator_RANLUX0)||(PRNG_generator==PRNG_generator_RANLUX1)||
         (PRNG_generator==PRNG_generator_RANLUX2)||(PRNG_generator==PRNG_generator_RANLUX3)||
         (PRNG_generator==PRNG_generator_RANLUX4)||(PRNG_generator==PRNG_generator_RANLUX)){
@@ -297,12 +619,13 @@ void                PRNG::produce_CPU(float* randoms_cpu)
     if (PRNG_generator==PRNG_generator_PM)     PM_produce_CPU(randoms_cpu);
     if (PRNG_generator==PRNG_generator_XOR7)   XOR7_produce_CPU(randoms_cpu);
     if (PRNG_generator==PRNG_generator_RANECU) RANECU_produce_CPU(randoms_cpu);
+    if (PRNG_generator==PRNG_generator_PHILOX) PHILOX_produce_CPU(randoms_cpu);
+    if (PRNG_generator==PRNG_generator_RANLUXPP) RLPP_produce_CPU(randoms_cpu);
+    if (PRNG_generator==PRNG_generator_MRG32K3A) MRG32K3A_produce_CPU(randoms_cpu);
 }
 void                PRNG::produce_CPU(float* randoms_cpu,int number_of_prns_CPU)
 {
-#ifndef CPU_RUN
     if (PRNG_generator==PRNG_generator_XOR128) XOR128_produce_CPU(randoms_cpu,number_of_prns_CPU);
-#endif
     if ((PRNG_generator==PRNG_generator_RANLUX0)||(PRNG_generator==PRNG_generator_RANLUX1)||
         (PRNG_generator==PRNG_generator_RANLUX2)||(PRNG_generator==PRNG_generator_RANLUX3)||
         (PRNG_generator==PRNG_generator_RANLUX4)||(PRNG_generator==PRNG_generator_RANLUX)){
@@ -313,6 +636,136 @@ void                PRNG::produce_CPU(float* randoms_cpu,int number_of_prns_CPU)
     if (PRNG_generator==PRNG_generator_PM)     PM_produce_CPU(randoms_cpu,number_of_prns_CPU);
     if (PRNG_generator==PRNG_generator_XOR7)   XOR7_produce_CPU(randoms_cpu,number_of_prns_CPU);
     if (PRNG_generator==PRNG_generator_RANECU) RANECU_produce_CPU(randoms_cpu,number_of_prns_CPU);
+    if (PRNG_generator==PRNG_generator_PHILOX) PHILOX_produce_CPU(randoms_cpu,number_of_prns_CPU);
+    if (PRNG_generator==PRNG_generator_RANLUXPP) RLPP_produce_CPU(randoms_cpu,number_of_prns_CPU);
+    if (PRNG_generator==PRNG_generator_MRG32K3A) MRG32K3A_produce_CPU(randoms_cpu,number_of_prns_CPU);
+}
+bool                PRNG::substreams_CPU(void){
+    return ((PRNG_generator==PRNG_generator_XOR128)||(PRNG_generator==PRNG_generator_RANECU)||(PRNG_generator==PRNG_generator_MRG32K3A));
+}
+void                PRNG::initialize_CPU(unsigned int thread){
+    // thread 0 is the ordinary CPU generator, thread i is the i-th substream (as the i-th GPU instance)
+    bool substreams = substreams_CPU();
+    if ((thread)&&(!substreams)) {
+        // generators without jump-ahead: seed of thread i is hashed from (PRNG_randseries, i)
+        unsigned int seed = PRNG_randseries ^ (thread * 0x9E3779B9u);
+        seed = (seed ^ (seed >> 16)) * 0x85EBCA6Bu;
+        seed = (seed ^ (seed >> 13)) * 0xC2B2AE35u;
+        seed =  seed ^ (seed >> 16);
+        PRNG_randseries = (seed) ? seed : 1;
+    }
+    initialize_CPU();
+    if ((!thread)||(!substreams)) return;
+
+    if (PRNG_generator==PRNG_generator_XOR128){
+        unsigned int (*matrix)[4] = (unsigned int (*)[4]) calloc(128,sizeof(unsigned int[4]));
+        XOR128_jump_matrix(thread,XOR128_substream_log2,matrix);
+        XOR128_jump(matrix,XOR128_state.s);
+        free(matrix);
+    }
+    if (PRNG_generator==PRNG_generator_RANECU){
+        unsigned int a1, a2;
+        RANECU_jump_multipliers(thread,RANECU_substream_log2,&a1,&a2);
+        RANECU_jseed1 = (int) (((unsigned long long) RANECU_jseed1 * a1) % RANECU_icons1);
+        RANECU_jseed2 = (int) (((unsigned long long) RANECU_jseed2 * a2) % RANECU_icons2);
+    }
+    if (PRNG_generator==PRNG_generator_MRG32K3A){
+        unsigned long long a1[9], a2[9];
+        MRG32K3A_jump_matrix(thread,MRG32K3A_substream_log2,a1,a2);
+        MRG32K3A_jump(a1,a2,MRG32K3A_state);
+    }
+}
+void                PRNG::skip_CPU(unsigned long long n)
+{
+    if (PRNG_generator==PRNG_generator_XOR128){
+        unsigned int (*matrix)[4] = (unsigned int (*)[4]) calloc(128,sizeof(unsigned int[4]));
+        XOR128_jump_matrix(n,0,matrix);
+        XOR128_jump(matrix,XOR128_state.s);
+        free(matrix);
+    }
+    if (PRNG_generator==PRNG_generator_RANECU){
+        unsigned int a1, a2;
+        RANECU_jump_multipliers(n,0,&a1,&a2);
+        RANECU_jseed1 = (int) (((unsigned long long) RANECU_jseed1 * a1) % RANECU_icons1);
+        RANECU_jseed2 = (int) (((unsigned long long) RANECU_jseed2 * a2) % RANECU_icons2);
+    }
+    if (PRNG_generator==PRNG_generator_MRG32K3A){
+        unsigned long long a1[9], a2[9];
+        MRG32K3A_jump_matrix(n,0,a1,a2);
+        MRG32K3A_jump(a1,a2,MRG32K3A_state);
+    }
+}
+bool                PRNG::batch_initialize_CPU(unsigned int instances)
+{
+    // instance 0 continues the CPU generator, instance i is the i-th substream (as the i-th GPU instance after initialize_CPU)
+    unsigned int rows = 0;
+    size_t element = sizeof(float);
+    if (PRNG_generator==PRNG_generator_XOR128)   {rows = 4;  element = sizeof(unsigned int);}
+    if ((PRNG_generator==PRNG_generator_RANLUX0)||(PRNG_generator==PRNG_generator_RANLUX1)||
+        (PRNG_generator==PRNG_generator_RANLUX2)||(PRNG_generator==PRNG_generator_RANLUX3)||
+        (PRNG_generator==PRNG_generator_RANLUX4)||(PRNG_generator==PRNG_generator_RANLUX)){
+                                                  rows = 25; element = sizeof(float);
+    }
+    if (PRNG_generator==PRNG_generator_RANECU)   {rows = 2;  element = sizeof(int);}
+    if (PRNG_generator==PRNG_generator_MRG32K3A) {rows = 6;  element = sizeof(double);}
+
+    batch_finalize_CPU();
+    if ((rows==0)||(instances==0)) return false;
+
+    batch_instances = instances;
+    batch_state = calloc((size_t) rows * instances,element);
+
+    if (PRNG_generator==PRNG_generator_XOR128)   XOR128_batch_initialize_CPU();
+    if (rows==25)                                RL_batch_initialize_CPU();
+    if (PRNG_generator==PRNG_generator_RANECU)   RANECU_batch_initialize_CPU();
+    if (PRNG_generator==PRNG_generator_MRG32K3A) MRG32K3A_batch_initialize_CPU();
+
+    return true;
+}
+void                PRNG::batch_produce_CPU(float* randoms_cpu,int number_of_prns_CPU)
+{
+    if (!batch_state) return;
+    if (PRNG_generator==PRNG_generator_XOR128) XOR128_batch_produce_CPU(randoms_cpu,number_of_prns_CPU);
+    if ((PRNG_generator==PRNG_generator_RANLUX0)||(PRNG_generator==PRNG_generator_RANLUX1)||
+        (PRNG_generator==PRNG_generator_RANLUX2)||(PRNG_generator==PRNG_generator_RANLUX3)||
+        (PRNG_generator==PRNG_generator_RANLUX4)||(PRNG_generator==PRNG_generator_RANLUX)){
+            RL_batch_produce_CPU(randoms_cpu,number_of_prns_CPU);
+    }
+    if (PRNG_generator==PRNG_generator_RANECU)   RANECU_batch_produce_CPU(randoms_cpu,number_of_prns_CPU);
+    if (PRNG_generator==PRNG_generator_MRG32K3A) MRG32K3A_batch_produce_CPU(randoms_cpu,number_of_prns_CPU);
+}
+void                PRNG::batch_finalize_CPU(void)
+{
+    if (batch_state) free(batch_state);
+    batch_state     = NULL;
+    batch_instances = 0;
+}
+void                PRNG::batch_load_CPU(unsigned int instance)
+{
+    unsigned int n = batch_instances;
+    if (PRNG_generator==PRNG_generator_XOR128){
+        unsigned int* state = (unsigned int*) batch_state;
+        for (int k=0; k<4; k++) XOR128_state.s[k] = state[k * n + instance];
+    }
+    if ((PRNG_generator==PRNG_generator_RANLUX0)||(PRNG_generator==PRNG_generator_RANLUX1)||
+        (PRNG_generator==PRNG_generator_RANLUX2)||(PRNG_generator==PRNG_generator_RANLUX3)||
+        (PRNG_generator==PRNG_generator_RANLUX4)||(PRNG_generator==PRNG_generator_RANLUX)){
+        float* state = (float*) batch_state;
+        for (int k=0; k<24; k++) RL_seeds[k] = state[k * n + instance];
+        RL_carry = state[24 * n + instance];
+        RL_i24   = RL_batch_i24;
+        RL_j24   = RL_batch_j24;
+        RL_in24  = RL_batch_in24;
+    }
+    if (PRNG_generator==PRNG_generator_RANECU){
+        int* state = (int*) batch_state;
+        RANECU_jseed1 = state[instance];
+        RANECU_jseed2 = state[n + instance];
+    }
+    if (PRNG_generator==PRNG_generator_MRG32K3A){
+        double* state = (double*) batch_state;
+        for (int k=0; k<6; k++) MRG32K3A_state[k] = (unsigned int) state[k * n + instance];
+    }
 }
 #ifndef CPU_RUN
 unsigned int        PRNG::check_seeds(void)
@@ -329,6 +782,8 @@ unsigned int        PRNG::check_seeds(void)
         result = RANMAR_check_seeds();
         if (result) RANMAR_print_seeds();
     }
+    if (PRNG_generator==PRNG_generator_RANLUXPP)
+        result = RLPP_check_seeds();
 
     if (result) printf("Seeds check failed: %u errors\n",result);
     else printf("Seeds check passed!\n");
@@ -341,7 +796,50 @@ unsigned int        PRNG::check(void)
 
 //    PRNG_randseries and PRNG_samples must be initialized in the parent program
     unsigned int result = 0;
+    int i_quads = 4;
+    if (PRNG_generator == PRNG_generator_RANMAR) {i_quads = 1;}
+    if (PRNG_generator == PRNG_generator_PM)     {i_quads = 1;}
+    if (PRNG_generator == PRNG_generator_RANECU) {i_quads = 1;}
+
+    // double PRNs are built of two raw outputs with rejection of out-of-range draws, so the device state advances
+    // by a variable amount which CPU generators do not follow: double output is checked for range only
+    if (PRNG_precision == PRNG_precision_double) {
+        produce();
+        fill();
+        result = check_range();
+        printf("PRNG check result: %u errors out of range (double precision PRNs: CPU stream and seeds are not compared)\n\n",result);
+        return result;
+    }
+
+    // CPU generator follows the first GPU instance: skip PRNs it has already produced (initialize() runs one block)
+    if (PRNG_generator != PRNG_generator_PHILOX) {
+        unsigned int skipped = (i_quads == 4) ? randoms_produced : randoms_produced / 4;
+        if ((PRNG_generator==PRNG_generator_XOR128)||(PRNG_generator==PRNG_generator_RANECU)||(PRNG_generator==PRNG_generator_MRG32K3A))
+            skip_CPU(skipped);
+        else {
+            float* randoms_skipped = (float*) calloc(PRNG_samples*4,sizeof(float));
+            while (skipped) {
+                int chunk = (skipped < (unsigned int) PRNG_samples*4) ? (int) skipped : PRNG_samples*4;
+                produce_CPU(randoms_skipped,chunk);
+                skipped -= chunk;
+            }
+            free(randoms_skipped);
+        }
+    }
     produce();
+    fill();
+
+    // generators with jump-ahead are checked for every GPU instance by CPU batch (instance i is the i-th substream),
+    // the others - for the first instance only
+    unsigned int instances_checked = 1;
+    float* randoms_batch = NULL;
+    if (((PRNG_generator==PRNG_generator_XOR128)||(PRNG_generator==PRNG_generator_RANECU)||(PRNG_generator==PRNG_generator_MRG32K3A))&&
+        (batch_initialize_CPU(PRNG_instances))) {
+        instances_checked = PRNG_instances;
+        randoms_batch = (float*) calloc((size_t) PRNG_instances * PRNG_samples * 4,sizeof(float));
+        batch_produce_CPU(randoms_batch,PRNG_samples*4);
+        batch_finalize_CPU();
+    }
 
     // CPU prn production
     float* randoms_cpu = (float*) calloc(PRNG_samples*4,sizeof(float));
@@ -355,30 +853,35 @@ unsigned int        PRNG::check(void)
     check_seeds();
 
     int max_output = 512;
-    unsigned int offset = PRNG_instances;
-    int i_quads = 4;
-    if (PRNG_generator == PRNG_generator_RANMAR) {i_quads = 1;}
-    if (PRNG_generator == PRNG_generator_PM)     {i_quads = 1;}
-    if (PRNG_generator == PRNG_generator_RANECU) {i_quads = 1;}
+    unsigned int offset = ((PRNG_generator == PRNG_generator_PHILOX) && (PRNG_in_kernels)) ? 1 : PRNG_instances;
+    for (unsigned int n=0; n<instances_checked; n++)
     for (int i=0; i<PRNG_samples; i++) {
         double prn_cpu0,prn_cpu1,prn_cpu2,prn_cpu3;
-        if (i_quads == 4) {
+        if (randoms_batch) {
+            size_t k = (size_t) i_quads * i;
+            prn_cpu0 = randoms_batch[(k  ) * instances_checked + n];
+            prn_cpu1 = (i_quads == 4) ? randoms_batch[(k+1) * instances_checked + n] : 0.0;
+            prn_cpu2 = (i_quads == 4) ? randoms_batch[(k+2) * instances_checked + n] : 0.0;
+            prn_cpu3 = (i_quads == 4) ? randoms_batch[(k+3) * instances_checked + n] : 0.0;
+        } else if (i_quads == 4) {
             prn_cpu0 = randoms_cpu[4*i  ];
             prn_cpu1 = randoms_cpu[4*i+1];
             prn_cpu2 = randoms_cpu[4*i+2];
             prn_cpu3 = randoms_cpu[4*i+3];
         } else {
             prn_cpu0 = randoms_cpu[i];
+            prn_cpu1 = prn_cpu2 = prn_cpu3 = 0.0;
         }
 
-        unsigned int prn_gpu_int0 = GPU0->convert_to_uint((float) pointer_to_randoms[offset*i].s[0]);
-        unsigned int prn_gpu_int1 = GPU0->convert_to_uint((float) pointer_to_randoms[offset*i].s[1]);
-        unsigned int prn_gpu_int2 = GPU0->convert_to_uint((float) pointer_to_randoms[offset*i].s[2]);
-        unsigned int prn_gpu_int3 = GPU0->convert_to_uint((float) pointer_to_randoms[offset*i].s[3]);
-        double prn_gpu0 = GPU0->convert_to_double(pointer_to_randoms[offset*i].s[0]);
-        double prn_gpu1 = GPU0->convert_to_double(pointer_to_randoms[offset*i].s[1]);
-        double prn_gpu2 = GPU0->convert_to_double(pointer_to_randoms[offset*i].s[2]);
-        double prn_gpu3 = GPU0->convert_to_double(pointer_to_randoms[offset*i].s[3]);
+        size_t gpu_index = (size_t) offset * i + n;
+        unsigned int prn_gpu_int0 = GPU0->convert_to_uint((float) pointer_to_randoms[gpu_index].s[0]);
+        unsigned int prn_gpu_int1 = GPU0->convert_to_uint((float) pointer_to_randoms[gpu_index].s[1]);
+        unsigned int prn_gpu_int2 = GPU0->convert_to_uint((float) pointer_to_randoms[gpu_index].s[2]);
+        unsigned int prn_gpu_int3 = GPU0->convert_to_uint((float) pointer_to_randoms[gpu_index].s[3]);
+        double prn_gpu0 = GPU0->convert_to_double(pointer_to_randoms[gpu_index].s[0]);
+        double prn_gpu1 = GPU0->convert_to_double(pointer_to_randoms[gpu_index].s[1]);
+        double prn_gpu2 = GPU0->convert_to_double(pointer_to_randoms[gpu_index].s[2]);
+        double prn_gpu3 = GPU0->convert_to_double(pointer_to_randoms[gpu_index].s[3]);
 
         if ((i_quads >= 1) && (prn_cpu0-prn_gpu0)) result++;
         if ((i_quads >= 2) && (prn_cpu1-prn_gpu1)) result++;
@@ -387,16 +890,17 @@ unsigned int        PRNG::check(void)
 
         if (max_output>0) {
             max_output--;
-            if ((i_quads >= 1) && (prn_cpu0-prn_gpu0)) printf("[%2u].x: % e\t (CPU:% e,\t GPU:% e,\t intGPU:%u)\n",i,(prn_cpu0-prn_gpu0),prn_cpu0,prn_gpu0,prn_gpu_int0);
-            if ((i_quads >= 2) && (prn_cpu1-prn_gpu1)) printf("[%2u].y: % e\t (CPU:% e,\t GPU:% e,\t intGPU:%u)\n",i,(prn_cpu1-prn_gpu1),prn_cpu1,prn_gpu1,prn_gpu_int1);
-            if ((i_quads >= 3) && (prn_cpu2-prn_gpu2)) printf("[%2u].z: % e\t (CPU:% e,\t GPU:% e,\t intGPU:%u)\n",i,(prn_cpu2-prn_gpu2),prn_cpu2,prn_gpu2,prn_gpu_int2);
-            if ((i_quads >= 4) && (prn_cpu3-prn_gpu3)) printf("[%2u].w: % e\t (CPU:% e,\t GPU:% e,\t intGPU:%u)\n",i,(prn_cpu3-prn_gpu3),prn_cpu3,prn_gpu3,prn_gpu_int3);
+            if ((i_quads >= 1) && (prn_cpu0-prn_gpu0)) printf("[%2u:%2u].x: % e\t (CPU:% e,\t GPU:% e,\t intGPU:%u)\n",n,i,(prn_cpu0-prn_gpu0),prn_cpu0,prn_gpu0,prn_gpu_int0);
+            if ((i_quads >= 2) && (prn_cpu1-prn_gpu1)) printf("[%2u:%2u].y: % e\t (CPU:% e,\t GPU:% e,\t intGPU:%u)\n",n,i,(prn_cpu1-prn_gpu1),prn_cpu1,prn_gpu1,prn_gpu_int1);
+            if ((i_quads >= 3) && (prn_cpu2-prn_gpu2)) printf("[%2u:%2u].z: % e\t (CPU:% e,\t GPU:% e,\t intGPU:%u)\n",n,i,(prn_cpu2-prn_gpu2),prn_cpu2,prn_gpu2,prn_gpu_int2);
+            if ((i_quads >= 4) && (prn_cpu3-prn_gpu3)) printf("[%2u:%2u].w: % e\t (CPU:% e,\t GPU:% e,\t intGPU:%u)\n",n,i,(prn_cpu3-prn_gpu3),prn_cpu3,prn_gpu3,prn_gpu_int3);
         }
     }
 
-    delete[] randoms_cpu;
+    if (randoms_batch) free(randoms_batch);
+    free(randoms_cpu);
 
-    printf("PRNG check result: %u errors (%u samples)\n\n",result,PRNG_samples*4);
+    printf("PRNG check result: %u errors (%u instances x %u samples)\n\n",result,instances_checked,PRNG_samples*4);
 
     return result;
 }
@@ -404,19 +908,11 @@ unsigned int        PRNG::check_range(void)
 {
     unsigned int result = 0;
 
-    // check results
-    cl_float4* pointer_to_randoms = GPU0->buffer_map_float4(PRNG_randoms_id);
-    for (unsigned int i=0; i<randoms_size; i++) {
-        double prn_gpu0 = GPU0->convert_to_double(pointer_to_randoms[i].s[0]);
-        double prn_gpu1 = GPU0->convert_to_double(pointer_to_randoms[i].s[1]);
-        double prn_gpu2 = GPU0->convert_to_double(pointer_to_randoms[i].s[2]);
-        double prn_gpu3 = GPU0->convert_to_double(pointer_to_randoms[i].s[3]);
-
-        if ((prn_gpu0 <= 0.0) || (prn_gpu0 >= 1.0) || (prn_gpu0 != prn_gpu0)) result++;
-        if ((prn_gpu1 <= 0.0) || (prn_gpu1 >= 1.0) || (prn_gpu1 != prn_gpu1)) result++;
-        if ((prn_gpu2 <= 0.0) || (prn_gpu2 >= 1.0) || (prn_gpu2 != prn_gpu2)) result++;
-        if ((prn_gpu3 <= 0.0) || (prn_gpu3 >= 1.0) || (prn_gpu3 != prn_gpu3)) result++;
-    delete(pointer_to_randoms);
+    // check results (float4 or double4 PRNs)
+    unsigned int* pointer_to_randoms = GPU0->buffer_map(PRNG_randoms_id);
+    for (unsigned int i=0; i<4*randoms_size; i++) {
+        double prn_gpu = (PRNG_precision == PRNG_precision_double) ? ((double*) pointer_to_randoms)[i] : (double) ((float*) pointer_to_randoms)[i];
+        if ((prn_gpu <= 0.0) || (prn_gpu >= 1.0) || (prn_gpu != prn_gpu)) result++;
     }
 
     return result;
@@ -494,6 +990,7 @@ void                PRNG::RL_initialize(void)
             argument_id = GPU0->kernel_init_buffer(PRNG_randoms_kernel_id,PRNG_seed_table_id);
             argument_id = GPU0->kernel_init_buffer(PRNG_randoms_kernel_id,PRNG_randoms_id);
             argument_id = GPU0->kernel_init_constant(PRNG_randoms_kernel_id,&PRNG_samples);
+            PRNG_samples_argument = argument_id - 1;
 
 // TODO: Kill PRNG_seed_id buffer
 
@@ -631,35 +1128,119 @@ void                PRNG::RL_produce_CPU(float* randoms_cpu,int number_of_prns_C
 {
     for (int i=0; i<number_of_prns_CPU; i++) randoms_cpu[i] = RL_produce_one_CPU();
 }
+// Batch loops run over instances (rows are contiguous and branch-free) and are vectorized by the compiler
+// for the target instruction set (make SIMD=1: AVX2/AVX-512 of the host). Arithmetic is the same as in the scalar code.
+static void         RL_batch_step(float* __restrict seeds_i24,const float* __restrict seeds_j24,float* __restrict carry,unsigned int n)
+{
+PRNG_SIMD_LOOP
+    for (unsigned int i=0; i<n; i++) {
+        float uni = seeds_j24[i] - seeds_i24[i] - carry[i];
+        carry[i]     = (uni < 0.0f) ? RL_twom24 : 0.0f;
+        seeds_i24[i] = (uni < 0.0f) ? uni + 1.0f : uni;
+    }
+}
+void                PRNG::RL_batch_initialize_CPU(void)
+{
+    unsigned int n = batch_instances;
+    float* state = (float*) batch_state;
+
+    RL_batch_i24  = RL_i24;
+    RL_batch_j24  = RL_j24;
+    RL_batch_in24 = RL_in24;
+    for (int k=0; k<24; k++) state[k * n] = RL_seeds[k];
+    state[24 * n] = RL_carry;
+
+    // instances 1.. are seeded as RL_initialize_CPU with seeds RL_jseed+i and rotated to common indices RL_i24, RL_j24
+    // (they share luxury phase RL_in24 of instance 0)
+    int shift = RL_i24 - 23;
+    for (unsigned int i=1; i<n; i++) {
+        int RL_jseed_CPU = (int) (((unsigned int) RL_jseed + i) % RL_icons);
+        if (RL_jseed_CPU == 0) RL_jseed_CPU = 1;
+        float seeds[24];
+        for (int k=0; k<24; k++)
+        {
+            int RL_k = RL_jseed_CPU / 53668;
+            RL_jseed_CPU = 40014 * (RL_jseed_CPU - RL_k * 53668) - RL_k * 12211;
+            if (RL_jseed_CPU < 0) {RL_jseed_CPU = RL_jseed_CPU + RL_icons;}
+            seeds[k] = ((float) (RL_jseed_CPU % RL_itwo24)) * RL_twom24;
+        }
+        for (int k=0; k<24; k++) state[((k + shift + 24) % 24) * n + i] = seeds[k];
+        state[24 * n + i] = (seeds[23] == 0) ? RL_twom24 : 0.0f;
+    }
+}
+void                PRNG::RL_batch_produce_CPU(float* randoms_cpu,int number_of_prns_CPU)
+{
+    unsigned int n = batch_instances;
+    float* state = (float*) batch_state;
+    float* carry = state + 24 * n;
+
+    for (int k=0; k<number_of_prns_CPU; k++) {
+        if (RL_batch_in24 == 0)
+        {
+            RL_batch_in24 = 24;
+            for (int isk = 0; isk < RL_nskip; isk++)
+            {
+                RL_batch_step(state + RL_batch_i24 * n,state + RL_batch_j24 * n,carry,n);
+                if (RL_batch_i24==0) {RL_batch_i24=24;}
+                if (RL_batch_j24==0) {RL_batch_j24=24;}
+                RL_batch_i24--;
+                RL_batch_j24--;
+            }
+        }
+        const float* __restrict uni = state + RL_batch_i24 * n;
+        RL_batch_step(state + RL_batch_i24 * n,state + RL_batch_j24 * n,carry,n);
+        if (RL_batch_i24==0) {RL_batch_i24=24;}
+        if (RL_batch_j24==0) {RL_batch_j24=24;}
+        RL_batch_i24--;
+        RL_batch_j24--;
+
+        const float* __restrict next = state + RL_batch_j24 * n;
+        float* __restrict result = randoms_cpu + (size_t) k * n;
+PRNG_SIMD_LOOP
+        for (unsigned int i=0; i<n; i++) {
+            float small = uni[i] + RL_twom24 * next[i];
+            small = (small == 0.0f) ? RL_twom24 * RL_twom24 : small;
+            result[i] = (uni[i] < RL_twom12) ? small : uni[i];
+        }
+        RL_batch_in24--;
+    }
+}
 #ifndef CPU_RUN
 void                PRNG::XOR128_initialize(void)
 {
+        char options[1024];
+        int i_options = sprintf_s(options,sizeof(options),"-I %srandom",GPU0->cl_root_path);
+        if (PRNG_precision == PRNG_precision_double) i_options += sprintf_s(options+i_options,sizeof(options)-i_options," -D PRNG_PRECISION=2");
         char buffer_prng_cl[FNAME_MAX_LENGTH];
         int  j = sprintf_s(buffer_prng_cl  ,FNAME_MAX_LENGTH,  "%s",GPU0->cl_root_path);
              j+= sprintf_s(buffer_prng_cl+j,FNAME_MAX_LENGTH-j,"%s",SOURCE_PRNG);
         random = GPU0->source_read(buffer_prng_cl);
-                 GPU0->program_create(random);
+#ifdef BIGLAT
+                 GPU0->program_create_ndev(random,options,ndev);
+#else
+                 GPU0->program_create(random,options);
+#endif
 
         seed_table_size         = GPU0->buffer_size_align(PRNG_instances);
         randoms_size            = GPU0->buffer_size_align(PRNG_instances * PRNG_samples);
         PRNG_seed_table_uint4   = (cl_uint4*)  calloc(seed_table_size,sizeof(cl_uint4));
-        PRNG_randoms            = (void*) calloc(randoms_size,sizeof(cl_float4));
-
-        PRNG_seed_table_uint4[0].s[0] = XOR128_state.s[0];    // setup first thread as CPU
-        PRNG_seed_table_uint4[0].s[1] = XOR128_state.s[1];
-        PRNG_seed_table_uint4[0].s[2] = XOR128_state.s[2];
-        PRNG_seed_table_uint4[0].s[3] = XOR128_state.s[3];
-
-        for (unsigned int i=1; i<seed_table_size; i++)
+        int sizeoftype = sizeof(cl_float4);
+        if (PRNG_precision == PRNG_precision_double) sizeoftype = sizeof(cl_double4);
+        PRNG_randoms            = (void*) calloc(randoms_size,sizeoftype);
+
+        // first thread is the CPU one, each next thread starts 2^64 PRNs later
+        unsigned int (*matrix)[4] = (unsigned int (*)[4]) calloc(128,sizeof(unsigned int[4]));
+        XOR128_jump_matrix(1,XOR128_substream_log2,matrix);
+        cl_uint4 state = XOR128_state;
+        for (unsigned int i=0; i<seed_table_size; i++)
         {
-          PRNG_seed_table_uint4[i].s[0] = rand();
-          PRNG_seed_table_uint4[i].s[1] = rand();
-          PRNG_seed_table_uint4[i].s[2] = rand();
-          PRNG_seed_table_uint4[i].s[3] = rand();
+          if (i) XOR128_jump(matrix,state.s);
+          PRNG_seed_table_uint4[i] = state;
         }
+        free(matrix);
 
         PRNG_seed_table_id = GPU0->buffer_init(GPU0->buffer_type_IO, seed_table_size, PRNG_seed_table_uint4,    sizeof(cl_uint4));
-        PRNG_randoms_id    = GPU0->buffer_init(GPU0->buffer_type_IO, randoms_size,    PRNG_randoms,             sizeof(cl_float4));
+        PRNG_randoms_id    = GPU0->buffer_init(GPU0->buffer_type_IO, randoms_size,    PRNG_randoms,             sizeoftype);
 
         int argument_id;
         const size_t global_size[]  = {(size_t)PRNG_instances};                      // global_size
@@ -669,30 +1250,76 @@ void                PRNG::XOR128_initialize(void)
         argument_id = GPU0->kernel_init_buffer(PRNG_randoms_kernel_id,PRNG_seed_table_id);
         argument_id = GPU0->kernel_init_buffer(PRNG_randoms_kernel_id,PRNG_randoms_id);
         argument_id = GPU0->kernel_init_constant(PRNG_randoms_kernel_id,&PRNG_samples);
+        PRNG_samples_argument = argument_id - 1;
 }
 #endif
-#ifndef CPU_RUN
 void                PRNG::XOR128_initialize_CPU(void)
 {
         XOR128_state.s[0] = rand();
         XOR128_state.s[1] = rand();
         XOR128_state.s[2] = rand();
         XOR128_state.s[3] = rand();
+        if (PRNG_stream) {
+            unsigned int (*matrix)[4] = (unsigned int (*)[4]) calloc(128,sizeof(unsigned int[4]));
+            XOR128_jump_matrix(PRNG_stream,XOR128_stream_log2,matrix);
+            XOR128_jump(matrix,XOR128_state.s);
+            free(matrix);
+        }
+}
+// XOR128 is linear over GF(2): matrix[j] is the image of j-th bit of state (bit j%32 of word j/32)
+static void         XOR128_step(unsigned int* state)
+{
+        unsigned int t = (state[0]^(state[0]<<11));
+        state[0] = state[1];
+        state[1] = state[2];
+        state[2] = state[3];
+        state[3] = (state[3]^(state[3]>>19))^(t^(t>>8));
+}
+static void         XOR128_apply(unsigned int (*matrix)[4],const unsigned int* state,unsigned int* result)
+{
+        unsigned int r[4] = {0,0,0,0};
+        for (int j=0; j<128; j++)
+            if ((state[j >> 5] >> (j & 31)) & 1)
+                for (int k=0; k<4; k++) r[k] ^= matrix[j][k];
+        for (int k=0; k<4; k++) result[k] = r[k];
+}
+static void         XOR128_multiply(unsigned int (*a)[4],unsigned int (*b)[4],unsigned int (*c)[4])
+{
+        // c = a * b, c may coincide with a or b
+        unsigned int r[128][4];
+        for (int j=0; j<128; j++) XOR128_apply(a,b[j],r[j]);
+        memcpy(c,r,sizeof(r));
+}
+void                PRNG::XOR128_jump_matrix(unsigned long long n,unsigned int log2,unsigned int (*matrix)[4])
+{
+        // matrix = T^(n*2^log2) by squaring and multiplication, T - matrix of one step
+        unsigned int power[128][4];
+        for (int j=0; j<128; j++) {
+            for (int k=0; k<4; k++) {power[j][k] = 0; matrix[j][k] = 0;}
+            power[j][j >> 5]  = 1u << (j & 31);
+            matrix[j][j >> 5] = 1u << (j & 31);
+            XOR128_step(power[j]);
+        }
+        for (unsigned int i=0; i<log2; i++) XOR128_multiply(power,power,power);
+        while (n) {
+            if (n & 1) XOR128_multiply(power,matrix,matrix);
+            n >>= 1;
+            if (n) XOR128_multiply(power,power,power);
+        }
+}
+void                PRNG::XOR128_jump(unsigned int (*matrix)[4],unsigned int* state)
+{
+        XOR128_apply(matrix,state,state);
 }
 unsigned int        PRNG::XOR128_produce_one_uint_CPU(void)
 {
-        unsigned long t=(XOR128_state.s[0]^(XOR128_state.s[0]<<11));
-
-        XOR128_state.s[0] = XOR128_state.s[1];
-        XOR128_state.s[1] = XOR128_state.s[2];
-        XOR128_state.s[2] = XOR128_state.s[3];
-        XOR128_state.s[3] = (XOR128_state.s[3]^(XOR128_state.s[3]>>19))^(t^(t>>8));
+        XOR128_step(XOR128_state.s);
 
-        return XOR128_state.s[0];
+        return XOR128_state.s[3];
 }
 float               PRNG::XOR128_produce_one_CPU(void)
 {
-        return ((float) XOR128_produce_one_uint_CPU()) / 4294967295.0f;
+        return ((float) XOR128_produce_one_uint_CPU()) / 4294967296.0f;
 }
 void                PRNG::XOR128_produce_CPU(float* randoms_cpu)
 {
@@ -703,7 +1330,51 @@ void                PRNG::XOR128_produce_CPU(float* randoms_cpu,int number_of_pr
 {
     for (int i=0; i<number_of_prns_CPU; i++) randoms_cpu[i] = XOR128_produce_one_CPU();
 }
-#endif
+void                PRNG::XOR128_batch_initialize_CPU(void)
+{
+    unsigned int n = batch_instances;
+    unsigned int* state = (unsigned int*) batch_state;
+    unsigned int (*matrix)[4] = (unsigned int (*)[4]) calloc(128,sizeof(unsigned int[4]));
+    XOR128_jump_matrix(1,XOR128_substream_log2,matrix);
+
+    unsigned int instance[4];
+    for (int k=0; k<4; k++) instance[k] = XOR128_state.s[k];
+    for (unsigned int i=0; i<n; i++) {
+        if (i) XOR128_jump(matrix,instance);
+        for (int k=0; k<4; k++) state[k * n + i] = instance[k];
+    }
+    free(matrix);
+}
+void                PRNG::XOR128_batch_produce_CPU(float* randoms_cpu,int number_of_prns_CPU)
+{
+    unsigned int n = batch_instances;
+    unsigned int* row[4];
+    for (int k=0; k<4; k++) row[k] = (unsigned int*) batch_state + k * n;
+
+    for (int k=0; k<number_of_prns_CPU; k++) {
+        // new word replaces the oldest one, rows are renamed instead of shifted
+        unsigned int* __restrict s0 = row[0];
+        const unsigned int* __restrict s3 = row[3];
+        float* __restrict result = randoms_cpu + (size_t) k * n;
+PRNG_SIMD_LOOP
+        for (unsigned int i=0; i<n; i++) {
+            unsigned int t = (s0[i]^(s0[i]<<11));
+            unsigned int w = (s3[i]^(s3[i]>>19))^(t^(t>>8));
+            s0[i] = w;
+            result[i] = ((float) w) / 4294967296.0f;
+        }
+        row[0] = row[1]; row[1] = row[2]; row[2] = row[3]; row[3] = s0;
+    }
+
+    // restore row order
+    int rotation = number_of_prns_CPU % 4;
+    if (rotation) {
+        unsigned int* ordered = (unsigned int*) calloc(4 * (size_t) n,sizeof(unsigned int));
+        for (int k=0; k<4; k++) memcpy(ordered + k * n,row[k],n * sizeof(unsigned int));
+        memcpy(batch_state,ordered,4 * (size_t) n * sizeof(unsigned int));
+        free(ordered);
+    }
+}
 #ifndef CPU_RUN
 void                PRNG::RANMAR_initialize(void)
 {
@@ -764,6 +1435,7 @@ void                PRNG::RANMAR_initialize(void)
             argument_id = GPU0->kernel_init_buffer(PRNG_randoms_kernel_id,PRNG_seed_table_id);
             argument_id = GPU0->kernel_init_buffer(PRNG_randoms_kernel_id,PRNG_randoms_id);
             argument_id = GPU0->kernel_init_constant(PRNG_randoms_kernel_id,&PRNG_samples);
+            PRNG_samples_argument = argument_id - 1;
 
 // TODO: Kill PRNG_seed_id buffer
 
@@ -887,6 +1559,7 @@ void                PRNG::PM_initialize(void)
         argument_id = GPU0->kernel_init_buffer(PRNG_randoms_kernel_id,PRNG_seed_table_id);
         argument_id = GPU0->kernel_init_buffer(PRNG_randoms_kernel_id,PRNG_randoms_id);
         argument_id = GPU0->kernel_init_constant(PRNG_randoms_kernel_id,&PRNG_samples);
+        PRNG_samples_argument = argument_id - 1;
 }
 #endif
 void                PRNG::PM_initialize_CPU(void)
@@ -960,6 +1633,7 @@ void                PRNG::XOR7_initialize(void)
         argument_id = GPU0->kernel_init_buffer(PRNG_randoms_kernel_id,PRNG_seed_table_id);
         argument_id = GPU0->kernel_init_buffer(PRNG_randoms_kernel_id,PRNG_randoms_id);
         argument_id = GPU0->kernel_init_constant(PRNG_randoms_kernel_id,&PRNG_samples);
+        PRNG_samples_argument = argument_id - 1;
 }
 #endif
 void                PRNG::XOR7_initialize_CPU(void)
@@ -998,31 +1672,44 @@ void                PRNG::XOR7_produce_CPU(float* randoms_cpu,int number_of_prns
 #ifndef CPU_RUN
 void                PRNG::RANECU_initialize(void)
 {
+        char options[1024];
+        int i_options = sprintf_s(options,sizeof(options),"-I %srandom",GPU0->cl_root_path);
+        if (PRNG_precision == PRNG_precision_double) i_options += sprintf_s(options+i_options,sizeof(options)-i_options," -D PRNG_PRECISION=2");
         char buffer_prng_cl[FNAME_MAX_LENGTH];
         int  j = sprintf_s(buffer_prng_cl  ,FNAME_MAX_LENGTH,  "%s",GPU0->cl_root_path);
              j+= sprintf_s(buffer_prng_cl+j,FNAME_MAX_LENGTH-j,"%s",SOURCE_PRNG);
         random = GPU0->source_read(buffer_prng_cl);
-                 GPU0->program_create(random);
+#ifdef BIGLAT
+                 GPU0->program_create_ndev(random,options,ndev);
+#else
+                 GPU0->program_create(random,options);
+#endif
 
         seed_table_size         = PRNG_instances * 2;
         randoms_size            = PRNG_instances * PRNG_samples;
         PRNG_seed_table_uint4   = (cl_uint4*)  calloc(seed_table_size,sizeof(cl_uint4));
-        PRNG_randoms            = (void*) calloc(randoms_size,sizeof(cl_float4));
-
-        for (unsigned int i=0; i<seed_table_size; i++)
-        {
-          PRNG_seed_table_uint4[i].s[0] = rand() % 2147483647;
-          PRNG_seed_table_uint4[i].s[1] = rand() % 2147483647;
-          PRNG_seed_table_uint4[i].s[2] = rand() % 2147483647;
-          PRNG_seed_table_uint4[i].s[3] = rand() % 2147483647;
-        }
-
-        PRNG_seed_table_uint4[0].s[0] = RANECU_jseed1;    // setup first thread as CPU
-
-        PRNG_seed_table_uint4[PRNG_instances].s[0] = RANECU_jseed2;    // setup first thread as CPU
+        int sizeoftype = sizeof(cl_float4);
+        if (PRNG_precision == PRNG_precision_double) sizeoftype = sizeof(cl_double4);
+        PRNG_randoms            = (void*) calloc(randoms_size,sizeoftype);
+
+        // each thread runs 4 lanes: lane c of thread i starts (c*PRNG_instances + i)*2^36 PRNs after the CPU one
+        if (4 * PRNG_instances > (1 << (RANECU_stream_log2 - RANECU_substream_log2)))
+            printf("RANECU: %u lanes do not fit into one stream, streams overlap\n",4 * PRNG_instances);
+        unsigned int a1, a2;
+        RANECU_jump_multipliers(1,RANECU_substream_log2,&a1,&a2);
+        unsigned long long seed1 = RANECU_jseed1;
+        unsigned long long seed2 = RANECU_jseed2;
+        for (int c=0; c<4; c++)
+            for (int i=0; i<PRNG_instances; i++)
+            {
+                PRNG_seed_table_uint4[i].s[c]                  = (cl_uint) seed1;
+                PRNG_seed_table_uint4[i + PRNG_instances].s[c] = (cl_uint) seed2;
+                seed1 = (seed1 * a1) % RANECU_icons1;
+                seed2 = (seed2 * a2) % RANECU_icons2;
+            }
 
         PRNG_seed_table_id = GPU0->buffer_init(GPU0->buffer_type_IO, seed_table_size, PRNG_seed_table_uint4,    sizeof(cl_uint4));
-        PRNG_randoms_id    = GPU0->buffer_init(GPU0->buffer_type_IO, randoms_size,    PRNG_randoms,             sizeof(cl_float4));
+        PRNG_randoms_id    = GPU0->buffer_init(GPU0->buffer_type_IO, randoms_size,    PRNG_randoms,             sizeoftype);
 
         int argument_id;
         const size_t global_size[]  = {(size_t)PRNG_instances};                      // global_size
@@ -1032,12 +1719,34 @@ void                PRNG::RANECU_initialize(void)
         argument_id = GPU0->kernel_init_buffer(PRNG_randoms_kernel_id,PRNG_seed_table_id);
         argument_id = GPU0->kernel_init_buffer(PRNG_randoms_kernel_id,PRNG_randoms_id);
         argument_id = GPU0->kernel_init_constant(PRNG_randoms_kernel_id,&PRNG_samples);
+        PRNG_samples_argument = argument_id - 1;
 }
 #endif
 void                PRNG::RANECU_initialize_CPU(void)
 {
         RANECU_jseed1 = rand() % 2147483647;
         RANECU_jseed2 = rand() % 2147483647;
+        if (PRNG_stream) {
+            unsigned int a1, a2;
+            RANECU_jump_multipliers(PRNG_stream,RANECU_stream_log2,&a1,&a2);
+            RANECU_jseed1 = (int) (((unsigned long long) RANECU_jseed1 * a1) % RANECU_icons1);
+            RANECU_jseed2 = (int) (((unsigned long long) RANECU_jseed2 * a2) % RANECU_icons2);
+        }
+}
+void                PRNG::RANECU_jump_multipliers(unsigned long long n,unsigned int log2,unsigned int* a1,unsigned int* a2)
+{
+        // both components are multiplicative LCGs: n*2^log2 steps multiply seeds by a^(n*2^log2) mod m
+        unsigned long long p1 = RANECU_seedP13, p2 = RANECU_seedP23;
+        unsigned long long r1 = 1, r2 = 1;
+        for (unsigned int i=0; i<log2; i++) {p1 = (p1 * p1) % RANECU_icons1; p2 = (p2 * p2) % RANECU_icons2;}
+        while (n) {
+            if (n & 1) {r1 = (r1 * p1) % RANECU_icons1; r2 = (r2 * p2) % RANECU_icons2;}
+            p1 = (p1 * p1) % RANECU_icons1;
+            p2 = (p2 * p2) % RANECU_icons2;
+            n >>= 1;
+        }
+        (*a1) = (unsigned int) r1;
+        (*a2) = (unsigned int) r2;
 }
 float               PRNG::RANECU_produce_one_CPU(void)
 {
@@ -1067,7 +1776,544 @@ void                PRNG::RANECU_produce_CPU(float* randoms_cpu,int number_of_pr
 {
     for (int i=0; i<number_of_prns_CPU; i++) randoms_cpu[i] = RANECU_produce_one_CPU();
 }
+void                PRNG::RANECU_batch_initialize_CPU(void)
+{
+    unsigned int n = batch_instances;
+    int* state = (int*) batch_state;
+    unsigned int a1, a2;
+    RANECU_jump_multipliers(1,RANECU_substream_log2,&a1,&a2);
+
+    unsigned long long seed1 = RANECU_jseed1, seed2 = RANECU_jseed2;
+    for (unsigned int i=0; i<n; i++) {
+        if (i) {
+            seed1 = (seed1 * a1) % RANECU_icons1;
+            seed2 = (seed2 * a2) % RANECU_icons2;
+        }
+        state[i]     = (int) seed1;
+        state[n + i] = (int) seed2;
+    }
+}
+void                PRNG::RANECU_batch_produce_CPU(float* randoms_cpu,int number_of_prns_CPU)
+{
+    unsigned int n = batch_instances;
+    int* __restrict jseed1 = (int*) batch_state;
+    int* __restrict jseed2 = (int*) batch_state + n;
+
+    for (int k=0; k<number_of_prns_CPU; k++) {
+        float* __restrict result = randoms_cpu + (size_t) k * n;
+PRNG_SIMD_LOOP
+        for (unsigned int i=0; i<n; i++) {
+            int k1 = jseed1[i] / RANECU_seedP11;
+            int s1 = RANECU_seedP13 * (jseed1[i] - k1 * RANECU_seedP11) - k1 * RANECU_seedP12;
+            s1 = (s1 < 0) ? s1 + RANECU_icons1 : s1;
+
+            int k2 = jseed2[i] / RANECU_seedP21;
+            int s2 = RANECU_seedP23 * (jseed2[i] - k2 * RANECU_seedP21) - k2 * RANECU_seedP22;
+            s2 = (s2 < 0) ? s2 + RANECU_icons2 : s2;
+
+            jseed1[i] = s1;
+            jseed2[i] = s2;
+            int z = s1 - s2;
+            z = (z < 1) ? z + RANECU_icons3 : z;
+            result[i] = (float) ((float) (z)) / ((float) RANECU_twom31);
+        }
+    }
+}
+
+
+#ifndef CPU_RUN
+void                PRNG::PHILOX_initialize(void)
+{
+        char options[1024];
+        int i_options = sprintf_s(options,sizeof(options),"-I %srandom",GPU0->cl_root_path);
+        if (PRNG_precision == PRNG_precision_double) i_options += sprintf_s(options+i_options,sizeof(options)-i_options," -D PRNG_PRECISION=2");
+        char buffer_prng_cl[FNAME_MAX_LENGTH];
+        int  j = sprintf_s(buffer_prng_cl  ,FNAME_MAX_LENGTH,  "%s",GPU0->cl_root_path);
+             j+= sprintf_s(buffer_prng_cl+j,FNAME_MAX_LENGTH-j,"%s",SOURCE_PRNG);
+        random = GPU0->source_read(buffer_prng_cl);
+#ifdef BIGLAT
+                 GPU0->program_create_ndev(random,options,ndev);
+#else
+                 GPU0->program_create(random,options);
+#endif
+
+        // no seed table: PRN is a function of key, PRNG_counter and its index
+        // in-kernel PRNs are not read from buffer, it keeps the stream of the first instance for checks only
+        unsigned int instances_filled = (PRNG_in_kernels) ? 1 : PRNG_instances;
+        randoms_size            = instances_filled * PRNG_samples;
+        int sizeoftype = sizeof(cl_float4);
+        if (PRNG_precision == PRNG_precision_double) sizeoftype = sizeof(cl_double4);
+        PRNG_randoms            = (void*) calloc(randoms_size,sizeoftype);
+
+        PHILOX_state.s[0] = PHILOX_key[0];
+        PHILOX_state.s[1] = PHILOX_key[1];
+        PHILOX_state.s[2] = PRNG_counter;
+        PHILOX_state.s[3] = 0;
+
+        PRNG_randoms_id    = GPU0->buffer_init(GPU0->buffer_type_IO, randoms_size, PRNG_randoms, sizeoftype);
+
+        int argument_id;
+        const size_t global_size[]  = {(size_t)instances_filled};                    // global_size
+
+        if (PRNG_in_kernels)    // single work-item, its work group size is fixed
+            PRNG_randoms_kernel_id   = GPU0->kernel_init("philox",1,global_size,global_size,false);
+        else
+            PRNG_randoms_kernel_id   = GPU0->kernel_init("philox",1,global_size,NULL);
+        argument_id = GPU0->kernel_init_buffer(PRNG_randoms_kernel_id,PRNG_randoms_id);
+        argument_id = GPU0->kernel_init_constant(PRNG_randoms_kernel_id,&PHILOX_state);
+        PRNG_consumer_kernel[PRNG_consumers]   = PRNG_randoms_kernel_id;     // counter of check kernel follows produce()
+        PRNG_consumer_argument[PRNG_consumers] = argument_id - 1;
+        PRNG_consumers++;
+        argument_id = GPU0->kernel_init_constant(PRNG_randoms_kernel_id,&PRNG_samples);
+        PRNG_samples_argument = argument_id - 1;
+        argument_id = GPU0->kernel_init_constant(PRNG_randoms_kernel_id,&PRNG_instances);
+}
+#endif
+void                PRNG::PHILOX_initialize_CPU(void)
+{
+        PHILOX_key[0] = rand();
+        PHILOX_key[1] = rand();
+        PHILOX_index  = 0;
+}
+void                PRNG::PHILOX_block_CPU(const unsigned int* counter,unsigned int* result)
+{
+    unsigned int c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+    unsigned int k0 = PHILOX_key[0], k1 = PHILOX_key[1];
+    for (int round=0; round<10; round++) {
+        unsigned long long p0 = (unsigned long long) PHILOX_M0 * c0;
+        unsigned long long p1 = (unsigned long long) PHILOX_M1 * c2;
+        unsigned int hi0 = (unsigned int) (p0 >> 32), lo0 = (unsigned int) p0;
+        unsigned int hi1 = (unsigned int) (p1 >> 32), lo1 = (unsigned int) p1;
+        c0 = hi1 ^ c1 ^ k0;
+        c1 = lo1;
+        c2 = hi0 ^ c3 ^ k1;
+        c3 = lo0;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    result[0] = c0; result[1] = c1; result[2] = c2; result[3] = c3;
+}
+float               PRNG::PHILOX_produce_one_CPU(void)
+{
+    // CPU stream is the stream of the first GPU instance: quad i has index i * PRNG_instances
+    unsigned long long index = (unsigned long long) (PHILOX_index / 4) * ((PRNG_instances > 0) ? PRNG_instances : 1);
+    unsigned int counter[4] = {(unsigned int) index, PRNG_counter, (unsigned int) (index >> 32), 0};
+    unsigned int rnd[4];
+    PHILOX_block_CPU(counter,rnd);
+    float result = ((float) (rnd[PHILOX_index % 4] >> 9) + 0.5f) * PHILOX_twom23;
+    PHILOX_index++;
+    return result;
+}
+void                PRNG::PHILOX_produce_CPU(float* randoms_cpu)
+{
+    int number_of_prns_CPU = PRNG_samples * 4;
+    for (int i=0; i<number_of_prns_CPU; i++) randoms_cpu[i] = PHILOX_produce_one_CPU();
+}
+void                PRNG::PHILOX_produce_CPU(float* randoms_cpu,int number_of_prns_CPU)
+{
+    for (int i=0; i<number_of_prns_CPU; i++) randoms_cpu[i] = PHILOX_produce_one_CPU();
+}
+
+// RANLUX++: x' = A * x mod m, m = 2^576 - 2^240 + 1, A = a^2048 (a = m - (m - 1) / 2^24 is RANLUX multiplier)
+const unsigned long long PRNG::RLPP_A[RLPP_words] = {
+    0xed7faa90747aaad9ULL, 0x4cec2c78af55c101ULL, 0xe64dcb31c48228ecULL,
+    0x6d8a15a13bee7cb0ULL, 0x20b2ca60cb78c509ULL, 0x256c3d3c662ea36cULL,
+    0xff74e54107684ed2ULL, 0x492edfcc0cc8e753ULL, 0xb48c187cf5b22097ULL
+};
+const unsigned long long PRNG::RLPP_m[RLPP_words] = {
+    0x0000000000000001ULL, 0x0000000000000000ULL, 0x0000000000000000ULL,
+    0xffff000000000000ULL, 0xffffffffffffffffULL, 0xffffffffffffffffULL,
+    0xffffffffffffffffULL, 0xffffffffffffffffULL, 0xffffffffffffffffULL
+};
+
+static unsigned long long RLPP_mul_hi(unsigned long long a,unsigned long long b)
+{
+    unsigned long long a0 = a & 0xFFFFFFFFULL, a1 = a >> 32;
+    unsigned long long b0 = b & 0xFFFFFFFFULL, b1 = b >> 32;
+    unsigned long long p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+    unsigned long long mid = (p00 >> 32) + (p01 & 0xFFFFFFFFULL) + (p10 & 0xFFFFFFFFULL);
+    return p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+}
+
+static void RLPP_fold(unsigned long long* p)
+{
+    // p = p_low + p_high * 2^576 -> p_low + p_high * 2^240 - p_high (2^576 = 2^240 - 1 mod m), same as ranluxpp_fold()
+    unsigned long long h[RLPP_words];
+    for (int k=0; k<RLPP_words; k++) {h[k] = p[k+RLPP_words]; p[k+RLPP_words] = 0;}
+
+    unsigned long long carry = 0;
+    for (int k=0; k<10; k++) {
+        unsigned long long w  = ((k < 9) ? (h[k] << 48) : 0) | ((k > 0) ? (h[k-1] >> 16) : 0);
+        unsigned long long s  = p[k+3] + w;
+        unsigned long long c1 = (s < w);
+        unsigned long long s2 = s + carry;
+        unsigned long long c2 = (s2 < carry);
+        p[k+3] = s2;
+        carry = c1 + c2;
+    }
+    for (int k=13; k<18; k++) {
+        unsigned long long s = p[k] + carry;
+        carry = (s < carry);
+        p[k] = s;
+    }
+
+    unsigned long long borrow = 0;
+    for (int k=0; k<18; k++) {
+        unsigned long long hk = (k < 9) ? h[k] : 0;
+        unsigned long long d  = p[k] - hk;
+        unsigned long long b1 = (p[k] < hk);
+        unsigned long long d2 = d - borrow;
+        unsigned long long b2 = (d < borrow);
+        p[k] = d2;
+        borrow = b1 | b2;
+    }
+}
+
+void                PRNG::RLPP_mulmod(const unsigned long long* a,unsigned long long* x)
+{
+    unsigned long long p[2*RLPP_words];
+    for (int k=0; k<2*RLPP_words; k++) p[k] = 0;
+
+    for (int i=0; i<RLPP_words; i++) {
+        unsigned long long carry = 0;
+        for (int j=0; j<RLPP_words; j++) {
+            unsigned long long lo = a[i] * x[j];
+            unsigned long long hi = RLPP_mul_hi(a[i],x[j]);
+            unsigned long long s  = p[i+j] + lo;
+            unsigned long long c1 = (s < lo);
+            s += carry;
+            unsigned long long c2 = (s < carry);
+            p[i+j] = s;
+            carry = hi + c1 + c2;
+        }
+        p[i+RLPP_words] = carry;
+    }
+    RLPP_fold(p);   // < 2^817
+    RLPP_fold(p);   // < 2^576 + 2^481
+    RLPP_fold(p);   // < 2^576
+
+    int ge = 1;
+    for (int k=RLPP_words-1; k>=0; k--)
+        if (p[k] != RLPP_m[k]) {ge = (p[k] > RLPP_m[k]); break;}
+    unsigned long long borrow = 0;
+    for (int k=0; k<RLPP_words; k++) {
+        unsigned long long mk = (ge) ? RLPP_m[k] : 0;
+        unsigned long long d  = p[k] - mk;
+        unsigned long long b1 = (p[k] < mk);
+        unsigned long long d2 = d - borrow;
+        unsigned long long b2 = (d < borrow);
+        x[k] = d2;
+        borrow = b1 | b2;
+    }
+}
+
+void                PRNG::RLPP_powermod(const unsigned long long* a,unsigned long long* x,unsigned long long n)
+{
+    unsigned long long base[RLPP_words];
+    for (int k=0; k<RLPP_words; k++) {base[k] = a[k]; x[k] = 0;}
+    x[0] = 1;
+    while (n) {
+        if (n & 1) RLPP_mulmod(base,x);
+        RLPP_mulmod(base,base);
+        n >>= 1;
+    }
+}
+
+void                PRNG::RLPP_skip_seed(unsigned long long* a)
+{
+    // seeds s and s+1 are 2^96 states (of 576 bits) apart
+    RLPP_powermod(RLPP_A,a,((unsigned long long) 1) << 48);
+    RLPP_powermod(a,a,((unsigned long long) 1) << 48);
+}
+
+void                PRNG::RLPP_initialize_CPU(void)
+{
+        RLPP_seed = (((unsigned long long) rand()) << 31) ^ ((unsigned long long) rand());
+
+        unsigned long long a_seed[RLPP_words];
+        RLPP_skip_seed(a_seed);
+        RLPP_powermod(a_seed,RLPP_state,RLPP_seed);    // x = A^(2^96 * seed) * 1
+        RLPP_position = 0;
+}
+
+unsigned int        PRNG::RLPP_produce_one_uint_CPU(void)
+{
+    if (RLPP_position >= RLPP_numbers) {
+        RLPP_mulmod(RLPP_A,RLPP_state);
+        RLPP_position = 0;
+    }
+    unsigned int bit  = RLPP_position * 24;
+    unsigned int idx  = bit >> 6;
+    unsigned int offs = bit & 63;
+    unsigned long long bits = RLPP_state[idx] >> offs;
+    if (offs > 40) bits |= RLPP_state[idx+1] << (64 - offs);
+    RLPP_position++;
+    return (unsigned int) (bits & 0xffffff);
+}
+
+float               PRNG::RLPP_produce_one_CPU(void)
+{
+    return ((float) (RLPP_produce_one_uint_CPU() >> 1) + 0.5f) * RLPP_twom23;
+}
 
+void                PRNG::RLPP_produce_CPU(float* randoms_cpu)
+{
+    int number_of_prns_CPU = PRNG_samples * 4;
+    for (int i=0; i<number_of_prns_CPU; i++) randoms_cpu[i] = RLPP_produce_one_CPU();
+}
+
+void                PRNG::RLPP_produce_CPU(float* randoms_cpu,int number_of_prns_CPU)
+{
+    for (int i=0; i<number_of_prns_CPU; i++) randoms_cpu[i] = RLPP_produce_one_CPU();
+}
+
+#ifndef CPU_RUN
+void                PRNG::RLPP_initialize(void)
+{
+        char options[1024];
+        int i_options = sprintf_s(options,sizeof(options),"-I %srandom",GPU0->cl_root_path);
+        if (PRNG_precision == PRNG_precision_double) i_options += sprintf_s(options+i_options,sizeof(options)-i_options," -D PRNG_PRECISION=2");
+        char buffer_prng_cl[FNAME_MAX_LENGTH];
+        int  j = sprintf_s(buffer_prng_cl  ,FNAME_MAX_LENGTH,  "%s",GPU0->cl_root_path);
+             j+= sprintf_s(buffer_prng_cl+j,FNAME_MAX_LENGTH-j,"%s",SOURCE_PRNG);
+        random = GPU0->source_read(buffer_prng_cl);
+#ifdef BIGLAT
+                 GPU0->program_create_ndev(random,options,ndev);
+#else
+                 GPU0->program_create(random,options);
+#endif
+
+        seed_table_size         = PRNG_instances * (RLPP_words + 1);    // LCG state and position of each instance
+        randoms_size            = PRNG_instances * PRNG_samples;
+        PRNG_seed_table_ulong   = (cl_ulong*) calloc(seed_table_size,sizeof(cl_ulong));
+        int sizeoftype = sizeof(cl_float4);
+        if (PRNG_precision == PRNG_precision_double) sizeoftype = sizeof(cl_double4);
+        PRNG_randoms            = (void*) calloc(randoms_size,sizeoftype);
+
+        // instance i starts from seed RLPP_seed + i, first instance is the CPU one
+        unsigned long long a_seed[RLPP_words];
+        unsigned long long x[RLPP_words];
+        RLPP_skip_seed(a_seed);
+        for (int k=0; k<RLPP_words; k++) x[k] = RLPP_state[k];
+        for (int i=0; i<PRNG_instances; i++) {
+            if (i) RLPP_mulmod(a_seed,x);
+            for (int k=0; k<RLPP_words; k++) PRNG_seed_table_ulong[i + k * PRNG_instances] = x[k];
+            PRNG_seed_table_ulong[i + RLPP_words * PRNG_instances] = RLPP_position;
+        }
+
+        PRNG_seed_table_id = GPU0->buffer_init(GPU0->buffer_type_IO, seed_table_size, PRNG_seed_table_ulong, sizeof(cl_ulong));
+        PRNG_randoms_id    = GPU0->buffer_init(GPU0->buffer_type_IO, randoms_size,    PRNG_randoms,          sizeoftype);
+
+        int argument_id;
+        const size_t global_size[]  = {(size_t)PRNG_instances};                      // global_size
+
+        PRNG_randoms_kernel_id   = GPU0->kernel_init("ranluxpp",1,global_size,NULL);
+        argument_id = GPU0->kernel_init_buffer(PRNG_randoms_kernel_id,PRNG_seed_table_id);
+        argument_id = GPU0->kernel_init_buffer(PRNG_randoms_kernel_id,PRNG_randoms_id);
+        argument_id = GPU0->kernel_init_constant(PRNG_randoms_kernel_id,&PRNG_samples);
+        PRNG_samples_argument = argument_id - 1;
+}
+
+unsigned int        PRNG::RLPP_check_seeds(void)
+{
+    unsigned int result = 0;
+    cl_ulong* seed_table = (cl_ulong*) GPU0->buffer_map(PRNG_seed_table_id);
+    for (int k=0; k<RLPP_words; k++)
+        if (seed_table[k * PRNG_instances] != RLPP_state[k]) result++;
+    if (seed_table[RLPP_words * PRNG_instances] != RLPP_position) result++;
+    return result;
+}
+#endif
+
+
+#ifndef CPU_RUN
+void                PRNG::MRG32K3A_initialize(void)
+{
+        char options[1024];
+        int i_options = sprintf_s(options,sizeof(options),"-I %srandom",GPU0->cl_root_path);
+        if (PRNG_precision == PRNG_precision_double) i_options += sprintf_s(options+i_options,sizeof(options)-i_options," -D PRNG_PRECISION=2");
+        char buffer_prng_cl[FNAME_MAX_LENGTH];
+        int  j = sprintf_s(buffer_prng_cl  ,FNAME_MAX_LENGTH,  "%s",GPU0->cl_root_path);
+             j+= sprintf_s(buffer_prng_cl+j,FNAME_MAX_LENGTH-j,"%s",SOURCE_PRNG);
+        random = GPU0->source_read(buffer_prng_cl);
+#ifdef BIGLAT
+                 GPU0->program_create_ndev(random,options,ndev);
+#else
+                 GPU0->program_create(random,options);
+#endif
+
+        seed_table_size         = PRNG_instances * 2;   // states of both components
+        randoms_size            = PRNG_instances * PRNG_samples;
+        PRNG_seed_table_uint4   = (cl_uint4*)  calloc(seed_table_size,sizeof(cl_uint4));
+        int sizeoftype = sizeof(cl_float4);
+        if (PRNG_precision == PRNG_precision_double) sizeoftype = sizeof(cl_double4);
+        PRNG_randoms            = (void*) calloc(randoms_size,sizeoftype);
+
+        // first thread is the CPU one, each next thread starts 2^76 PRNs later (next substream)
+        unsigned long long a1[9], a2[9];
+        unsigned int state[6];
+        MRG32K3A_jump_matrix(1,MRG32K3A_substream_log2,a1,a2);
+        for (int k=0; k<6; k++) state[k] = MRG32K3A_state[k];
+        for (int i=0; i<PRNG_instances; i++) {
+            if (i) MRG32K3A_jump(a1,a2,state);
+            for (int k=0; k<3; k++) {
+                PRNG_seed_table_uint4[i].s[k]                  = state[k];
+                PRNG_seed_table_uint4[i + PRNG_instances].s[k] = state[k + 3];
+            }
+        }
+
+        PRNG_seed_table_id = GPU0->buffer_init(GPU0->buffer_type_IO, seed_table_size, PRNG_seed_table_uint4, sizeof(cl_uint4));
+        PRNG_randoms_id    = GPU0->buffer_init(GPU0->buffer_type_IO, randoms_size,    PRNG_randoms,          sizeoftype);
+
+        int argument_id;
+        const size_t global_size[]  = {(size_t)PRNG_instances};                      // global_size
+
+        PRNG_randoms_kernel_id   = GPU0->kernel_init("mrg32k3a",1,global_size,NULL);
+        argument_id = GPU0->kernel_init_buffer(PRNG_randoms_kernel_id,PRNG_seed_table_id);
+        argument_id = GPU0->kernel_init_buffer(PRNG_randoms_kernel_id,PRNG_randoms_id);
+        argument_id = GPU0->kernel_init_constant(PRNG_randoms_kernel_id,&PRNG_samples);
+        PRNG_samples_argument = argument_id - 1;
+}
+#endif
+void                PRNG::MRG32K3A_initialize_CPU(void)
+{
+        for (int k=0; k<6; k++) MRG32K3A_state[k] = (unsigned int) rand() + 1;  // nonzero and below m1, m2
+        if (PRNG_stream) {
+            unsigned long long a1[9], a2[9];
+            MRG32K3A_jump_matrix(PRNG_stream,MRG32K3A_stream_log2,a1,a2);
+            MRG32K3A_jump(a1,a2,MRG32K3A_state);
+        }
+}
+// c = a * b mod m for 3x3 matrices (entries are below m < 2^32), c may coincide with a or b
+static void         MRG32K3A_multiply(const unsigned long long* a,const unsigned long long* b,unsigned long long* c,unsigned long long m)
+{
+        unsigned long long r[9];
+        for (int i=0; i<3; i++)
+            for (int j=0; j<3; j++)
+                r[3*i+j] = ((a[3*i] * b[j]) % m + (a[3*i+1] * b[3+j]) % m + (a[3*i+2] * b[6+j]) % m) % m;
+        for (int k=0; k<9; k++) c[k] = r[k];
+}
+void                PRNG::MRG32K3A_jump_matrix(unsigned long long n,unsigned int log2,unsigned long long* a1,unsigned long long* a2)
+{
+        // (a1,a2) = (A1,A2)^(n*2^log2), A1 and A2 - matrices of one step for (x[n-3], x[n-2], x[n-1])
+        unsigned long long p1[9] = {0, 1, 0,  0, 0, 1,  MRG32K3A_m1 - 810728, 1403580, 0};
+        unsigned long long p2[9] = {0, 1, 0,  0, 0, 1,  MRG32K3A_m2 - 1370589, 0, 527612};
+        for (int k=0; k<9; k++) a1[k] = a2[k] = ((k % 4) == 0) ? 1 : 0;
+        for (unsigned int i=0; i<log2; i++) {
+            MRG32K3A_multiply(p1,p1,p1,MRG32K3A_m1);
+            MRG32K3A_multiply(p2,p2,p2,MRG32K3A_m2);
+        }
+        while (n) {
+            if (n & 1) {
+                MRG32K3A_multiply(p1,a1,a1,MRG32K3A_m1);
+                MRG32K3A_multiply(p2,a2,a2,MRG32K3A_m2);
+            }
+            n >>= 1;
+            if (n) {
+                MRG32K3A_multiply(p1,p1,p1,MRG32K3A_m1);
+                MRG32K3A_multiply(p2,p2,p2,MRG32K3A_m2);
+            }
+        }
+}
+void                PRNG::MRG32K3A_jump(const unsigned long long* a1,const unsigned long long* a2,unsigned int* state)
+{
+        unsigned long long x[6];
+        for (int k=0; k<6; k++) x[k] = state[k];
+        for (int i=0; i<3; i++) {
+            state[i]     = (unsigned int) (((a1[3*i] * x[0]) % MRG32K3A_m1 + (a1[3*i+1] * x[1]) % MRG32K3A_m1 + (a1[3*i+2] * x[2]) % MRG32K3A_m1) % MRG32K3A_m1);
+            state[i + 3] = (unsigned int) (((a2[3*i] * x[3]) % MRG32K3A_m2 + (a2[3*i+1] * x[4]) % MRG32K3A_m2 + (a2[3*i+2] * x[5]) % MRG32K3A_m2) % MRG32K3A_m2);
+        }
+}
+float               PRNG::MRG32K3A_produce_one_CPU(void)
+{
+        // the same arithmetic as mrg32k3a_step in prngcl_mrg32k3a.cl
+        long long x1n = 1403580LL * MRG32K3A_state[1] - 810728LL * MRG32K3A_state[0];
+        long long k = x1n / MRG32K3A_m1;
+        x1n -= k * MRG32K3A_m1;
+        if (x1n < 0) x1n += MRG32K3A_m1;
+        MRG32K3A_state[0] = MRG32K3A_state[1];
+        MRG32K3A_state[1] = MRG32K3A_state[2];
+        MRG32K3A_state[2] = (unsigned int) x1n;
+
+        long long x2n = 527612LL * MRG32K3A_state[5] - 1370589LL * MRG32K3A_state[3];
+        k = x2n / MRG32K3A_m2;
+        x2n -= k * MRG32K3A_m2;
+        if (x2n < 0) x2n += MRG32K3A_m2;
+        MRG32K3A_state[3] = MRG32K3A_state[4];
+        MRG32K3A_state[4] = MRG32K3A_state[5];
+        MRG32K3A_state[5] = (unsigned int) x2n;
+
+        if (x1n > x2n) return (float) ((x1n - x2n) * MRG32K3A_norm);
+        return (float) ((x1n - x2n + MRG32K3A_m1) * MRG32K3A_norm);
+}
+void                PRNG::MRG32K3A_produce_CPU(float* randoms_cpu)
+{
+    int number_of_prns_CPU = PRNG_samples * 4;
+    for (int i=0; i<number_of_prns_CPU; i++) randoms_cpu[i] = MRG32K3A_produce_one_CPU();
+}
+void                PRNG::MRG32K3A_produce_CPU(float* randoms_cpu,int number_of_prns_CPU)
+{
+    for (int i=0; i<number_of_prns_CPU; i++) randoms_cpu[i] = MRG32K3A_produce_one_CPU();
+}
+void                PRNG::MRG32K3A_batch_initialize_CPU(void)
+{
+    unsigned int n = batch_instances;
+    double* state = (double*) batch_state;
+    unsigned long long a1[9], a2[9];
+    MRG32K3A_jump_matrix(1,MRG32K3A_substream_log2,a1,a2);
+
+    unsigned int instance[6];
+    for (int k=0; k<6; k++) instance[k] = MRG32K3A_state[k];
+    for (unsigned int i=0; i<n; i++) {
+        if (i) MRG32K3A_jump(a1,a2,instance);
+        for (int k=0; k<6; k++) state[k * n + i] = (double) instance[k];
+    }
+}
+void                PRNG::MRG32K3A_batch_produce_CPU(float* randoms_cpu,int number_of_prns_CPU)
+{
+    // state is kept in double: products are below 2^53, so the modular reduction is exact and equal to the integer one
+    // (quotient is rounded to integer by adding and subtracting 1.5*2^52)
+    unsigned int n = batch_instances;
+    double* row[6];
+    for (int k=0; k<6; k++) row[k] = (double*) batch_state + k * n;
+    const double m1 = (double) MRG32K3A_m1, m2 = (double) MRG32K3A_m2;
+    const double round = 6755399441055744.0;
+
+    for (int k=0; k<number_of_prns_CPU; k++) {
+        double* __restrict x10 = row[0];
+        const double* __restrict x11 = row[1];
+        double* __restrict x20 = row[3];
+        const double* __restrict x22 = row[5];
+        float* __restrict result = randoms_cpu + (size_t) k * n;
+PRNG_SIMD_LOOP
+        for (unsigned int i=0; i<n; i++) {
+            double p1 = 1403580.0 * x11[i] - 810728.0 * x10[i];
+            p1 -= ((p1 * (1.0 / m1) + round) - round) * m1;
+            p1 = (p1 < 0.0) ? p1 + m1 : p1;
+            p1 = (p1 >= m1) ? p1 - m1 : p1;
+
+            double p2 = 527612.0 * x22[i] - 1370589.0 * x20[i];
+            p2 -= ((p2 * (1.0 / m2) + round) - round) * m2;
+            p2 = (p2 < 0.0) ? p2 + m2 : p2;
+            p2 = (p2 >= m2) ? p2 - m2 : p2;
+
+            x10[i] = p1;
+            x20[i] = p2;
+            result[i] = (float) (((p1 > p2) ? p1 - p2 : p1 - p2 + m1) * MRG32K3A_norm);
+        }
+        row[0] = row[1]; row[1] = row[2]; row[2] = x10;
+        row[3] = row[4]; row[4] = row[5]; row[5] = x20;
+    }
+
+    // restore row order
+    int rotation = number_of_prns_CPU % 3;
+    if (rotation) {
+        double* ordered = (double*) calloc(6 * (size_t) n,sizeof(double));
+        for (int k=0; k<6; k++) memcpy(ordered + k * n,row[k],n * sizeof(double));
+        memcpy(batch_state,ordered,6 * (size_t) n * sizeof(double));
+        free(ordered);
+    }
+}
 
 //+++ TODO: measure PRNG performance (samples per second)
 //+++ TODO: implentation of RANLUX
@@ -1077,7 +2323,6 @@ void                PRNG::RANECU_produce_CPU(float* randoms_cpu,int number_of_pr
 
 // TODO: double precision for seed tables?
 
-// TODO: save/load prng state to/from file
 // TODO: introduce precision for output PRNs
 // TODO: check PRNs with PRNG battery tests
 
@@ -23,7 +23,10 @@ class PRNG {
                 PRNG_generator_RANMAR,                  // RANMAR generator
                 PRNG_generator_PM,                      // Park-Miller generator
 				PRNG_generator_XOR7,                    // XORSeven generator
-                PRNG_generator_RANECU                   // RANECU generator
+                PRNG_generator_RANECU,                  // RANECU generator
+                PRNG_generator_PHILOX,                  // Philox4x32-10 counter-based generator
+                PRNG_generator_RANLUXPP,                // RANLUX++ generator
+                PRNG_generator_MRG32K3A                 // MRG32k3a generator
 			} PRNG_generators;
 
             typedef enum enum_PRNG_precision{
@@ -43,11 +46,16 @@ class PRNG {
           unsigned int PRNG_srandtime;
 
           unsigned int PRNG_counter;        // counter runs of subroutine PRNG_produce
+          unsigned int PRNG_stream;         // stream number (BIGLAT sublattice, replica): XOR128, RANECU and MRG32k3a streams do not overlap
+                  bool PRNG_in_kernels;     // counter-based PRNs are computed inside consumer kernels (no PRNG_randoms traffic)
+                  bool PRNG_adaptive;       // production is sized to PRNs demand reported by consumer kernels
+                   int PRNG_samples_active; // number of PRNs, generated by each PRNG instance for current pass (PRNG_samples if not adaptive)
 #ifndef CPU_RUN
             cl_uint*   PRNG_seeds;                      // input seed table (uint)
            cl_uint4*   PRNG_seeds4;                     // input seed table (uint4)
            cl_uint4*   PRNG_seed_table_uint4;           // seed table
           cl_float4*   PRNG_seed_table_float4;          // seed table
+           cl_ulong*   PRNG_seed_table_ulong;           // seed table
                void*   PRNG_randoms;                    // output buffer for randoms
 
          unsigned int  PRNG_seed_id;                    // input seeds ID
@@ -55,18 +63,37 @@ class PRNG {
          unsigned int  PRNG_randoms_id;                 // output buffer for randoms ID
          unsigned int  PRNG_randoms_seed_id;            // kernel for seed ID
          unsigned int  PRNG_randoms_kernel_id;          // kernel ID
+         unsigned int  PRNG_demand_id;                  // PRNs demand buffer ID: [0] - float4 PRNs per consumer work-item, [1] - max float4 PRNs taken,
+                                                        // [2] - histogram bin width, [3..3+PRNG_DEMAND_BINS) - histogram of float4 PRNs taken
 
           GPU_CL::GPU* GPU0;                            // pointer to GPU instance
+
+             int  kernel_init_prns(int kernel_id);                               // setup PRNs argument of consumer kernel
+             int  kernel_init_demand(int kernel_id);                             // setup PRNs demand argument of consumer kernel
+            void  demand_initialize(unsigned int step,unsigned int worst);       // setup adaptive production: consumer stride and worst-case float4 PRNs per work-item
+            void  demand_collect(void);                                          // take the last PRNs demand histogram counts (end of run)
+             int  print_demand(char* header,int header_size);                    // PRNs demand histogram
+            void  fill(void);                                                    // fill PRNG_randoms with in-kernel PRNs of current counter
+    unsigned int  state_size(void);                                              // size of generator state for checkpoint (bytes)
+            void  state_save(FILE* stream);                                      // write generator state (seed table and CPU state)
+            bool  state_load(FILE* stream);                                      // restore generator state written by state_save
 #endif
           PRNG(void);
          ~PRNG(void);
 
           double  trunc(double x);
           void  initialize_CPU(void); //Nat
+            void  initialize_CPU(unsigned int thread);                           // CPU generator of worker thread: substream (XOR128, RANECU, MRG32k3a) or seed derived from PRNG_randseries
+            bool  substreams_CPU(void);                                          // worker threads take substreams (generator has jump-ahead)
             void  initialize(void);                                              // PRNG initialization
             void  produce(void);                                                 // PRNG produce on GPU
             void  produce_CPU(float* randoms_cpu);                               // PRNG produce on CPU (float)
             void  produce_CPU(float* randoms_cpu,int number_of_prns_CPU);        // PRNG produce on CPU (float)
+            void  skip_CPU(unsigned long long n);                                // PRNG skip n PRNs on CPU in O(log n) (XOR128, RANECU, MRG32k3a)
+            bool  batch_initialize_CPU(unsigned int instances);                  // CPU batch of independent instances (RANLUX, XOR128, RANECU, MRG32k3a)
+            void  batch_produce_CPU(float* randoms_cpu,int number_of_prns_CPU);  // batch produce on CPU: randoms_cpu[k*batch_instances+i] = k-th prn of instance i
+            void  batch_finalize_CPU(void);                                      // free batch
+    unsigned int  batch_instances;                                               // number of instances in CPU batch
     unsigned int  check(void);                                                   // PRNG compare GPU results with CPU
     unsigned int  check_seeds(void);                                             // PRNG check GPU seeds table with CPU
     unsigned int  check_range(void);                                             // PRNG check GPU produced PRNs range (0;1)
@@ -95,6 +122,30 @@ PRNG::PRNG_generators convert_uint_to_generator(unsigned int generator);
     unsigned int  randoms_size;               // size of output buffer
     unsigned int* pointer_to_randoms;         // pointer to output randoms
     unsigned int  randoms_produced;           // whole number of produced numbers (from first produced number)
+#ifndef CPU_RUN
+         #define  PRNG_MAX_CONSUMERS  32
+             int  PRNG_consumers;                              // number of kernels with PRNs argument by value
+             int  PRNG_consumer_kernel[PRNG_MAX_CONSUMERS];    // kernel IDs
+             int  PRNG_consumer_argument[PRNG_MAX_CONSUMERS];  // argument IDs
+             int  PRNG_samples_argument;                       // argument ID of samples in PRNG_randoms_kernel_id
+
+         #define  PRNG_DEMAND_PERIOD  16
+         #define  PRNG_DEMAND_BINS    16
+    unsigned int  PRNG_demand_step;           // stride of consumer work-items in PRNG_randoms (float4)
+    unsigned int  PRNG_demand_worst;          // worst-case float4 PRNs per consumer work-item
+    unsigned int  PRNG_demand_budget;         // float4 PRNs per consumer work-item allocated for current passes
+    unsigned int  PRNG_demand_passes;         // passes since last demand readout
+         cl_uint* PRNG_demand;                // host copy of PRNs demand buffer
+            bool  PRNG_demand_pending;        // demand readback is in flight
+unsigned long long  PRNG_demand_histogram[PRNG_DEMAND_BINS];   // work-item updates by float4 PRNs taken (bins of PRNG_demand[2])
+            void  demand_adapt(void);         // read PRNs demand (without waiting for device) and resize production
+            void  demand_resize(void);        // size production to demand budget
+
+           void*  state_seed_table(unsigned int* size_in_bytes);             // host copy of seed table and its size
+    unsigned int  state_CPU(unsigned char* data,bool save);                  // copy CPU state of generators to (save) or from data
+#endif
+           void*  batch_state;                // CPU batch state: rows of batch_instances elements (structure of arrays)
+            void  batch_load_CPU(unsigned int instance);                     // copy state of batch instance to CPU generator
 
         // ___ RANLUX___________________________________________________________________
          #define  RL_icons  2147483563
@@ -118,17 +169,32 @@ PRNG::PRNG_generators convert_uint_to_generator(unsigned int generator);
     unsigned int  RL_check_seeds(void);                                          // RANLUX check GPU seeds table with CPU
              int  RL_get_seed_table_index(int skip,int produced);                // RANLUX get seed table index
 
+             int  RL_batch_i24;                                                  // indices are common for all batch instances
+             int  RL_batch_j24;
+             int  RL_batch_in24;
+            void  RL_batch_initialize_CPU(void);                                 // RANLUX batch: rows 0..23 - seeds, row 24 - carry
+            void  RL_batch_produce_CPU(float* randoms_cpu,int number_of_prns_CPU);
+
         // ___ XOR128___________________________________________________________________
+         #define  XOR128_substream_log2  64     // instances are 2^64 PRNs apart
+         #define  XOR128_stream_log2     96     // streams are 2^96 PRNs apart
 #ifndef CPU_RUN
         cl_uint4  XOR128_state;
+#else
+          struct {unsigned int s[4];} XOR128_state;                          // layout of cl_uint4
 #endif
 
+            void  XOR128_jump_matrix(unsigned long long n,unsigned int log2,unsigned int (*matrix)[4]);  // matrix of n*2^log2 steps over GF(2)
+            void  XOR128_jump(unsigned int (*matrix)[4],unsigned int* state);    // state = matrix * state
+
             void  XOR128_initialize(void);                                       // XOR128 generator initialization on GPU
             void  XOR128_initialize_CPU(void);                                   // XOR128 generator initialization on CPU
     unsigned int  XOR128_produce_one_uint_CPU(void);                             // XOR128 produce one prn on CPU (unsigned integer)
            float  XOR128_produce_one_CPU(void);                                  // XOR128 produce one prn on CPU (float)
             void  XOR128_produce_CPU(float* randoms_cpu);                        // XOR128 produce on CPU (float)
             void  XOR128_produce_CPU(float* randoms_cpu,int number_of_prns_CPU); // XOR128 produce on CPU (float)
+            void  XOR128_batch_initialize_CPU(void);                             // XOR128 batch: rows 0..3 - state, instances are 2^64 PRNs apart
+            void  XOR128_batch_produce_CPU(float* randoms_cpu,int number_of_prns_CPU);
 
         // ___ RANMAR___________________________________________________________________
          #define  RM_CD (7654321.0 / 16777216.0)
@@ -196,14 +262,82 @@ PRNG::PRNG_generators convert_uint_to_generator(unsigned int generator);
          #define  RANECU_seed1  314159265
          #define  RANECU_seed2	123456789
 
+         #define  RANECU_substream_log2  36     // lanes of instances are 2^36 PRNs apart
+         #define  RANECU_stream_log2     51     // streams are 2^51 PRNs apart (2^15 lanes at most)
+
              int  RANECU_jseed1;
              int  RANECU_jseed2;
 
+            void  RANECU_jump_multipliers(unsigned long long n,unsigned int log2,unsigned int* a1,unsigned int* a2); // multipliers of n*2^log2 steps
+
             void  RANECU_initialize(void);                                       // RANECU generator initialization on GPU
             void  RANECU_initialize_CPU(void);                                   // RANECU generator initialization on CPU
            float  RANECU_produce_one_CPU(void);                                  // RANECU produce one prn on CPU (float)
             void  RANECU_produce_CPU(float* randoms_cpu);                        // RANECU produce on CPU (float)
             void  RANECU_produce_CPU(float* randoms_cpu,int number_of_prns_CPU); // RANECU produce on CPU (float)
+            void  RANECU_batch_initialize_CPU(void);                             // RANECU batch: rows 0..1 - seeds, instances are 2^36 PRNs apart
+            void  RANECU_batch_produce_CPU(float* randoms_cpu,int number_of_prns_CPU);
+
+        // ___ Philox4x32-10____________________________________________________________
+         #define  PHILOX_M0     0xD2511F53
+         #define  PHILOX_M1     0xCD9E8D57
+         #define  PHILOX_W0     0x9E3779B9
+         #define  PHILOX_W1     0xBB67AE85
+         #define  PHILOX_twom23 (1.0f / 8388608.0f)
+
+    unsigned int  PHILOX_key[2];
+    unsigned int  PHILOX_index;                                          // PRNs produced on CPU for current PRNG_counter
+#ifndef CPU_RUN
+        cl_uint4  PHILOX_state;                                          // key (s0,s1) and PRNG_counter (s2) for kernels
+#endif
+
+            void  PHILOX_initialize(void);                                       // Philox generator initialization on GPU
+            void  PHILOX_initialize_CPU(void);                                   // Philox generator initialization on CPU
+            void  PHILOX_block_CPU(const unsigned int* counter,unsigned int* result); // Philox4x32-10 block on CPU
+           float  PHILOX_produce_one_CPU(void);                                  // Philox produce one prn on CPU (float)
+            void  PHILOX_produce_CPU(float* randoms_cpu);                        // Philox produce on CPU (float)
+            void  PHILOX_produce_CPU(float* randoms_cpu,int number_of_prns_CPU); // Philox produce on CPU (float)
+
+        // ___ RANLUX++_________________________________________________________________
+         #define  RLPP_words    9                   // 576-bit LCG state in 64-bit words
+         #define  RLPP_numbers  24                  // 24-bit numbers in one state
+         #define  RLPP_twom23   (1.0f / 8388608.0f)
+
+    static const unsigned long long RLPP_A[RLPP_words];                  // a^2048 mod m, m = 2^576 - 2^240 + 1
+    static const unsigned long long RLPP_m[RLPP_words];
+    unsigned long long RLPP_state[RLPP_words];
+    unsigned long long RLPP_seed;
+    unsigned int  RLPP_position;                                         // next 24-bit number in RLPP_state
+
+            void  RLPP_initialize(void);                                         // RANLUX++ generator initialization on GPU
+            void  RLPP_initialize_CPU(void);                                     // RANLUX++ generator initialization on CPU
+            void  RLPP_mulmod(const unsigned long long* a,unsigned long long* x);// x = a * x mod m
+            void  RLPP_powermod(const unsigned long long* a,unsigned long long* x,unsigned long long n); // x = a^n mod m
+            void  RLPP_skip_seed(unsigned long long* a);                         // a = RLPP_A^(2^96), distance between seeds
+    unsigned int  RLPP_produce_one_uint_CPU(void);                               // RANLUX++ produce one 24-bit number on CPU
+           float  RLPP_produce_one_CPU(void);                                    // RANLUX++ produce one prn on CPU (float)
+            void  RLPP_produce_CPU(float* randoms_cpu);                          // RANLUX++ produce on CPU (float)
+            void  RLPP_produce_CPU(float* randoms_cpu,int number_of_prns_CPU);   // RANLUX++ produce on CPU (float)
+    unsigned int  RLPP_check_seeds(void);                                        // RANLUX++ check GPU state of first instance with CPU
+
+        // ___ MRG32k3a_________________________________________________________________
+         #define  MRG32K3A_m1    4294967087
+         #define  MRG32K3A_m2    4294944443
+         #define  MRG32K3A_norm  2.3283065492957276882397381481401e-10 // 1/(2^32-208)
+         #define  MRG32K3A_substream_log2  76   // instances are 2^76 PRNs apart (as in RngStreams)
+         #define  MRG32K3A_stream_log2    127   // streams are 2^127 PRNs apart
+
+    unsigned int  MRG32K3A_state[6];                                             // x1[n-3], x1[n-2], x1[n-1], x2[n-3], x2[n-2], x2[n-1]
+
+            void  MRG32K3A_initialize(void);                                     // MRG32k3a generator initialization on GPU
+            void  MRG32K3A_initialize_CPU(void);                                 // MRG32k3a generator initialization on CPU
+            void  MRG32K3A_jump_matrix(unsigned long long n,unsigned int log2,unsigned long long* a1,unsigned long long* a2); // 3x3 matrices of n*2^log2 steps
+            void  MRG32K3A_jump(const unsigned long long* a1,const unsigned long long* a2,unsigned int* state); // state = (a1,a2) * state
+           float  MRG32K3A_produce_one_CPU(void);                                // MRG32k3a produce one prn on CPU (float)
+            void  MRG32K3A_produce_CPU(float* randoms_cpu);                      // MRG32k3a produce on CPU (float)
+            void  MRG32K3A_produce_CPU(float* randoms_cpu,int number_of_prns_CPU); // MRG32k3a produce on CPU (float)
+            void  MRG32K3A_batch_initialize_CPU(void);                           // MRG32k3a batch: rows 0..5 - state (double), instances are 2^76 PRNs apart
+            void  MRG32K3A_batch_produce_CPU(float* randoms_cpu,int number_of_prns_CPU);
 
 };
 };
@@ -67,6 +67,12 @@
 #define BID         (get_group_id(0))
 #define GROUP_SIZE  (get_local_size(0))
 
+#ifdef INDEX64
+typedef ulong   lattice_index;      // 64-bit lattice indices (lattices beyond 4G elements)
+#else
+typedef uint    lattice_index;      // 32-bit lattice indices
+#endif
+
 #ifndef N1N2
 #define N1N2        (N1 * N2)
 #endif
@@ -96,7 +102,11 @@
 #define Z   2
 #define T   3
 
+#ifdef INDEX64
+#define SITES       ((lattice_index) N1 * N2 * N3 * N4)
+#else
 #define SITES       (N1 * N2 * N3 * N4)
+#endif
 #define LINKS       (SITES * ND)
 #define SITESHALF   (SITES / 2)
 
@@ -122,6 +132,33 @@
 #ifndef PI2
 #define PI2   6.2831853071795864769252867665590    // 2*pi
 #endif
+#ifndef SQRT3
+#define SQRT3 1.7320508075688772935274463415059    // sqrt(3)
+#endif
+
+#ifndef HMC_EXP_ORDER
+#define HMC_EXP_ORDER   12      // order of Taylor series for exponentiation of SU(3) momenta
+#endif
+
+#ifdef RECT_ACTION      // improved gauge action: c0 * plaquettes + c1 * 1x2 rectangles
+#ifndef ACTION_C1
+#define ACTION_C1   (-1.0 / 12.0)               // tree-level Symanzik
+#endif
+#define ACTION_C0   (1.0 - 8.0 * (ACTION_C1))   // normalization c0 + 8 c1 = 1
+#define COLOURSITES (SITES / 8)                 // sites of one colour of rectangle update
+#ifdef PRNG_DEMAND
+#error "rectangle update takes fixed PRNs slice, it is incompatible with PRNG_DEMAND"
+#endif
+#endif
+
+#ifdef TILED_UPDATE     // tiled update: 2x2x2x2 tiles with halo in local memory, tiles of one of 8 colours per launch
+#define TILESITES   16                          // sites of tile (work-items of work-group)
+#define TILESLOTS   128                         // tile and halo sites with at most one coordinate below and one above tile
+#define TILEGROUPS  (SITES / 8)                 // work-items of one colour of tiles
+#ifdef PRNG_DEMAND
+#error "tiled update takes fixed PRNs slice, it is incompatible with PRNG_DEMAND"
+#endif
+#endif
 
 #ifndef NHIT
 #define NHIT    10
@@ -131,6 +168,45 @@
 #define PRNGSTEP    (SITES / 2)
 #endif
 
+#ifdef PRNG_DEMAND      // update kernels get PRNs allocation and report PRNs demand: [0] - float4 PRNs per work-item, [1] - max float4 PRNs taken by work-item,
+                        // [2] - width of histogram bin, [3..3+PRNG_DEMAND_BINS) - histogram of float4 PRNs taken by work-item
+#ifndef PRNG_DEMAND_BINS
+#define PRNG_DEMAND_BINS        16
+#endif
+#define PRNG_DEMAND_ARG         ,__global uint * prng_demand
+#define PRNG_DEMAND_PASS        ,prng_demand
+#define PRNG_DEMAND_REPORT(taken)   {atomic_max(&prng_demand[1],(taken)); atomic_inc(&prng_demand[3 + min((taken) / prng_demand[2],(uint) (PRNG_DEMAND_BINS - 1))]);}
+#else
+#define PRNG_DEMAND_ARG
+#define PRNG_DEMAND_PASS
+#endif
+
+#ifndef PRNG_SLICE
+#define PRNG_SLICE  (NHIT + 1)
+#endif
+
+#if defined(PRNG_DEMAND) || defined(HEATBATH_KP)
+#define PRNG_SECONDARY          // work-item that ran out of its PRNs allocation goes on with secondary stream
+#include "prngcl_philox.cl"
+#define PRNG_LIMIT_ARG          ,lattice_index indlimit,uint4* prng_key,uint* prng_secondary
+#define PRNG_LIMIT_PASS         ,indlimit,&prng_key,&prng_secondary
+#else
+#define PRNG_LIMIT_ARG
+#define PRNG_LIMIT_PASS
+#endif
+
+#ifdef HEATBATH_STATS   // update kernels accumulate heatbath statistics per work-item: x - SU(2) updates, y - tries, z - failed updates
+#define HEATBATH_STATS_ARG      ,__global uint4 * heatbath_stats
+#define HEATBATH_STATS_PASS     ,heatbath_stats
+#define HEATBATH_COUNT_ARG      ,uint4* hb_count
+#define HEATBATH_COUNT_PASS     ,&hb_count
+#else
+#define HEATBATH_STATS_ARG
+#define HEATBATH_STATS_PASS
+#define HEATBATH_COUNT_ARG
+#define HEATBATH_COUNT_PASS
+#endif
+
 typedef union _Float_and_Double{         // Float <---> Double converter
                 float       flVal[2];
                 hgpu_double dbVal;
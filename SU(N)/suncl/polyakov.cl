@@ -66,13 +66,13 @@ lattice_polyakov(__global hgpu_float4  * lattice_table,
     hgpu_double polyakov_loop_p2 = 0.0;
     hgpu_double polyakov_loop_p4 = 0.0;
 
-    uint gindex;
-    uint gdi = GID;
+    lattice_index gindex;
+    lattice_index gdi = GID;
     lattice_gid_to_gid_xyz(&gdi,&gindex);
 
     coords_4 coord;
     coords_4 coord10;
-    uint gdiT;
+    lattice_index gdiT;
 #if SUN == 2
     gpu_su_2 m0,m1;
     su_2 v0,v1,v2;
@@ -153,14 +153,14 @@ lattice_polyakov_diff_x(__global hgpu_float4  * lattice_table,
     hgpu_double polyakov_loop_re = 0.0;
     hgpu_double polyakov_loop_im = 0.0;
 
-    uint gindex;// -- index on the ordinar lattice
-    uint gdiK = GID;// -- index on the enlarged lattice
+    lattice_index gindex;// -- index on the ordinar lattice
+    lattice_index gdiK = GID;// -- index on the enlarged lattice
 
     lattice_gidK_x_to_gid_xyz(&gdiK,&gindex); // => 1 workgroup corresponds to the same x for N2 = N1 {z1 {=gid} = z3 * N2*PLK; N2 * PLK ~ workgroup_size}.
 
     coords_4 coord;
     coords_4 coord10;
-    uint gdiT;
+    lattice_index gdiT;
 #if SUN == 2
     gpu_su_2 m0,m1;
     su_2 v0,v1,v2;
@@ -250,14 +250,14 @@ lattice_polyakov_diff_y(__global hgpu_float4  * lattice_table,
     hgpu_double polyakov_loop_re = 0.0;
     hgpu_double polyakov_loop_im = 0.0;
 
-    uint gindex = GID;
-    uint gdiK = GID;
+    lattice_index gindex = GID;
+    lattice_index gdiK = GID;
 
     lattice_gidK_y_to_gid_xyz(&gdiK,&gindex);
     
     coords_4 coord;
     coords_4 coord10;
-    uint gdiT;
+    lattice_index gdiT;
 #if SUN == 2
     gpu_su_2 m0,m1;
     su_2 v0,v1,v2;
@@ -332,14 +332,14 @@ lattice_polyakov_diff_z(__global hgpu_float4  * lattice_table,
     hgpu_double polyakov_loop_re = 0.0;
     hgpu_double polyakov_loop_im = 0.0;
 
-    uint gindex;
-    uint gdiK = GID;
+    lattice_index gindex;
+    lattice_index gdiK = GID;
 
     lattice_gidK_z_to_gid_xyz(&gdiK,&gindex);
     
     coords_4 coord;
     coords_4 coord10;
-    uint gdiT;
+    lattice_index gdiT;
 #if SUN == 2
     gpu_su_2 m0,m1;
     su_2 v0,v1,v2;
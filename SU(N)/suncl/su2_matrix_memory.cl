@@ -53,7 +53,7 @@ matrix_times2(gpu_su_2* u,gpu_su_2* v)
 }
 
                     __attribute__((always_inline)) __private gpu_su_2
-lattice_table_2(__global hgpu_float4 * lattice_table,const coords_4 * coord,uint gindex,const uint dir,const su2_twist * twist)
+lattice_table_2(__global hgpu_float4 * lattice_table,const coords_4 * coord,lattice_index gindex,const uint dir,const su2_twist * twist)
 {
     gpu_su_2 m;
     switch (dir){
@@ -97,7 +97,7 @@ lattice_table_2(__global hgpu_float4 * lattice_table,const coords_4 * coord,uint
 }                                                                                                                                                
 
                     __attribute__((always_inline)) __private gpu_su_2
-lattice_table_notwist_2(__global hgpu_float4 * lattice_table,uint gindex,const uint dir)
+lattice_table_notwist_2(__global hgpu_float4 * lattice_table,lattice_index gindex,const uint dir)
 {
     gpu_su_2 m;
     switch (dir){
@@ -122,7 +122,7 @@ lattice_table_notwist_2(__global hgpu_float4 * lattice_table,uint gindex,const u
 
 
                     __attribute__((always_inline)) void
-lattice_store_2(__global hgpu_float4 * lattice_table,gpu_su_2* m,uint gindex,const uint dir){
+lattice_store_2(__global hgpu_float4 * lattice_table,gpu_su_2* m,lattice_index gindex,const uint dir){
     switch (dir){
         case 0:
             lattice_table[gindex +  0 * ROWSIZE] = (*m).uv1;
@@ -144,4 +144,21 @@ lattice_store_2(__global hgpu_float4 * lattice_table,gpu_su_2* m,uint gindex,con
 
 
 
+#ifdef TILED_UPDATE
+                    __attribute__((always_inline)) __private gpu_su_2
+lattice_tile_2(__local hgpu_float4 * lattice_tile,int slot,const uint dir)
+{
+    // link [slot,dir] of tile in local memory (direction dir at [slot + dir * TILESLOTS])
+    gpu_su_2 m;
+    m.uv1 = lattice_tile[slot + dir * TILESLOTS];
+
+    return m;
+}
+
+                    __attribute__((always_inline)) void
+lattice_tile_store_2(__local hgpu_float4 * lattice_tile,gpu_su_2* m,int slot,const uint dir){
+    lattice_tile[slot + dir * TILESLOTS] = (*m).uv1;
+}
+#endif
+
 #endif
@@ -107,7 +107,7 @@ matrix_add2(su_2* u,su_2* v)
 }
 
                     __attribute__((always_inline)) void
-lattice_random2(gpu_su_2* matrix,__global const hgpu_prng_float4 * prns,uint gidprn)
+lattice_random2(gpu_su_2* matrix,hgpu_prng_buffer prns,lattice_index gidprn)
 {
     /* M. Di Pierro */
     gpu_su_2 m1;
@@ -119,10 +119,11 @@ lattice_random2(gpu_su_2* matrix,__global const hgpu_prng_float4 * prns,uint gid
     __private hgpu_float t1;
 
     __private hgpu_float4 rnd;
-    rnd.x = (hgpu_float) prns[gidprn].x;
-    rnd.y = (hgpu_float) prns[gidprn].y;
-    rnd.z = (hgpu_float) prns[gidprn].z;
-    rnd.w = (hgpu_float) prns[gidprn].w;
+    hgpu_prng_float4 prn = prng_load4(prns,gidprn);
+    rnd.x = (hgpu_float) prn.x;
+    rnd.y = (hgpu_float) prn.y;
+    rnd.z = (hgpu_float) prn.z;
+    rnd.w = (hgpu_float) prn.w;
 
     lattice_unity2(&m1);
 
@@ -203,18 +204,18 @@ lattice_staple_hermitian_backward2(gpu_su_2* u1, gpu_su_2* u2, gpu_su_2* u3)
 }
 
                     __attribute__((always_inline)) __private su_2
-lattice_staple_2(__global hgpu_float4 * lattice_table, uint gindex,const uint dir,const su2_twist * twist)
+lattice_staple_2(__global hgpu_float4 * lattice_table, lattice_index gindex,const uint dir,const su2_twist * twist)
 {
         coords_4 coord,coordX,coordY,coordZ,coordT;
         coords_4 coord10,coord11,coord12,coord13,coord14,coord15;
 
-        uint gdiX,   gdiY,   gdiZ,   gdiT;
-        uint gdiXm,  gdiYm,  gdiZm,  gdiTm;
+        lattice_index gdiX,   gdiY,   gdiZ,   gdiT;
+        lattice_index gdiXm,  gdiYm,  gdiZm,  gdiTm;
 
-            uint gdiYmX, gdiZmX, gdiTmX;
-            uint gdiXmY, gdiZmY, gdiTmY;
-            uint gdiYmZ, gdiXmZ, gdiTmZ;
-            uint gdiXmT, gdiYmT, gdiZmT;
+            lattice_index gdiYmX, gdiZmX, gdiTmX;
+            lattice_index gdiXmY, gdiZmY, gdiTmY;
+            lattice_index gdiYmZ, gdiXmZ, gdiTmZ;
+            lattice_index gdiXmT, gdiYmT, gdiZmT;
 
 
         gpu_su_2 m1,m2,m3;
@@ -430,8 +431,176 @@ lattice_staple_2(__global hgpu_float4 * lattice_table, uint gindex,const uint di
     return staple;
 }
 
+#ifdef RECT_ACTION
+                    __attribute__((always_inline)) __private su_2
+matrix_combine2(su_2* u,su_2* v,hgpu_float a,hgpu_float b)
+{
+    // a * u + b * v
+    su_2 tmp;
+
+    tmp.u1.re = a * (*u).u1.re + b * (*v).u1.re;    tmp.u1.im = a * (*u).u1.im + b * (*v).u1.im;
+    tmp.u2.re = a * (*u).u2.re + b * (*v).u2.re;    tmp.u2.im = a * (*u).u2.im + b * (*v).u2.im;
+
+    tmp.v1.re = a * (*u).v1.re + b * (*v).v1.re;    tmp.v1.im = a * (*u).v1.im + b * (*v).v1.im;
+    tmp.v2.re = a * (*u).v2.re + b * (*v).v2.re;    tmp.v2.im = a * (*u).v2.im + b * (*v).v2.im;
+
+    return tmp;
+}
+
+                    __attribute__((always_inline)) __private su_2
+lattice_rectangle2(gpu_su_2* u1, gpu_su_2* u2, gpu_su_2* u3, gpu_su_2* u4, gpu_su_2* u5)
+{
+    // open 1x2 rectangle u1*u2*u3*u4*u5 (hermitian conjugation is done by caller)
+    gpu_su_2 m1, m2;
+
+    m1 = matrix_times2(u1,u2);
+    m2 = matrix_times2(&m1,u3);
+    m1 = matrix_times2(&m2,u4);
+    m2 = matrix_times2(&m1,u5);
+
+    return lattice_reconstruct2(&m2);
+}
+
+                    __attribute__((always_inline)) __private su_2
+lattice_staple_rectangle2(__global hgpu_float4 * lattice_table, lattice_index gindex,const uint dir)
+{
+    // sum of six 1x2 rectangle staples of link [p,D] in every plane D-N; [p,D] * staple closes the loop
+    coords_4 coord,coordD,coordDD,coordDm,coordN,coordNm,tmp;
+    lattice_index gdiD,gdiDD,gdiDm,gdiN,gdiNN,gdiNm,gdiNmm;
+    lattice_index gdiDN,gdiDNm,gdiDNmm,gdiDmN,gdiDmNm,gdiDDNm;
+
+    gpu_su_2 m1,m2,m3,m4,m5;
+    su_2 staple,rect;
+
+    lattice_zero_2(&staple);
+    lattice_gid_to_coords(&gindex,&coord);
+
+    lattice_neighbours_gid(&coord,&coordD,&gdiD,dir);               // p+D
+    lattice_neighbours_gid(&coordD,&coordDD,&gdiDD,dir);            // p+2D
+    lattice_neighbours_gid_minus(&coord,&coordDm,&gdiDm,dir);       // p-D
+
+    for (uint nu = X; nu <= T; nu++){
+        if (nu == dir) continue;
+        lattice_neighbours_gid(&coord,&coordN,&gdiN,nu);            // p+N
+        lattice_neighbours_gid(&coordN,&tmp,&gdiNN,nu);             // p+2N
+        lattice_neighbours_gid_minus(&coord,&coordNm,&gdiNm,nu);    // p-N
+        lattice_neighbours_gid_minus(&coordNm,&tmp,&gdiNmm,nu);     // p-2N
+        lattice_neighbours_gid(&coordD,&tmp,&gdiDN,nu);             // p+D+N
+        lattice_neighbours_gid_minus(&coordD,&tmp,&gdiDNm,nu);      // p+D-N
+        lattice_neighbours_gid_minus(&tmp,&tmp,&gdiDNmm,nu);        // p+D-2N
+        lattice_neighbours_gid(&coordDm,&tmp,&gdiDmN,nu);           // p-D+N
+        lattice_neighbours_gid_minus(&coordDm,&tmp,&gdiDmNm,nu);    // p-D-N
+        lattice_neighbours_gid_minus(&coordDD,&tmp,&gdiDDNm,nu);    // p+2D-N
+
+        m1 = lattice_table_notwist_2(lattice_table,gdiD,dir);       // [p+D,D]
+        m2 = lattice_table_notwist_2(lattice_table,gdiDD,nu);       // [p+2D,N]
+        m3 = lattice_table_notwist_2(lattice_table,gdiDN,dir);      m3 = matrix_hermitian2(&m3);    // [p+D+N,D]*
+        m4 = lattice_table_notwist_2(lattice_table,gdiN,dir);       m4 = matrix_hermitian2(&m4);    // [p+N,D]*
+        m5 = lattice_table_notwist_2(lattice_table,gindex,nu);      m5 = matrix_hermitian2(&m5);    // [p,N]*
+        rect   = lattice_rectangle2(&m1,&m2,&m3,&m4,&m5);
+        staple = matrix_add2(&staple,&rect);                        // 2D x N, forward
+
+        m1 = lattice_table_notwist_2(lattice_table,gdiDDNm,nu);     m1 = matrix_hermitian2(&m1);    // [p+2D-N,N]*
+        m2 = lattice_table_notwist_2(lattice_table,gdiDNm,dir);     m2 = matrix_hermitian2(&m2);    // [p+D-N,D]*
+        m3 = lattice_table_notwist_2(lattice_table,gdiNm,dir);      m3 = matrix_hermitian2(&m3);    // [p-N,D]*
+        m4 = lattice_table_notwist_2(lattice_table,gdiNm,nu);       // [p-N,N]
+        m5 = lattice_table_notwist_2(lattice_table,gdiD,dir);       // [p+D,D]
+        rect   = lattice_rectangle2(&m5,&m1,&m2,&m3,&m4);
+        staple = matrix_add2(&staple,&rect);                        // 2D x N, backward
+
+        m1 = lattice_table_notwist_2(lattice_table,gdiD,nu);        // [p+D,N]
+        m2 = lattice_table_notwist_2(lattice_table,gdiN,dir);       m2 = matrix_hermitian2(&m2);    // [p+N,D]*
+        m3 = lattice_table_notwist_2(lattice_table,gdiDmN,dir);     m3 = matrix_hermitian2(&m3);    // [p-D+N,D]*
+        m4 = lattice_table_notwist_2(lattice_table,gdiDm,nu);       m4 = matrix_hermitian2(&m4);    // [p-D,N]*
+        m5 = lattice_table_notwist_2(lattice_table,gdiDm,dir);      // [p-D,D]
+        rect   = lattice_rectangle2(&m1,&m2,&m3,&m4,&m5);
+        staple = matrix_add2(&staple,&rect);                        // -D+D x N, forward
+
+        m1 = lattice_table_notwist_2(lattice_table,gdiDNm,nu);      m1 = matrix_hermitian2(&m1);    // [p+D-N,N]*
+        m2 = lattice_table_notwist_2(lattice_table,gdiNm,dir);      m2 = matrix_hermitian2(&m2);    // [p-N,D]*
+        m3 = lattice_table_notwist_2(lattice_table,gdiDmNm,dir);    m3 = matrix_hermitian2(&m3);    // [p-D-N,D]*
+        m4 = lattice_table_notwist_2(lattice_table,gdiDmNm,nu);     // [p-D-N,N]
+        m5 = lattice_table_notwist_2(lattice_table,gdiDm,dir);      // [p-D,D]
+        rect   = lattice_rectangle2(&m1,&m2,&m3,&m4,&m5);
+        staple = matrix_add2(&staple,&rect);                        // -D+D x N, backward
+
+        m1 = lattice_table_notwist_2(lattice_table,gdiD,nu);        // [p+D,N]
+        m2 = lattice_table_notwist_2(lattice_table,gdiDN,nu);       // [p+D+N,N]
+        m3 = lattice_table_notwist_2(lattice_table,gdiNN,dir);      m3 = matrix_hermitian2(&m3);    // [p+2N,D]*
+        m4 = lattice_table_notwist_2(lattice_table,gdiN,nu);        m4 = matrix_hermitian2(&m4);    // [p+N,N]*
+        m5 = lattice_table_notwist_2(lattice_table,gindex,nu);      m5 = matrix_hermitian2(&m5);    // [p,N]*
+        rect   = lattice_rectangle2(&m1,&m2,&m3,&m4,&m5);
+        staple = matrix_add2(&staple,&rect);                        // D x 2N, forward
+
+        m1 = lattice_table_notwist_2(lattice_table,gdiDNm,nu);      m1 = matrix_hermitian2(&m1);    // [p+D-N,N]*
+        m2 = lattice_table_notwist_2(lattice_table,gdiDNmm,nu);     m2 = matrix_hermitian2(&m2);    // [p+D-2N,N]*
+        m3 = lattice_table_notwist_2(lattice_table,gdiNmm,dir);     m3 = matrix_hermitian2(&m3);    // [p-2N,D]*
+        m4 = lattice_table_notwist_2(lattice_table,gdiNmm,nu);      // [p-2N,N]
+        m5 = lattice_table_notwist_2(lattice_table,gdiNm,nu);       // [p-N,N]
+        rect   = lattice_rectangle2(&m1,&m2,&m3,&m4,&m5);
+        staple = matrix_add2(&staple,&rect);                        // D x 2N, backward
+    }
+
+    return staple;
+}
+#endif
+
+                    __attribute__((always_inline)) __private su_2
+lattice_staple_action2(__global hgpu_float4 * lattice_table, lattice_index gindex,const uint dir,const su2_twist * twist)
+{
+    // staple of gauge action: plaquettes (Wilson) or c0 * plaquettes + c1 * rectangles (improved actions)
+    su_2 staple = lattice_staple_2(lattice_table,gindex,dir,twist);
+#ifdef RECT_ACTION
+    su_2 rect   = lattice_staple_rectangle2(lattice_table,gindex,dir);
+    staple = matrix_combine2(&staple,&rect,ACTION_C0,ACTION_C1);
+#endif
+    return staple;
+}
+
+#ifdef TILED_UPDATE
+                    __attribute__((always_inline)) __private su_2
+lattice_staple_tile_2(__local hgpu_float4 * lattice_tile,const uint* w,const uint dir)
+{
+    // staple of link [w,dir] of tile site w from links in local memory (see lattice_staple_2)
+    uint wD[4],wN[4],wNm[4],wDNm[4];
+    gpu_su_2 m1,m2,m3;
+    su_2 staple,staple1;
+    int slot = lattice_tile_slot(w);
+
+    for (int i = 0; i < 4; i++) wD[i] = w[i];
+    wD[dir]++;                                                      // p+D
+    lattice_zero_2(&staple);
+
+    for (uint nu = X; nu <= T; nu++){
+        if (nu == dir) continue;
+        for (int i = 0; i < 4; i++){
+            wN[i]   = w[i];
+            wNm[i]  = w[i];
+            wDNm[i] = wD[i];
+        }
+        wN[nu]++;                                                   // p+N
+        wNm[nu]--;                                                  // p-N
+        wDNm[nu]--;                                                 // p+D-N
+
+             m1 = lattice_tile_2(lattice_tile,lattice_tile_slot(wD),nu);     // [p+D,N]
+             m2 = lattice_tile_2(lattice_tile,lattice_tile_slot(wN),dir);    // [p+N,D]
+             m3 = lattice_tile_2(lattice_tile,slot,nu);                      // [p,N]
+        staple1 = lattice_staple_hermitian2(&m1,&m2,&m3);                 //  d-n: [p+D,N] -[p+N,D]*-[p,N]*
+        staple  = matrix_add2(&staple,&staple1);
+
+             m1 = lattice_tile_2(lattice_tile,lattice_tile_slot(wDNm),nu);   // [p+D-N,N]
+             m2 = lattice_tile_2(lattice_tile,lattice_tile_slot(wNm),dir);   // [p-N,D]
+             m3 = lattice_tile_2(lattice_tile,lattice_tile_slot(wNm),nu);    // [p-N,N]
+        staple1 = lattice_staple_hermitian_backward2(&m1,&m2,&m3);        // -d-n: [p+D-N,N]*-[p-N,D]*-[p-N,N]
+        staple  = matrix_add2(&staple,&staple1);
+    }
+
+    return staple;
+}
+#endif
+
                     __attribute__((always_inline)) void
-lattice_heatbath2(su_2* a,hgpu_float* beta,__global const hgpu_prng_float4 * prns,uint* indprng)
+lattice_heatbath2(su_2* a,hgpu_float* beta,hgpu_prng_buffer prns,lattice_index* indprng PRNG_LIMIT_ARG HEATBATH_COUNT_ARG)
 {
     //Gattringer, Lang; Kennedy, Pendleton
     gpu_su_2 aH,c,d;
@@ -459,7 +628,11 @@ hgpu_float gid;
 
     bdet = (*beta) * det;                    // bdet = beta sqrt(det(a))
 
+#ifdef HEATBATH_KP
+    while (flag == false){        // Kennedy-Pendleton: tries until acceptance, secondary stream after PRNs of work-item
+#else
     while ((i < NHIT) && (flag == false)){
+#endif
 #ifdef GID_UPD
         gid = prns[(*indprng)].x;
 
@@ -474,11 +647,18 @@ rnd.y = (hgpu_float) fabs(cos((0.005*(1 + NHIT)+ 60.0/SITES)*gid));
 rnd.z = (hgpu_float) fabs(sin((0.005*(1 + NHIT)-150.0/SITES)*gid));
 rnd.w = (hgpu_float) fabs(cos((0.005*(1 + NHIT)-380.0/SITES)*gid));
 #endif
+#elif defined(PRNG_SECONDARY)
+        hgpu_prng_float4 prn = prng_next4(prns,indprng,indlimit,prng_key,prng_secondary);
+        rnd.x = (hgpu_float) prn.x;
+        rnd.y = (hgpu_float) prn.y;
+        rnd.z = (hgpu_float) prn.z;
+        rnd.w = (hgpu_float) prn.w;
 #else
-        rnd.x = (hgpu_float) prns[(*indprng)].x;
-        rnd.y = (hgpu_float) prns[(*indprng)].y;
-        rnd.z = (hgpu_float) prns[(*indprng)].z;
-        rnd.w = (hgpu_float) prns[(*indprng)].w;
+        hgpu_prng_float4 prn = prng_load4(prns,(*indprng));
+        rnd.x = (hgpu_float) prn.x;
+        rnd.y = (hgpu_float) prn.y;
+        rnd.z = (hgpu_float) prn.z;
+        rnd.w = (hgpu_float) prn.w;
         (*indprng) += PRNGSTEP;
 #endif
         cosrnd = cos(PI2 * rnd.y);
@@ -490,6 +670,11 @@ rnd.w = (hgpu_float) fabs(cos((0.005*(1 + NHIT)-380.0/SITES)*gid));
 #endif
         i++;
     }
+#ifdef HEATBATH_STATS
+    (*hb_count).x++;
+    (*hb_count).y += i;
+    if (flag == false) (*hb_count).z++;
+#endif
 
         if (flag) {
 #ifdef GID_UPD
@@ -504,11 +689,18 @@ rnd.y = (hgpu_float) fabs(sin((0.08-60.0/SITES)*gid));
 rnd.z = (hgpu_float) fabs(cos((0.08+150.0/SITES)*gid));
 rnd.w = (hgpu_float) fabs(sin((0.08+380.0/SITES)*gid));
 #endif
+#elif defined(PRNG_SECONDARY)
+            hgpu_prng_float4 prn = prng_next4(prns,indprng,indlimit,prng_key,prng_secondary);
+            rnd.x = (hgpu_float) prn.x;
+            rnd.y = (hgpu_float) prn.y;
+            rnd.z = (hgpu_float) prn.z;
+            rnd.w = (hgpu_float) prn.w;
 #else
-            rnd.x = (hgpu_float) prns[(*indprng)].x;
-            rnd.y = (hgpu_float) prns[(*indprng)].y;
-            rnd.z = (hgpu_float) prns[(*indprng)].z;
-            rnd.w = (hgpu_float) prns[(*indprng)].w;
+            hgpu_prng_float4 prn = prng_load4(prns,(*indprng));
+            rnd.x = (hgpu_float) prn.x;
+            rnd.y = (hgpu_float) prn.y;
+            rnd.z = (hgpu_float) prn.z;
+            rnd.w = (hgpu_float) prn.w;
             (*indprng) += PRNGSTEP;
 #endif
             cosal = 1.0 - delta;
@@ -531,14 +723,32 @@ rnd.w = (hgpu_float) fabs(sin((0.08+380.0/SITES)*gid));
 }
 
                     __attribute__((always_inline)) __private gpu_su_2
-lattice_heatbath_2(su_2* staple,gpu_su_2* m0,hgpu_float* beta,__global const hgpu_prng_float4 * prns)
+lattice_heatbath_2(su_2* staple,gpu_su_2* m0,hgpu_float* beta,hgpu_prng_buffer prns PRNG_DEMAND_ARG HEATBATH_STATS_ARG)
 {
     gpu_su_2 reslt;
     su_2 U1;
 
-    uint indprng = GID;
+    lattice_index indprng = GID;
+#ifdef PRNG_DEMAND
+    lattice_index indlimit = GID + prng_demand[0] * PRNGSTEP;
+    uint4 prng_key = (uint4) (0, 0, (uint) GID, 0);     // secondary stream
+    uint prng_secondary = 0;
+#elif defined(HEATBATH_KP)
+    lattice_index indlimit = GID + PRNG_SLICE * PRNGSTEP;
+    uint4 prng_key = (uint4) (0, 0, (uint) GID, 0);     // secondary stream
+    uint prng_secondary = 0;
+#endif
+#ifdef HEATBATH_STATS
+    uint4 hb_count = heatbath_stats[GID];
+#endif
 
-    lattice_heatbath2(staple,beta,prns,&indprng);
+    lattice_heatbath2(staple,beta,prns,&indprng PRNG_LIMIT_PASS HEATBATH_COUNT_PASS);
+#ifdef HEATBATH_STATS
+    heatbath_stats[GID] = hb_count;
+#endif
+#ifdef PRNG_DEMAND
+    PRNG_DEMAND_REPORT((uint) ((indprng - GID) / PRNGSTEP));
+#endif
     if(*beta < 0.0)
     {
         U1 = *staple;
@@ -546,6 +756,63 @@ lattice_heatbath_2(su_2* staple,gpu_su_2* m0,hgpu_float* beta,__global const hgp
     }
     else reslt.uv1 = (*m0).uv1;
 
+    return reslt;
+}
+
+                    __attribute__((always_inline)) __private gpu_su_2
+lattice_overrelaxation_2(su_2* staple,gpu_su_2* m0)
+{
+    // microcanonical reflection U -> aH U^+ aH, aH = [a / sqrt(det(a))]^+, a = staple: Re Tr(U a) is kept, no PRNs are consumed
+    gpu_su_2 aH,m1,reslt;
+    hgpu_float4 M;
+    hgpu_float det;
+
+    M.x = ((*staple).u1.re + (*staple).v2.re);
+    M.y = ((*staple).u1.im - (*staple).v2.im);
+    M.z = ((*staple).u2.re - (*staple).v1.re);
+    M.w = ((*staple).u2.im + (*staple).v1.im);
+
+    det = sqrt(M.x * M.x + M.y * M.y + M.z * M.z + M.w * M.w);
+    if (det <= 0.0) return (*m0);            // reflection is undefined for vanishing staple
+
+    aH.uv1.x =  M.x / det;
+    aH.uv1.z = -M.y / det;
+    aH.uv1.y = -M.z / det;
+    aH.uv1.w = -M.w / det;
+
+    m1    = matrix_hermitian2(m0);
+    m1    = matrix_times2(&aH,&m1);
+    reslt = matrix_times2(&m1,&aH);
+
+    return reslt;
+}
+
+                    __attribute__((always_inline)) void
+lattice_hmc_force_2(su_2* w,hgpu_float4* f)
+{
+    // components of -Im Tr(sigma_a W)/2, W = U * staple: force of link along generators i*sigma_a/2
+    (*f).x = -0.5 * ((*w).u2.im + (*w).v1.im);
+    (*f).y = -0.5 * ((*w).u2.re - (*w).v1.re);
+    (*f).z = -0.5 * ((*w).u1.im - (*w).v2.im);
+    (*f).w = 0.0;
+}
+
+                    __attribute__((always_inline)) __private gpu_su_2
+lattice_hmc_link_2(gpu_su_2* m0,hgpu_float4* p,hgpu_float eps)
+{
+    // U -> exp(eps P) U, exp(i theta n*sigma) = cos(theta) + i sin(theta) n*sigma
+    gpu_su_2 e,reslt;
+    hgpu_float pabs,theta,sinth,costh;
+
+    pabs  = sqrt((*p).x * (*p).x + (*p).y * (*p).y + (*p).z * (*p).z);
+    theta = 0.5 * eps * pabs;
+    sinth = hgpu_sincos(theta,&costh);
+    sinth = (pabs > 0.0) ? sinth / pabs : 0.5 * eps;
+
+    e.uv1 = (hgpu_float4) (costh, sinth * (*p).y, sinth * (*p).z, sinth * (*p).x);
+    reslt = matrix_times2(&e,m0);
+    lattice_su2_Normalize(&reslt);
+
     return reslt;
 }
 
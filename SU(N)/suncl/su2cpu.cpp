@@ -658,14 +658,16 @@ void            SU::lattice_load_cpu(model* lat,unsigned int* lattice_pointer){
 
 double*         SU::lattice_avr_plaquette_cpu(model* lat){
     double* result = new double[2];
-    coords_4 coords,coords2,coords3;
+    coords_4 coords,coords2,coords3,coords4;
 
     double plq_spat = 0.0;
     double plq_temp = 0.0;
 
     double tmp_spat,tmp_temp;
-    unsigned int gdi,gdi2,gdi3;
+    unsigned int gdi,gdi2,gdi3,gdi4;
     su_2 matrix_1,matrix_2,matrix_3,matrix_4,plaquette;
+    su_2 matrix_5,matrix_6,rectangle;
+    double rect;
     double mult = lat->BETA / ((double) lat->lattice_group);
 
     for (int x1 = 0; x1 < lat->lattice_domain_size[0]; x1++)
@@ -698,12 +700,36 @@ double*         SU::lattice_avr_plaquette_cpu(model* lat){
 
                     plaquette = lattice_plaquette2(matrix_1,matrix_2,matrix_3,matrix_4);
 
+                    // rectangles 2*dir1 x dir2 and dir1 x 2*dir2 (improved actions only)
+                    rect = 0.0;
+                    if (lat->action_c1 != 0.0) {
+                        coords4 = lattice_neighbours_coords(lat,coords2,dir1);
+                        gdi4 = lattice_coords_to_gid(lat,coords4);
+                        matrix_5 = lattice_table_2(lat,coords2,gdi2,dir1);
+                        matrix_6 = lattice_table_2(lat,coords4,gdi4,dir2);
+                        coords4 = lattice_neighbours_coords(lat,coords2,dir2);
+                        gdi4 = lattice_coords_to_gid(lat,coords4);
+                        rectangle = lattice_plaquette2(lattice_matrix_times2(matrix_1,matrix_5),matrix_6,
+                                                      lattice_matrix_times2(matrix_3,lattice_table_2(lat,coords4,gdi4,dir1)),matrix_4);
+                        rect += 2.0 - lattice_retrace(rectangle);
+
+                        coords4 = lattice_neighbours_coords(lat,coords3,dir2);
+                        gdi4 = lattice_coords_to_gid(lat,coords4);
+                        matrix_5 = lattice_table_2(lat,coords4,gdi4,dir1);
+                        coords4 = lattice_neighbours_coords(lat,coords2,dir2);
+                        gdi4 = lattice_coords_to_gid(lat,coords4);
+                        matrix_6 = lattice_table_2(lat,coords4,gdi4,dir2);
+                        rectangle = lattice_plaquette2(matrix_1,lattice_matrix_times2(matrix_2,matrix_6),
+                                                      matrix_5,lattice_matrix_times2(matrix_4,lattice_table_2(lat,coords3,gdi3,dir2)));
+                        rect += 2.0 - lattice_retrace(rectangle);
+                    }
+
                     if (dir2==(lat->lattice_nd-1)) {
                         tmp_temp = lattice_retrace(plaquette);
-                        plq_temp += mult * (2.0 - tmp_temp);
+                        plq_temp += mult * (lat->action_c0 * (2.0 - tmp_temp) + lat->action_c1 * rect);
                     } else {
                         tmp_spat = lattice_retrace(plaquette);
-                        plq_spat += mult * (2.0 - tmp_spat);
+                        plq_spat += mult * (lat->action_c0 * (2.0 - tmp_spat) + lat->action_c1 * rect);
                     }
                 }
 
@@ -1125,7 +1151,7 @@ void            SU::lattice_check_cpu(model* lat){
     lat->Analysis[DM_Plq_temp].CPU_last_value    = 0.0;
     lat->Analysis[DM_Plq_total].CPU_last_value   = 0.0;
     lat->Analysis[DM_Wilson_loop].CPU_last_value = 0.0;
-    unsigned int lattice_measurement_s = lat->lattice_measurement_size;
+    lattice_index lattice_measurement_s = lat->lattice_measurement_size;
     if ((lat->get_Fmunu)||((lat->get_F0mu))) lattice_measurement_s = lat->lattice_measurement_size_F;
 
     if (lat->lattice_pointer_last != NULL){
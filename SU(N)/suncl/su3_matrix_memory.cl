@@ -39,20 +39,73 @@
 
 #include "su3cl.cl"
 
+#ifdef SU3_COMPRESS8
+// 8-parameter links: rows (4*k + dir), k = 0,1 hold (u1, u2) and (v3, arg u3, arg w3), where w = (u x v)*
+// |u3| and |w3| follow from unit norm of row u and column 3, v1 and v2 - from (u,v) = 0 and w3 = (u1 v2 - u2 v1)*
                     __attribute__((always_inline)) __private gpu_su_3
-lattice_table_3(__global hgpu_float4 * lattice_table,const coords_4 * coord,uint gindex,const uint dir,const su3_twist * twist)
+lattice_decompress_3(hgpu_float4 c1,hgpu_float4 c2)
 {
     gpu_su_3 m;
+    hgpu_float n   = c1.x * c1.x + c1.y * c1.y + c1.z * c1.z + c1.w * c1.w;
+    if (n == (hgpu_float) 0.0) {    // padding of lattice table
+        m.uv1 = (hgpu_float4) 0.0;
+        m.uv2 = (hgpu_float4) 0.0;
+        m.uv3 = (hgpu_float4) 0.0;
+        return m;
+    }
+    n = fmin(n, (hgpu_float) 1.0);  // |u1|^2 + |u2|^2 <= 1 up to rounding
+    hgpu_float n1  = ((hgpu_float) 1.0) / n;
+    hgpu_float au3 = sqrt(fmax((hgpu_float) 0.0, ((hgpu_float) 1.0) - n));
+    hgpu_float aw3 = sqrt(fmax((hgpu_float) 0.0, n - c2.x * c2.x - c2.y * c2.y));
+    hgpu_float u3re = au3 * cos(c2.z);
+    hgpu_float u3im = au3 * sin(c2.z);
+    hgpu_float w3re = aw3 * cos(c2.w);
+    hgpu_float w3im = aw3 * sin(c2.w);
+    hgpu_float tre  = u3re * c2.x + u3im * c2.y;    // u3* v3
+    hgpu_float tim  = u3re * c2.y - u3im * c2.x;
+
+    m.uv1 = (hgpu_float4) (c1.x, c1.z, u3re, c2.x);
+    m.uv2 = (hgpu_float4) (c1.y, c1.w, u3im, c2.y);
+    m.uv3.x = -(tre * c1.x - tim * c1.y + c1.z * w3re - c1.w * w3im) * n1;
+    m.uv3.y =  (c1.x * w3re - c1.y * w3im - c1.z * tre + c1.w * tim) * n1;
+    m.uv3.z = -(tre * c1.y + tim * c1.x - c1.z * w3im - c1.w * w3re) * n1;
+    m.uv3.w = -(c1.x * w3im + c1.y * w3re + c1.z * tim + c1.w * tre) * n1;
+
+    return m;
+}
+
+                    __attribute__((always_inline)) void
+lattice_compress_3(gpu_su_3* m,hgpu_float4* c1,hgpu_float4* c2)
+{
+    hgpu_float w3re =   (*m).uv1.x * (*m).uv3.y - (*m).uv2.x * (*m).uv3.w - (*m).uv1.y * (*m).uv3.x + (*m).uv2.y * (*m).uv3.z;
+    hgpu_float w3im = -((*m).uv1.x * (*m).uv3.w + (*m).uv2.x * (*m).uv3.y - (*m).uv1.y * (*m).uv3.z - (*m).uv2.y * (*m).uv3.x);
+
+    (*c1) = (hgpu_float4) ((*m).uv1.x, (*m).uv2.x, (*m).uv1.y, (*m).uv2.y);
+    (*c2) = (hgpu_float4) ((*m).uv1.w, (*m).uv2.w, atan2((*m).uv2.z, (*m).uv1.z), atan2(w3im, w3re));
+}
+#endif
+
+                    __attribute__((always_inline)) __private gpu_su_3
+lattice_table_3(__global hgpu_float4 * lattice_table,const coords_4 * coord,lattice_index gindex,const uint dir,const su3_twist * twist)
+{
+    gpu_su_3 m;
+#ifdef SU3_COMPRESS8
+    m = lattice_decompress_3(lattice_table[gindex + dir * ROWSIZE],lattice_table[gindex + (4 + dir) * ROWSIZE]);
+#endif
     switch (dir){
         case X:
+#ifndef SU3_COMPRESS8
             m.uv1 = lattice_table[gindex +  0 * ROWSIZE];
             m.uv2 = lattice_table[gindex +  4 * ROWSIZE];
             m.uv3 = lattice_table[gindex +  8 * ROWSIZE];
+#endif
             break;
         case Y:
+#ifndef SU3_COMPRESS8
             m.uv1 = lattice_table[gindex +  1 * ROWSIZE];
             m.uv2 = lattice_table[gindex +  5 * ROWSIZE];
             m.uv3 = lattice_table[gindex +  9 * ROWSIZE];
+#endif
 
 #ifdef  TBC
 //twist here if coord.x = N1 - 1; H = (0, 0, Hz)
@@ -98,14 +151,18 @@ lattice_table_3(__global hgpu_float4 * lattice_table,const coords_4 * coord,uint
 #endif
             break;
         case Z:
+#ifndef SU3_COMPRESS8
             m.uv1 = lattice_table[gindex +  2 * ROWSIZE];
             m.uv2 = lattice_table[gindex +  6 * ROWSIZE];
             m.uv3 = lattice_table[gindex + 10 * ROWSIZE];
+#endif
             break;
         case T:
+#ifndef SU3_COMPRESS8
             m.uv1 = lattice_table[gindex +  3 * ROWSIZE];
             m.uv2 = lattice_table[gindex +  7 * ROWSIZE];
             m.uv3 = lattice_table[gindex + 11 * ROWSIZE];
+#endif
             break;
         default:
             break;
@@ -115,9 +172,12 @@ lattice_table_3(__global hgpu_float4 * lattice_table,const coords_4 * coord,uint
 }                                                                                                                                                
 
                     __attribute__((always_inline)) __private gpu_su_3
-lattice_table_notwist_3(__global hgpu_float4 * lattice_table,uint gindex,const uint dir)
+lattice_table_notwist_3(__global hgpu_float4 * lattice_table,lattice_index gindex,const uint dir)
 {
     gpu_su_3 m;
+#ifdef SU3_COMPRESS8
+    m = lattice_decompress_3(lattice_table[gindex + dir * ROWSIZE],lattice_table[gindex + (4 + dir) * ROWSIZE]);
+#else
     switch (dir){
         case X:
             m.uv1 = lattice_table[gindex +  0 * ROWSIZE];
@@ -142,13 +202,20 @@ lattice_table_notwist_3(__global hgpu_float4 * lattice_table,uint gindex,const u
         default:
             break;
     }
+#endif
 
     return m;
 }                                                                                                                                                
 
 
                     __attribute__((always_inline)) void
-lattice_store_3(__global hgpu_float4 * lattice_table,gpu_su_3* m,uint gindex,const uint dir){
+lattice_store_3(__global hgpu_float4 * lattice_table,gpu_su_3* m,lattice_index gindex,const uint dir){
+#ifdef SU3_COMPRESS8
+    hgpu_float4 c1,c2;
+    lattice_compress_3(m,&c1,&c2);
+    lattice_table[gindex +  dir      * ROWSIZE] = c1;
+    lattice_table[gindex + (4 + dir) * ROWSIZE] = c2;
+#else
     switch (dir){
         case 0:
             lattice_table[gindex +  0 * ROWSIZE] = (*m).uv1;
@@ -173,10 +240,17 @@ lattice_store_3(__global hgpu_float4 * lattice_table,gpu_su_3* m,uint gindex,con
         default:
             break;
     }
+#endif
 }
 
 					__attribute__((always_inline)) void
-lattice_store_3_rowsize(__global hgpu_float4 * lattice_table, gpu_su_3* m, uint gindex, const uint dir, int rowsize){
+lattice_store_3_rowsize(__global hgpu_float4 * lattice_table, gpu_su_3* m, lattice_index gindex, const uint dir, int rowsize){
+#ifdef SU3_COMPRESS8
+	hgpu_float4 c1,c2;
+	lattice_compress_3(m,&c1,&c2);
+	lattice_table[gindex + dir * rowsize] = c1;
+	lattice_table[gindex + (4 + dir) * rowsize] = c2;
+#else
 	switch (dir){
 		case 0:
 			lattice_table[gindex + 0 * rowsize] = (*m).uv1;
@@ -201,9 +275,31 @@ lattice_store_3_rowsize(__global hgpu_float4 * lattice_table, gpu_su_3* m, uint
 		default:
 			break;
 	}
+#endif
 }
 
 
 
 
+#ifdef TILED_UPDATE
+                    __attribute__((always_inline)) __private gpu_su_3
+lattice_tile_3(__local hgpu_float4 * lattice_tile,int slot,const uint dir)
+{
+    // link [slot,dir] of tile in local memory (row k of direction dir at [slot + (4*k + dir) * TILESLOTS])
+    gpu_su_3 m;
+    m.uv1 = lattice_tile[slot + (0 + dir) * TILESLOTS];
+    m.uv2 = lattice_tile[slot + (4 + dir) * TILESLOTS];
+    m.uv3 = lattice_tile[slot + (8 + dir) * TILESLOTS];
+
+    return m;
+}
+
+                    __attribute__((always_inline)) void
+lattice_tile_store_3(__local hgpu_float4 * lattice_tile,gpu_su_3* m,int slot,const uint dir){
+    lattice_tile[slot + (0 + dir) * TILESLOTS] = (*m).uv1;
+    lattice_tile[slot + (4 + dir) * TILESLOTS] = (*m).uv2;
+    lattice_tile[slot + (8 + dir) * TILESLOTS] = (*m).uv3;
+}
+#endif
+
 #endif
@@ -619,6 +619,65 @@ lattice_retrace_plaquette3_double(double_su_3* m1, double_su_3* m2, double_su_3*
     return result;
 }
 
+#ifdef RECT_ACTION
+                    __attribute__((always_inline)) __private hgpu_double
+lattice_retrace_rectangle3(gpu_su_3* u1, gpu_su_3* u2, gpu_su_3* u3, gpu_su_3* u4, gpu_su_3* u5, gpu_su_3* u6)
+{
+    // Re Tr(u1 * u2 * u3 * u4^+ * u5^+ * u6^+)
+    double_su_3 m1, m2;
+    double_su_3 w1, w2;
+
+    m1 = lattice_reconstruct3_double(u1);
+    m2 = lattice_reconstruct3_double(u2);
+    w1 = matrix_times_su3_double(&m1,&m2);
+    m1 = lattice_reconstruct3_double(u3);
+    w2 = matrix_times_su3_double(&w1,&m1);
+    m1 = lattice_reconstruct3_double(u4);
+    m2 = matrix_hermitian_su3_double(&m1);
+    w1 = matrix_times_su3_double(&w2,&m2);
+    m1 = lattice_reconstruct3_double(u5);
+    m2 = matrix_hermitian_su3_double(&m1);
+    w2 = matrix_times_su3_double(&w1,&m2);
+    m1 = lattice_reconstruct3_double(u6);
+    m2 = matrix_hermitian_su3_double(&m1);
+    w1 = matrix_times_su3_double(&w2,&m2);
+
+    return matrix_retrace3_double(&w1);
+}
+
+                    __attribute__((always_inline)) __private hgpu_double
+lattice_retrace_rectangles3(__global hgpu_float4 * lattice_table,const coords_4 * coord,lattice_index gindex,const uint mu,const uint nu)
+{
+    // both 1x2 rectangles of plane mu-nu starting at p: 2mu x nu and mu x 2nu
+    coords_4 coordM,coordN,tmp;
+    lattice_index gdiM,gdiN,gdiMM,gdiNN,gdiMN;
+    gpu_su_3 m1,m2,m3,m4,m5,m6;
+    hgpu_double result;
+
+    lattice_neighbours_gid(coord,&coordM,&gdiM,mu);     // p+M
+    lattice_neighbours_gid(coord,&coordN,&gdiN,nu);     // p+N
+    lattice_neighbours_gid(&coordM,&tmp,&gdiMM,mu);     // p+2M
+    lattice_neighbours_gid(&coordN,&tmp,&gdiNN,nu);     // p+2N
+    lattice_neighbours_gid(&coordM,&tmp,&gdiMN,nu);     // p+M+N
+
+        m1 = lattice_table_notwist_3(lattice_table,gindex,mu);  // [p,M]
+        m2 = lattice_table_notwist_3(lattice_table,gdiM,mu);    // [p+M,M]
+        m3 = lattice_table_notwist_3(lattice_table,gdiMM,nu);   // [p+2M,N]
+        m4 = lattice_table_notwist_3(lattice_table,gdiMN,mu);   // [p+M+N,M]
+        m5 = lattice_table_notwist_3(lattice_table,gdiN,mu);    // [p+N,M]
+        m6 = lattice_table_notwist_3(lattice_table,gindex,nu);  // [p,N]
+    result = lattice_retrace_rectangle3(&m1,&m2,&m3,&m4,&m5,&m6);
+
+        m2 = lattice_table_notwist_3(lattice_table,gdiM,nu);    // [p+M,N]
+        m3 = lattice_table_notwist_3(lattice_table,gdiMN,nu);   // [p+M+N,N]
+        m4 = lattice_table_notwist_3(lattice_table,gdiNN,mu);   // [p+2N,M]
+        m5 = lattice_table_notwist_3(lattice_table,gdiN,nu);    // [p+N,N]
+    result += lattice_retrace_rectangle3(&m1,&m2,&m3,&m4,&m5,&m6);
+
+    return result;
+}
+#endif
+
 
 #endif
                                                                                                                                                                   
@@ -162,7 +162,7 @@ matrix_times2(gpu_su_2* u,gpu_su_2* v)
 }
 
                     __attribute__((always_inline)) void
-lattice_random3(gpu_su_3* matrix,__global const hgpu_prng_float4 * prns,uint gidprn1,uint gidprn2,uint gidprn3)
+lattice_random3(gpu_su_3* matrix,hgpu_prng_buffer prns,lattice_index gidprn1,lattice_index gidprn2,lattice_index gidprn3)
 {
     __private gpu_su_3 m1;
     __private hgpu_float4 alpha,phi;
@@ -173,20 +173,23 @@ lattice_random3(gpu_su_3* matrix,__global const hgpu_prng_float4 * prns,uint gid
     __private hgpu_float4 t1;
 
     __private hgpu_float4 rnd1,rnd2,rnd3;
-    rnd1.x = (hgpu_float) prns[gidprn1].x;
-    rnd1.y = (hgpu_float) prns[gidprn1].y;
-    rnd1.z = (hgpu_float) prns[gidprn1].z;
-    rnd1.w = (hgpu_float) prns[gidprn1].w;
-
-    rnd2.x = (hgpu_float) prns[gidprn2].x;
-    rnd2.y = (hgpu_float) prns[gidprn2].y;
-    rnd2.z = (hgpu_float) prns[gidprn2].z;
-    rnd2.w = (hgpu_float) prns[gidprn2].w;
-
-    rnd3.x = (hgpu_float) prns[gidprn3].x;
-    rnd3.y = (hgpu_float) prns[gidprn3].y;
-    rnd3.z = (hgpu_float) prns[gidprn3].z;
-    rnd3.w = (hgpu_float) prns[gidprn3].w;
+    hgpu_prng_float4 prn1 = prng_load4(prns,gidprn1);
+    rnd1.x = (hgpu_float) prn1.x;
+    rnd1.y = (hgpu_float) prn1.y;
+    rnd1.z = (hgpu_float) prn1.z;
+    rnd1.w = (hgpu_float) prn1.w;
+
+    hgpu_prng_float4 prn2 = prng_load4(prns,gidprn2);
+    rnd2.x = (hgpu_float) prn2.x;
+    rnd2.y = (hgpu_float) prn2.y;
+    rnd2.z = (hgpu_float) prn2.z;
+    rnd2.w = (hgpu_float) prn2.w;
+
+    hgpu_prng_float4 prn3 = prng_load4(prns,gidprn3);
+    rnd3.x = (hgpu_float) prn3.x;
+    rnd3.y = (hgpu_float) prn3.y;
+    rnd3.z = (hgpu_float) prn3.z;
+    rnd3.w = (hgpu_float) prn3.w;
 
     lattice_unity3(&m1);
 
@@ -338,18 +341,18 @@ lattice_staple_hermitian_backward3(gpu_su_3* u1, gpu_su_3* u2, gpu_su_3* u3)
 }
 
                     __attribute__((always_inline)) __private su_3
-lattice_staple_3(__global hgpu_float4 * lattice_table, uint gindex,const uint dir,const su3_twist * twist)
+lattice_staple_3(__global hgpu_float4 * lattice_table, lattice_index gindex,const uint dir,const su3_twist * twist)
 {
         coords_4 coord,coordX,coordY,coordZ,coordT;
         coords_4 coord10,coord11,coord12,coord13,coord14,coord15;
 
-        uint gdiX,   gdiY,   gdiZ,   gdiT;
-        uint gdiXm,  gdiYm,  gdiZm,  gdiTm;
+        lattice_index gdiX,   gdiY,   gdiZ,   gdiT;
+        lattice_index gdiXm,  gdiYm,  gdiZm,  gdiTm;
 
-            uint gdiYmX, gdiZmX, gdiTmX;
-            uint gdiXmY, gdiZmY, gdiTmY;
-            uint gdiYmZ, gdiXmZ, gdiTmZ;
-            uint gdiXmT, gdiYmT, gdiZmT;
+            lattice_index gdiYmX, gdiZmX, gdiTmX;
+            lattice_index gdiXmY, gdiZmY, gdiTmY;
+            lattice_index gdiYmZ, gdiXmZ, gdiTmZ;
+            lattice_index gdiXmT, gdiYmT, gdiZmT;
 
         gpu_su_3 m1,m2,m3;
         su_3 staple, staple1, staple2;
@@ -564,8 +567,182 @@ lattice_staple_3(__global hgpu_float4 * lattice_table, uint gindex,const uint di
     return staple;
 }
 
+#ifdef RECT_ACTION
+                    __attribute__((always_inline)) __private su_3
+matrix_combine3(su_3* u,su_3* v,hgpu_float a,hgpu_float b)
+{
+    // a * u + b * v
+    su_3 tmp;
+
+    tmp.u1.re = a * (*u).u1.re + b * (*v).u1.re;    tmp.u1.im = a * (*u).u1.im + b * (*v).u1.im;
+    tmp.u2.re = a * (*u).u2.re + b * (*v).u2.re;    tmp.u2.im = a * (*u).u2.im + b * (*v).u2.im;
+    tmp.u3.re = a * (*u).u3.re + b * (*v).u3.re;    tmp.u3.im = a * (*u).u3.im + b * (*v).u3.im;
+
+    tmp.v1.re = a * (*u).v1.re + b * (*v).v1.re;    tmp.v1.im = a * (*u).v1.im + b * (*v).v1.im;
+    tmp.v2.re = a * (*u).v2.re + b * (*v).v2.re;    tmp.v2.im = a * (*u).v2.im + b * (*v).v2.im;
+    tmp.v3.re = a * (*u).v3.re + b * (*v).v3.re;    tmp.v3.im = a * (*u).v3.im + b * (*v).v3.im;
+
+    tmp.w1.re = a * (*u).w1.re + b * (*v).w1.re;    tmp.w1.im = a * (*u).w1.im + b * (*v).w1.im;
+    tmp.w2.re = a * (*u).w2.re + b * (*v).w2.re;    tmp.w2.im = a * (*u).w2.im + b * (*v).w2.im;
+    tmp.w3.re = a * (*u).w3.re + b * (*v).w3.re;    tmp.w3.im = a * (*u).w3.im + b * (*v).w3.im;
+
+    return tmp;
+}
+
+                    __attribute__((always_inline)) __private su_3
+lattice_rectangle3(gpu_su_3* u1, gpu_su_3* u2, gpu_su_3* u3, gpu_su_3* u4, gpu_su_3* u5)
+{
+    // open 1x2 rectangle u1*u2*u3*u4*u5 (hermitian conjugation is done by caller)
+    gpu_su_3 m1, m2;
+
+    m1 = matrix_times3(u1,u2);
+    m2 = matrix_times3(&m1,u3);
+    m1 = matrix_times3(&m2,u4);
+    m2 = matrix_times3(&m1,u5);
+
+    return lattice_reconstruct3(&m2);
+}
+
+                    __attribute__((always_inline)) __private su_3
+lattice_staple_rectangle3(__global hgpu_float4 * lattice_table, lattice_index gindex,const uint dir)
+{
+    // sum of six 1x2 rectangle staples of link [p,D] in every plane D-N; [p,D] * staple closes the loop
+    coords_4 coord,coordD,coordDD,coordDm,coordN,coordNm,tmp;
+    lattice_index gdiD,gdiDD,gdiDm,gdiN,gdiNN,gdiNm,gdiNmm;
+    lattice_index gdiDN,gdiDNm,gdiDNmm,gdiDmN,gdiDmNm,gdiDDNm;
+
+    gpu_su_3 m1,m2,m3,m4,m5;
+    su_3 staple,rect;
+
+    lattice_zero_3(&staple);
+    lattice_gid_to_coords(&gindex,&coord);
+
+    lattice_neighbours_gid(&coord,&coordD,&gdiD,dir);               // p+D
+    lattice_neighbours_gid(&coordD,&coordDD,&gdiDD,dir);            // p+2D
+    lattice_neighbours_gid_minus(&coord,&coordDm,&gdiDm,dir);       // p-D
+
+    for (uint nu = X; nu <= T; nu++){
+        if (nu == dir) continue;
+        lattice_neighbours_gid(&coord,&coordN,&gdiN,nu);            // p+N
+        lattice_neighbours_gid(&coordN,&tmp,&gdiNN,nu);             // p+2N
+        lattice_neighbours_gid_minus(&coord,&coordNm,&gdiNm,nu);    // p-N
+        lattice_neighbours_gid_minus(&coordNm,&tmp,&gdiNmm,nu);     // p-2N
+        lattice_neighbours_gid(&coordD,&tmp,&gdiDN,nu);             // p+D+N
+        lattice_neighbours_gid_minus(&coordD,&tmp,&gdiDNm,nu);      // p+D-N
+        lattice_neighbours_gid_minus(&tmp,&tmp,&gdiDNmm,nu);        // p+D-2N
+        lattice_neighbours_gid(&coordDm,&tmp,&gdiDmN,nu);           // p-D+N
+        lattice_neighbours_gid_minus(&coordDm,&tmp,&gdiDmNm,nu);    // p-D-N
+        lattice_neighbours_gid_minus(&coordDD,&tmp,&gdiDDNm,nu);    // p+2D-N
+
+        m1 = lattice_table_notwist_3(lattice_table,gdiD,dir);       // [p+D,D]
+        m2 = lattice_table_notwist_3(lattice_table,gdiDD,nu);       // [p+2D,N]
+        m3 = lattice_table_notwist_3(lattice_table,gdiDN,dir);      m3 = matrix_hermitian3(&m3);    // [p+D+N,D]*
+        m4 = lattice_table_notwist_3(lattice_table,gdiN,dir);       m4 = matrix_hermitian3(&m4);    // [p+N,D]*
+        m5 = lattice_table_notwist_3(lattice_table,gindex,nu);      m5 = matrix_hermitian3(&m5);    // [p,N]*
+        rect   = lattice_rectangle3(&m1,&m2,&m3,&m4,&m5);
+        staple = matrix_add3(&staple,&rect);                        // 2D x N, forward
+
+        m1 = lattice_table_notwist_3(lattice_table,gdiDDNm,nu);     m1 = matrix_hermitian3(&m1);    // [p+2D-N,N]*
+        m2 = lattice_table_notwist_3(lattice_table,gdiDNm,dir);     m2 = matrix_hermitian3(&m2);    // [p+D-N,D]*
+        m3 = lattice_table_notwist_3(lattice_table,gdiNm,dir);      m3 = matrix_hermitian3(&m3);    // [p-N,D]*
+        m4 = lattice_table_notwist_3(lattice_table,gdiNm,nu);       // [p-N,N]
+        m5 = lattice_table_notwist_3(lattice_table,gdiD,dir);       // [p+D,D]
+        rect   = lattice_rectangle3(&m5,&m1,&m2,&m3,&m4);
+        staple = matrix_add3(&staple,&rect);                        // 2D x N, backward
+
+        m1 = lattice_table_notwist_3(lattice_table,gdiD,nu);        // [p+D,N]
+        m2 = lattice_table_notwist_3(lattice_table,gdiN,dir);       m2 = matrix_hermitian3(&m2);    // [p+N,D]*
+        m3 = lattice_table_notwist_3(lattice_table,gdiDmN,dir);     m3 = matrix_hermitian3(&m3);    // [p-D+N,D]*
+        m4 = lattice_table_notwist_3(lattice_table,gdiDm,nu);       m4 = matrix_hermitian3(&m4);    // [p-D,N]*
+        m5 = lattice_table_notwist_3(lattice_table,gdiDm,dir);      // [p-D,D]
+        rect   = lattice_rectangle3(&m1,&m2,&m3,&m4,&m5);
+        staple = matrix_add3(&staple,&rect);                        // -D+D x N, forward
+
+        m1 = lattice_table_notwist_3(lattice_table,gdiDNm,nu);      m1 = matrix_hermitian3(&m1);    // [p+D-N,N]*
+        m2 = lattice_table_notwist_3(lattice_table,gdiNm,dir);      m2 = matrix_hermitian3(&m2);    // [p-N,D]*
+        m3 = lattice_table_notwist_3(lattice_table,gdiDmNm,dir);    m3 = matrix_hermitian3(&m3);    // [p-D-N,D]*
+        m4 = lattice_table_notwist_3(lattice_table,gdiDmNm,nu);     // [p-D-N,N]
+        m5 = lattice_table_notwist_3(lattice_table,gdiDm,dir);      // [p-D,D]
+        rect   = lattice_rectangle3(&m1,&m2,&m3,&m4,&m5);
+        staple = matrix_add3(&staple,&rect);                        // -D+D x N, backward
+
+        m1 = lattice_table_notwist_3(lattice_table,gdiD,nu);        // [p+D,N]
+        m2 = lattice_table_notwist_3(lattice_table,gdiDN,nu);       // [p+D+N,N]
+        m3 = lattice_table_notwist_3(lattice_table,gdiNN,dir);      m3 = matrix_hermitian3(&m3);    // [p+2N,D]*
+        m4 = lattice_table_notwist_3(lattice_table,gdiN,nu);        m4 = matrix_hermitian3(&m4);    // [p+N,N]*
+        m5 = lattice_table_notwist_3(lattice_table,gindex,nu);      m5 = matrix_hermitian3(&m5);    // [p,N]*
+        rect   = lattice_rectangle3(&m1,&m2,&m3,&m4,&m5);
+        staple = matrix_add3(&staple,&rect);                        // D x 2N, forward
+
+        m1 = lattice_table_notwist_3(lattice_table,gdiDNm,nu);      m1 = matrix_hermitian3(&m1);    // [p+D-N,N]*
+        m2 = lattice_table_notwist_3(lattice_table,gdiDNmm,nu);     m2 = matrix_hermitian3(&m2);    // [p+D-2N,N]*
+        m3 = lattice_table_notwist_3(lattice_table,gdiNmm,dir);     m3 = matrix_hermitian3(&m3);    // [p-2N,D]*
+        m4 = lattice_table_notwist_3(lattice_table,gdiNmm,nu);      // [p-2N,N]
+        m5 = lattice_table_notwist_3(lattice_table,gdiNm,nu);       // [p-N,N]
+        rect   = lattice_rectangle3(&m1,&m2,&m3,&m4,&m5);
+        staple = matrix_add3(&staple,&rect);                        // D x 2N, backward
+    }
+
+    return staple;
+}
+#endif
+
+                    __attribute__((always_inline)) __private su_3
+lattice_staple_action3(__global hgpu_float4 * lattice_table, lattice_index gindex,const uint dir,const su3_twist * twist)
+{
+    // staple of gauge action: plaquettes (Wilson) or c0 * plaquettes + c1 * rectangles (improved actions)
+    su_3 staple = lattice_staple_3(lattice_table,gindex,dir,twist);
+#ifdef RECT_ACTION
+    su_3 rect   = lattice_staple_rectangle3(lattice_table,gindex,dir);
+    staple = matrix_combine3(&staple,&rect,ACTION_C0,ACTION_C1);
+#endif
+    return staple;
+}
+
+#ifdef TILED_UPDATE
+                    __attribute__((always_inline)) __private su_3
+lattice_staple_tile_3(__local hgpu_float4 * lattice_tile,const uint* w,const uint dir)
+{
+    // staple of link [w,dir] of tile site w from links in local memory (see lattice_staple_3)
+    uint wD[4],wN[4],wNm[4],wDNm[4];
+    gpu_su_3 m1,m2,m3;
+    su_3 staple,staple1;
+    int slot = lattice_tile_slot(w);
+
+    for (int i = 0; i < 4; i++) wD[i] = w[i];
+    wD[dir]++;                                                      // p+D
+    lattice_zero_3(&staple);
+
+    for (uint nu = X; nu <= T; nu++){
+        if (nu == dir) continue;
+        for (int i = 0; i < 4; i++){
+            wN[i]   = w[i];
+            wNm[i]  = w[i];
+            wDNm[i] = wD[i];
+        }
+        wN[nu]++;                                                   // p+N
+        wNm[nu]--;                                                  // p-N
+        wDNm[nu]--;                                                 // p+D-N
+
+             m1 = lattice_tile_3(lattice_tile,lattice_tile_slot(wD),nu);     // [p+D,N]
+             m2 = lattice_tile_3(lattice_tile,lattice_tile_slot(wN),dir);    // [p+N,D]
+             m3 = lattice_tile_3(lattice_tile,slot,nu);                      // [p,N]
+        staple1 = lattice_staple_hermitian3(&m1,&m2,&m3);                 //  d-n: [p+D,N] -[p+N,D]*-[p,N]*
+        staple  = matrix_add3(&staple,&staple1);
+
+             m1 = lattice_tile_3(lattice_tile,lattice_tile_slot(wDNm),nu);   // [p+D-N,N]
+             m2 = lattice_tile_3(lattice_tile,lattice_tile_slot(wNm),dir);   // [p-N,D]
+             m3 = lattice_tile_3(lattice_tile,lattice_tile_slot(wNm),nu);    // [p-N,N]
+        staple1 = lattice_staple_hermitian_backward3(&m1,&m2,&m3);        // -d-n: [p+D-N,N]*-[p-N,D]*-[p-N,N]
+        staple  = matrix_add3(&staple,&staple1);
+    }
+
+    return staple;
+}
+#endif
+
                     __attribute__((always_inline)) void
-lattice_heatbath2(su_2* a,hgpu_float* beta,__global const hgpu_prng_float4 * prns,uint* indprng)
+lattice_heatbath2(su_2* a,hgpu_float* beta,hgpu_prng_buffer prns,lattice_index* indprng PRNG_LIMIT_ARG HEATBATH_COUNT_ARG)
 {
     gpu_su_2 aH,c,d;
 
@@ -594,7 +771,11 @@ lattice_heatbath2(su_2* a,hgpu_float* beta,__global const hgpu_prng_float4 * prn
 
     bdet = (*beta) * det;
 
+#ifdef HEATBATH_KP
+    while (flag == false){        // Kennedy-Pendleton: tries until acceptance, secondary stream after PRNs of work-item
+#else
     while ((i < NHIT) && (flag == false)){
+#endif
 #ifdef GID_UPD
         gid = prns[(*indprng)].x;
 
@@ -609,11 +790,18 @@ rnd.y = (hgpu_float) fabs(cos((0.005*(1 + NHIT)+ 60.0/SITES)*gid));
 rnd.z = (hgpu_float) fabs(sin((0.005*(1 + NHIT)-150.0/SITES)*gid));
 rnd.w = (hgpu_float) fabs(cos((0.005*(1 + NHIT)-380.0/SITES)*gid));
 #endif
+#elif defined(PRNG_SECONDARY)
+        hgpu_prng_float4 prn = prng_next4(prns,indprng,indlimit,prng_key,prng_secondary);
+        rnd.x = (hgpu_float) prn.x;
+        rnd.y = (hgpu_float) prn.y;
+        rnd.z = (hgpu_float) prn.z;
+        rnd.w = (hgpu_float) prn.w;
 #else
-        rnd.x = (hgpu_float) prns[(*indprng)].x;
-        rnd.y = (hgpu_float) prns[(*indprng)].y;
-        rnd.z = (hgpu_float) prns[(*indprng)].z;
-        rnd.w = (hgpu_float) prns[(*indprng)].w;
+        hgpu_prng_float4 prn = prng_load4(prns,(*indprng));
+        rnd.x = (hgpu_float) prn.x;
+        rnd.y = (hgpu_float) prn.y;
+        rnd.z = (hgpu_float) prn.z;
+        rnd.w = (hgpu_float) prn.w;
         (*indprng) += PRNGSTEP;
 #endif
         cosrnd = cos(PI2 * rnd.y);
@@ -626,6 +814,11 @@ rnd.w = (hgpu_float) fabs(cos((0.005*(1 + NHIT)-380.0/SITES)*gid));
 #endif
         i++;
     }
+#ifdef HEATBATH_STATS
+    (*hb_count).x++;
+    (*hb_count).y += i;
+    if (flag == false) (*hb_count).z++;
+#endif
 
         if (flag) {
 #ifdef GID_UPD
@@ -640,11 +833,18 @@ rnd.y = (hgpu_float) fabs(sin((0.08-60.0/SITES)*gid));
 rnd.z = (hgpu_float) fabs(cos((0.08+150.0/SITES)*gid));
 rnd.w = (hgpu_float) fabs(sin((0.08+380.0/SITES)*gid));
 #endif
+#elif defined(PRNG_SECONDARY)
+            hgpu_prng_float4 prn = prng_next4(prns,indprng,indlimit,prng_key,prng_secondary);
+            rnd.x = (hgpu_float) prn.x;
+            rnd.y = (hgpu_float) prn.y;
+            rnd.z = (hgpu_float) prn.z;
+            rnd.w = (hgpu_float) prn.w;
 #else
-            rnd.x = (hgpu_float) prns[(*indprng)].x;
-            rnd.y = (hgpu_float) prns[(*indprng)].y;
-            rnd.z = (hgpu_float) prns[(*indprng)].z;
-            rnd.w = (hgpu_float) prns[(*indprng)].w;
+            hgpu_prng_float4 prn = prng_load4(prns,(*indprng));
+            rnd.x = (hgpu_float) prn.x;
+            rnd.y = (hgpu_float) prn.y;
+            rnd.z = (hgpu_float) prn.z;
+            rnd.w = (hgpu_float) prn.w;
             (*indprng) += PRNGSTEP;
 #endif
             cosal = 1.0 - delta;
@@ -668,15 +868,53 @@ rnd.w = (hgpu_float) fabs(sin((0.08+380.0/SITES)*gid));
         }
 }
 
+                    __attribute__((always_inline)) void
+lattice_overrelaxation2(su_2* a)
+{
+    // microcanonical reflection of SU(2) subgroup element: a -> aH^2, aH = [a / sqrt(det(a))]^+ keeps Re Tr(a)
+    gpu_su_2 aH,d;
+    hgpu_float det;
+
+    aH.uv1.x =  ((*a).u1.re + (*a).v2.re);
+    aH.uv1.z = -((*a).u1.im - (*a).v2.im);
+    aH.uv1.y = -((*a).u2.re - (*a).v1.re);
+    aH.uv1.w = -((*a).u2.im + (*a).v1.im);
+
+    det = sqrt(aH.uv1.x * aH.uv1.x + aH.uv1.y * aH.uv1.y + aH.uv1.z * aH.uv1.z + aH.uv1.w * aH.uv1.w);
+
+    if (det > 0.0) {
+        aH.uv1.x /= det;
+        aH.uv1.z /= det;
+        aH.uv1.y /= det;
+        aH.uv1.w /= det;
+
+        d = matrix_times2(&aH,&aH);
+        (*a) = lattice_reconstruct2(&d);
+    } else
+        lattice_unity_2(a);
+}
+
 __attribute__((always_inline)) __private gpu_su_3
-lattice_heatbath3(su_3* staple,gpu_su_3* m0,hgpu_float* beta,__global const hgpu_prng_float4 * prns)
+lattice_heatbath3(su_3* staple,gpu_su_3* m0,hgpu_float* beta,hgpu_prng_buffer prns PRNG_DEMAND_ARG HEATBATH_STATS_ARG)
 {
     gpu_su_3 reslt, Vg, m1, m2, m3;
 
 su_3 x0;
 su_3 U0;
 
-uint indprng = GID;
+lattice_index indprng = GID;
+#ifdef PRNG_DEMAND
+lattice_index indlimit = GID + prng_demand[0] * PRNGSTEP;
+uint4 prng_key = (uint4) (0, 0, (uint) GID, 0);     // secondary stream
+uint prng_secondary = 0;
+#elif defined(HEATBATH_KP)
+lattice_index indlimit = GID + PRNG_SLICE * PRNGSTEP;    // Kennedy-Pendleton tries of all subgroups share PRNs of work-item
+uint4 prng_key = (uint4) (0, 0, (uint) GID, 0);     // secondary stream
+uint prng_secondary = 0;
+#endif
+#ifdef HEATBATH_STATS
+uint4 hb_count = heatbath_stats[GID];
+#endif
 
 su_2 r0;
 
@@ -695,7 +933,7 @@ for(int j = 0; j < NHITPar; j++)
         r0.v2.re = x0.v2.re;
         r0.v2.im = x0.v2.im;
 
-        lattice_heatbath2(&r0,beta,prns,&indprng);  // r0->(heatbath)->r0
+        lattice_heatbath2(&r0,beta,prns,&indprng PRNG_LIMIT_PASS HEATBATH_COUNT_PASS);  // r0->(heatbath)->r0
         
         Vg.uv1.x = r0.u1.re;
         Vg.uv1.y = r0.u2.re;
@@ -724,7 +962,7 @@ for(int j = 0; j < NHITPar; j++)
         r0.v2.re = x0.w3.re;
         r0.v2.im = x0.w3.im;
 
-        lattice_heatbath2(&r0,beta,prns,&indprng);  // r2->(heatbath)->r2
+        lattice_heatbath2(&r0,beta,prns,&indprng PRNG_LIMIT_PASS HEATBATH_COUNT_PASS);  // r2->(heatbath)->r2
 
         Vg.uv1.x = r0.u1.re;
         Vg.uv1.y = 0.0;
@@ -753,7 +991,7 @@ for(int j = 0; j < NHITPar; j++)
         r0.v2.re = x0.w3.re;
         r0.v2.im = x0.w3.im;
 
-        lattice_heatbath2(&r0,beta,prns,&indprng);  // r4->(heatbath)->r4
+        lattice_heatbath2(&r0,beta,prns,&indprng PRNG_LIMIT_PASS HEATBATH_COUNT_PASS);  // r4->(heatbath)->r4
 
         Vg.uv1.x = 1.0;
         Vg.uv1.y = 0.0;
@@ -774,10 +1012,184 @@ for(int j = 0; j < NHITPar; j++)
         lattice_GramSchmidt3(&reslt);
         U0 = lattice_reconstruct3(&reslt);
 }
+#ifdef PRNG_DEMAND
+        PRNG_DEMAND_REPORT((uint) ((indprng - GID) / PRNGSTEP));
+#endif
+#ifdef HEATBATH_STATS
+        heatbath_stats[GID] = hb_count;
+#endif
 
         return reslt;
 }
 
+__attribute__((always_inline)) __private gpu_su_3
+lattice_overrelaxation3(su_3* staple,gpu_su_3* m0)
+{
+    // Cabibbo-Marinari sweep of microcanonical reflections over three SU(2) subgroups, no PRNs are consumed
+    gpu_su_3 reslt, Vg, m1, m2;
+
+su_3 x0;
+su_3 U0;
+
+su_2 r0;
+
+       U0 = lattice_reconstruct3(m0);
+       x0 = matrix_times_su3(&U0,staple);                                          /////////////////////////
+                                                                                   //                     //
+        r0.u1.re = x0.u1.re;                                                       //   /  u1  u2  0  \   //
+        r0.u1.im = x0.u1.im;                                                       //   |  v1  v2  0  |   //
+        r0.u2.re = x0.u2.re;                                                       //   \  0   0   1  /   //
+        r0.u2.im = x0.u2.im;                                                       //                     //
+        r0.v1.re = x0.v1.re;                                                       /////////////////////////
+        r0.v1.im = x0.v1.im;
+        r0.v2.re = x0.v2.re;
+        r0.v2.im = x0.v2.im;
+
+        lattice_overrelaxation2(&r0);                               // r0->(reflection)->r0
+        
+        Vg.uv1.x = r0.u1.re;
+        Vg.uv1.y = r0.u2.re;
+        Vg.uv1.z = 0.0;
+        Vg.uv1.w = 0.0;
+            Vg.uv2.x = r0.u1.im;
+            Vg.uv2.y = r0.u2.im;
+            Vg.uv2.z = 0.0;
+            Vg.uv2.w = 0.0;
+        Vg.uv3.x = r0.v1.re;
+        Vg.uv3.y = r0.v2.re;
+        Vg.uv3.z = r0.v1.im;
+        Vg.uv3.w = r0.v2.im;
+
+        m1 = matrix_times3(&Vg,m0);
+        U0 = lattice_reconstruct3(&m1);
+
+        x0 = matrix_times_su3(&U0,staple);                                         /////////////////////////
+                                                                                   //                     //
+        r0.u1.re = x0.u1.re;                                                       //   /  u1  0  u2  \   //
+        r0.u1.im = x0.u1.im;                                                       //   |  0   1  0   |   //
+        r0.u2.re = x0.u3.re;                                                       //   \  v1  0  v2  /   //
+        r0.u2.im = x0.u3.im;                                                       //                     //
+        r0.v1.re = x0.w1.re;                                                       /////////////////////////
+        r0.v1.im = x0.w1.im;
+        r0.v2.re = x0.w3.re;
+        r0.v2.im = x0.w3.im;
+
+        lattice_overrelaxation2(&r0);                               // r2->(reflection)->r2
+
+        Vg.uv1.x = r0.u1.re;
+        Vg.uv1.y = 0.0;
+        Vg.uv1.z = r0.u2.re;
+        Vg.uv1.w = 0.0;
+            Vg.uv2.x = r0.u1.im;
+            Vg.uv2.y = 0.0;
+            Vg.uv2.z = r0.u2.im;
+            Vg.uv2.w = 0.0;
+        Vg.uv3.x = 0.0;
+        Vg.uv3.y = 1.0;
+        Vg.uv3.z = 0.0;
+        Vg.uv3.w = 0.0;
+
+        m2 = matrix_times3(&Vg,&m1);
+        U0 = lattice_reconstruct3(&m2);
+
+        x0 = matrix_times_su3(&U0,staple);                                         /////////////////////////
+                                                                                   //                     //
+        r0.u1.re = x0.v2.re;                                                       //   / 1   0   0   \   //
+        r0.u1.im = x0.v2.im;                                                       //   | 0   u1  u2  |   //
+        r0.u2.re = x0.v3.re;                                                       //   \ 0   v1  v2  /   //
+        r0.u2.im = x0.v3.im;                                                       //                     //
+        r0.v1.re = x0.w2.re;                                                       /////////////////////////
+        r0.v1.im = x0.w2.im;
+        r0.v2.re = x0.w3.re;
+        r0.v2.im = x0.w3.im;
+
+        lattice_overrelaxation2(&r0);                               // r4->(reflection)->r4
+
+        Vg.uv1.x = 1.0;
+        Vg.uv1.y = 0.0;
+        Vg.uv1.z = 0.0;
+        Vg.uv1.w = r0.u2.re;
+            Vg.uv2.x = 0.0;
+            Vg.uv2.y = 0.0;
+            Vg.uv2.z = 0.0;
+            Vg.uv2.w = r0.u2.im;
+        Vg.uv3.x = 0.0;
+        Vg.uv3.y = r0.u1.re;
+        Vg.uv3.z = 0.0;
+        Vg.uv3.w = r0.u1.im;
+
+        reslt = matrix_times3(&Vg,&m2);
+
+        lattice_GramSchmidt3(&reslt);
+
+        return reslt;
+}
+
+                    __attribute__((always_inline)) void
+lattice_hmc_force3(su_3* w,hgpu_float4* fa,hgpu_float4* fb)
+{
+    // components of -Im Tr(lambda_a W)/2, W = U * staple: force of link along generators i*lambda_a/2
+    (*fa).x = -0.5 * ((*w).u2.im + (*w).v1.im);
+    (*fa).y = -0.5 * ((*w).u2.re - (*w).v1.re);
+    (*fa).z = -0.5 * ((*w).u1.im - (*w).v2.im);
+    (*fa).w = -0.5 * ((*w).u3.im + (*w).w1.im);
+    (*fb).x = -0.5 * ((*w).u3.re - (*w).w1.re);
+    (*fb).y = -0.5 * ((*w).v3.im + (*w).w2.im);
+    (*fb).z = -0.5 * ((*w).v3.re - (*w).w2.re);
+    (*fb).w = -0.5 * ((*w).u1.im + (*w).v2.im - 2.0 * (*w).w3.im) / SQRT3;
+}
+
+                    __attribute__((always_inline)) __private su_3
+lattice_hmc_exp3(hgpu_float4* pa,hgpu_float4* pb,hgpu_float eps)
+{
+    // exp(eps * sum_a p_a i*lambda_a/2) by Horner scheme of Taylor series
+    su_3 x,e,t;
+    hgpu_float h = 0.5 * eps;
+    hgpu_float d = (*pb).w / SQRT3;
+
+    x.u1.re = 0.0;                  x.u1.im =  h * ((*pa).z + d);
+    x.u2.re =  h * (*pa).y;         x.u2.im =  h * (*pa).x;
+    x.u3.re =  h * (*pb).x;         x.u3.im =  h * (*pa).w;
+    x.v1.re = -h * (*pa).y;         x.v1.im =  h * (*pa).x;
+    x.v2.re = 0.0;                  x.v2.im =  h * (d - (*pa).z);
+    x.v3.re =  h * (*pb).z;         x.v3.im =  h * (*pb).y;
+    x.w1.re = -h * (*pb).x;         x.w1.im =  h * (*pa).w;
+    x.w2.re = -h * (*pb).z;         x.w2.im =  h * (*pb).y;
+    x.w3.re = 0.0;                  x.w3.im = -h * 2.0 * d;
+
+    e = x;
+    for (int k = HMC_EXP_ORDER; k > 1; k--){
+        e.u1.re += k;   e.v2.re += k;   e.w3.re += k;       // e = k + x * (...)
+        t = matrix_times_su3(&x,&e);
+        e = t;
+        e.u1.re /= k;   e.u1.im /= k;   e.u2.re /= k;   e.u2.im /= k;   e.u3.re /= k;   e.u3.im /= k;
+        e.v1.re /= k;   e.v1.im /= k;   e.v2.re /= k;   e.v2.im /= k;   e.v3.re /= k;   e.v3.im /= k;
+        e.w1.re /= k;   e.w1.im /= k;   e.w2.re /= k;   e.w2.im /= k;   e.w3.re /= k;   e.w3.im /= k;
+    }
+    e.u1.re += 1.0;   e.v2.re += 1.0;   e.w3.re += 1.0;
+
+    return e;
+}
+
+                    __attribute__((always_inline)) __private gpu_su_3
+lattice_hmc_link3(gpu_su_3* m0,hgpu_float4* pa,hgpu_float4* pb,hgpu_float eps)
+{
+    // U -> exp(eps P) U
+    gpu_su_3 reslt;
+    su_3 e,u,v;
+
+    e = lattice_hmc_exp3(pa,pb,eps);
+    u = lattice_reconstruct3(m0);
+    v = matrix_times_su3(&e,&u);
+
+    reslt.uv1 = (hgpu_float4) (v.u1.re, v.u2.re, v.u3.re, v.v3.re);
+    reslt.uv2 = (hgpu_float4) (v.u1.im, v.u2.im, v.u3.im, v.v3.im);
+    reslt.uv3 = (hgpu_float4) (v.v1.re, v.v2.re, v.v1.im, v.v2.im);
+    lattice_GramSchmidt3(&reslt);
+
+    return reslt;
+}
+
 #endif
                                                                                                                                                                   
                                                                                                                                                                   
@@ -203,7 +203,20 @@ void            SU::lattice_store_3(model* lat,SU::su_3 matrix,unsigned int gind
 SU::su_3        SU::lattice_get_3(model* lat,unsigned int * lattice_table,unsigned int gindex,int dir){
     SU::su_3 result,result2;
 
-  if (lat->precision == model::model_precision_single) {
+  if (lat->link_storage == model::model_link_storage_8) {
+    // 8-parameter link: rows (4*k + dir), k = 0,1
+    double c[8], m[12];
+    for (int k = 0; k < 2; k++)
+        for (int i = 0; i < 4; i++)
+            if (lat->precision == model::model_precision_single)
+                c[4*k + i] = GPU0->convert_to_double(lattice_table[gindex*4 + i + (4*k + dir) * lat->rowsize4]);
+            else
+                c[4*k + i] = GPU0->convert_to_double(lattice_table[gindex*8 + 2*i + (8*k + 2*dir) * lat->rowsize4],lattice_table[gindex*8 + 2*i + 1 + (8*k + 2*dir) * lat->rowsize4]);
+    model::lattice_link_decompress_3(c,m);
+    result.u1.re = m[0];    result.u2.re = m[1];    result.u3.re = m[2];    result.v3.re = m[3];
+    result.u1.im = m[4];    result.u2.im = m[5];    result.u3.im = m[6];    result.v3.im = m[7];
+    result.v1.re = m[8];    result.v2.re = m[9];    result.v1.im = m[10];   result.v2.im = m[11];
+  } else if (lat->precision == model::model_precision_single) {
     switch (dir){
         case 0:
             result.u1.re = GPU0->convert_to_double(lattice_table[gindex*4     + 0 * lat->rowsize4]);
@@ -1154,14 +1167,16 @@ void            SU::lattice_load_cpu(model* lat,unsigned int* lattice_pointer){
 
 double*         SU::lattice_avr_plaquette_cpu(model* lat){
     double* result = new double[2];
-    coords_4 coords,coords2,coords3;
+    coords_4 coords,coords2,coords3,coords4;
 
     double plq_spat = 0.0;
     double plq_temp = 0.0;
 
     double tmp_spat,tmp_temp;
-    unsigned int gdi,gdi2,gdi3;
+    unsigned int gdi,gdi2,gdi3,gdi4;
     su_3 matrix_1,matrix_2,matrix_3,matrix_4,plaquette;
+    su_3 matrix_5,matrix_6,rectangle;
+    double rect;
     double mult = lat->BETA / ((double) lat->lattice_group);
 
     for (int x1 = 0; x1 < lat->lattice_domain_size[0]; x1++)
@@ -1194,12 +1209,36 @@ double*         SU::lattice_avr_plaquette_cpu(model* lat){
 
                     plaquette = lattice_plaquette3(matrix_1,matrix_2,matrix_3,matrix_4);
 
+                    // rectangles 2*dir1 x dir2 and dir1 x 2*dir2 (improved actions only)
+                    rect = 0.0;
+                    if (lat->action_c1 != 0.0) {
+                        coords4 = lattice_neighbours_coords(lat,coords2,dir1);
+                        gdi4 = lattice_coords_to_gid(lat,coords4);
+                        matrix_5 = lattice_table_3(lat,coords2,gdi2,dir1);
+                        matrix_6 = lattice_table_3(lat,coords4,gdi4,dir2);
+                        coords4 = lattice_neighbours_coords(lat,coords2,dir2);
+                        gdi4 = lattice_coords_to_gid(lat,coords4);
+                        rectangle = lattice_plaquette3(lattice_matrix_times3(matrix_1,matrix_5),matrix_6,
+                                                      lattice_matrix_times3(matrix_3,lattice_table_3(lat,coords4,gdi4,dir1)),matrix_4);
+                        rect += 3.0 - lattice_retrace(rectangle);
+
+                        coords4 = lattice_neighbours_coords(lat,coords3,dir2);
+                        gdi4 = lattice_coords_to_gid(lat,coords4);
+                        matrix_5 = lattice_table_3(lat,coords4,gdi4,dir1);
+                        coords4 = lattice_neighbours_coords(lat,coords2,dir2);
+                        gdi4 = lattice_coords_to_gid(lat,coords4);
+                        matrix_6 = lattice_table_3(lat,coords4,gdi4,dir2);
+                        rectangle = lattice_plaquette3(matrix_1,lattice_matrix_times3(matrix_2,matrix_6),
+                                                      matrix_5,lattice_matrix_times3(matrix_4,lattice_table_3(lat,coords3,gdi3,dir2)));
+                        rect += 3.0 - lattice_retrace(rectangle);
+                    }
+
                     if (dir2==(lat->lattice_nd-1)) {
                         tmp_temp = lattice_retrace(plaquette);
-                        plq_temp += mult * (3.0 - tmp_temp);
+                        plq_temp += mult * (lat->action_c0 * (3.0 - tmp_temp) + lat->action_c1 * rect);
                     } else {
                         tmp_spat = lattice_retrace(plaquette);
-                        plq_spat += mult * (3.0 - tmp_spat);
+                        plq_spat += mult * (lat->action_c0 * (3.0 - tmp_spat) + lat->action_c1 * rect);
                     }
                 }
 
@@ -1621,7 +1660,7 @@ void            SU::lattice_check_cpu(model* lat){
     lat->Analysis[DM_Plq_temp].CPU_last_value    = 0.0;
     lat->Analysis[DM_Plq_total].CPU_last_value   = 0.0;
     lat->Analysis[DM_Wilson_loop].CPU_last_value = 0.0;
-    unsigned int lattice_measurement_s = lat->lattice_measurement_size;
+    lattice_index lattice_measurement_s = lat->lattice_measurement_size;
     if ((lat->get_Fmunu)||((lat->get_F0mu))) lattice_measurement_s = lat->lattice_measurement_size_F;
 
     if (lat->lattice_pointer_last != NULL){
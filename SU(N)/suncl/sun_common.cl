@@ -38,11 +38,11 @@
 #define SUN_COMMON_CL
 
                     __attribute__((always_inline)) void
-lattice_gid_to_coords(const uint * gindex,coords_4 * coord)
+lattice_gid_to_coords(const lattice_index * gindex,coords_4 * coord)
 {
     coords_4 tmp;
-    uint z1,z2,z3,z4;
-    uint gdi = (*gindex);
+    lattice_index z1,z2,z3,z4;
+    lattice_index gdi = (*gindex);
 
     z4 = gdi / N2N3N4; 
     z1 = gdi - z4 * N2N3N4;
@@ -60,18 +60,18 @@ lattice_gid_to_coords(const uint * gindex,coords_4 * coord)
 }
 
                     __attribute__((always_inline)) void
-lattice_coords_to_gid(uint * gindex,const coords_4 * coord)
+lattice_coords_to_gid(lattice_index * gindex,const coords_4 * coord)
 {
-    (*gindex) = (*coord).y + (*coord).z * N2 + (*coord).t * N2N3 + (*coord).x * N2N3N4;
+    (*gindex) = (*coord).y + (*coord).z * N2 + (*coord).t * N2N3 + (lattice_index) (*coord).x * N2N3N4;
 }
 
                     __attribute__((always_inline)) void
-lattice_gid_to_gid_xyz(const uint * gindex,uint * gnew)
+lattice_gid_to_gid_xyz(const lattice_index * gindex,lattice_index * gnew)
 {
     coords_4 tmp;
-    uint gtmp;
-    uint z1,z2,z3,z4;
-    uint gdi = (*gindex);
+    lattice_index gtmp;
+    lattice_index z1,z2,z3,z4;
+    lattice_index gdi = (*gindex);
 
     z4 = gdi / N1N2N3;
     z1 = gdi - z4 * N1N2N3;
@@ -91,16 +91,16 @@ lattice_gid_to_gid_xyz(const uint * gindex,uint * gnew)
 
 #if (defined PLK) || (defined PLKx)
 __attribute__((always_inline)) void
-lattice_gidK_x_to_gid_xyz(const uint * gindex,uint * gnew)
+lattice_gidK_x_to_gid_xyz(const lattice_index * gindex,lattice_index * gnew)
 {
 // convert gindex[y, z, x, t] -> gnew[y, z, t, x]
 // gindex = y + z*N2 + x*N2N3 + t*N1N2N3
 //   gnew = y + z*N2 + t*N2N3 + x*N2N3N4
 // N3 -> PLK
     coords_4 tmp;
-    uint gtmp;
-    uint z1,z2,z3,z4;
-    uint gdi = (*gindex);
+    lattice_index gtmp;
+    lattice_index z1,z2,z3,z4;
+    lattice_index gdi = (*gindex);
 
 #ifdef PLKx
     z4 = gdi / (N1N2 * PLKx);
@@ -139,15 +139,15 @@ lattice_gidK_x_to_gid_xyz(const uint * gindex,uint * gnew)
 }
 
 __attribute__((always_inline)) void
-lattice_gidK_y_to_gid_xyz(const uint * gindex,uint * gnew)
+lattice_gidK_y_to_gid_xyz(const lattice_index * gindex,lattice_index * gnew)
 {
 // gindex = x + z*N1 + y*N1N3 + t*N1N2N3
 //   gnew = y + z*N2 + t*N2N3 + x*N2N3N4
 // N3 -> PLK
     coords_4 tmp;
-    uint gtmp;
-    uint z1,z2,z3,z4;
-    uint gdi = (*gindex);
+    lattice_index gtmp;
+    lattice_index z1,z2,z3,z4;
+    lattice_index gdi = (*gindex);
 
 #ifdef PLKy
     z4 = gdi / (N1N2 * PLKy);
@@ -179,15 +179,15 @@ lattice_gidK_y_to_gid_xyz(const uint * gindex,uint * gnew)
 }
 
 __attribute__((always_inline)) void
-lattice_gidK_z_to_gid_xyz(const uint * gindex,uint * gnew)
+lattice_gidK_z_to_gid_xyz(const lattice_index * gindex,lattice_index * gnew)
 {
 // gindex = x + y*N1 + z*N1N2 + t*N1N2N3
 //   gnew = y + z*N2 + t*N2N3 + x*N2N3N4
 // N2 -> PLK
     coords_4 tmp;
-    uint gtmp;
-    uint z1,z2,z3,z4;
-    uint gdi = (*gindex);
+    lattice_index gtmp;
+    lattice_index z1,z2,z3,z4;
+    lattice_index gdi = (*gindex);
 
 #ifdef PLKz
     z4 = gdi / (N1 * N3 * PLKz);
@@ -219,16 +219,16 @@ lattice_gidK_z_to_gid_xyz(const uint * gindex,uint * gnew)
 }
 
 __attribute__((always_inline)) void
-lattice_gidK_x_to_gid(const uint * gindex,uint * gnew)
+lattice_gidK_x_to_gid(const lattice_index * gindex,lattice_index * gnew)
 {
 // convert gindex[y, z, x, t] -> gnew[y, z, t, x]
 // gindex = t + y*N4 + z*N2N4 + x*N2N3N4
 //   gnew = y + z*N2 + t*N2N3 + x*N2N3N4
 // N3 -> PLK
     coords_4 tmp;
-    uint gtmp;
-    uint z1,z2,z3,z4;
-    uint gdi = (*gindex);
+    lattice_index gtmp;
+    lattice_index z1,z2,z3,z4;
+    lattice_index gdi = (*gindex);
 
 #ifdef PLKx
     z4 = gdi / (N2 * PLKx * N4);
@@ -267,15 +267,15 @@ lattice_gidK_x_to_gid(const uint * gindex,uint * gnew)
 }
 
 __attribute__((always_inline)) void
-lattice_gidK_y_to_gid(const uint * gindex,uint * gnew)
+lattice_gidK_y_to_gid(const lattice_index * gindex,lattice_index * gnew)
 {
 // gindex = t + x*N4 + z*N1N4 + y*N1N3N4
 //   gnew = y + z*N2 + t*N2N3 + x*N2N3N4
 // N3 -> PLK
     coords_4 tmp;
-    uint gtmp;
-    uint z1,z2,z3,z4;
-    uint gdi = (*gindex);
+    lattice_index gtmp;
+    lattice_index z1,z2,z3,z4;
+    lattice_index gdi = (*gindex);
 
 #ifdef PLKy
     z4 = gdi / (N1 * PLKy * N4);
@@ -307,15 +307,15 @@ lattice_gidK_y_to_gid(const uint * gindex,uint * gnew)
 }
 
 __attribute__((always_inline)) void
-lattice_gidK_z_to_gid(const uint * gindex,uint * gnew)
+lattice_gidK_z_to_gid(const lattice_index * gindex,lattice_index * gnew)
 {
 // gindex = t + y*N4 + x*N2N4 + z*N1N2N4
 //   gnew = y + z*N2 + t*N2N3 + x*N2N3N4
 // N2 -> PLK
     coords_4 tmp;
-    uint gtmp;
-    uint z1,z2,z3,z4;
-    uint gdi = (*gindex);
+    lattice_index gtmp;
+    lattice_index z1,z2,z3,z4;
+    lattice_index gdi = (*gindex);
 
 #ifdef PLKz
     z4 = gdi / (N1 * PLKz * N4);
@@ -347,10 +347,10 @@ lattice_gidK_z_to_gid(const uint * gindex,uint * gnew)
 }
 #endif
 
-                    __attribute__((always_inline)) __private uint
+                    __attribute__((always_inline)) __private lattice_index
 lattice_even_gid(void)
 {
-    uint odd_check,gindex,gde;
+    lattice_index odd_check,gindex,gde;
 
     gde = 2 * GID;
 
@@ -363,10 +363,10 @@ lattice_even_gid(void)
     return gindex;
 }
 
-                    __attribute__((always_inline)) __private uint
+                    __attribute__((always_inline)) __private lattice_index
 lattice_odd_gid(void)
 {
-    uint even_check,gindex,gde;
+    lattice_index even_check,gindex,gde;
 
     gde = 2 * GID + 1;
 
@@ -380,10 +380,10 @@ lattice_odd_gid(void)
 }
 
 #ifdef BIGLAT
-                    __attribute__((always_inline)) __private uint
+                    __attribute__((always_inline)) __private lattice_index
 Lattice_odd_gid(void)
 {
-    uint even_check,gindex,gde;
+    lattice_index even_check,gindex,gde;
 
     gde = 2 * GID + 1;
 
@@ -398,10 +398,10 @@ Lattice_odd_gid(void)
     return gindex;
 }
 
-                    __attribute__((always_inline)) __private uint
+                    __attribute__((always_inline)) __private lattice_index
 Lattice_even_gid(void)
 {
-    uint odd_check,gindex,gde;
+    lattice_index odd_check,gindex,gde;
 
     gde = 2 * GID;
 
@@ -416,10 +416,10 @@ Lattice_even_gid(void)
     return gindex;
 }
 
-                    __attribute__((always_inline)) __private uint
+                    __attribute__((always_inline)) __private lattice_index
 full_lattice_even_gid(void)
 {
-    uint odd_check,gindex,gde;
+    lattice_index odd_check,gindex,gde;
 #ifdef BIGLAT
     gde = 2 * GID + 1*N2N3N4 + LEFT_SITES;
 #else
@@ -433,10 +433,10 @@ full_lattice_even_gid(void)
     return gindex;
 }
 
-                    __attribute__((always_inline)) __private uint
+                    __attribute__((always_inline)) __private lattice_index
 full_lattice_odd_gid(void)
 {
-    uint even_check,gindex,gde;
+    lattice_index even_check,gindex,gde;
 #ifdef BIGLAT
     gde = 2 * GID + 1*N2N3N4 + LEFT_SITES + 1;
 #else
@@ -452,9 +452,9 @@ full_lattice_odd_gid(void)
 #endif
 
                     __attribute__((always_inline)) void
-lattice_neighbours_gid(const coords_4 * coord,coords_4 * coord_new,uint * gneighbour,const uint dir)
+lattice_neighbours_gid(const coords_4 * coord,coords_4 * coord_new,lattice_index * gneighbour,const uint dir)
 {
-    uint gne;
+    lattice_index gne;
     coords_4 tmp = (*coord);
 
     switch (dir){
@@ -482,9 +482,9 @@ lattice_neighbours_gid(const coords_4 * coord,coords_4 * coord_new,uint * gneigh
 }                                                                                                                                                
 
                     __attribute__((always_inline)) void
-lattice_neighbours_gid_minus(const coords_4 * coord,coords_4 * coord_new,uint * gneighbour,const uint dir)
+lattice_neighbours_gid_minus(const coords_4 * coord,coords_4 * coord_new,lattice_index * gneighbour,const uint dir)
 {
-    uint gne;
+    lattice_index gne;
     coords_4 tmp = (*coord);
 
     switch (dir){
@@ -512,4 +512,137 @@ lattice_neighbours_gid_minus(const coords_4 * coord,coords_4 * coord_new,uint *
     (*coord_new) = tmp;
 }
 
+#ifdef RECT_ACTION
+                    __attribute__((always_inline)) __private lattice_index
+lattice_colour_gid(const uint dir,const uint colour)
+{
+    // site of colour = 4 * (x_dir & 1) + ((sum of other coordinates) & 3); links [p,dir] of one colour
+    // do not enter into rectangle staples of each other (all lattice extents are multiples of 4)
+    uint n[4] = {N1, N2, N3, N4};
+    uint c[4];
+    uint order[4] = {Y, Z, T, X};                   // memory order of coordinates
+    uint quarter = (dir == Y) ? Z : Y;              // coordinate which fixes colour
+    lattice_index gdi = GID;
+    lattice_index gindex;
+    uint sum = 0;
+    coords_4 coord;
+
+    n[dir]     /= 2;
+    n[quarter] /= 4;
+    for (int i = 0; i < 4; i++){
+        c[order[i]] = gdi % n[order[i]];
+        gdi        /= n[order[i]];
+    }
+    for (uint i = X; i <= T; i++) if ((i != dir) && (i != quarter)) sum += c[i];
+
+    c[dir]     = 2 * c[dir] + (colour >> 2);
+    c[quarter] = 4 * c[quarter] + (((colour & 3) + 4 - (sum & 3)) & 3);
+
+    coord.x = c[X];
+    coord.y = c[Y];
+    coord.z = c[Z];
+    coord.t = c[T];
+    lattice_coords_to_gid(&gindex,&coord);
+
+    return gindex;
+}
+#endif
+
+#ifdef TILED_UPDATE
+                    __attribute__((always_inline)) __private void
+lattice_tile_origin(const uint colour,uint* origin)
+{
+    // origin of tile BID of colour: tile coordinates (mod 2) are (c_x ^ s, c_y ^ s, c_z ^ s, s), s = 0,1;
+    // neighbouring tiles (along one or two directions) differ in colour, so links of tiles of one colour
+    // do not enter into staples of each other and halo links do not change during launch
+    uint n[4] = {N1 / 4, N2 / 4, N3 / 4, N4 / 4};
+    uint order[4] = {Y, Z, T, X};                   // memory order of coordinates
+    uint k[4];
+    uint bid = BID;
+    uint s   = bid & 1;
+
+    bid >>= 1;
+    for (int i = 0; i < 4; i++){
+        k[order[i]] = bid % n[order[i]];
+        bid        /= n[order[i]];
+    }
+    origin[X] = 4 * k[X] + 2 * (((colour     ) & 1) ^ s);
+    origin[Y] = 4 * k[Y] + 2 * (((colour >> 1) & 1) ^ s);
+    origin[Z] = 4 * k[Z] + 2 * (((colour >> 2) & 1) ^ s);
+    origin[T] = 4 * k[T] + 2 * s;
+}
+
+                    __attribute__((always_inline)) __private int
+lattice_tile_slot(const uint* w)
+{
+    // slot of window site w (w[i] = 0 below tile, 1..2 inside, 3 above tile) in local memory,
+    // -1 if the site does not enter into staples of tile links
+    int below = -1, above = -1;
+    int bits = 0, nbits = 0;
+
+    for (int i = 0; i < 4; i++){
+        if (w[i] == 0)      {if (below >= 0) return -1; below = i;}
+        else if (w[i] == 3) {if (above >= 0) return -1; above = i;}
+        else                {bits |= (w[i] - 1) << nbits; nbits++;}
+    }
+    if ((below < 0) && (above < 0)) return bits;                            // tile:              0..15
+    if (above < 0) return 16 + 8 * below + bits;                            // below tile:       16..47
+    if (below < 0) return 48 + 8 * above + bits;                            // above tile:       48..79
+    return 80 + 4 * (3 * below + above - (above > below)) + bits;          // below and above:  80..127
+}
+
+                    __attribute__((always_inline)) __private bool
+lattice_tile_link(const uint* w,const uint dir)
+{
+    // link [w,dir] of window site enters into staples of tile links:
+    // above tile along N - links [p+N,D], D != N; below along N and above along D - link [p+D-N,N] only
+    int below = -1, above = -1;
+
+    for (int i = 0; i < 4; i++){
+        if (w[i] == 0) below = i;
+        if (w[i] == 3) above = i;
+    }
+    if (above == (int) dir) return false;
+
+    return ((below < 0) || (above < 0) || (below == (int) dir));
+}
+#endif
+
+                    __attribute__((always_inline)) hgpu_float4
+lattice_gauss4(hgpu_prng_float4* prn)
+{
+    // four normal deviates from four uniform PRNs (Box-Muller)
+    hgpu_float r1,r2,s1,c1,s2,c2;
+
+    r1 = sqrt(-2.0 * log(1.0 - (hgpu_float) (*prn).x));
+    r2 = sqrt(-2.0 * log(1.0 - (hgpu_float) (*prn).z));
+    s1 = hgpu_sincos(PI2 * (hgpu_float) (*prn).y,&c1);
+    s2 = hgpu_sincos(PI2 * (hgpu_float) (*prn).w,&c2);
+
+    return (hgpu_float4) (r1 * c1, r1 * s1, r2 * c2, r2 * s2);
+}
+
+#ifdef PRNG_SECONDARY
+                    __attribute__((always_inline)) hgpu_prng_float4
+prng_next4(hgpu_prng_buffer prns,lattice_index* indprng,lattice_index indlimit,uint4* key,uint* secondary)
+{
+    // PRNs of work-item allocation, then secondary stream: Philox keyed by the last primary PRNs, so heatbath tries are not cut;
+    // index keeps growing past the limit and overflow is still reported to host
+    hgpu_prng_float4 prn;
+    if ((*indprng) < indlimit) {
+        prn = prng_load4(prns,(*indprng));
+        (*key) = (uint4) (as_uint((float) prn.x), as_uint((float) prn.y), (uint) GID, as_uint((float) prn.z));
+    } else {
+#ifdef PRNG_PRECISION_DOUBLE
+        prn = philox_double4((*key),(*secondary));
+#else
+        prn = philox_float4((*key),(*secondary));
+#endif
+        (*secondary)++;
+    }
+    (*indprng) += PRNGSTEP;
+    return prn;
+}
+#endif
+
 #endif
@@ -62,7 +62,7 @@ lattice_measurement(__global hgpu_float4  * lattice_table,
     hgpu_double2 out2 = (hgpu_double2) 0.0;
     hgpu_double retrac_spat = 0.0;
     hgpu_double retrac_temp = 0.0;
-    uint gindex = GID;
+    lattice_index gindex = GID;
     hgpu_float bet = lattice_parameters[0];
     su2_twist twist;
     twist.phi   = lattice_parameters[1];
@@ -70,7 +70,7 @@ lattice_measurement(__global hgpu_float4  * lattice_table,
     if (GID<SITES) {
         coords_4 coord;
         coords_4 coordX,coordY,coordZ,coordT;
-        uint gdiX,gdiY,gdiZ,gdiT;
+        lattice_index gdiX,gdiY,gdiZ,gdiT;
 
         gpu_su_2 m1,m2,m3,m4,m5,m6;
 
@@ -110,9 +110,23 @@ lattice_measurement(__global hgpu_float4  * lattice_table,
             m3 = lattice_table_2(lattice_table,&coordT,gdiT,Z,&twist);   // [p+T,Z]
         retrac_temp += lattice_retrace_plaquette2(&m5,&m2,&m3,&m6); // z-t: [p,Z]-[p+Z,T]-[p+T,Z]*-[p,T]*
 
+#ifdef RECT_ACTION
+        hgpu_double rect_spat = lattice_retrace_rectangles2(lattice_table,&coord,gindex,X,Y)
+                              + lattice_retrace_rectangles2(lattice_table,&coord,gindex,X,Z)
+                              + lattice_retrace_rectangles2(lattice_table,&coord,gindex,Y,Z);
+        hgpu_double rect_temp = lattice_retrace_rectangles2(lattice_table,&coord,gindex,X,T)
+                              + lattice_retrace_rectangles2(lattice_table,&coord,gindex,Y,T)
+                              + lattice_retrace_rectangles2(lattice_table,&coord,gindex,Z,T);
+#endif
+
         // first reduction
+#ifdef RECT_ACTION
+        out.x = bet * (ACTION_C0 * (6.0 - retrac_spat) + ACTION_C1 * (12.0 - rect_spat));
+        out.y = bet * (ACTION_C0 * (6.0 - retrac_temp) + ACTION_C1 * (12.0 - rect_temp));
+#else
         out.x = bet * (6.0 - retrac_spat);
         out.y = bet * (6.0 - retrac_temp);
+#endif
     }
     reduce_first_step_val_double2(lattice_lds,&out, &out2);
     if(TID == 0) lattice_measurement[BID] = out2;
@@ -123,7 +137,7 @@ lattice_measurement(__global hgpu_float4  * lattice_table,
     hgpu_double2 out2 = (hgpu_double2) 0.0;
     hgpu_double retrac_spat = 0.0;
     hgpu_double retrac_temp = 0.0;
-    uint gindex = GID;
+    lattice_index gindex = GID;
     hgpu_float bet = lattice_parameters[0];
     su3_twist twist;
     twist.phi   = lattice_parameters[1];
@@ -132,7 +146,7 @@ lattice_measurement(__global hgpu_float4  * lattice_table,
     if (GID<SITES) {
         coords_4 coord;
         coords_4 coordX,coordY,coordZ,coordT;
-        uint gdiX,gdiY,gdiZ,gdiT;
+        lattice_index gdiX,gdiY,gdiZ,gdiT;
 
         gpu_su_3 m1,m2,m3,m4,m5,m6;
 
@@ -172,9 +186,23 @@ lattice_measurement(__global hgpu_float4  * lattice_table,
             m3 = lattice_table_3(lattice_table,&coordT,gdiT,Z,&twist);   // [p+T,Z]
         retrac_temp += lattice_retrace_plaquette3(&m5,&m2,&m3,&m6); // z-t: [p,Z]-[p+Z,T]-[p+T,Z]*-[p,T]*
 
+#ifdef RECT_ACTION
+        hgpu_double rect_spat = lattice_retrace_rectangles3(lattice_table,&coord,gindex,X,Y)
+                              + lattice_retrace_rectangles3(lattice_table,&coord,gindex,X,Z)
+                              + lattice_retrace_rectangles3(lattice_table,&coord,gindex,Y,Z);
+        hgpu_double rect_temp = lattice_retrace_rectangles3(lattice_table,&coord,gindex,X,T)
+                              + lattice_retrace_rectangles3(lattice_table,&coord,gindex,Y,T)
+                              + lattice_retrace_rectangles3(lattice_table,&coord,gindex,Z,T);
+#endif
+
         // first reduction
+#ifdef RECT_ACTION
+        out.x = bet * (ACTION_C0 * (9.0 - retrac_spat) + ACTION_C1 * (18.0 - rect_spat));
+        out.y = bet * (ACTION_C0 * (9.0 - retrac_temp) + ACTION_C1 * (18.0 - rect_temp));
+#else
 		out.x = bet * (9.0 - retrac_spat);
 		out.y = bet * (9.0 - retrac_temp);
+#endif
     }
     
     reduce_first_step_val_double2(lattice_lds,&out, &out2);
@@ -196,8 +224,8 @@ lattice_action_diff_x(__global hgpu_float4  * lattice_table,
     hgpu_double retrac_spat = 0.0;
     hgpu_double retrac_temp = 0.0;
     
-    uint gindex;// -- index on the ordinar lattice
-    uint gdiK = GID;// -- index on the enlarged lattice
+    lattice_index gindex;// -- index on the ordinar lattice
+    lattice_index gdiK = GID;// -- index on the enlarged lattice
     
     hgpu_float bet = lattice_parameters[0];
     su2_twist twist;
@@ -212,7 +240,7 @@ lattice_action_diff_x(__global hgpu_float4  * lattice_table,
 #endif
         coords_4 coord;
         coords_4 coordX,coordY,coordZ,coordT;
-        uint gdiX,gdiY,gdiZ,gdiT;
+        lattice_index gdiX,gdiY,gdiZ,gdiT;
 
         gpu_su_2 m1,m2,m3,m4,m5,m6;
 
@@ -252,8 +280,19 @@ lattice_action_diff_x(__global hgpu_float4  * lattice_table,
             m3 = lattice_table_2(lattice_table,&coordT,gdiT,Z,&twist);   // [p+T,Z]
         retrac_temp += lattice_retrace_plaquette2(&m5,&m2,&m3,&m6); // z-t: [p,Z]-[p+Z,T]-[p+T,Z]*-[p,T]*
 
+#ifdef RECT_ACTION
+        hgpu_double rect_spat = lattice_retrace_rectangles2(lattice_table,&coord,gindex,X,Y)
+                              + lattice_retrace_rectangles2(lattice_table,&coord,gindex,X,Z)
+                              + lattice_retrace_rectangles2(lattice_table,&coord,gindex,Y,Z);
+        hgpu_double rect_temp = lattice_retrace_rectangles2(lattice_table,&coord,gindex,X,T)
+                              + lattice_retrace_rectangles2(lattice_table,&coord,gindex,Y,T)
+                              + lattice_retrace_rectangles2(lattice_table,&coord,gindex,Z,T);
+        out.x = bet * (ACTION_C0 * (6.0 - retrac_spat) + ACTION_C1 * (12.0 - rect_spat));
+        out.y = bet * (ACTION_C0 * (6.0 - retrac_temp) + ACTION_C1 * (12.0 - rect_temp));
+#else
         out.x = bet * (6.0 - retrac_spat);
         out.y = bet * (6.0 - retrac_temp);
+#endif
     }
     
     // first reduction
@@ -265,8 +304,8 @@ lattice_action_diff_x(__global hgpu_float4  * lattice_table,
     hgpu_double retrac_spat = 0.0;
     hgpu_double retrac_temp = 0.0;
     
-    uint gindex;// -- index on the ordinar lattice
-    uint gdiK = GID;// -- index on the enlarged lattice
+    lattice_index gindex;// -- index on the ordinar lattice
+    lattice_index gdiK = GID;// -- index on the enlarged lattice
     
     hgpu_float bet = lattice_parameters[0];
     su3_twist twist;
@@ -282,7 +321,7 @@ lattice_action_diff_x(__global hgpu_float4  * lattice_table,
 #endif
         coords_4 coord;
         coords_4 coordX,coordY,coordZ,coordT;
-        uint gdiX,gdiY,gdiZ,gdiT;
+        lattice_index gdiX,gdiY,gdiZ,gdiT;
 
         gpu_su_3 m1,m2,m3,m4,m5,m6;
 
@@ -322,8 +361,19 @@ lattice_action_diff_x(__global hgpu_float4  * lattice_table,
             m3 = lattice_table_3(lattice_table,&coordT,gdiT,Z,&twist);   // [p+T,Z]
         retrac_temp += lattice_retrace_plaquette3(&m5,&m2,&m3,&m6); // z-t: [p,Z]-[p+Z,T]-[p+T,Z]*-[p,T]*
 
+#ifdef RECT_ACTION
+        hgpu_double rect_spat = lattice_retrace_rectangles3(lattice_table,&coord,gindex,X,Y)
+                              + lattice_retrace_rectangles3(lattice_table,&coord,gindex,X,Z)
+                              + lattice_retrace_rectangles3(lattice_table,&coord,gindex,Y,Z);
+        hgpu_double rect_temp = lattice_retrace_rectangles3(lattice_table,&coord,gindex,X,T)
+                              + lattice_retrace_rectangles3(lattice_table,&coord,gindex,Y,T)
+                              + lattice_retrace_rectangles3(lattice_table,&coord,gindex,Z,T);
+        out.x = bet * (ACTION_C0 * (9.0 - retrac_spat) + ACTION_C1 * (18.0 - rect_spat));
+        out.y = bet * (ACTION_C0 * (9.0 - retrac_temp) + ACTION_C1 * (18.0 - rect_temp));
+#else
         out.x = bet * (9.0 - retrac_spat);
         out.y = bet * (9.0 - retrac_temp);
+#endif
     }
     
     // first reduction
@@ -345,8 +395,8 @@ lattice_action_diff_y(__global hgpu_float4  * lattice_table,
     hgpu_double retrac_spat = 0.0;
     hgpu_double retrac_temp = 0.0;
     
-    uint gindex;// -- index on the ordinar lattice
-    uint gdiK = GID;// -- index on the enlarged lattice
+    lattice_index gindex;// -- index on the ordinar lattice
+    lattice_index gdiK = GID;// -- index on the enlarged lattice
     
     hgpu_float bet = lattice_parameters[0];
     su2_twist twist;
@@ -357,7 +407,7 @@ lattice_action_diff_y(__global hgpu_float4  * lattice_table,
     if (gindex<SITES) {
         coords_4 coord;
         coords_4 coordX,coordY,coordZ,coordT;
-        uint gdiX,gdiY,gdiZ,gdiT;
+        lattice_index gdiX,gdiY,gdiZ,gdiT;
 
         gpu_su_2 m1,m2,m3,m4,m5,m6;
 
@@ -397,8 +447,19 @@ lattice_action_diff_y(__global hgpu_float4  * lattice_table,
             m3 = lattice_table_2(lattice_table,&coordT,gdiT,Z,&twist);   // [p+T,Z]
         retrac_temp += lattice_retrace_plaquette2(&m5,&m2,&m3,&m6); // z-t: [p,Z]-[p+Z,T]-[p+T,Z]*-[p,T]*
 
+#ifdef RECT_ACTION
+        hgpu_double rect_spat = lattice_retrace_rectangles2(lattice_table,&coord,gindex,X,Y)
+                              + lattice_retrace_rectangles2(lattice_table,&coord,gindex,X,Z)
+                              + lattice_retrace_rectangles2(lattice_table,&coord,gindex,Y,Z);
+        hgpu_double rect_temp = lattice_retrace_rectangles2(lattice_table,&coord,gindex,X,T)
+                              + lattice_retrace_rectangles2(lattice_table,&coord,gindex,Y,T)
+                              + lattice_retrace_rectangles2(lattice_table,&coord,gindex,Z,T);
+        out.x = bet * (ACTION_C0 * (6.0 - retrac_spat) + ACTION_C1 * (12.0 - rect_spat));
+        out.y = bet * (ACTION_C0 * (6.0 - retrac_temp) + ACTION_C1 * (12.0 - rect_temp));
+#else
         out.x = bet * (6.0 - retrac_spat);
         out.y = bet * (6.0 - retrac_temp);
+#endif
     }
     
     // first reduction
@@ -410,8 +471,8 @@ lattice_action_diff_y(__global hgpu_float4  * lattice_table,
     hgpu_double retrac_spat = 0.0;
     hgpu_double retrac_temp = 0.0;
     
-    uint gindex;// -- index on the ordinar lattice
-    uint gdiK = GID;// -- index on the enlarged lattice
+    lattice_index gindex;// -- index on the ordinar lattice
+    lattice_index gdiK = GID;// -- index on the enlarged lattice
     
     hgpu_float bet = lattice_parameters[0];
     su3_twist twist;
@@ -423,7 +484,7 @@ lattice_action_diff_y(__global hgpu_float4  * lattice_table,
     if (gindex<SITES) {
         coords_4 coord;
         coords_4 coordX,coordY,coordZ,coordT;
-        uint gdiX,gdiY,gdiZ,gdiT;
+        lattice_index gdiX,gdiY,gdiZ,gdiT;
 
         gpu_su_3 m1,m2,m3,m4,m5,m6;
 
@@ -463,8 +524,19 @@ lattice_action_diff_y(__global hgpu_float4  * lattice_table,
             m3 = lattice_table_3(lattice_table,&coordT,gdiT,Z,&twist);   // [p+T,Z]
         retrac_temp += lattice_retrace_plaquette3(&m5,&m2,&m3,&m6); // z-t: [p,Z]-[p+Z,T]-[p+T,Z]*-[p,T]*
 
+#ifdef RECT_ACTION
+        hgpu_double rect_spat = lattice_retrace_rectangles3(lattice_table,&coord,gindex,X,Y)
+                              + lattice_retrace_rectangles3(lattice_table,&coord,gindex,X,Z)
+                              + lattice_retrace_rectangles3(lattice_table,&coord,gindex,Y,Z);
+        hgpu_double rect_temp = lattice_retrace_rectangles3(lattice_table,&coord,gindex,X,T)
+                              + lattice_retrace_rectangles3(lattice_table,&coord,gindex,Y,T)
+                              + lattice_retrace_rectangles3(lattice_table,&coord,gindex,Z,T);
+        out.x = bet * (ACTION_C0 * (9.0 - retrac_spat) + ACTION_C1 * (18.0 - rect_spat));
+        out.y = bet * (ACTION_C0 * (9.0 - retrac_temp) + ACTION_C1 * (18.0 - rect_temp));
+#else
         out.x = bet * (9.0 - retrac_spat);
         out.y = bet * (9.0 - retrac_temp);
+#endif
     }
     
     // first reduction
@@ -485,8 +557,8 @@ lattice_action_diff_z(__global hgpu_float4  * lattice_table,
     hgpu_double retrac_spat = 0.0;
     hgpu_double retrac_temp = 0.0;
     
-    uint gindex;// -- index on the ordinar lattice
-    uint gdiK = GID;// -- index on the enlarged lattice
+    lattice_index gindex;// -- index on the ordinar lattice
+    lattice_index gdiK = GID;// -- index on the enlarged lattice
     
     hgpu_float bet = lattice_parameters[0];
     su2_twist twist;
@@ -497,7 +569,7 @@ lattice_action_diff_z(__global hgpu_float4  * lattice_table,
     if (gindex<SITES) {
         coords_4 coord;
         coords_4 coordX,coordY,coordZ,coordT;
-        uint gdiX,gdiY,gdiZ,gdiT;
+        lattice_index gdiX,gdiY,gdiZ,gdiT;
 
         gpu_su_2 m1,m2,m3,m4,m5,m6;
 
@@ -537,8 +609,19 @@ lattice_action_diff_z(__global hgpu_float4  * lattice_table,
             m3 = lattice_table_2(lattice_table,&coordT,gdiT,Z,&twist);   // [p+T,Z]
         retrac_temp += lattice_retrace_plaquette2(&m5,&m2,&m3,&m6); // z-t: [p,Z]-[p+Z,T]-[p+T,Z]*-[p,T]*
 
+#ifdef RECT_ACTION
+        hgpu_double rect_spat = lattice_retrace_rectangles2(lattice_table,&coord,gindex,X,Y)
+                              + lattice_retrace_rectangles2(lattice_table,&coord,gindex,X,Z)
+                              + lattice_retrace_rectangles2(lattice_table,&coord,gindex,Y,Z);
+        hgpu_double rect_temp = lattice_retrace_rectangles2(lattice_table,&coord,gindex,X,T)
+                              + lattice_retrace_rectangles2(lattice_table,&coord,gindex,Y,T)
+                              + lattice_retrace_rectangles2(lattice_table,&coord,gindex,Z,T);
+        out.x = bet * (ACTION_C0 * (6.0 - retrac_spat) + ACTION_C1 * (12.0 - rect_spat));
+        out.y = bet * (ACTION_C0 * (6.0 - retrac_temp) + ACTION_C1 * (12.0 - rect_temp));
+#else
         out.x = bet * (6.0 - retrac_spat);
         out.y = bet * (6.0 - retrac_temp);
+#endif
     }
     
     // first reduction
@@ -550,8 +633,8 @@ lattice_action_diff_z(__global hgpu_float4  * lattice_table,
     hgpu_double retrac_spat = 0.0;
     hgpu_double retrac_temp = 0.0;
     
-    uint gindex;// -- index on the ordinar lattice
-    uint gdiK = GID;// -- index on the enlarged lattice
+    lattice_index gindex;// -- index on the ordinar lattice
+    lattice_index gdiK = GID;// -- index on the enlarged lattice
     
     hgpu_float bet = lattice_parameters[0];
     su3_twist twist;
@@ -563,7 +646,7 @@ lattice_action_diff_z(__global hgpu_float4  * lattice_table,
     if (gindex<SITES) {
         coords_4 coord;
         coords_4 coordX,coordY,coordZ,coordT;
-        uint gdiX,gdiY,gdiZ,gdiT;
+        lattice_index gdiX,gdiY,gdiZ,gdiT;
 
         gpu_su_3 m1,m2,m3,m4,m5,m6;
 
@@ -603,8 +686,19 @@ lattice_action_diff_z(__global hgpu_float4  * lattice_table,
             m3 = lattice_table_3(lattice_table,&coordT,gdiT,Z,&twist);   // [p+T,Z]
         retrac_temp += lattice_retrace_plaquette3(&m5,&m2,&m3,&m6); // z-t: [p,Z]-[p+Z,T]-[p+T,Z]*-[p,T]*
 
+#ifdef RECT_ACTION
+        hgpu_double rect_spat = lattice_retrace_rectangles3(lattice_table,&coord,gindex,X,Y)
+                              + lattice_retrace_rectangles3(lattice_table,&coord,gindex,X,Z)
+                              + lattice_retrace_rectangles3(lattice_table,&coord,gindex,Y,Z);
+        hgpu_double rect_temp = lattice_retrace_rectangles3(lattice_table,&coord,gindex,X,T)
+                              + lattice_retrace_rectangles3(lattice_table,&coord,gindex,Y,T)
+                              + lattice_retrace_rectangles3(lattice_table,&coord,gindex,Z,T);
+        out.x = bet * (ACTION_C0 * (9.0 - retrac_spat) + ACTION_C1 * (18.0 - rect_spat));
+        out.y = bet * (ACTION_C0 * (9.0 - retrac_temp) + ACTION_C1 * (18.0 - rect_temp));
+#else
         out.x = bet * (9.0 - retrac_spat);
         out.y = bet * (9.0 - retrac_temp);
+#endif
     }
     
     // first reduction
@@ -707,6 +801,56 @@ reduce_action_diff_z_double2(__global hgpu_double2 * lattice_measurement,
 	lattice_energies[index + offset2 * i] = out[i];
 }
 
+#ifdef HEATBATH_STATS
+                                        __kernel void
+lattice_heatbath_stats(__global uint4         * heatbath_stats,
+                       __global hgpu_double2  * lattice_heatbath_reduce,
+                       __local hgpu_double2   * lattice_lds,
+                       uint4 param)
+{
+    // heatbath counters of update work-items since previous measurement (param.x - number of work-items) are reduced and reset:
+    // [BID] - (SU(2) updates, tries), [BID + param.y] - (failed updates, 0)
+    hgpu_double2 out  = (hgpu_double2) 0.0;
+    hgpu_double2 out2 = (hgpu_double2) 0.0;
+    hgpu_double2 out3 = (hgpu_double2) 0.0;
+    hgpu_double2 out4 = (hgpu_double2) 0.0;
+
+    lattice_lds[TID] = (hgpu_double2) 0.0;
+    if (GID < param.x) {
+        uint4 hb_count = heatbath_stats[GID];
+        heatbath_stats[GID] = (uint4) 0;
+        out  = (hgpu_double2) ((hgpu_double) hb_count.x, (hgpu_double) hb_count.y);
+        out3 = (hgpu_double2) ((hgpu_double) hb_count.z, 0.0);
+    }
+    reduce_first_step_val_double2(lattice_lds,&out, &out2);
+    reduce_first_step_val_double2(lattice_lds,&out3,&out4);
+
+    if (TID == 0) {
+        lattice_heatbath_reduce[BID          ] = out2;
+        lattice_heatbath_reduce[BID + param.y] = out4;
+    }
+}
+
+                                        __kernel void
+reduce_heatbath_stats_double2(__global hgpu_double2 * lattice_heatbath_reduce,
+                              __global hgpu_double2 * lattice_heatbath_measurements,
+                              __local  hgpu_double2 * lattice_lds,
+                              uint4 param,
+                              uint index)
+{
+    // param: x - number of work groups, y - offset of failures in lattice_heatbath_reduce, z - offset of failures in lattice_heatbath_measurements
+    reduce_final_step_double2(lattice_lds,lattice_heatbath_reduce,param.x);
+    hgpu_double2 out  = lattice_lds[TID];
+    reduce_final_step_double2_offset(lattice_lds,lattice_heatbath_reduce,param.x,param.y);
+    hgpu_double2 out2 = lattice_lds[TID];
+
+    if (GID==0) {
+        lattice_heatbath_measurements[index          ] = out;
+        lattice_heatbath_measurements[index + param.z] = out2;
+    }
+}
+#endif
+
 #ifdef FMUNU
 // Fmunu measurement for H field
                                         __kernel void
@@ -738,7 +882,7 @@ lattice_measurement_plq(__global hgpu_float4  * lattice_table,
     hgpu_double retrac_spat = 0.0;
     hgpu_double retrac_temp = 0.0;
 
-    uint gindex = GID;
+    lattice_index gindex = GID;
     su2_twist twist;
     twist.phi   = lattice_parameters[1];
     hgpu_complex_double Fxy3, Fxz3, Fyz3;
@@ -748,7 +892,7 @@ lattice_measurement_plq(__global hgpu_float4  * lattice_table,
     if (GID<SITES) {
         coords_4 coord;
         coords_4 coordX,coordY,coordZ,coordT;
-        uint gdiX,gdiY,gdiZ,gdiT;
+        lattice_index gdiX,gdiY,gdiZ,gdiT;
 
         gpu_su_2 m1,m2,m3,m4,m5,m6;
 
@@ -851,7 +995,7 @@ lattice_measurement_plq(__global hgpu_float4  * lattice_table,
     hgpu_double retrac_spat = 0.0;
     hgpu_double retrac_temp = 0.0;
 
-    uint gindex = GID;
+    lattice_index gindex = GID;
     su3_twist twist;
     twist.phi   = lattice_parameters[1];
     twist.omega = lattice_parameters[2];
@@ -862,7 +1006,7 @@ lattice_measurement_plq(__global hgpu_float4  * lattice_table,
     if (GID<SITES) {
         coords_4 coord;
         coords_4 coordX,coordY,coordZ,coordT;
-        uint gdiX,gdiY,gdiZ,gdiT;
+        lattice_index gdiX,gdiY,gdiZ,gdiT;
 
         gpu_su_3 m1,m2,m3,m4,m5,m6;
 
@@ -973,7 +1117,7 @@ lattice_measurement_plq(__global hgpu_float4  * lattice_table,
     hgpu_double retrac_spat = 0.0;
     hgpu_double retrac_temp = 0.0;
 
-    uint gindex = GID;
+    lattice_index gindex = GID;
     su2_twist twist;
     twist.phi   = lattice_parameters[1];
     hgpu_complex_double Fxt3, Fyt3, Fzt3;
@@ -983,7 +1127,7 @@ lattice_measurement_plq(__global hgpu_float4  * lattice_table,
     if (GID<SITES) {
         coords_4 coord;
         coords_4 coordX,coordY,coordZ,coordT;
-        uint gdiX,gdiY,gdiZ,gdiT;
+        lattice_index gdiX,gdiY,gdiZ,gdiT;
 
         gpu_su_2 m1,m2,m3,m4,m5,m6;
 
@@ -1082,7 +1226,7 @@ lattice_measurement_plq(__global hgpu_float4  * lattice_table,
     hgpu_double retrac_spat = 0.0;
     hgpu_double retrac_temp = 0.0;
 
-    uint gindex = GID;
+    lattice_index gindex = GID;
     su3_twist twist;
     twist.phi   = lattice_parameters[1];
     twist.omega = lattice_parameters[2];
@@ -1093,7 +1237,7 @@ lattice_measurement_plq(__global hgpu_float4  * lattice_table,
     if (GID<SITES) {
         coords_4 coord;
         coords_4 coordX,coordY,coordZ,coordT;
-        uint gdiX,gdiY,gdiZ,gdiT;
+        lattice_index gdiX,gdiY,gdiZ,gdiT;
 
         gpu_su_3 m1,m2,m3,m4,m5,m6;
 
@@ -1185,7 +1329,7 @@ lattice_measurement_plq(__global hgpu_float4  * lattice_table,
     hgpu_double2 out  = (hgpu_double2) 0.0;
     hgpu_double2 out2 = (hgpu_double2) 0.0;
 
-    uint gindex = GID;
+    lattice_index gindex = GID;
     su2_twist twist;
     twist.phi   = lattice_parameters[1];
 
@@ -1196,7 +1340,7 @@ lattice_measurement_plq(__global hgpu_float4  * lattice_table,
     if (GID<SITES) {
         coords_4 coord;
         coords_4 coordX,coordY,coordZ,coordT;
-        uint gdiX,gdiY,gdiZ,gdiT;
+        lattice_index gdiX,gdiY,gdiZ,gdiT;
 
         gpu_su_2 m1,m2,m3,m4,m5,m6;
 
@@ -1247,7 +1391,7 @@ lattice_measurement_plq(__global hgpu_float4  * lattice_table,
     hgpu_double2 out  = (hgpu_double2) 0.0;
     hgpu_double2 out2 = (hgpu_double2) 0.0;
 
-    uint gindex = GID;
+    lattice_index gindex = GID;
     su3_twist twist;
     twist.phi   = lattice_parameters[1];
     twist.omega = lattice_parameters[2];
@@ -1259,7 +1403,7 @@ lattice_measurement_plq(__global hgpu_float4  * lattice_table,
     if (GID<SITES) {
         coords_4 coord;
         coords_4 coordX,coordY,coordZ,coordT;
-        uint gdiX,gdiY,gdiZ,gdiT;
+        lattice_index gdiX,gdiY,gdiZ,gdiT;
 
         gpu_su_3 m1,m2,m3,m4,m5,m6;
 
@@ -54,11 +54,11 @@
 
                                         __kernel void
 lattice_init_hot_X(__global hgpu_float4 * lattice_table,
-                   __global const hgpu_prng_float4 * prns)
+                   hgpu_prng_buffer prns)
 {
 
 #if SUN == 2
-    uint gidprn1 = GID;
+    lattice_index gidprn1 = GID;
     
     gpu_su_2 matrix;
     if (GID < SITES) {
@@ -68,9 +68,9 @@ lattice_init_hot_X(__global hgpu_float4 * lattice_table,
 #endif
 
 #if SUN == 3
-    uint gidprn1 = GID + 0 * ROWSIZE;
-    uint gidprn2 = GID + 1 * ROWSIZE;
-    uint gidprn3 = GID + 2 * ROWSIZE;
+    lattice_index gidprn1 = GID + 0 * ROWSIZE;
+    lattice_index gidprn2 = GID + 1 * ROWSIZE;
+    lattice_index gidprn3 = GID + 2 * ROWSIZE;
     gpu_su_3 matrix;
     if (GID < SITES) {
         lattice_random3(&matrix,prns,gidprn1,gidprn2,gidprn3);
@@ -81,11 +81,11 @@ lattice_init_hot_X(__global hgpu_float4 * lattice_table,
 
                                         __kernel void
 lattice_init_hot_Y(__global hgpu_float4 * lattice_table,
-                   __global const hgpu_prng_float4 * prns)
+                   hgpu_prng_buffer prns)
 {
 
 #if SUN == 2
-    uint gidprn1 = GID;
+    lattice_index gidprn1 = GID;
     
     gpu_su_2 matrix;
     if (GID < SITES) {
@@ -95,9 +95,9 @@ lattice_init_hot_Y(__global hgpu_float4 * lattice_table,
 #endif
 
 #if SUN == 3
-    uint gidprn1 = GID + 0 * ROWSIZE;
-    uint gidprn2 = GID + 1 * ROWSIZE;
-    uint gidprn3 = GID + 2 * ROWSIZE;
+    lattice_index gidprn1 = GID + 0 * ROWSIZE;
+    lattice_index gidprn2 = GID + 1 * ROWSIZE;
+    lattice_index gidprn3 = GID + 2 * ROWSIZE;
     gpu_su_3 matrix;
     if (GID < SITES) {
         lattice_random3(&matrix,prns,gidprn1,gidprn2,gidprn3);
@@ -108,11 +108,11 @@ lattice_init_hot_Y(__global hgpu_float4 * lattice_table,
 
                                         __kernel void
 lattice_init_hot_Z(__global hgpu_float4 * lattice_table,
-                   __global const hgpu_prng_float4 * prns)
+                   hgpu_prng_buffer prns)
 {
 
 #if SUN == 2
-    uint gidprn1 = GID;
+    lattice_index gidprn1 = GID;
     
     gpu_su_2 matrix;
     if (GID < SITES) {
@@ -122,9 +122,9 @@ lattice_init_hot_Z(__global hgpu_float4 * lattice_table,
 #endif
 
 #if SUN == 3
-    uint gidprn1 = GID + 0 * ROWSIZE;
-    uint gidprn2 = GID + 1 * ROWSIZE;
-    uint gidprn3 = GID + 2 * ROWSIZE;
+    lattice_index gidprn1 = GID + 0 * ROWSIZE;
+    lattice_index gidprn2 = GID + 1 * ROWSIZE;
+    lattice_index gidprn3 = GID + 2 * ROWSIZE;
     gpu_su_3 matrix;
     if (GID < SITES) {
         lattice_random3(&matrix,prns,gidprn1,gidprn2,gidprn3);
@@ -135,11 +135,11 @@ lattice_init_hot_Z(__global hgpu_float4 * lattice_table,
 
                                         __kernel void
 lattice_init_hot_T(__global hgpu_float4 * lattice_table,
-                   __global const hgpu_prng_float4 * prns)
+                   hgpu_prng_buffer prns)
 {
 
 #if SUN == 2
-    uint gidprn1 = GID;
+    lattice_index gidprn1 = GID;
     
     gpu_su_2 matrix;
     if (GID < SITES) {
@@ -149,9 +149,9 @@ lattice_init_hot_T(__global hgpu_float4 * lattice_table,
 #endif
 
 #if SUN == 3
-    uint gidprn1 = GID + 0 * ROWSIZE;
-    uint gidprn2 = GID + 1 * ROWSIZE;
-    uint gidprn3 = GID + 2 * ROWSIZE;
+    lattice_index gidprn1 = GID + 0 * ROWSIZE;
+    lattice_index gidprn2 = GID + 1 * ROWSIZE;
+    lattice_index gidprn3 = GID + 2 * ROWSIZE;
     gpu_su_3 matrix;
     if (GID < SITES) {
         lattice_random3(&matrix,prns,gidprn1,gidprn2,gidprn3);
@@ -353,7 +353,7 @@ lattice_GramSchmidt(__global hgpu_float4 * lattice_table,
 #if SUN == 2
     gpu_su_2 matrix;
     coords_4 coord;
-    uint gindex = GID;
+    lattice_index gindex = GID;
     lattice_gid_to_coords(&gindex,&coord);
 
     if (GID < SITES) {
@@ -375,7 +375,7 @@ lattice_GramSchmidt(__global hgpu_float4 * lattice_table,
 #if SUN == 3
     gpu_su_3 matrix;
     coords_4 coord;
-    uint gindex = GID;
+    lattice_index gindex = GID;
     lattice_gid_to_coords(&gindex,&coord);
 
     if (GID < SITES) {
@@ -398,13 +398,13 @@ lattice_GramSchmidt(__global hgpu_float4 * lattice_table,
                                         __kernel void
 update_even_X(__global hgpu_float4 * lattice_table,
               __global hgpu_float * lattice_parameters,
-              __global const hgpu_prng_float4 * prns)
+              hgpu_prng_buffer prns PRNG_DEMAND_ARG HEATBATH_STATS_ARG)
 {
     coords_4 coord;
 #ifdef BIGLAT
-    uint gindex = Lattice_even_gid();  // x_+/-_y,z,t
+    lattice_index gindex = Lattice_even_gid();  // x_+/-_y,z,t
 #else
-    uint gindex = lattice_even_gid();  // x_+/-_y,z,t
+    lattice_index gindex = lattice_even_gid();  // x_+/-_y,z,t
 #endif
     hgpu_float bet      = lattice_parameters[0];
 #if SUN == 2
@@ -429,7 +429,7 @@ prns[GID].x = (float) (gindex - N2N3N4 + LEFT_SITES);
 prns[GID].x = (float) gindex;
 #endif
 #endif
-        mU     = lattice_heatbath_2(&staple,&m0,&bet,prns);
+        mU     = lattice_heatbath_2(&staple,&m0,&bet,prns PRNG_DEMAND_PASS HEATBATH_STATS_PASS);
 
 #ifndef BULK_UPDATES
            lattice_store_2(lattice_table,&mU,gindex,X);    // update lattice
@@ -459,7 +459,7 @@ prns[GID].x = (float) (gindex - N2N3N4 + LEFT_SITES);
 prns[GID].x = (float) gindex;
 #endif
 #endif
-        mU     = lattice_heatbath3(&staple,&m0,&bet,prns);
+        mU     = lattice_heatbath3(&staple,&m0,&bet,prns PRNG_DEMAND_PASS HEATBATH_STATS_PASS);
 
 #ifndef BULK_UPDATES
            lattice_store_3(lattice_table,&mU,gindex,X);    // update lattice
@@ -470,13 +470,13 @@ prns[GID].x = (float) gindex;
                                         __kernel void
 update_even_Y(__global hgpu_float4 * lattice_table,
               __global hgpu_float * lattice_parameters,
-              __global const hgpu_prng_float4 * prns)
+              hgpu_prng_buffer prns PRNG_DEMAND_ARG HEATBATH_STATS_ARG)
 {
     coords_4 coord;
 #ifdef BIGLAT
-    uint gindex = Lattice_even_gid();  // x_+/-_y,z,t
+    lattice_index gindex = Lattice_even_gid();  // x_+/-_y,z,t
 #else
-    uint gindex = lattice_even_gid();  // x_+/-_y,z,t
+    lattice_index gindex = lattice_even_gid();  // x_+/-_y,z,t
 #endif
     hgpu_float bet   = lattice_parameters[0];
 #if SUN == 2
@@ -501,7 +501,7 @@ prns[GID].x = (float) (gindex - N2N3N4 + LEFT_SITES);
 prns[GID].x = (float) gindex;
 #endif
 #endif
-        mU     = lattice_heatbath_2(&staple,&m0,&bet,prns);
+        mU     = lattice_heatbath_2(&staple,&m0,&bet,prns PRNG_DEMAND_PASS HEATBATH_STATS_PASS);
 
 #ifndef BULK_UPDATES
            lattice_store_2(lattice_table,&mU,gindex,Y);    // update lattice
@@ -531,7 +531,7 @@ prns[GID].x = (float) (gindex - N2N3N4 + LEFT_SITES);
 prns[GID].x = (float) gindex;
 #endif
 #endif
-        mU     = lattice_heatbath3(&staple,&m0,&bet,prns);
+        mU     = lattice_heatbath3(&staple,&m0,&bet,prns PRNG_DEMAND_PASS HEATBATH_STATS_PASS);
 
 #ifndef BULK_UPDATES
            lattice_store_3(lattice_table,&mU,gindex,Y);    // update lattice
@@ -542,13 +542,13 @@ prns[GID].x = (float) gindex;
                                         __kernel void
 update_even_Z(__global hgpu_float4 * lattice_table,
               __global hgpu_float * lattice_parameters,
-              __global const hgpu_prng_float4 * prns)
+              hgpu_prng_buffer prns PRNG_DEMAND_ARG HEATBATH_STATS_ARG)
 {
     coords_4 coord;
 #ifdef BIGLAT
-    uint gindex = Lattice_even_gid();  // x_+/-_y,z,t
+    lattice_index gindex = Lattice_even_gid();  // x_+/-_y,z,t
 #else
-    uint gindex = lattice_even_gid();  // x_+/-_y,z,t
+    lattice_index gindex = lattice_even_gid();  // x_+/-_y,z,t
 #endif
     hgpu_float bet   = lattice_parameters[0];
 #if SUN == 2
@@ -573,7 +573,7 @@ prns[GID].x = (float) (gindex - N2N3N4 + LEFT_SITES);
 prns[GID].x = (float) gindex;
 #endif
 #endif
-        mU     = lattice_heatbath_2(&staple,&m0,&bet,prns);
+        mU     = lattice_heatbath_2(&staple,&m0,&bet,prns PRNG_DEMAND_PASS HEATBATH_STATS_PASS);
 
 #ifndef BULK_UPDATES
            lattice_store_2(lattice_table,&mU,gindex,Z);    // update lattice
@@ -603,7 +603,7 @@ prns[GID].x = (float) (gindex - N2N3N4 + LEFT_SITES);
 prns[GID].x = (float) gindex;
 #endif
 #endif
-        mU     = lattice_heatbath3(&staple,&m0,&bet,prns);
+        mU     = lattice_heatbath3(&staple,&m0,&bet,prns PRNG_DEMAND_PASS HEATBATH_STATS_PASS);
 
 #ifndef BULK_UPDATES
            lattice_store_3(lattice_table,&mU,gindex,Z);    // update lattice
@@ -614,13 +614,13 @@ prns[GID].x = (float) gindex;
                                         __kernel void
 update_even_T(__global hgpu_float4 * lattice_table,
               __global hgpu_float * lattice_parameters,
-              __global const hgpu_prng_float4 * prns)
+              hgpu_prng_buffer prns PRNG_DEMAND_ARG HEATBATH_STATS_ARG)
 {
     coords_4 coord;
 #ifdef BIGLAT
-    uint gindex = Lattice_even_gid();  // x_+/-_y,z,t
+    lattice_index gindex = Lattice_even_gid();  // x_+/-_y,z,t
 #else
-    uint gindex = lattice_even_gid();  // x_+/-_y,z,t
+    lattice_index gindex = lattice_even_gid();  // x_+/-_y,z,t
 #endif
     hgpu_float bet   = lattice_parameters[0];
 #if SUN == 2
@@ -645,7 +645,7 @@ prns[GID].x = (float) (gindex - N2N3N4 + LEFT_SITES);
 prns[GID].x = (float) gindex;
 #endif
 #endif
-        mU     = lattice_heatbath_2(&staple,&m0,&bet,prns);
+        mU     = lattice_heatbath_2(&staple,&m0,&bet,prns PRNG_DEMAND_PASS HEATBATH_STATS_PASS);
 
 #ifndef BULK_UPDATES
            lattice_store_2(lattice_table,&mU,gindex,T);    // update lattice
@@ -675,7 +675,7 @@ prns[GID].x = (float) (gindex - N2N3N4 + LEFT_SITES);
 prns[GID].x = (float) gindex;
 #endif
 #endif
-        mU     = lattice_heatbath3(&staple,&m0,&bet,prns);
+        mU     = lattice_heatbath3(&staple,&m0,&bet,prns PRNG_DEMAND_PASS HEATBATH_STATS_PASS);
 
 #ifndef BULK_UPDATES
            lattice_store_3(lattice_table,&mU,gindex,T);    // update lattice
@@ -686,13 +686,13 @@ prns[GID].x = (float) gindex;
                                         __kernel void
 update_odd_X(__global hgpu_float4 * lattice_table,
              __global hgpu_float * lattice_parameters,
-             __global const hgpu_prng_float4 * prns)
+             hgpu_prng_buffer prns PRNG_DEMAND_ARG HEATBATH_STATS_ARG)
 {
     coords_4 coord;
 #ifdef BIGLAT
-    uint gindex = Lattice_odd_gid();  // x_+/-_y,z,t
+    lattice_index gindex = Lattice_odd_gid();  // x_+/-_y,z,t
 #else
-    uint gindex = lattice_odd_gid();  // x_+/-_y,z,t
+    lattice_index gindex = lattice_odd_gid();  // x_+/-_y,z,t
 #endif
     hgpu_float bet   = lattice_parameters[0];
 #if SUN == 2
@@ -717,7 +717,7 @@ prns[GID].x = (float) (gindex - N2N3N4 + LEFT_SITES);
 prns[GID].x = (float) gindex;
 #endif
 #endif
-        mU     = lattice_heatbath_2(&staple,&m0,&bet,prns);
+        mU     = lattice_heatbath_2(&staple,&m0,&bet,prns PRNG_DEMAND_PASS HEATBATH_STATS_PASS);
 
 #ifndef BULK_UPDATES
            lattice_store_2(lattice_table,&mU,gindex,X);    // update lattice
@@ -748,7 +748,7 @@ prns[GID].x = (float) (gindex - N2N3N4 + LEFT_SITES);
 prns[GID].x = (float) gindex;
 #endif
 #endif
-        mU     = lattice_heatbath3(&staple,&m0,&bet,prns);
+        mU     = lattice_heatbath3(&staple,&m0,&bet,prns PRNG_DEMAND_PASS HEATBATH_STATS_PASS);
 
 #ifndef BULK_UPDATES
            lattice_store_3(lattice_table,&mU,gindex,X);    // update lattice
@@ -759,13 +759,13 @@ prns[GID].x = (float) gindex;
                                         __kernel void
 update_odd_Y(__global hgpu_float4 * lattice_table,
              __global hgpu_float * lattice_parameters,
-             __global const hgpu_prng_float4 * prns)
+             hgpu_prng_buffer prns PRNG_DEMAND_ARG HEATBATH_STATS_ARG)
 {
     coords_4 coord;
 #ifdef BIGLAT
-    uint gindex = Lattice_odd_gid();  // x_+/-_y,z,t
+    lattice_index gindex = Lattice_odd_gid();  // x_+/-_y,z,t
 #else
-    uint gindex = lattice_odd_gid();  // x_+/-_y,z,t
+    lattice_index gindex = lattice_odd_gid();  // x_+/-_y,z,t
 #endif
     hgpu_float bet   = lattice_parameters[0];
 #if SUN == 2
@@ -790,7 +790,7 @@ prns[GID].x = (float) (gindex - N2N3N4 + LEFT_SITES);
 prns[GID].x = (float) gindex;
 #endif
 #endif
-        mU     = lattice_heatbath_2(&staple,&m0,&bet,prns);
+        mU     = lattice_heatbath_2(&staple,&m0,&bet,prns PRNG_DEMAND_PASS HEATBATH_STATS_PASS);
 
 #ifndef BULK_UPDATES
            lattice_store_2(lattice_table,&mU,gindex,Y);    // update lattice
@@ -820,7 +820,7 @@ prns[GID].x = (float) (gindex - N2N3N4 + LEFT_SITES);
 prns[GID].x = (float) gindex;
 #endif
 #endif
-        mU     = lattice_heatbath3(&staple,&m0,&bet,prns);
+        mU     = lattice_heatbath3(&staple,&m0,&bet,prns PRNG_DEMAND_PASS HEATBATH_STATS_PASS);
 
 #ifndef BULK_UPDATES
            lattice_store_3(lattice_table,&mU,gindex,Y);    // update lattice
@@ -831,13 +831,13 @@ prns[GID].x = (float) gindex;
                                         __kernel void
 update_odd_Z(__global hgpu_float4 * lattice_table,
              __global hgpu_float * lattice_parameters,
-             __global const hgpu_prng_float4 * prns)
+             hgpu_prng_buffer prns PRNG_DEMAND_ARG HEATBATH_STATS_ARG)
 {
     coords_4 coord;
 #ifdef BIGLAT
-    uint gindex = Lattice_odd_gid();  // x_+/-_y,z,t
+    lattice_index gindex = Lattice_odd_gid();  // x_+/-_y,z,t
 #else
-    uint gindex = lattice_odd_gid();  // x_+/-_y,z,t
+    lattice_index gindex = lattice_odd_gid();  // x_+/-_y,z,t
 #endif
     hgpu_float bet   = lattice_parameters[0];
 #if SUN == 2
@@ -862,7 +862,7 @@ prns[GID].x = (float) (gindex - N2N3N4 + LEFT_SITES);
 prns[GID].x = (float) gindex;
 #endif
 #endif
-        mU     = lattice_heatbath_2(&staple,&m0,&bet,prns);
+        mU     = lattice_heatbath_2(&staple,&m0,&bet,prns PRNG_DEMAND_PASS HEATBATH_STATS_PASS);
 
 #ifndef BULK_UPDATES
            lattice_store_2(lattice_table,&mU,gindex,Z);    // update lattice
@@ -892,7 +892,7 @@ prns[GID].x = (float) (gindex - N2N3N4 + LEFT_SITES);
 prns[GID].x = (float) gindex;
 #endif
 #endif
-        mU     = lattice_heatbath3(&staple,&m0,&bet,prns);
+        mU     = lattice_heatbath3(&staple,&m0,&bet,prns PRNG_DEMAND_PASS HEATBATH_STATS_PASS);
 
 #ifndef BULK_UPDATES
            lattice_store_3(lattice_table,&mU,gindex,Z);    // update lattice
@@ -904,13 +904,13 @@ prns[GID].x = (float) gindex;
                                         __kernel void
 update_odd_T(__global hgpu_float4 * lattice_table,
              __global hgpu_float * lattice_parameters,
-             __global const hgpu_prng_float4 * prns)
+             hgpu_prng_buffer prns PRNG_DEMAND_ARG HEATBATH_STATS_ARG)
 {
     coords_4 coord;
 #ifdef BIGLAT
-    uint gindex = Lattice_odd_gid();  // x_+/-_y,z,t
+    lattice_index gindex = Lattice_odd_gid();  // x_+/-_y,z,t
 #else
-    uint gindex = lattice_odd_gid();  // x_+/-_y,z,t
+    lattice_index gindex = lattice_odd_gid();  // x_+/-_y,z,t
 #endif
     hgpu_float bet   = lattice_parameters[0];
 #if SUN == 2
@@ -935,7 +935,7 @@ prns[GID].x = (float) (gindex - N2N3N4 + LEFT_SITES);
 prns[GID].x = (float) gindex;
 #endif
 #endif
-        mU     = lattice_heatbath_2(&staple,&m0,&bet,prns);
+        mU     = lattice_heatbath_2(&staple,&m0,&bet,prns PRNG_DEMAND_PASS HEATBATH_STATS_PASS);
 
 #ifndef BULK_UPDATES
            lattice_store_2(lattice_table,&mU,gindex,T);    // update lattice
@@ -965,7 +965,7 @@ prns[GID].x = (float) (gindex - N2N3N4 + LEFT_SITES);
 prns[GID].x = (float) gindex;
 #endif
 #endif
-        mU     = lattice_heatbath3(&staple,&m0,&bet,prns);
+        mU     = lattice_heatbath3(&staple,&m0,&bet,prns PRNG_DEMAND_PASS HEATBATH_STATS_PASS);
 
 #ifndef BULK_UPDATES
            lattice_store_3(lattice_table,&mU,gindex,T);    // update lattice
@@ -974,6 +974,828 @@ prns[GID].x = (float) gindex;
     }
 }
 
+// microcanonical overrelaxation of links (no PRNs are consumed) ____________________________________
+                                        __kernel void
+orelax_even_X(__global hgpu_float4 * lattice_table,
+              __global hgpu_float * lattice_parameters)
+{
+    coords_4 coord;
+#ifdef BIGLAT
+    lattice_index gindex = Lattice_even_gid();  // x_+/-_y,z,t
+#else
+    lattice_index gindex = lattice_even_gid();  // x_+/-_y,z,t
+#endif
+#if SUN == 2
+    su2_twist twist;
+    twist.phi   = lattice_parameters[1];
+
+#ifdef BIGLAT
+    if (GID < (N1 - 2) * N2N3N4 / 2){
+#else
+    if (GID < SITESHALF) {
+#endif
+        gpu_su_2 m0,mU;
+        su_2 staple;
+        lattice_gid_to_coords(&gindex,&coord);
+
+        m0     = lattice_table_2(lattice_table,&coord,gindex,X,&twist);    // [p,X]
+        staple = lattice_staple_2(lattice_table,gindex,X,&twist);
+        mU     = lattice_overrelaxation_2(&staple,&m0);
+
+#ifndef BULK_UPDATES
+           lattice_store_2(lattice_table,&mU,gindex,X);    // update lattice
+#endif
+#endif
+
+#if SUN == 3
+    su3_twist twist;
+    twist.phi   = lattice_parameters[1];
+    twist.omega = lattice_parameters[2];
+
+#ifdef BIGLAT
+    if (GID < (N1 - 2) * N2N3N4 / 2){
+#else
+    if (GID < SITESHALF) {
+#endif
+        gpu_su_3 m0,mU;
+        su_3 staple;
+        lattice_gid_to_coords(&gindex,&coord);
+
+        m0     = lattice_table_3(lattice_table,&coord,gindex,X,&twist);    // [p,X]
+        staple = lattice_staple_3(lattice_table,gindex,X,&twist);
+        mU     = lattice_overrelaxation3(&staple,&m0);
+
+#ifndef BULK_UPDATES
+           lattice_store_3(lattice_table,&mU,gindex,X);    // update lattice
+#endif
+#endif
+    }
+}
+                                        __kernel void
+orelax_even_Y(__global hgpu_float4 * lattice_table,
+              __global hgpu_float * lattice_parameters)
+{
+    coords_4 coord;
+#ifdef BIGLAT
+    lattice_index gindex = Lattice_even_gid();  // x_+/-_y,z,t
+#else
+    lattice_index gindex = lattice_even_gid();  // x_+/-_y,z,t
+#endif
+#if SUN == 2
+    su2_twist twist;
+    twist.phi   = lattice_parameters[1];
+
+#ifdef BIGLAT
+    if (GID < (N1 - 2) * N2N3N4 / 2){
+#else
+    if (GID < SITESHALF) {
+#endif
+        gpu_su_2 m0,mU;
+        su_2 staple;
+        lattice_gid_to_coords(&gindex,&coord);
+
+        m0     = lattice_table_2(lattice_table,&coord,gindex,Y,&twist);    // [p,Y]
+        staple = lattice_staple_2(lattice_table,gindex,Y,&twist);
+        mU     = lattice_overrelaxation_2(&staple,&m0);
+
+#ifndef BULK_UPDATES
+           lattice_store_2(lattice_table,&mU,gindex,Y);    // update lattice
+#endif
+#endif
+
+#if SUN == 3
+    su3_twist twist;
+    twist.phi   = lattice_parameters[1];
+    twist.omega = lattice_parameters[2];
+
+#ifdef BIGLAT
+    if (GID < (N1 - 2) * N2N3N4 / 2){
+#else
+    if (GID < SITESHALF) {
+#endif
+        gpu_su_3 m0,mU;
+        su_3 staple;
+        lattice_gid_to_coords(&gindex,&coord);
+
+        m0     = lattice_table_3(lattice_table,&coord,gindex,Y,&twist);    // [p,Y]
+        staple = lattice_staple_3(lattice_table,gindex,Y,&twist);
+        mU     = lattice_overrelaxation3(&staple,&m0);
+
+#ifndef BULK_UPDATES
+           lattice_store_3(lattice_table,&mU,gindex,Y);    // update lattice
+#endif
+#endif
+    }
+}
+                                        __kernel void
+orelax_even_Z(__global hgpu_float4 * lattice_table,
+              __global hgpu_float * lattice_parameters)
+{
+    coords_4 coord;
+#ifdef BIGLAT
+    lattice_index gindex = Lattice_even_gid();  // x_+/-_y,z,t
+#else
+    lattice_index gindex = lattice_even_gid();  // x_+/-_y,z,t
+#endif
+#if SUN == 2
+    su2_twist twist;
+    twist.phi   = lattice_parameters[1];
+
+#ifdef BIGLAT
+    if (GID < (N1 - 2) * N2N3N4 / 2){
+#else
+    if (GID < SITESHALF) {
+#endif
+        gpu_su_2 m0,mU;
+        su_2 staple;
+        lattice_gid_to_coords(&gindex,&coord);
+
+        m0     = lattice_table_2(lattice_table,&coord,gindex,Z,&twist);    // [p,Z]
+        staple = lattice_staple_2(lattice_table,gindex,Z,&twist);
+        mU     = lattice_overrelaxation_2(&staple,&m0);
+
+#ifndef BULK_UPDATES
+           lattice_store_2(lattice_table,&mU,gindex,Z);    // update lattice
+#endif
+#endif
+
+#if SUN == 3
+    su3_twist twist;
+    twist.phi   = lattice_parameters[1];
+    twist.omega = lattice_parameters[2];
+
+#ifdef BIGLAT
+    if (GID < (N1 - 2) * N2N3N4 / 2){
+#else
+    if (GID < SITESHALF) {
+#endif
+        gpu_su_3 m0,mU;
+        su_3 staple;
+        lattice_gid_to_coords(&gindex,&coord);
+
+        m0     = lattice_table_3(lattice_table,&coord,gindex,Z,&twist);    // [p,Z]
+        staple = lattice_staple_3(lattice_table,gindex,Z,&twist);
+        mU     = lattice_overrelaxation3(&staple,&m0);
+
+#ifndef BULK_UPDATES
+           lattice_store_3(lattice_table,&mU,gindex,Z);    // update lattice
+#endif
+#endif
+    }
+}
+                                        __kernel void
+orelax_even_T(__global hgpu_float4 * lattice_table,
+              __global hgpu_float * lattice_parameters)
+{
+    coords_4 coord;
+#ifdef BIGLAT
+    lattice_index gindex = Lattice_even_gid();  // x_+/-_y,z,t
+#else
+    lattice_index gindex = lattice_even_gid();  // x_+/-_y,z,t
+#endif
+#if SUN == 2
+    su2_twist twist;
+    twist.phi   = lattice_parameters[1];
+
+#ifdef BIGLAT
+    if (GID < (N1 - 2) * N2N3N4 / 2){
+#else
+    if (GID < SITESHALF) {
+#endif
+        gpu_su_2 m0,mU;
+        su_2 staple;
+        lattice_gid_to_coords(&gindex,&coord);
+
+        m0     = lattice_table_2(lattice_table,&coord,gindex,T,&twist);    // [p,T]
+        staple = lattice_staple_2(lattice_table,gindex,T,&twist);
+        mU     = lattice_overrelaxation_2(&staple,&m0);
+
+#ifndef BULK_UPDATES
+           lattice_store_2(lattice_table,&mU,gindex,T);    // update lattice
+#endif
+#endif
+
+#if SUN == 3
+    su3_twist twist;
+    twist.phi   = lattice_parameters[1];
+    twist.omega = lattice_parameters[2];
+
+#ifdef BIGLAT
+    if (GID < (N1 - 2) * N2N3N4 / 2){
+#else
+    if (GID < SITESHALF) {
+#endif
+        gpu_su_3 m0,mU;
+        su_3 staple;
+        lattice_gid_to_coords(&gindex,&coord);
+
+        m0     = lattice_table_3(lattice_table,&coord,gindex,T,&twist);    // [p,T]
+        staple = lattice_staple_3(lattice_table,gindex,T,&twist);
+        mU     = lattice_overrelaxation3(&staple,&m0);
+
+#ifndef BULK_UPDATES
+           lattice_store_3(lattice_table,&mU,gindex,T);    // update lattice
+#endif
+#endif
+    }
+}
+                                        __kernel void
+orelax_odd_X(__global hgpu_float4 * lattice_table,
+             __global hgpu_float * lattice_parameters)
+{
+    coords_4 coord;
+#ifdef BIGLAT
+    lattice_index gindex = Lattice_odd_gid();  // x_+/-_y,z,t
+#else
+    lattice_index gindex = lattice_odd_gid();  // x_+/-_y,z,t
+#endif
+#if SUN == 2
+    su2_twist twist;
+    twist.phi   = lattice_parameters[1];
+
+#ifdef BIGLAT
+    if (GID < (N1 - 2) * N2N3N4 / 2){
+#else
+    if (GID < SITESHALF) {
+#endif
+        gpu_su_2 m0,mU;
+        su_2 staple;
+        lattice_gid_to_coords(&gindex,&coord);
+
+        m0     = lattice_table_2(lattice_table,&coord,gindex,X,&twist);    // [p,X]
+        staple = lattice_staple_2(lattice_table,gindex,X,&twist);
+        mU     = lattice_overrelaxation_2(&staple,&m0);
+
+#ifndef BULK_UPDATES
+           lattice_store_2(lattice_table,&mU,gindex,X);    // update lattice
+#endif
+#endif
+
+#if SUN == 3
+    su3_twist twist;
+    twist.phi   = lattice_parameters[1];
+    twist.omega = lattice_parameters[2];
+
+#ifdef BIGLAT
+    if (GID < (N1 - 2) * N2N3N4 / 2){
+#else
+    if (GID < SITESHALF) {
+#endif
+        gpu_su_3 m0,mU;
+        su_3 staple;
+        lattice_gid_to_coords(&gindex,&coord);
+
+        m0     = lattice_table_3(lattice_table,&coord,gindex,X,&twist);    // [p,X]
+        staple = lattice_staple_3(lattice_table,gindex,X,&twist);
+        mU     = lattice_overrelaxation3(&staple,&m0);
+
+#ifndef BULK_UPDATES
+           lattice_store_3(lattice_table,&mU,gindex,X);    // update lattice
+#endif
+#endif
+    }
+}
+                                        __kernel void
+orelax_odd_Y(__global hgpu_float4 * lattice_table,
+             __global hgpu_float * lattice_parameters)
+{
+    coords_4 coord;
+#ifdef BIGLAT
+    lattice_index gindex = Lattice_odd_gid();  // x_+/-_y,z,t
+#else
+    lattice_index gindex = lattice_odd_gid();  // x_+/-_y,z,t
+#endif
+#if SUN == 2
+    su2_twist twist;
+    twist.phi   = lattice_parameters[1];
+
+#ifdef BIGLAT
+    if (GID < (N1 - 2) * N2N3N4 / 2){
+#else
+    if (GID < SITESHALF) {
+#endif
+        gpu_su_2 m0,mU;
+        su_2 staple;
+        lattice_gid_to_coords(&gindex,&coord);
+
+        m0     = lattice_table_2(lattice_table,&coord,gindex,Y,&twist);    // [p,Y]
+        staple = lattice_staple_2(lattice_table,gindex,Y,&twist);
+        mU     = lattice_overrelaxation_2(&staple,&m0);
+
+#ifndef BULK_UPDATES
+           lattice_store_2(lattice_table,&mU,gindex,Y);    // update lattice
+#endif
+#endif
+
+#if SUN == 3
+    su3_twist twist;
+    twist.phi   = lattice_parameters[1];
+    twist.omega = lattice_parameters[2];
+
+#ifdef BIGLAT
+    if (GID < (N1 - 2) * N2N3N4 / 2){
+#else
+    if (GID < SITESHALF) {
+#endif
+        gpu_su_3 m0,mU;
+        su_3 staple;
+        lattice_gid_to_coords(&gindex,&coord);
+
+        m0     = lattice_table_3(lattice_table,&coord,gindex,Y,&twist);    // [p,Y]
+        staple = lattice_staple_3(lattice_table,gindex,Y,&twist);
+        mU     = lattice_overrelaxation3(&staple,&m0);
+
+#ifndef BULK_UPDATES
+           lattice_store_3(lattice_table,&mU,gindex,Y);    // update lattice
+#endif
+#endif
+    }
+}
+                                        __kernel void
+orelax_odd_Z(__global hgpu_float4 * lattice_table,
+             __global hgpu_float * lattice_parameters)
+{
+    coords_4 coord;
+#ifdef BIGLAT
+    lattice_index gindex = Lattice_odd_gid();  // x_+/-_y,z,t
+#else
+    lattice_index gindex = lattice_odd_gid();  // x_+/-_y,z,t
+#endif
+#if SUN == 2
+    su2_twist twist;
+    twist.phi   = lattice_parameters[1];
+
+#ifdef BIGLAT
+    if (GID < (N1 - 2) * N2N3N4 / 2){
+#else
+    if (GID < SITESHALF) {
+#endif
+        gpu_su_2 m0,mU;
+        su_2 staple;
+        lattice_gid_to_coords(&gindex,&coord);
+
+        m0     = lattice_table_2(lattice_table,&coord,gindex,Z,&twist);    // [p,Z]
+        staple = lattice_staple_2(lattice_table,gindex,Z,&twist);
+        mU     = lattice_overrelaxation_2(&staple,&m0);
+
+#ifndef BULK_UPDATES
+           lattice_store_2(lattice_table,&mU,gindex,Z);    // update lattice
+#endif
+#endif
+
+#if SUN == 3
+    su3_twist twist;
+    twist.phi   = lattice_parameters[1];
+    twist.omega = lattice_parameters[2];
+
+#ifdef BIGLAT
+    if (GID < (N1 - 2) * N2N3N4 / 2){
+#else
+    if (GID < SITESHALF) {
+#endif
+        gpu_su_3 m0,mU;
+        su_3 staple;
+        lattice_gid_to_coords(&gindex,&coord);
+
+        m0     = lattice_table_3(lattice_table,&coord,gindex,Z,&twist);    // [p,Z]
+        staple = lattice_staple_3(lattice_table,gindex,Z,&twist);
+        mU     = lattice_overrelaxation3(&staple,&m0);
+
+#ifndef BULK_UPDATES
+           lattice_store_3(lattice_table,&mU,gindex,Z);    // update lattice
+#endif
+#endif
+    }
+}
+                                        __kernel void
+orelax_odd_T(__global hgpu_float4 * lattice_table,
+             __global hgpu_float * lattice_parameters)
+{
+    coords_4 coord;
+#ifdef BIGLAT
+    lattice_index gindex = Lattice_odd_gid();  // x_+/-_y,z,t
+#else
+    lattice_index gindex = lattice_odd_gid();  // x_+/-_y,z,t
+#endif
+#if SUN == 2
+    su2_twist twist;
+    twist.phi   = lattice_parameters[1];
+
+#ifdef BIGLAT
+    if (GID < (N1 - 2) * N2N3N4 / 2){
+#else
+    if (GID < SITESHALF) {
+#endif
+        gpu_su_2 m0,mU;
+        su_2 staple;
+        lattice_gid_to_coords(&gindex,&coord);
+
+        m0     = lattice_table_2(lattice_table,&coord,gindex,T,&twist);    // [p,T]
+        staple = lattice_staple_2(lattice_table,gindex,T,&twist);
+        mU     = lattice_overrelaxation_2(&staple,&m0);
+
+#ifndef BULK_UPDATES
+           lattice_store_2(lattice_table,&mU,gindex,T);    // update lattice
+#endif
+#endif
+
+#if SUN == 3
+    su3_twist twist;
+    twist.phi   = lattice_parameters[1];
+    twist.omega = lattice_parameters[2];
+
+#ifdef BIGLAT
+    if (GID < (N1 - 2) * N2N3N4 / 2){
+#else
+    if (GID < SITESHALF) {
+#endif
+        gpu_su_3 m0,mU;
+        su_3 staple;
+        lattice_gid_to_coords(&gindex,&coord);
+
+        m0     = lattice_table_3(lattice_table,&coord,gindex,T,&twist);    // [p,T]
+        staple = lattice_staple_3(lattice_table,gindex,T,&twist);
+        mU     = lattice_overrelaxation3(&staple,&m0);
+
+#ifndef BULK_UPDATES
+           lattice_store_3(lattice_table,&mU,gindex,T);    // update lattice
+#endif
+#endif
+    }
+}
+
+#if (!defined BIGLAT) && (defined RECT_ACTION)
+// Improved gauge actions: links [p,dir] of one of 8 colours (lattice_colour_gid) are updated simultaneously,
+// colours 4*parity+q (q = 0..3) share one PRNs production, work-items of colour q take slice q*COLOURSITES
+                                        __kernel void
+update_rect(__global hgpu_float4 * lattice_table,
+            __global hgpu_float * lattice_parameters,
+            hgpu_prng_buffer prns HEATBATH_STATS_ARG,
+            const uint dir,
+            const uint colour)
+{
+    lattice_index gindex = lattice_colour_gid(dir,colour);
+    hgpu_float bet       = lattice_parameters[0];
+    hgpu_prng_buffer prns_colour = prng_offset(prns,(colour & 3) * COLOURSITES);
+
+    if (GID < COLOURSITES) {
+#if SUN == 2
+        su2_twist twist;
+        twist.phi   = lattice_parameters[1];
+        gpu_su_2 m0,mU;
+        su_2 staple;
+
+        m0     = lattice_table_notwist_2(lattice_table,gindex,dir);
+        staple = lattice_staple_action2(lattice_table,gindex,dir,&twist);
+#ifdef GID_UPD
+prns_colour[GID].x = (float) gindex;
+#endif
+        mU     = lattice_heatbath_2(&staple,&m0,&bet,prns_colour HEATBATH_STATS_PASS);
+
+#ifndef BULK_UPDATES
+           lattice_store_2(lattice_table,&mU,gindex,dir);    // update lattice
+#endif
+#endif
+#if SUN == 3
+        su3_twist twist;
+        twist.phi   = lattice_parameters[1];
+        twist.omega = lattice_parameters[2];
+        gpu_su_3 m0,mU;
+        su_3 staple;
+
+        m0     = lattice_table_notwist_3(lattice_table,gindex,dir);
+        staple = lattice_staple_action3(lattice_table,gindex,dir,&twist);
+#ifdef GID_UPD
+prns_colour[GID].x = (float) gindex;
+#endif
+        mU     = lattice_heatbath3(&staple,&m0,&bet,prns_colour HEATBATH_STATS_PASS);
+
+#ifndef BULK_UPDATES
+           lattice_store_3(lattice_table,&mU,gindex,dir);    // update lattice
+#endif
+#endif
+    }
+}
+
+                                        __kernel void
+orelax_rect(__global hgpu_float4 * lattice_table,
+            __global hgpu_float * lattice_parameters,
+            const uint dir,
+            const uint colour)
+{
+    lattice_index gindex = lattice_colour_gid(dir,colour);
+
+    if (GID < COLOURSITES) {
+#if SUN == 2
+        su2_twist twist;
+        twist.phi   = lattice_parameters[1];
+        gpu_su_2 m0,mU;
+        su_2 staple;
+
+        m0     = lattice_table_notwist_2(lattice_table,gindex,dir);
+        staple = lattice_staple_action2(lattice_table,gindex,dir,&twist);
+        mU     = lattice_overrelaxation_2(&staple,&m0);
+
+#ifndef BULK_UPDATES
+           lattice_store_2(lattice_table,&mU,gindex,dir);    // update lattice
+#endif
+#endif
+#if SUN == 3
+        su3_twist twist;
+        twist.phi   = lattice_parameters[1];
+        twist.omega = lattice_parameters[2];
+        gpu_su_3 m0,mU;
+        su_3 staple;
+
+        m0     = lattice_table_notwist_3(lattice_table,gindex,dir);
+        staple = lattice_staple_action3(lattice_table,gindex,dir,&twist);
+        mU     = lattice_overrelaxation3(&staple,&m0);
+
+#ifndef BULK_UPDATES
+           lattice_store_3(lattice_table,&mU,gindex,dir);    // update lattice
+#endif
+#endif
+    }
+}
+#endif
+
+#if (!defined BIGLAT) && (defined TILED_UPDATE)
+// Tiled update: work-group loads 2x2x2x2 tile of colour (lattice_tile_origin) with its halo into local memory once
+// and updates odd X..T, even X..T links of the tile there; work-item takes PRNs slice dir*TILEGROUPS for link [p,dir]
+                                        __kernel void
+update_tiled(__global hgpu_float4 * lattice_table,
+             __global hgpu_float * lattice_parameters,
+             hgpu_prng_buffer prns HEATBATH_STATS_ARG,
+             __local hgpu_float4 * lattice_tile,
+             const uint colour)
+{
+    uint n[4] = {N1, N2, N3, N4};
+    uint origin[4], w[4], wsite[4];
+    coords_4 coord;
+    lattice_index gindex,gsite;
+    uint tid    = TID;                                          // tile site of work-item, slot tid
+    uint parity = (tid + (tid >> 1) + (tid >> 2) + (tid >> 3)) & 1;
+    int  slot;
+
+    lattice_tile_origin(colour,origin);
+    for (int i = 0; i < 4; i++) wsite[i] = 1 + ((tid >> i) & 1);
+    coord.x = origin[X] + wsite[X] - 1;
+    coord.y = origin[Y] + wsite[Y] - 1;
+    coord.z = origin[Z] + wsite[Z] - 1;
+    coord.t = origin[T] + wsite[T] - 1;
+    lattice_coords_to_gid(&gsite,&coord);
+
+    // load links of tile and halo (4x4x4x4 window around tile)
+    for (uint j = tid; j < 256; j += TILESITES){
+        for (int i = 0; i < 4; i++) w[i] = (j >> (2 * i)) & 3;
+        slot = lattice_tile_slot(w);
+        if (slot < 0) continue;
+        coord.x = (origin[X] + w[X] + n[X] - 1) % n[X];
+        coord.y = (origin[Y] + w[Y] + n[Y] - 1) % n[Y];
+        coord.z = (origin[Z] + w[Z] + n[Z] - 1) % n[Z];
+        coord.t = (origin[T] + w[T] + n[T] - 1) % n[T];
+        lattice_coords_to_gid(&gindex,&coord);
+        for (uint dir = X; dir <= T; dir++){
+            if (!lattice_tile_link(w,dir)) continue;
+#if SUN == 2
+            gpu_su_2 m = lattice_table_notwist_2(lattice_table,gindex,dir);
+            lattice_tile_store_2(lattice_tile,&m,slot,dir);
+#endif
+#if SUN == 3
+            gpu_su_3 m = lattice_table_notwist_3(lattice_table,gindex,dir);
+            lattice_tile_store_3(lattice_tile,&m,slot,dir);
+#endif
+        }
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // odd sites first, then even ones; links of one parity and direction are updated simultaneously
+    for (uint p = 1; p < 3; p++)
+        for (uint dir = X; dir <= T; dir++){
+            if (parity == (p & 1)) {
+                hgpu_prng_buffer prns_dir = prng_offset(prns,dir * TILEGROUPS);
+                hgpu_float bet = lattice_parameters[0];         // heatbath marks accepted SU(2) update by bet < 0
+#ifdef GID_UPD
+prns_dir[GID].x = (float) gsite;
+#endif
+#if SUN == 2
+                gpu_su_2 m0,mU;
+                su_2 staple;
+
+                m0     = lattice_tile_2(lattice_tile,tid,dir);
+                staple = lattice_staple_tile_2(lattice_tile,wsite,dir);
+                mU     = lattice_heatbath_2(&staple,&m0,&bet,prns_dir HEATBATH_STATS_PASS);
+                lattice_tile_store_2(lattice_tile,&mU,tid,dir);
+#endif
+#if SUN == 3
+                gpu_su_3 m0,mU;
+                su_3 staple;
+
+                m0     = lattice_tile_3(lattice_tile,tid,dir);
+                staple = lattice_staple_tile_3(lattice_tile,wsite,dir);
+                mU     = lattice_heatbath3(&staple,&m0,&bet,prns_dir HEATBATH_STATS_PASS);
+                lattice_tile_store_3(lattice_tile,&mU,tid,dir);
+#endif
+            }
+            barrier(CLK_LOCAL_MEM_FENCE);
+        }
+
+    // store links of tile
+#ifndef BULK_UPDATES
+    for (uint dir = X; dir <= T; dir++){
+#if SUN == 2
+        gpu_su_2 m = lattice_tile_2(lattice_tile,tid,dir);
+        lattice_store_2(lattice_table,&m,gsite,dir);       // update lattice
+#endif
+#if SUN == 3
+        gpu_su_3 m = lattice_tile_3(lattice_tile,tid,dir);
+        lattice_store_3(lattice_table,&m,gsite,dir);       // update lattice
+#endif
+    }
+#endif
+}
+#endif
+
+#ifndef BIGLAT
+// Hybrid Monte Carlo: momenta are stored as lattice_table (component k of direction dir at [gindex + (4*k + dir) * ROWSIZE]),
+// P = sum_a p_a i*lambda_a/2 (SU(3): 8 components in two float4) or P = sum_a p_a i*sigma_a/2 (SU(2): 3 components)
+                                        __kernel void
+hmc_momenta(__global hgpu_float4 * hmc_momenta,
+            hgpu_prng_buffer prns,
+            const int dir)
+{
+    if (GID < SITES) {
+        hgpu_prng_float4 prn = prng_load4(prns,GID);
+        hmc_momenta[GID + dir * ROWSIZE] = lattice_gauss4(&prn);
+#if SUN == 2
+        hmc_momenta[GID + dir * ROWSIZE].w = 0.0;
+#endif
+#if SUN == 3
+        prn = prng_load4(prns,GID + SITES);
+        hmc_momenta[GID + (4 + dir) * ROWSIZE] = lattice_gauss4(&prn);
+#endif
+    }
+}
+
+                                        __kernel void
+hmc_force(__global hgpu_float4 * lattice_table,
+          __global hgpu_float * lattice_parameters,
+          __global hgpu_float4 * hmc_momenta,
+          const hgpu_float eps)
+{
+    // P -> P + eps * beta/N * F(U), links are not changed
+    coords_4 coord;
+    lattice_index gindex = GID;
+    hgpu_float bet = lattice_parameters[0] * eps;
+
+    if (GID < SITES) {
+        lattice_gid_to_coords(&gindex,&coord);
+#if SUN == 2
+        su2_twist twist;
+        twist.phi   = lattice_parameters[1];
+        gpu_su_2 m0;
+        su_2 staple,u,w;
+        hgpu_float4 f;
+        for (uint dir = X; dir <= T; dir++){
+            m0     = lattice_table_2(lattice_table,&coord,gindex,dir,&twist);
+            staple = lattice_staple_action2(lattice_table,gindex,dir,&twist);
+            u      = lattice_reconstruct2(&m0);
+            w      = matrix_times_su2(&u,&staple);
+            lattice_hmc_force_2(&w,&f);
+            hmc_momenta[gindex + dir * ROWSIZE] += bet * f;
+        }
+#endif
+#if SUN == 3
+        su3_twist twist;
+        twist.phi   = lattice_parameters[1];
+        twist.omega = lattice_parameters[2];
+        gpu_su_3 m0;
+        su_3 staple,u,w;
+        hgpu_float4 fa,fb;
+        for (uint dir = X; dir <= T; dir++){
+            m0     = lattice_table_3(lattice_table,&coord,gindex,dir,&twist);
+            staple = lattice_staple_action3(lattice_table,gindex,dir,&twist);
+            u      = lattice_reconstruct3(&m0);
+            w      = matrix_times_su3(&u,&staple);
+            lattice_hmc_force3(&w,&fa,&fb);
+            hmc_momenta[gindex +  dir      * ROWSIZE] += bet * fa;
+            hmc_momenta[gindex + (4 + dir) * ROWSIZE] += bet * fb;
+        }
+#endif
+    }
+}
+
+                                        __kernel void
+hmc_links(__global hgpu_float4 * lattice_table,
+          __global hgpu_float4 * hmc_momenta,
+          const hgpu_float eps)
+{
+    // U -> exp(eps P) U, momenta are not changed
+    if (GID < SITES) {
+#if SUN == 2
+        gpu_su_2 m0,mU;
+        hgpu_float4 p;
+        for (uint dir = X; dir <= T; dir++){
+            m0 = lattice_table_notwist_2(lattice_table,GID,dir);
+            p  = hmc_momenta[GID + dir * ROWSIZE];
+            mU = lattice_hmc_link_2(&m0,&p,eps);
+            lattice_store_2(lattice_table,&mU,GID,dir);
+        }
+#endif
+#if SUN == 3
+        gpu_su_3 m0,mU;
+        hgpu_float4 pa,pb;
+        for (uint dir = X; dir <= T; dir++){
+            m0 = lattice_table_notwist_3(lattice_table,GID,dir);
+            pa = hmc_momenta[GID +  dir      * ROWSIZE];
+            pb = hmc_momenta[GID + (4 + dir) * ROWSIZE];
+            mU = lattice_hmc_link3(&m0,&pa,&pb,eps);
+            lattice_store_3(lattice_table,&mU,GID,dir);
+        }
+#endif
+    }
+}
+
+                                        __kernel void
+hmc_energy(__global hgpu_float4 * lattice_table,
+           __global hgpu_float * lattice_parameters,
+           __global hgpu_float4 * hmc_momenta,
+           __global hgpu_double2 * hmc_energy,
+           __local hgpu_double2 * lattice_lds)
+{
+    // per site: x - kinetic energy sum_a p_a^2/2, y - sum over links of Re Tr(U * staple) weighted by number of links in loop
+    // (each plaquette is counted 4 times, each rectangle - 6 times), sites are summed over work group into hmc_energy[BID]
+    coords_4 coord;
+    lattice_index gindex = GID;
+    hgpu_double2 energy = (hgpu_double2) (0.0, 0.0);
+    hgpu_float4 p;
+
+    if (GID < SITES) {
+        lattice_gid_to_coords(&gindex,&coord);
+#if SUN == 2
+        su2_twist twist;
+        twist.phi   = lattice_parameters[1];
+        gpu_su_2 m0;
+        su_2 staple,u,w;
+        for (uint dir = X; dir <= T; dir++){
+            m0     = lattice_table_2(lattice_table,&coord,gindex,dir,&twist);
+            staple = lattice_staple_2(lattice_table,gindex,dir,&twist);
+            u      = lattice_reconstruct2(&m0);
+            w      = matrix_times_su2(&u,&staple);
+            p      = hmc_momenta[gindex + dir * ROWSIZE];
+            energy.x += 0.5 * (hgpu_double) dot(p,p);
+#ifdef RECT_ACTION
+            energy.y += ACTION_C0 * (hgpu_double) (w.u1.re + w.v2.re) / 4.0;
+            staple = lattice_staple_rectangle2(lattice_table,gindex,dir);
+            w      = matrix_times_su2(&u,&staple);
+            energy.y += ACTION_C1 * (hgpu_double) (w.u1.re + w.v2.re) / 6.0;
+#else
+            energy.y += (hgpu_double) (w.u1.re + w.v2.re) / 4.0;
+#endif
+        }
+#endif
+#if SUN == 3
+        su3_twist twist;
+        twist.phi   = lattice_parameters[1];
+        twist.omega = lattice_parameters[2];
+        gpu_su_3 m0;
+        su_3 staple,u,w;
+        for (uint dir = X; dir <= T; dir++){
+            m0     = lattice_table_3(lattice_table,&coord,gindex,dir,&twist);
+            staple = lattice_staple_3(lattice_table,gindex,dir,&twist);
+            u      = lattice_reconstruct3(&m0);
+            w      = matrix_times_su3(&u,&staple);
+            p      = hmc_momenta[gindex + dir * ROWSIZE];
+            energy.x += 0.5 * (hgpu_double) dot(p,p);
+            p      = hmc_momenta[gindex + (4 + dir) * ROWSIZE];
+            energy.x += 0.5 * (hgpu_double) dot(p,p);
+#ifdef RECT_ACTION
+            energy.y += ACTION_C0 * (hgpu_double) (w.u1.re + w.v2.re + w.w3.re) / 4.0;
+            staple = lattice_staple_rectangle3(lattice_table,gindex,dir);
+            w      = matrix_times_su3(&u,&staple);
+            energy.y += ACTION_C1 * (hgpu_double) (w.u1.re + w.v2.re + w.w3.re) / 6.0;
+#else
+            energy.y += (hgpu_double) (w.u1.re + w.v2.re + w.w3.re) / 4.0;
+#endif
+        }
+#endif
+    }
+
+    hgpu_double2 out;
+    reduce_first_step_val_double2(lattice_lds,&energy,&out);
+    if (TID == 0) hmc_energy[BID] = out;
+}
+
+                                        __kernel void
+reduce_hmc_energy_double2(__global hgpu_double2 * hmc_energy,
+                          __global hgpu_double2 * hmc_hamiltonian,
+                          __local hgpu_double2  * lattice_lds,
+                          uint size)
+{
+    reduce_final_step_double2(lattice_lds,hmc_energy,size);
+    if (GID == 0) hmc_hamiltonian[0] = lattice_lds[0];
+}
+#endif
 #endif
                                                                                                                                                                  
                                                                                                                                                                  
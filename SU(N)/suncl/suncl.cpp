@@ -165,17 +165,23 @@ void        SubLattice::sublattice_analysis_SpatTemp(int data_size, model::enum_
 
         get_actions_avr     = true;  // calculate mean action values
         check_prngs         = false; // check PRNG production
+#ifdef CPU_RUN
+        CPU_threads         = 0;     // all available worker threads
+#endif
 #ifndef CPU_RUN
         PRNG_counter = 0;   // counter runs of subroutine PRNG_produce (for load_state purposes)
+        PRNG_state_size = 0;
+        PRNG_hmc_state_size = 0;
+        PRNG_hmc     = NULL;
         NAV_counter  = 0;   // number of performed thermalization cycles
         ITER_counter = 0;   // number of performed working cycles
         LOAD_state   = 0;
 #endif
-        lattice_full_size   = new int[ND_MAX];
-        lattice_domain_size = new int[ND_MAX];
+        lattice_full_size   = new int[ND_MAX]();
+        lattice_domain_size = new int[ND_MAX]();
+        lattice_domain_n1   = 0;    // sizes are taken from init file, analysis arrays below are reallocated by lattice_analysis
 #ifndef CPU_RUN
         // clear pointers
-        lattice_pointer_save         = NULL;
         lattice_pointer_last         = NULL;
         lattice_pointer_initial      = NULL;
         lattice_pointer_measurements = NULL;
@@ -368,6 +374,17 @@ void        model::lattice_get_init_file(char* file){
             if (!strcmp(parameters[parameters_items].Variable,"ITER"))  {ITER            = parameters[parameters_items].iVarVal;}
             if (!strcmp(parameters[parameters_items].Variable,"NITER")) {NITER           = parameters[parameters_items].iVarVal;}
             if (!strcmp(parameters[parameters_items].Variable,"NHIT"))  {NHIT            = parameters[parameters_items].iVarVal;}
+            if (!strcmp(parameters[parameters_items].Variable,"NOR"))   {NOR             = parameters[parameters_items].iVarVal;}
+            if (!strcmp(parameters[parameters_items].Variable,"HEATBATH")) {heatbath_KP  = (parameters[parameters_items].iVarVal == 1);}
+            if (!strcmp(parameters[parameters_items].Variable,"TILED"))    {update_tiled    = (parameters[parameters_items].iVarVal != 0);}
+            if (!strcmp(parameters[parameters_items].Variable,"LINKS"))    {link_storage    = (parameters[parameters_items].iVarVal == 8) ? model_link_storage_8 : model_link_storage_12;}
+            if (!strcmp(parameters[parameters_items].Variable,"HBSTATS"))  {get_heatbath_stats = (parameters[parameters_items].iVarVal != 0);}
+            if (!strcmp(parameters[parameters_items].Variable,"UPDATE"))   {update_engine   = (parameters[parameters_items].iVarVal == 1) ? model_update_hmc : model_update_heatbath;}
+            if (!strcmp(parameters[parameters_items].Variable,"HMCSTEPS")) {HMC_steps       = parameters[parameters_items].iVarVal;}
+            if (!strcmp(parameters[parameters_items].Variable,"HMCTAU"))   {HMC_tau         = parameters[parameters_items].fVarVal;}
+            if (!strcmp(parameters[parameters_items].Variable,"HMCINT"))   {HMC_integrator  = (parameters[parameters_items].iVarVal == 1) ? model_integrator_omelyan : model_integrator_leapfrog;}
+            if (!strcmp(parameters[parameters_items].Variable,"ACTION"))   {gauge_action    = (model_actions) parameters[parameters_items].iVarVal;}
+            if (!strcmp(parameters[parameters_items].Variable,"ACTIONC1")) {action_c1_custom = parameters[parameters_items].fVarVal;}
             if (!strcmp(parameters[parameters_items].Variable,"BETA"))  {BETA            = parameters[parameters_items].fVarVal;}
             if (!strcmp(parameters[parameters_items].Variable,"PHI"))   {PHI             = parameters[parameters_items].fVarVal;}
             if (!strcmp(parameters[parameters_items].Variable,"OMEGA")) {OMEGA           = parameters[parameters_items].fVarVal;}
@@ -384,6 +401,14 @@ void        model::lattice_get_init_file(char* file){
                 for(int j = 0; j < NPARTS; j++){
                     SubLat[j].PRNG0->parameters_setup(parameters[parameters_items].Variable, rnds[j], prng);
                 }
+            if (!strcmp(parameters[parameters_items].Variable,"PRNGADAPT")){
+                for(int j = 0; j < NPARTS; j++)
+                    SubLat[j].PRNG0->PRNG_adaptive = (parameters[parameters_items].iVarVal != 0);
+            }
+            if (!strcmp(parameters[parameters_items].Variable,"PRNGPRECISION")){
+                for(int j = 0; j < NPARTS; j++)
+                    SubLat[j].PRNG0->PRNG_precision = (parameters[parameters_items].iVarVal == 2) ? PRNG_CL::PRNG::PRNG_precision_double : PRNG_CL::PRNG::PRNG_precision_single;
+            }
 #else
             PRNG0->parameters_setup(parameters[parameters_items].Variable,parameters[parameters_items].iVarVal,parameters[parameters_items].txtVarVal);
 #endif
@@ -395,6 +420,9 @@ void        model::lattice_get_init_file(char* file){
                 finishpath = (char*) realloc(finishpath, (strlen(parameters[parameters_items].txtVarVal) + 1) * sizeof(char));
                 strcpy_s(finishpath,(strlen(parameters[parameters_items].txtVarVal) + 1),parameters[parameters_items].txtVarVal);
             }
+#ifdef CPU_RUN
+            if (!strcmp(parameters[parameters_items].Variable,"THREADS"))  {CPU_threads = parameters[parameters_items].iVarVal;}
+#endif
 #ifndef CPU_RUN
             if (!strcmp(parameters[parameters_items].Variable,"TURNOFFWAITING"))  {
                 GPU0->GPU_debug.local_run = true;
@@ -402,6 +430,34 @@ void        model::lattice_get_init_file(char* file){
             if (!strcmp(parameters[parameters_items].Variable,"REBUILDBINARY"))  {
                 GPU0->GPU_debug.rebuild_binary = true;
             }
+            if (!strcmp(parameters[parameters_items].Variable,"ASYNCDISPATCH"))  {
+                GPU0->GPU_debug.async_dispatch = true;
+            }
+            if (!strcmp(parameters[parameters_items].Variable,"AUTOTUNE"))  {
+                GPU0->GPU_debug.autotune = true;
+            }
+            if (!strcmp(parameters[parameters_items].Variable,"OVERLAPMEASUREMENTS"))  {
+                GPU0->GPU_debug.overlap_measurements = true;
+            }
+            if (!strcmp(parameters[parameters_items].Variable,"CACHEPATH"))  {
+                GPU0->program_cache_set_path(parameters[parameters_items].txtVarVal);
+            }
+            if (!strcmp(parameters[parameters_items].Variable,"CACHESIZE"))  {
+                GPU_CL::GPU::cache_size = parameters[parameters_items].iVarVal;
+            }
+            if (!strcmp(parameters[parameters_items].Variable,"TRACE"))  {
+                GPU0->GPU_debug.trace = true;
+            }
+            if (!strcmp(parameters[parameters_items].Variable,"TRACEFILE"))  {
+                GPU0->GPU_debug.trace = true;
+                GPU0->trace_set_path(parameters[parameters_items].txtVarVal);
+            }
+            if (!strcmp(parameters[parameters_items].Variable,"PEAKBANDWIDTH"))  {
+                GPU0->GPU_info.peak_bandwidth = parameters[parameters_items].fVarVal;
+            }
+            if (!strcmp(parameters[parameters_items].Variable,"PEAKGFLOPS"))  {
+                GPU0->GPU_info.peak_gflops = parameters[parameters_items].fVarVal;
+            }
 #endif
             if (!strcmp(parameters[parameters_items].Variable,"GETWILSON"))  {
                 get_wilson_loop = true;
@@ -561,6 +617,12 @@ char*       model::lattice_make_header(void){
     j  += sprintf_s(header+j,header_size-j, " iter (# of samples)         : %i\n",ITER);
     j  += sprintf_s(header+j,header_size-j, " nhit                        : %i\n",NHIT);
     j  += sprintf_s(header+j,header_size-j, " nhitPar                     : %i\n",NHITPar);
+    if (NOR > 0) j  += sprintf_s(header+j,header_size-j, " nor (overrelaxation sweeps) : %i\n",NOR);
+    if (heatbath_KP) j  += sprintf_s(header+j,header_size-j, " heatbath                    : Kennedy-Pendleton\n");
+    if (update_tiled) j += sprintf_s(header+j,header_size-j, " update                      : tiled (2x2x2x2 tiles in local memory)\n");
+    if (link_storage == model_link_storage_8) j += sprintf_s(header+j,header_size-j, " links                       : 8 parameters\n");
+    if (update_engine == model_update_hmc)
+        j  += sprintf_s(header+j,header_size-j, " update                      : HMC (%s, %i steps, tau=%f)\n",(HMC_integrator == model_integrator_omelyan) ? "Omelyan" : "leapfrog",HMC_steps,HMC_tau);
     if (precision == model::model_precision_single) j  += sprintf_s(header+j,header_size-j, " precision                   : single\n");
     if (precision == model::model_precision_mixed)  j  += sprintf_s(header+j,header_size-j, " precision                   : mixed\n");
     if (precision == model::model_precision_double)
@@ -588,7 +650,14 @@ char*       model::lattice_make_header(void){
     j  += sprintf_s(header+j,header_size-j, " Monte Carlo simulation of %uD SU(%u) LGT\n\n",lattice_nd,lattice_group);
 
     j  += sprintf_s(header+j,header_size-j, " ***************************************************\n");
-    j  += sprintf_s(header+j,header_size-j, " Sequential run on  CPU\n");
+    if (CPU_threads > 1) {
+        j  += sprintf_s(header+j,header_size-j, " Parallel run on  CPU (%i threads)\n",CPU_threads);
+        if (PRNG0->substreams_CPU())
+            j  += sprintf_s(header+j,header_size-j, " PRNs of threads: substreams of the generator\n");
+        else
+            j  += sprintf_s(header+j,header_size-j, " PRNs of threads: seeds hashed from randseries (generator has no jump-ahead)\n");
+    } else
+        j  += sprintf_s(header+j,header_size-j, " Sequential run on  CPU\n");
     j  += sprintf_s(header+j,header_size-j, " ***************************************************\n");
     j  += sprintf_s(header+j,header_size-j, " lattice size                : %3u x %3u x %3u x %3u\n",lattice_full_size[0],lattice_full_size[1],lattice_full_size[2],lattice_full_size[3]);
     j  += sprintf_s(header+j,header_size-j, " init                        : %i\n",INIT);
@@ -754,6 +823,25 @@ void        model::model_create(void){
 #endif
 
         turnoff_gramschmidt = false; // turn off Gram-Schmidt orthogonalization
+        NOR                 = 0;     // heatbath only, no overrelaxation sweeps
+        heatbath_KP         = false; // heatbath tries are capped by NHIT
+        update_tiled        = false; // one kernel per parity and direction of links
+        link_storage        = model_link_storage_12; // SU(3) links are stored by two rows
+        get_heatbath_stats  = false; // do not count heatbath tries
+        heatbath_tries      = 0.0;
+        heatbath_failures   = 0.0;
+        update_engine       = model_update_heatbath;     // heatbath (+ overrelaxation) updates
+        HMC_integrator      = model_integrator_leapfrog; // leapfrog integrator for HMC
+        HMC_steps           = 10;    // molecular dynamics steps per HMC trajectory
+        HMC_tau             = 1.0;   // HMC trajectory length
+        HMC_trajectories    = 0;
+        HMC_accepted        = 0;
+        HMC_dH              = 0.0;
+        HMC_exp_dH          = 0.0;
+        gauge_action        = model_action_wilson;       // Wilson plaquette action
+        action_c0           = 1.0;
+        action_c1           = 0.0;
+        action_c1_custom    = 0.0;   // c1 is taken from gauge_action
 
         get_plaquettes_avr  = true;  // calculate mean plaquette values
 #ifndef CPU_RUN
@@ -786,6 +874,10 @@ int         model::model_make_header(char* header,int header_size){
     if (get_F0mu)
         j  += sprintf_s(header+j,header_size-j," F0MU(%u, %u)\n",Fmunu_index1,Fmunu_index2);
 
+    if (action_c1 != 0.0) {
+        const char* action_names[] = {"Wilson", "Symanzik", "Iwasaki", "DBW2"};
+        j  += sprintf_s(header+j,header_size-j, " action                      : %s (c0=%f, c1=%f)\n",(action_c1_custom != 0.0) ? "custom" : action_names[gauge_action],action_c0,action_c1);
+    }
     j  += sprintf_s(header+j,header_size-j, " BETA                        : %16.13e\n",BETA);
     j  += sprintf_s(header+j,header_size-j, " PHI   (lambda_3)            : %16.13e\n",PHI);
     j  += sprintf_s(header+j,header_size-j, " OMEGA (lambda_8)            : %16.13e\n",OMEGA);
@@ -794,6 +886,126 @@ int         model::model_make_header(char* header,int header_size){
     return j;
 }
 
+void        model::lattice_action_init(void){
+    // improved actions S = beta/N * sum [c0 (N - Re Tr U_P) + c1 (N - Re Tr U_R)], c0 + 8 c1 = 1
+    switch (gauge_action){
+        case model_action_symanzik: action_c1 = -1.0 / 12.0; break;
+        case model_action_iwasaki:  action_c1 = -0.331;      break;
+        case model_action_dbw2:     action_c1 = -1.4088;     break;
+        default:                    action_c1 = 0.0;         break;
+    }
+    if (action_c1_custom != 0.0) action_c1 = action_c1_custom;
+
+    // rectangle updates are coloured by coordinates modulo 4
+    bool lattice_fits = true;
+    for (int i=0;i<lattice_nd;i++) if (lattice_full_size[i] % 4) lattice_fits = false;
+#ifdef BIGLAT
+    if (action_c1 != 0.0) {
+        printf("Improved gauge actions are not supported for multi-device lattice, Wilson action is used\n");
+        action_c1 = 0.0;
+    }
+#endif
+    if ((action_c1 != 0.0)&&(!((PHI==0.0)&&(OMEGA==0.0)))) {
+        printf("Improved gauge actions are not supported for twisted boundary conditions, Wilson action is used\n");
+        action_c1 = 0.0;
+    }
+    if ((action_c1 != 0.0)&&(!lattice_fits)) {
+        printf("Improved gauge actions require lattice sizes to be multiples of 4, Wilson action is used\n");
+        action_c1 = 0.0;
+    }
+    if (action_c1 == 0.0) {
+        gauge_action     = model_action_wilson;
+        action_c1_custom = 0.0;
+    }
+    action_c0 = 1.0 - 8.0 * action_c1;
+}
+
+void        model::lattice_tiled_init(void){
+    // tiles of 8 colours: tile coordinates modulo 2 up to flip of all of them, i.e. lattice sizes are multiples of 4
+    if (!update_tiled) return;
+    if (update_engine == model_update_hmc) {
+        update_tiled = false;
+        return;
+    }
+#ifdef BIGLAT
+    printf("Tiled update is not supported for multi-device lattice, standard update is used\n");
+    update_tiled = false;
+#endif
+    bool lattice_fits = true;
+    for (int i=0;i<lattice_nd;i++) if (lattice_full_size[i] % 4) lattice_fits = false;
+    if ((update_tiled)&&(!((PHI==0.0)&&(OMEGA==0.0)))) {
+        printf("Tiled update is not supported for twisted boundary conditions, standard update is used\n");
+        update_tiled = false;
+    }
+    if ((update_tiled)&&(action_c1 != 0.0)) {
+        printf("Tiled update is not supported for improved gauge actions, standard update is used\n");
+        update_tiled = false;
+    }
+    if ((update_tiled)&&(!lattice_fits)) {
+        printf("Tiled update requires lattice sizes to be multiples of 4, standard update is used\n");
+        update_tiled = false;
+    }
+#ifndef CPU_RUN
+    cl_ulong tile_size = 128 * lattice_nd * ((lattice_group == 3) ? 12 : lattice_group_elements[lattice_group-1]) / 4 * ((precision == model_precision_single) ? sizeof(cl_float4) : sizeof(cl_double4));
+    if ((update_tiled)&&(tile_size > GPU0->GPU_info.local_memory_size)) {
+        printf("Tiled update needs %u bytes of local memory, standard update is used\n",(unsigned int) tile_size);
+        update_tiled = false;
+    }
+#endif
+}
+
+void        model::lattice_links_init(void){
+    // 8-parameter links are supported for SU(3) on single device only
+    if (lattice_group != 3) link_storage = model_link_storage_12;   // SU(2) links are stored by 4 reals
+#ifdef BIGLAT
+    if (link_storage == model_link_storage_8) {
+        printf("Compressed links are not supported for multi-device lattice, 12-real links are used\n");
+        link_storage = model_link_storage_12;
+    }
+#endif
+#ifndef CPU_RUN
+    lattice_group_elements[2] = (link_storage == model_link_storage_8) ? 8 : 12;
+#endif
+}
+
+void        model::lattice_link_compress_3(const double* m,double* c){
+    // m = (u1.re, u2.re, u3.re, v3.re, u1.im, u2.im, u3.im, v3.im, v1.re, v2.re, v1.im, v2.im),
+    // c = (u1, u2, v3, arg u3, arg w3), where w = (u x v)*
+    double w3_re =   m[0] * m[9]  - m[4] * m[11] - m[1] * m[8]  + m[5] * m[10];
+    double w3_im = -(m[0] * m[11] + m[4] * m[9]  - m[1] * m[10] - m[5] * m[8]);
+
+    c[0] = m[0];    c[1] = m[4];
+    c[2] = m[1];    c[3] = m[5];
+    c[4] = m[3];    c[5] = m[7];
+    c[6] = atan2(m[6],m[2]);
+    c[7] = atan2(w3_im,w3_re);
+}
+
+void        model::lattice_link_decompress_3(const double* c,double* m){
+    // |u3| and |w3| follow from unit norm of row u and column 3, v1 and v2 - from (u,v) = 0 and w3 = (u1 v2 - u2 v1)*
+    double n = c[0] * c[0] + c[1] * c[1] + c[2] * c[2] + c[3] * c[3];
+    if (n == 0.0) {     // padding of lattice table
+        for (int i=0;i<12;i++) m[i] = 0.0;
+        return;
+    }
+    n = fmin(n, 1.0);   // |u1|^2 + |u2|^2 <= 1 up to rounding
+    double au3  = sqrt(fmax(0.0, 1.0 - n));
+    double aw3  = sqrt(fmax(0.0, n - c[4] * c[4] - c[5] * c[5]));
+    double u3re = au3 * cos(c[6]);
+    double u3im = au3 * sin(c[6]);
+    double w3re = aw3 * cos(c[7]);
+    double w3im = aw3 * sin(c[7]);
+    double tre  = u3re * c[4] + u3im * c[5];   // u3* v3
+    double tim  = u3re * c[5] - u3im * c[4];
+
+    m[0] = c[0];    m[1] = c[2];    m[2]  = u3re;   m[3]  = c[4];
+    m[4] = c[1];    m[5] = c[3];    m[6]  = u3im;   m[7]  = c[5];
+    m[8]  = -(tre * c[0] - tim * c[1] + c[2] * w3re - c[3] * w3im) / n;
+    m[9]  =  (c[0] * w3re - c[1] * w3im - c[2] * tre + c[3] * tim) / n;
+    m[10] = -(tre * c[1] + tim * c[0] - c[2] * w3im - c[3] * w3re) / n;
+    m[11] = -(c[0] * w3im + c[1] * w3re + c[2] * tim + c[3] * tre) / n;
+}
+
 char*       model::lattice_make_header2(void){
     int header_size = 16384;
     int j = header_index;
@@ -810,49 +1022,61 @@ char*       model::lattice_make_header2(void){
     j  += sprintf_s(header+j,header_size-j, " Finish time              : %s",timeend);
     j  += sprintf_s(header+j,header_size-j, " Elapsed time             : %i:%2.2i:%2.2i:%2.2i\n",elapsdays,elapshours,elapsminites,elapsseconds);
     j  += sprintf_s(header+j,header_size-j, " ***************************************************\n");
-    j  += sprintf_s(header+j,header_size-j, " Mean %-20s: % 16.13e\n",    Analysis[DM_S_total].data_name,Analysis[DM_S_total].mean_value);
-    j  += sprintf_s(header+j,header_size-j, " Variance %-16s: % 16.13e\n",Analysis[DM_S_total].data_name,Analysis[DM_S_total].variance);
-    j  += sprintf_s(header+j,header_size-j, " Mean %-20s: % 16.13e\n",    Analysis[DM_Plq_total].data_name,Analysis[DM_Plq_total].mean_value);
-    j  += sprintf_s(header+j,header_size-j, " Variance %-16s: % 16.13e\n",Analysis[DM_Plq_total].data_name,Analysis[DM_Plq_total].variance);
-    j  += sprintf_s(header+j,header_size-j, " Mean %-20s: % 16.13e\n",    Analysis[DM_Polyakov_loop].data_name,Analysis[DM_Polyakov_loop].mean_value);
-    j  += sprintf_s(header+j,header_size-j, " Variance %-16s: % 16.13e\n",Analysis[DM_Polyakov_loop].data_name,Analysis[DM_Polyakov_loop].variance);
-    j  += sprintf_s(header+j,header_size-j, " Mean %-20s: % 16.13e\n",    Analysis[DM_Polyakov_loop_im].data_name,Analysis[DM_Polyakov_loop_im].mean_value);
-    j  += sprintf_s(header+j,header_size-j, " Variance %-16s: % 16.13e\n",Analysis[DM_Polyakov_loop_im].data_name,Analysis[DM_Polyakov_loop_im].variance);
-    j  += sprintf_s(header+j,header_size-j, " Mean %-20s: % 16.13e\n",    Analysis[DM_Polyakov_loop_P2].data_name,Analysis[DM_Polyakov_loop_P2].mean_value);
-    j  += sprintf_s(header+j,header_size-j, " Variance %-16s: % 16.13e\n",Analysis[DM_Polyakov_loop_P2].data_name,Analysis[DM_Polyakov_loop_P2].variance);
-    j  += sprintf_s(header+j,header_size-j, " Mean %-20s: % 16.13e\n",    Analysis[DM_Polyakov_loop_P4].data_name,Analysis[DM_Polyakov_loop_P4].mean_value);
-    j  += sprintf_s(header+j,header_size-j, " Variance %-16s: % 16.13e\n",Analysis[DM_Polyakov_loop_P4].data_name,Analysis[DM_Polyakov_loop_P4].variance);
-    j  += sprintf_s(header+j,header_size-j, " Mean %-20s: % 16.13e\n",    Analysis[DM_Wilson_loop].data_name,Analysis[DM_Wilson_loop].mean_value);
-    j  += sprintf_s(header+j,header_size-j, " Variance %-16s: % 16.13e\n",Analysis[DM_Wilson_loop].data_name,Analysis[DM_Wilson_loop].variance);
+    // quantities which were not measured have no data_name and are not printed
+    const int results_summary[] = {DM_S_total,DM_Plq_total,DM_Polyakov_loop,DM_Polyakov_loop_im,DM_Polyakov_loop_P2,DM_Polyakov_loop_P4,DM_Wilson_loop};
+    const int results_summary_number = (int) (sizeof(results_summary) / sizeof(results_summary[0]));
+    for (int i=0;i<results_summary_number;i++) if (Analysis[results_summary[i]].data_name) {
+        j  += sprintf_s(header+j,header_size-j, " Mean %-20s: % 16.13e\n",    Analysis[results_summary[i]].data_name,Analysis[results_summary[i]].mean_value);
+        j  += sprintf_s(header+j,header_size-j, " Variance %-16s: % 16.13e\n",Analysis[results_summary[i]].data_name,Analysis[results_summary[i]].variance);
+    }
     j  += sprintf_s(header+j,header_size-j, " ***************************************************\n");
+    if (get_heatbath_stats) {
+        j  += sprintf_s(header+j,header_size-j, " Heatbath tries per update: % 16.13e\n",heatbath_tries);
+        j  += sprintf_s(header+j,header_size-j, " Heatbath failure rate    : % 16.13e\n",heatbath_failures);
+        j  += sprintf_s(header+j,header_size-j, " ***************************************************\n");
+    }
+#ifndef CPU_RUN
+#ifdef BIGLAT
+    for (int k = 0; k < lattice_Nparts; k++) {
+        int jd = SubLat[k].PRNG0->print_demand((header+j),(header_size-j));
+        j  += jd;
+        if (jd) j  += sprintf_s(header+j,header_size-j, " ***************************************************\n");
+    }
+#else
+    int jd = PRNG0->print_demand((header+j),(header_size-j));
+    j  += jd;
+    if (jd) j  += sprintf_s(header+j,header_size-j, " ***************************************************\n");
+#endif
+#endif
+    if ((update_engine == model_update_hmc)&&(HMC_trajectories > 0)) {
+        j  += sprintf_s(header+j,header_size-j, " HMC trajectories         : %i\n",HMC_trajectories);
+        j  += sprintf_s(header+j,header_size-j, " HMC acceptance rate      : % 16.13e\n",(double) HMC_accepted / HMC_trajectories);
+        j  += sprintf_s(header+j,header_size-j, " HMC mean dH              : % 16.13e\n",HMC_dH / HMC_trajectories);
+        j  += sprintf_s(header+j,header_size-j, " HMC mean exp(-dH)        : % 16.13e\n",HMC_exp_dH / HMC_trajectories);
+        if (HMC_accepted == 0)
+        j  += sprintf_s(header+j,header_size-j, " HMC warning              : no trajectory accepted, step size HMCTAU/HMCSTEPS is too large\n");
+        j  += sprintf_s(header+j,header_size-j, " ***************************************************\n");
+    }
 
-    for (int i=0;i<((lattice_nd-1)*2+2)*2;i++)
-        j  += sprintf_s(header+j,header_size-j, " Mean %-20s: % 16.13e\n",Analysis[DM_Fmunu_3+i].data_name,Analysis[DM_Fmunu_3+i].mean_value);
-    for (int i=0;i<((lattice_nd-1)*2+2)*2;i++)
-        j  += sprintf_s(header+j,header_size-j, " Variance %-16s: % 16.13e\n",Analysis[DM_Fmunu_3+i].data_name,Analysis[DM_Fmunu_3+i].variance);
-    j  += sprintf_s(header+j,header_size-j, " ***************************************************\n");
-    for (int jj=0;jj<((lattice_nd-2)*(lattice_nd-1)+2)*2;jj++){
-        j  += sprintf_s(header+j,header_size-j, " GPU last %-16s: % 16.13e\n",Analysis[jj+DM_Fmunu_3].data_name,Analysis[jj+DM_Fmunu_3].GPU_last_value);
-        j  += sprintf_s(header+j,header_size-j, " CPU last %-16s: % 16.13e\n",Analysis[jj+DM_Fmunu_3].data_name,Analysis[jj+DM_Fmunu_3].CPU_last_value);
+    if (Analysis[DM_Fmunu_3].data_name) {
+        for (int i=0;i<((lattice_nd-1)*2+2)*2;i++)
+            j  += sprintf_s(header+j,header_size-j, " Mean %-20s: % 16.13e\n",Analysis[DM_Fmunu_3+i].data_name,Analysis[DM_Fmunu_3+i].mean_value);
+        for (int i=0;i<((lattice_nd-1)*2+2)*2;i++)
+            j  += sprintf_s(header+j,header_size-j, " Variance %-16s: % 16.13e\n",Analysis[DM_Fmunu_3+i].data_name,Analysis[DM_Fmunu_3+i].variance);
+        j  += sprintf_s(header+j,header_size-j, " ***************************************************\n");
+        for (int jj=0;jj<((lattice_nd-2)*(lattice_nd-1)+2)*2;jj++){
+            j  += sprintf_s(header+j,header_size-j, " GPU last %-16s: % 16.13e\n",Analysis[jj+DM_Fmunu_3].data_name,Analysis[jj+DM_Fmunu_3].GPU_last_value);
+            j  += sprintf_s(header+j,header_size-j, " CPU last %-16s: % 16.13e\n",Analysis[jj+DM_Fmunu_3].data_name,Analysis[jj+DM_Fmunu_3].CPU_last_value);
     }
     j  += sprintf_s(header+j,header_size-j, " ***************************************************\n");
     for (int jj=0;jj<(lattice_nd-2)*(lattice_nd-1)*2;jj++)
         j  += sprintf_s(header+j,header_size-j, " CPU l.varnc %-13s: % 16.13e\n",Analysis[jj+DM_Fmunu_3].data_name,Analysis[jj+DM_Fmunu_3].CPU_last_variance);
     j  += sprintf_s(header+j,header_size-j, " ***************************************************\n");
-    j  += sprintf_s(header+j,header_size-j, " CPU last %-16s: % 16.13e\n",Analysis[DM_S_total].data_name,Analysis[DM_S_total].CPU_last_value);
-    j  += sprintf_s(header+j,header_size-j, " GPU last %-16s: % 16.13e\n",Analysis[DM_S_total].data_name,Analysis[DM_S_total].GPU_last_value);
-    j  += sprintf_s(header+j,header_size-j, " CPU last %-16s: % 16.13e\n",Analysis[DM_Plq_total].data_name,Analysis[DM_Plq_total].CPU_last_value);
-    j  += sprintf_s(header+j,header_size-j, " GPU last %-16s: % 16.13e\n",Analysis[DM_Plq_total].data_name,Analysis[DM_Plq_total].GPU_last_value);
-    j  += sprintf_s(header+j,header_size-j, " CPU last %-16s: % 16.13e\n",Analysis[DM_Polyakov_loop].data_name,Analysis[DM_Polyakov_loop].CPU_last_value);
-    j  += sprintf_s(header+j,header_size-j, " GPU last %-16s: % 16.13e\n",Analysis[DM_Polyakov_loop].data_name,Analysis[DM_Polyakov_loop].GPU_last_value);
-    j  += sprintf_s(header+j,header_size-j, " CPU last %-16s: % 16.13e\n",Analysis[DM_Polyakov_loop_im].data_name,Analysis[DM_Polyakov_loop_im].CPU_last_value);
-    j  += sprintf_s(header+j,header_size-j, " GPU last %-16s: % 16.13e\n",Analysis[DM_Polyakov_loop_im].data_name,Analysis[DM_Polyakov_loop_im].GPU_last_value);
-    j  += sprintf_s(header+j,header_size-j, " CPU last %-16s: % 16.13e\n",Analysis[DM_Polyakov_loop_P2].data_name,Analysis[DM_Polyakov_loop_P2].CPU_last_value);
-    j  += sprintf_s(header+j,header_size-j, " GPU last %-16s: % 16.13e\n",Analysis[DM_Polyakov_loop_P2].data_name,Analysis[DM_Polyakov_loop_P2].GPU_last_value);
-    j  += sprintf_s(header+j,header_size-j, " CPU last %-16s: % 16.13e\n",Analysis[DM_Polyakov_loop_P4].data_name,Analysis[DM_Polyakov_loop_P4].CPU_last_value);
-    j  += sprintf_s(header+j,header_size-j, " GPU last %-16s: % 16.13e\n",Analysis[DM_Polyakov_loop_P4].data_name,Analysis[DM_Polyakov_loop_P4].GPU_last_value);
-    j  += sprintf_s(header+j,header_size-j, " CPU last %-16s: % 16.13e\n",Analysis[DM_Wilson_loop].data_name,Analysis[DM_Wilson_loop].CPU_last_value);
-    j  += sprintf_s(header+j,header_size-j, " GPU last %-16s: % 16.13e\n",Analysis[DM_Wilson_loop].data_name,Analysis[DM_Wilson_loop].GPU_last_value);
+    }
+    for (int i=0;i<results_summary_number;i++) if (Analysis[results_summary[i]].data_name) {
+        j  += sprintf_s(header+j,header_size-j, " CPU last %-16s: % 16.13e\n",Analysis[results_summary[i]].data_name,Analysis[results_summary[i]].CPU_last_value);
+        j  += sprintf_s(header+j,header_size-j, " GPU last %-16s: % 16.13e\n",Analysis[results_summary[i]].data_name,Analysis[results_summary[i]].GPU_last_value);
+    }
 #ifndef CPU_RUN
     if (analysis_CL::analysis::results_verification)
         j  += sprintf_s(header+j,header_size-j, " *** Verification successfully passed! *************\n");
@@ -1859,19 +2083,18 @@ void        model::lattice_save_state(void){
     time(&ltimesave);
     char* timesave   = GPU0->get_current_datetime();
 
-    lattice_pointer_save       = GPU0->buffer_map(lattice_table);
-    unsigned int* lattice_measurement_save   = GPU0->buffer_map(lattice_measurement);
-    unsigned int* lattice_energies_save      = GPU0->buffer_map(lattice_energies);
-    unsigned int* lattice_energies_plq_save  = NULL;
-    unsigned int* lattice_wilson_loop_save   = NULL;
-    unsigned int* lattice_polyakov_loop_save = NULL;
+    GPU0->device_synchronize();     // wait for asynchronously dispatched kernels
 
+    // start all readbacks at once, they are waited for in the order of writing
+    GPU0->buffer_read_async(lattice_table);
+    GPU0->buffer_read_async(lattice_measurement);
+    GPU0->buffer_read_async(lattice_energies);
     if ((get_plaquettes_avr) || (get_Fmunu) || (get_F0mu))
-        lattice_energies_plq_save  = GPU0->buffer_map(lattice_energies_plq);
+        GPU0->buffer_read_async(lattice_energies_plq);
     if (get_wilson_loop)
-        lattice_wilson_loop_save   = GPU0->buffer_map(lattice_wilson_loop);
+        GPU0->buffer_read_async(lattice_wilson_loop);
     if (PL_level > 0)
-        lattice_polyakov_loop_save = GPU0->buffer_map(lattice_polyakov_loop);
+        GPU0->buffer_read_async(lattice_polyakov_loop);
 
     FILE *stream;
     char buffer[250];
@@ -1887,18 +2110,24 @@ void        model::lattice_save_state(void){
     if(stream)
     {
         fwrite(head,sizeof(unsigned int),BIN_HEADER_SIZE,stream);                                       // write header
-        fwrite(lattice_measurement_save, sizeof(cl_double2), lattice_measurement_size_F, stream);       // write measurements
-        fwrite(lattice_energies_save,    sizeof(cl_double2), lattice_energies_size, stream);            // write energies
+        fwrite(GPU0->buffer_read_wait(lattice_measurement), sizeof(cl_double2), lattice_measurement_size_F, stream);       // write measurements
+        fwrite(GPU0->buffer_read_wait(lattice_energies),    sizeof(cl_double2), lattice_energies_size, stream);            // write energies
         if ((get_plaquettes_avr) || (get_Fmunu) || (get_F0mu))
-            fwrite(lattice_energies_plq_save,  sizeof(cl_double2), lattice_energies_size_F, stream);    // write energies_plq
+            fwrite(GPU0->buffer_read_wait(lattice_energies_plq),  sizeof(cl_double2), lattice_energies_size_F, stream);    // write energies_plq
         if (get_wilson_loop)
-            fwrite(lattice_wilson_loop_save,   sizeof(cl_double),  lattice_energies_size, stream);      // write wilson loop
+            fwrite(GPU0->buffer_read_wait(lattice_wilson_loop),   sizeof(cl_double),  lattice_energies_size, stream);      // write wilson loop
         if (PL_level > 0)
-            fwrite(lattice_polyakov_loop_save, sizeof(cl_double2), lattice_polyakov_loop_size, stream); // write polyakov loop
-        if (precision == model_precision_single)                                                        // write configuration
-            fwrite(lattice_pointer_save, sizeof(cl_float4), lattice_table_size, stream);
+            fwrite(GPU0->buffer_read_wait(lattice_polyakov_loop), sizeof(cl_double2), lattice_polyakov_loop_size, stream); // write polyakov loop
+        if (link_storage == model_link_storage_8) {                                                     // write configuration (12-real links)
+            void* lattice_table_full = lattice_table_expand(GPU0->buffer_read_wait(lattice_table));
+            fwrite(lattice_table_full, (precision == model_precision_single) ? sizeof(cl_float4) : sizeof(cl_double4), lattice_state_table_size, stream);
+            free(lattice_table_full);
+        } else if (precision == model_precision_single)                                                 // write configuration
+            fwrite(GPU0->buffer_read_wait(lattice_table), sizeof(cl_float4), lattice_table_size, stream);
         else
-            fwrite(lattice_pointer_save, sizeof(cl_double4), lattice_table_size, stream);
+            fwrite(GPU0->buffer_read_wait(lattice_table), sizeof(cl_double4), lattice_table_size, stream);
+        PRNG0->state_save(stream);                                                                      // write PRNG state
+        if (PRNG_hmc) PRNG_hmc->state_save(stream);                                                     // write PRNG state of HMC Metropolis step
 
         unsigned int hlen  = BIN_HEADER_SIZE*sizeof(unsigned int);
             if (GPU0->GPU_debug.brief_report) printf("Header: 0x%X-0x%X\n",0,hlen);
@@ -1924,15 +2153,33 @@ void        model::lattice_save_state(void){
             hlen += hlen2;
         }
         if (precision == model_precision_single)                                                        // write configuration
-            hlen2 = lattice_table_size * sizeof(cl_float4);
+            hlen2 = lattice_state_table_size * sizeof(cl_float4);
         else
-            hlen2 = lattice_table_size * sizeof(cl_double4);
+            hlen2 = lattice_state_table_size * sizeof(cl_double4);
         if (GPU0->GPU_debug.brief_report) printf("Lattice data: 0x%X-0x%X\n",hlen,(hlen+hlen2));
         hlen += hlen2;
+        hlen2 = PRNG0->state_size();
+        if (GPU0->GPU_debug.brief_report) printf("PRNG state: 0x%X-0x%X\n",hlen,(hlen+hlen2));
+        hlen += hlen2;
+        if (PRNG_hmc) {
+            hlen2 = PRNG_hmc->state_size();
+            if (GPU0->GPU_debug.brief_report) printf("HMC PRNG state: 0x%X-0x%X\n",hlen,(hlen+hlen2));
+            hlen += hlen2;
+        }
 
 
         if ( fclose(stream) ) printf( "The file was not closed!\n" );
     }
+    // host memory of readbacks is unmapped, staging areas are kept for the next save
+    GPU0->buffer_read_release(lattice_table);
+    GPU0->buffer_read_release(lattice_measurement);
+    GPU0->buffer_read_release(lattice_energies);
+    if ((get_plaquettes_avr) || (get_Fmunu) || (get_F0mu))
+        GPU0->buffer_read_release(lattice_energies_plq);
+    if (get_wilson_loop)
+        GPU0->buffer_read_release(lattice_wilson_loop);
+    if (PL_level > 0)
+        GPU0->buffer_read_release(lattice_polyakov_loop);
     free(head);
 }
 
@@ -1983,6 +2230,12 @@ unsigned int*   model::lattice_make_bin_header(void){
     result[k++] = lattice_nd;
     for (int i=0; i<lattice_nd; i++) result[k++] = lattice_full_size[i];
     for (int i=0; i<lattice_nd; i++) result[k++] = lattice_domain_size[i];
+    result[k++] = PRNG0->state_size();         // PRNG state follows lattice data
+    result[k++] = PRNG0->PRNG_stream;
+    result[k++] = (unsigned int) gauge_action;
+    result[k++] = GPU0->convert_to_uint_LOW( action_c1_custom);
+    result[k++] = GPU0->convert_to_uint_HIGH(action_c1_custom);
+    result[k++] = (PRNG_hmc) ? PRNG_hmc->state_size() : 0;  // PRNG state of HMC Metropolis step follows PRNG state
 
     return result;
 }
@@ -2036,6 +2289,16 @@ bool        model::lattice_load_bin_header(unsigned int* head){
     lattice_nd = head[k++];                             // 0x90
     for (int i=0; i<lattice_nd; i++) lattice_full_size[i] = head[k++];   // 0x98, 0x9C, 0xA0, 0xA4
     for (int i=0; i<lattice_nd; i++) lattice_domain_size[i] = head[k++]; // 0xA8, 0xAC, 0xB0, 0xB4
+    PRNG_state_size = head[k++];                        // 0xB8 (0 for state files without PRNG state)
+    PRNG0->PRNG_stream = head[k++];                     // 0xBC
+    model_actions state_action = (model_actions) head[k++];             // 0xC0 (Wilson for state files without gauge action)
+    get_low  = head[k++]; get_high = head[k++];         // 0xC4, 0xC8
+    double state_c1_custom = GPU0->convert_to_double(get_low,get_high);
+    if ((state_action != gauge_action)||(state_c1_custom != action_c1_custom))
+        printf("[Gauge action of init file differs from state file, action of state file is used]\n");
+    gauge_action     = state_action;
+    action_c1_custom = state_c1_custom;
+    PRNG_hmc_state_size = head[k++];                    // 0xCC (0 for state files without HMC PRNG state)
 
     return result;
 }
@@ -2066,10 +2329,26 @@ void        model::lattice_load_state(void){
                 fread(plattice_wilson_loop,   sizeof(cl_double),  lattice_energies_size, stream);      // load wilson loop
             if (PL_level > 0)
                 fread(plattice_polyakov_loop, sizeof(cl_double2), lattice_polyakov_loop_size, stream); // load polyakov loop
-            if (precision == model_precision_single)                                                   // load configuration
+            if (link_storage == model_link_storage_8) {                                                // load configuration (12-real links)
+                size_t size_of_row = (precision == model_precision_single) ? sizeof(cl_float4) : sizeof(cl_double4);
+                void* lattice_table_full = calloc(lattice_state_table_size, size_of_row);
+                fread(lattice_table_full, size_of_row, lattice_state_table_size, stream);
+                lattice_table_compress((precision == model_precision_single) ? (void*) plattice_table_float : (void*) plattice_table_double, lattice_table_full);
+                free(lattice_table_full);
+            } else if (precision == model_precision_single)                                            // load configuration
                 fread(plattice_table_float,   sizeof(cl_float4),  lattice_table_size, stream);
             else
                 fread(plattice_table_double,  sizeof(cl_double4), lattice_table_size, stream);
+            if (PRNG_state_size) {                                                                     // load PRNG state
+                if ((PRNG_state_size == PRNG0->state_size()) && (PRNG0->state_load(stream)))
+                    PRNG_counter = PRNG0->PRNG_counter;     // PRNG is restored, no adjustment by produce() is needed
+                else
+                    printf("[PRNG state does not match, PRNG is adjusted by PRNG_counter]\n");
+            }
+            if (PRNG_hmc) {                                                                            // load PRNG state of HMC Metropolis step
+                if (!((PRNG_hmc_state_size == PRNG_hmc->state_size()) && (PRNG_hmc->state_load(stream))))
+                    printf("[HMC PRNG state does not match, Metropolis step PRNs start from initial seed]\n");
+            }
 
             if ( fclose(stream) ) printf( "The file was not closed!\n" );
         }
@@ -2078,6 +2357,50 @@ void        model::lattice_load_state(void){
     free(head);
 }
 
+void*       model::lattice_table_expand(void* table){
+    // 8-parameter links (rows 4*k + dir, k = 0,1) -> 12-real links (rows 4*k + dir, k = 0..2)
+    bool single = (precision == model_precision_single);
+    void* table_full = calloc(lattice_state_table_size, single ? sizeof(cl_float4) : sizeof(cl_double4));
+    double c[8], m[12];
+    for (lattice_index gindex = 0; gindex < lattice_table_row_size; gindex++)
+        for (int dir = 0; dir < lattice_nd; dir++) {
+            for (int k = 0; k < 2; k++)
+                for (int i = 0; i < 4; i++) {
+                    lattice_index idx = (gindex + (4 * k + dir) * lattice_table_row_size) * 4 + i;
+                    c[4 * k + i] = single ? (double) ((cl_float*) table)[idx] : ((cl_double*) table)[idx];
+                }
+            lattice_link_decompress_3(c,m);
+            for (int k = 0; k < 3; k++)
+                for (int i = 0; i < 4; i++) {
+                    lattice_index idx = (gindex + (4 * k + dir) * lattice_table_row_size) * 4 + i;
+                    if (single) ((cl_float*) table_full)[idx] = (cl_float) m[4 * k + i];
+                    else        ((cl_double*) table_full)[idx] = m[4 * k + i];
+                }
+        }
+    return table_full;
+}
+
+void        model::lattice_table_compress(void* table,void* table_full){
+    // 12-real links (rows 4*k + dir, k = 0..2) -> 8-parameter links (rows 4*k + dir, k = 0,1)
+    bool single = (precision == model_precision_single);
+    double c[8], m[12];
+    for (lattice_index gindex = 0; gindex < lattice_table_row_size; gindex++)
+        for (int dir = 0; dir < lattice_nd; dir++) {
+            for (int k = 0; k < 3; k++)
+                for (int i = 0; i < 4; i++) {
+                    lattice_index idx = (gindex + (4 * k + dir) * lattice_table_row_size) * 4 + i;
+                    m[4 * k + i] = single ? (double) ((cl_float*) table_full)[idx] : ((cl_double*) table_full)[idx];
+                }
+            lattice_link_compress_3(m,c);
+            for (int k = 0; k < 2; k++)
+                for (int i = 0; i < 4; i++) {
+                    lattice_index idx = (gindex + (4 * k + dir) * lattice_table_row_size) * 4 + i;
+                    if (single) ((cl_float*) table)[idx] = (cl_float) c[4 * k + i];
+                    else        ((cl_double*) table)[idx] = c[4 * k + i];
+                }
+        }
+}
+
 int getK(int n1, int n2, int ws)
 {
   int i;
@@ -2115,6 +2438,7 @@ void        model::Fmunu_defaults(void)
 }
 void        model::model_lattice_init(void){
     Fmunu_defaults();
+    lattice_links_init();   // link storage defines sizes of sublattice tables
 
     //size_t workgroup_factor;
     int wln;
@@ -2188,19 +2512,32 @@ void        model::model_lattice_init(void){
 
         //_____________________________________________ PRNG preparation
         SubLat[k].PRNG0->ndev = k + 1;
+        SubLat[k].PRNG0->PRNG_stream = k;   // disjoint streams of sublattices (XOR128, RANECU, MRG32k3a)
         SubLat[k].PRNG0->PRNG_instances   = 0;    // number of instances of generator (or 0 for autoselect)
         // number of samples produced by each generator (quads)
         if (ints == model_start_hot)
             SubLat[k].PRNG0->PRNG_samples     = SubLat[k].GPU0->buffer_size_align((unsigned int) ceil(double(SubLat[k].sublattice_table_row_size * lattice_nd + 3 * SubLat[k].sublattice_table_row_size_half * (NHIT + 1))));
         else
             SubLat[k].PRNG0->PRNG_samples     = SubLat[k].GPU0->buffer_size_align((unsigned int) ceil(double(NHITPar * (3 * SubLat[k].sublattice_table_row_size_half * (NHIT + 1))))); 
+        if ((SubLat[k].PRNG0->PRNG_generator == PRNG_CL::PRNG::PRNG_generator_PHILOX) && (ints != model_start_gid))
+            SubLat[k].PRNG0->PRNG_in_kernels  = true;   // PRNs are computed inside kernels, buffer is filled for checks only
+        if (precision == model_precision_single)
+            SubLat[k].PRNG0->PRNG_precision   = PRNG_CL::PRNG::PRNG_precision_single;  // single precision update takes single precision PRNs
         
         SubLat[k].PRNG0->GPU0 = SubLat[k].GPU0;
         SubLat[k].prngstep = SubLat[k].sublattice_table_row_size_half;
     }
+    if (update_engine == model_update_hmc) {
+        printf("HMC is not supported for multi-device lattice, heatbath is used\n");
+        update_engine = model_update_heatbath;
+    }
+    lattice_action_init();
+    lattice_tiled_init();
         //_____________________________________________ PRNG initialization
     for (int k = 0; k < lattice_Nparts; k++){
         SubLat[k].PRNG0->initialize();
+        if (check_prngs) SubLat[k].PRNG0->check();
+        SubLat[k].PRNG0->demand_initialize(SubLat[k].prngstep, (lattice_group == 3) ? 3 * NHITPar * (NHIT + 1) : NHIT + 1);
         SubLat[k].GPU0->print_stage("PRNGs initialized");
     }
         //-----------------------------------------------------------------
@@ -2268,25 +2605,27 @@ void        model::model_lattice_init(void){
     lattice_energies_size_F         = lattice_energies_size * MODEL_energies_size;        // number of working iterations (for tensor Fmunu)
     lattice_energies_offset         = lattice_energies_size;
 
+    lattice_links_init();
     lattice_boundary_size           = GPU0->buffer_size_align(lattice_boundary_exact_size);
     lattice_table_row_size          = GPU0->buffer_size_align(lattice_domain_site);
     lattice_table_row_size_half     = GPU0->buffer_size_align(lattice_domain_site / 2);
     lattice_table_exact_row_size    = GPU0->buffer_size_align(lattice_domain_exact_site);
     lattice_table_exact_row_size_half=GPU0->buffer_size_align(lattice_domain_exact_site / 2);
     lattice_table_size              = GPU0->buffer_size_align(lattice_table_row_size * lattice_nd * lattice_group_elements[lattice_group-1] / 4);
+    lattice_state_table_size        = (link_storage == model_link_storage_8) ? GPU0->buffer_size_align(lattice_table_row_size * lattice_nd * 12 / 4) : lattice_table_size;
     lattice_table_group             = GPU0->buffer_size_align(lattice_table_row_size * lattice_nd);
     lattice_table_exact_group       = GPU0->buffer_size_align(lattice_table_exact_row_size * lattice_nd);
 
-    lattice_measurement_size        = GPU0->buffer_size_align((unsigned int) ceil((double) lattice_table_exact_row_size / workgroup_factor)); // workgroup_factor is the minimum number of workgroup items
+    lattice_measurement_size        = GPU0->buffer_size_align((lattice_index) ceil((double) lattice_table_exact_row_size / workgroup_factor)); // workgroup_factor is the minimum number of workgroup items
     lattice_measurement_size_F      = lattice_measurement_size * MODEL_energies_size;
     lattice_measurement_offset      = lattice_measurement_size;
 
     if (PL_level>2)
-      lattice_polyakov_size         = GPU0->buffer_size_align((unsigned int) (lattice_domain_n2n3 * getK(lattice_domain_n1, lattice_domain_size[1], GPU0->GPU_limit_max_workgroup_size)));
+      lattice_polyakov_size         = GPU0->buffer_size_align((lattice_index) (lattice_domain_n2n3 * getK(lattice_domain_n1, lattice_domain_size[1], GPU0->GPU_limit_max_workgroup_size)));
     else
-      lattice_polyakov_size           = GPU0->buffer_size_align((unsigned int) lattice_domain_exact_n1n2n3);
+      lattice_polyakov_size           = GPU0->buffer_size_align((lattice_index) lattice_domain_exact_n1n2n3);
     lattice_polyakov_loop_size      = GPU0->buffer_size_align(ITER);      // number of working iterations
-    lattice_polyakov_loop_offset    = GPU0->buffer_size_align((unsigned int) ceil((double) lattice_polyakov_size / workgroup_factor));
+    lattice_polyakov_loop_offset    = GPU0->buffer_size_align((lattice_index) ceil((double) lattice_polyakov_size / workgroup_factor));
 
     if(get_actions_diff)
       lattice_action_size = GPU0->buffer_size_align((unsigned int) (lattice_domain_n2n3n4 * getK(lattice_domain_n1, lattice_domain_size[1], GPU0->GPU_limit_max_workgroup_size)));
@@ -2297,6 +2636,11 @@ void        model::model_lattice_init(void){
         lattice_energies_size_F    = lattice_energies_size;
         lattice_measurement_size_F = lattice_measurement_size;
     }
+    // lattice_polyakov writes second moments at lattice_measurement[BID + offset]
+    if ((PL_level > 1) && (lattice_measurement_size_F < 2 * lattice_polyakov_loop_offset))
+        lattice_measurement_size_F = 2 * lattice_polyakov_loop_offset;
+    // lattice_heatbath_stats writes failed updates at lattice_heatbath_reduce[BID + offset]
+    size_lattice_heatbath_reduce    = 2 * GPU0->buffer_size_align((lattice_index) ceil((double) lattice_table_row_size_half / workgroup_factor));
 
     //_____________________________________________ PRNG preparation
         PRNG0->PRNG_instances   = 0;    // number of instances of generator (or 0 for autoselect)
@@ -2305,60 +2649,77 @@ void        model::model_lattice_init(void){
             PRNG0->PRNG_samples     = GPU0->buffer_size_align((unsigned int) ceil(double(lattice_table_row_size * lattice_nd + 3 * lattice_table_row_size_half * (NHIT + 1))));
         else
             PRNG0->PRNG_samples     = GPU0->buffer_size_align((unsigned int) ceil(double(NHITPar * (3 * lattice_table_row_size_half * (NHIT + 1))))); // 3*(NHIT+1) PRNs per link
+        if ((PRNG0->PRNG_generator == PRNG_CL::PRNG::PRNG_generator_PHILOX) && (ints != model_start_gid))
+            PRNG0->PRNG_in_kernels  = true;     // PRNs are computed inside kernels, buffer is filled for checks only
+        if (precision == model_precision_single)
+            PRNG0->PRNG_precision   = PRNG_CL::PRNG::PRNG_precision_single;    // single precision update takes single precision PRNs
         
         PRNG0->GPU0 = GPU0;
         prngstep = lattice_table_row_size_half;
+
+        if ((update_engine == model_update_hmc)&&(!((PHI==0.0)&&(OMEGA==0.0)))) {
+            printf("HMC is not supported for twisted boundary conditions, heatbath is used\n");
+            update_engine = model_update_heatbath;
+        }
+        if (update_engine == model_update_hmc)
+            PRNG0->PRNG_adaptive = false;   // momenta refresh takes a fixed number of PRNs
+        lattice_action_init();
+        if (action_c1 != 0.0)
+            PRNG0->PRNG_adaptive = false;   // colours of rectangle update take fixed slices of PRNs
+        lattice_tiled_init();
+        if (update_tiled)
+            PRNG0->PRNG_adaptive = false;   // links of tile take fixed slices of PRNs
     //-----------------------------------------------------------------
 
     if (GPU0->GPU_debug.brief_report) {
         printf("Full lattice: -----------------------\n");
-        printf("sites                       = %u\n",lattice_full_site);
+        printf("sites                       = " LATTICE_INDEX_FMT "\n",lattice_full_site);
         printf("n1n2n3                      = %u\n",lattice_full_n1n2n3);
         printf("Domain lattice: ---------------------\n");
-        printf("sites                       = %u\n",lattice_domain_site);
-        printf("link                        = %u\n",lattice_domain_link);
+        printf("sites                       = " LATTICE_INDEX_FMT "\n",lattice_domain_site);
+        printf("link                        = " LATTICE_INDEX_FMT "\n",lattice_domain_link);
         printf("n1n2n3                      = %u\n",lattice_domain_n1n2n3);
-        printf("sites (exact)               = %u\n",lattice_domain_exact_site);
-        printf("links (exact)               = %u\n",lattice_domain_exact_link);
+        printf("sites (exact)               = " LATTICE_INDEX_FMT "\n",lattice_domain_exact_site);
+        printf("links (exact)               = " LATTICE_INDEX_FMT "\n",lattice_domain_exact_link);
         printf("n1n2n3 (exact)              = %u\n",lattice_domain_exact_n1n2n3);
-        printf("lattice_table_exact_row_size= %u\n",lattice_table_exact_row_size);
-        printf("..table_exact_row_size_half = %u\n",lattice_table_exact_row_size_half);
+        printf("lattice_table_exact_row_size= " LATTICE_INDEX_FMT "\n",lattice_table_exact_row_size);
+        printf("..table_exact_row_size_half = " LATTICE_INDEX_FMT "\n",lattice_table_exact_row_size_half);
         printf("-------------------------------------\n");
         printf("workgroup_size              = %u\n",(unsigned int) (GPU0->GPU_info.max_workgroup_size));
-        printf("measurements                = %u\n",lattice_domain_exact_site / (unsigned int) GPU0->GPU_info.max_workgroup_size);
-        printf("lattice_table_row_size      = %u\n",lattice_table_row_size);
-        printf("lattice_table_row_size_half = %u\n",lattice_table_row_size_half);
-        printf("lattice_table_size          = %u\n",lattice_table_size);
-        printf("lattice_table_group         = %u\n",lattice_table_group);
-        printf("lattice_measurement_size    = %u\n",lattice_measurement_size);
+        printf("measurements                = " LATTICE_INDEX_FMT "\n",lattice_domain_exact_site / (unsigned int) GPU0->GPU_info.max_workgroup_size);
+        printf("lattice_table_row_size      = " LATTICE_INDEX_FMT "\n",lattice_table_row_size);
+        printf("lattice_table_row_size_half = " LATTICE_INDEX_FMT "\n",lattice_table_row_size_half);
+        printf("lattice_table_size          = " LATTICE_INDEX_FMT "\n",lattice_table_size);
+        printf("lattice_table_group         = " LATTICE_INDEX_FMT "\n",lattice_table_group);
+        printf("lattice_measurement_size    = " LATTICE_INDEX_FMT "\n",lattice_measurement_size);
         printf("lattice_measurement_size_F  = %u\n",lattice_measurement_size_F);
         printf("lattice_parameters_size     = %u\n",lattice_parameters_size);
         printf("lattice_energies_size       = %u\n",lattice_energies_size);
         printf("lattice_energies_size_F     = %u\n",lattice_energies_size_F);
-        printf("lattice_polyakov_size       = %u\n",lattice_polyakov_size);
+        printf("lattice_polyakov_size       = " LATTICE_INDEX_FMT "\n",lattice_polyakov_size);
         printf("lattice_polyakov_loop_size  = %u\n",lattice_polyakov_loop_size);
         printf("polykov_loop_offset         = %u\n",lattice_polyakov_loop_offset);
         printf("lattice_energies_offset     = %u\n",lattice_energies_offset);
         printf("local_size_intel            = %u\n",(unsigned int)local_size_intel);
         printf("kernels: ----------------------------\n");
-        printf("lattice_init                = %u\n",lattice_table_group);
-        printf("lattice_GramSchmidt         = %u\n",lattice_table_group);
-        printf("lattice_measurement         = %u\n",lattice_table_row_size);
-        printf("lattice_measurement_plq     = %u\n",lattice_table_row_size);
-        printf("lattice_measurement_wilson  = %u\n",lattice_table_row_size);
-        printf("update                      = %u\n",lattice_table_row_size_half);
-        printf("lattice_polyakov            = %u\n",lattice_polyakov_size);
+        printf("lattice_init                = " LATTICE_INDEX_FMT "\n",lattice_table_group);
+        printf("lattice_GramSchmidt         = " LATTICE_INDEX_FMT "\n",lattice_table_group);
+        printf("lattice_measurement         = " LATTICE_INDEX_FMT "\n",lattice_table_row_size);
+        printf("lattice_measurement_plq     = " LATTICE_INDEX_FMT "\n",lattice_table_row_size);
+        printf("lattice_measurement_wilson  = " LATTICE_INDEX_FMT "\n",lattice_table_row_size);
+        printf("update                      = " LATTICE_INDEX_FMT "\n",lattice_table_row_size_half);
+        printf("lattice_polyakov            = " LATTICE_INDEX_FMT "\n",lattice_polyakov_size);
         printf("PRNs (in quads): --------------------\n");
         printf("PRNG_instances              = %u\n",PRNG0->PRNG_instances);
         printf("PRNG_samples                = %u\n",PRNG0->PRNG_samples);
         printf("PRNs total                  = %u\n",PRNG0->PRNG_instances * PRNG0->PRNG_samples);
         printf("PRNG_step                   = %u\n",prngstep);
-        printf("PRNs for hot start          = %u\n",lattice_table_row_size * 3);
-        printf("PRNs for one update         = %u\n",int(ceil(double(3 * lattice_domain_link * (NHIT + 1)))));
+        printf("PRNs for hot start          = " LATTICE_INDEX_FMT "\n",lattice_table_row_size * 3);
+        printf("PRNs for one update         = " LATTICE_INDEX_FMT "\n",(lattice_index) (3 * lattice_domain_link * (NHIT + 1)));
         printf("-------------------------------------\n");
-        printf(" ROWSIZE                    = %u\n",lattice_table_row_size);
+        printf(" ROWSIZE                    = " LATTICE_INDEX_FMT "\n",lattice_table_row_size);
         printf(" NHIT                       = %u\n",NHIT);
-        printf(" PRNGSTEP                   = %u\n",lattice_table_row_size_half);
+        printf(" PRNGSTEP                   = " LATTICE_INDEX_FMT "\n",lattice_table_row_size_half);
         printf(" PRECISION                  = %u\n",precision);
         printf(" PL                         = %u\n",PL_level);
         printf(" ITER                       = %u\n",ITER);
@@ -2376,6 +2737,18 @@ void        model::model_lattice_init(void){
 
     //_____________________________________________ PRNG initialization
         PRNG0->initialize();
+        if (check_prngs) PRNG0->check();
+        PRNG0->demand_initialize(prngstep, (lattice_group == 3) ? 3 * NHITPar * (NHIT + 1) : NHIT + 1);
+        PRNG_hmc = NULL;
+        if (update_engine == model_update_hmc) {
+            // Metropolis step of HMC takes PRNs from separate CPU stream (next substream after GPU instances)
+            PRNG_hmc = new(PRNG_CL::PRNG);
+            PRNG_hmc->PRNG_generator  = PRNG0->PRNG_generator;
+            PRNG_hmc->PRNG_randseries = PRNG0->PRNG_randseries;
+            PRNG_hmc->PRNG_precision  = PRNG0->PRNG_precision;
+            PRNG_hmc->PRNG_stream     = PRNG0->PRNG_stream;
+            PRNG_hmc->initialize_CPU(PRNG0->PRNG_instances);
+        }
             GPU0->print_stage("PRNGs initialized");
     //-----------------------------------------------------------------
 
@@ -2412,6 +2785,9 @@ void    model::lattice_mp_Sim(void)
             options_length_common += sprintf_s(options_common + options_length_common, sizeof(options_common) - options_length_common, " -D GID_UPD");
         options_length_common += sprintf_s(options_common + options_length_common, sizeof(options_common) - options_length_common, " -D SUN=%u", lattice_group);
         options_length_common += sprintf_s(options_common + options_length_common, sizeof(options_common) - options_length_common, " -D ND=%u", lattice_nd);
+#ifdef INDEX64
+        options_length_common += sprintf_s(options_common + options_length_common, sizeof(options_common) - options_length_common, " -D INDEX64");      // 64-bit lattice indices
+#endif
         if (!((PHI == 0.0) && (OMEGA == 0.0))) options_length_common += sprintf_s(options_common + options_length_common, sizeof(options_common) - options_length_common, " -D TBC");     // turn on TBC
         options_length_common += sprintf_s(options_common + options_length_common, sizeof(options_common) - options_length_common, " -D PRECISION=%u", precision);
         
@@ -2444,6 +2820,12 @@ void    model::lattice_mp_Sim(void)
         options_length += sprintf_s(options + options_length, sizeof(options) - options_length, " -D NHIT=%u", NHIT);
         options_length += sprintf_s(options + options_length, sizeof(options) - options_length, " -D NHITPar=%u", NHITPar);
         options_length += sprintf_s(options + options_length, sizeof(options) - options_length, " -D PRNGSTEP=%u", SubLat[k].sublattice_table_row_size_half);
+        if (SubLat[k].PRNG0->PRNG_in_kernels)
+            options_length += sprintf_s(options + options_length, sizeof(options) - options_length, " -D PRNG_PHILOX -I %srandom", SubLat[k].GPU0->cl_root_path);
+        if (SubLat[k].PRNG0->PRNG_adaptive)
+            options_length += sprintf_s(options + options_length, sizeof(options) - options_length, " -D PRNG_DEMAND -D PRNG_DEMAND_BINS=%u -I %srandom", PRNG_DEMAND_BINS, SubLat[k].GPU0->cl_root_path);
+        if (heatbath_KP)
+            options_length += sprintf_s(options + options_length, sizeof(options) - options_length, " -D HEATBATH_KP -D PRNG_SLICE=%u -I %srandom", (lattice_group == 3) ? 3 * NHITPar * (NHIT + 1) : NHIT + 1, SubLat[k].GPU0->cl_root_path);
 
         j = sprintf_s(buffer_update_cl  ,FNAME_MAX_LENGTH,  "%s",SubLat[k].GPU0->cl_root_path);
         j+= sprintf_s(buffer_update_cl+j,FNAME_MAX_LENGTH-j,"%s",SOURCE_UPDATE);
@@ -2479,16 +2861,16 @@ void    model::lattice_kern_init_Sim(void)
         } else {
                 SubLat[k].sun_init_X_id = SubLat[k].GPU0->kernel_init("lattice_init_hot_X", 1, init_global_size, NULL);
                     argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_init_X_id,SubLat[k].sublattice_table);
-                    argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_init_X_id,SubLat[k].PRNG0->PRNG_randoms_id);
+                    argument_id = SubLat[k].PRNG0->kernel_init_prns(SubLat[k].sun_init_X_id);
                 SubLat[k].sun_init_Y_id = SubLat[k].GPU0->kernel_init("lattice_init_hot_Y", 1, init_global_size, NULL);
                     argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_init_Y_id,SubLat[k].sublattice_table);
-                    argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_init_Y_id,SubLat[k].PRNG0->PRNG_randoms_id);
+                    argument_id = SubLat[k].PRNG0->kernel_init_prns(SubLat[k].sun_init_Y_id);
                 SubLat[k].sun_init_Z_id = SubLat[k].GPU0->kernel_init("lattice_init_hot_Z", 1, init_global_size, NULL);
                     argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_init_Z_id,SubLat[k].sublattice_table);
-                    argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_init_Z_id,SubLat[k].PRNG0->PRNG_randoms_id);
+                    argument_id = SubLat[k].PRNG0->kernel_init_prns(SubLat[k].sun_init_Z_id);
                 SubLat[k].sun_init_T_id = SubLat[k].GPU0->kernel_init("lattice_init_hot_T", 1, init_global_size, NULL);
                     argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_init_T_id,SubLat[k].sublattice_table);
-                    argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_init_T_id,SubLat[k].PRNG0->PRNG_randoms_id);
+                    argument_id = SubLat[k].PRNG0->kernel_init_prns(SubLat[k].sun_init_T_id);
         }
 
         SubLat[k].sun_GramSchmidt_id = SubLat[k].GPU0->kernel_init("lattice_GramSchmidt",1,init_global_size,NULL); 
@@ -2521,42 +2903,50 @@ void    model::lattice_kern_update_Sim(void)
         SubLat[k].sun_update_odd_X_id = SubLat[k].GPU0->kernel_init("update_odd_X",1,monte_global_size, monte_local_size);
                 argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_update_odd_X_id,SubLat[k].sublattice_table);
                 argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_update_odd_X_id,SubLat[k].sublattice_parameters);
-                argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_update_odd_X_id,SubLat[k].PRNG0->PRNG_randoms_id);
+                argument_id = SubLat[k].PRNG0->kernel_init_prns(SubLat[k].sun_update_odd_X_id);
+                argument_id = SubLat[k].PRNG0->kernel_init_demand(SubLat[k].sun_update_odd_X_id);
 
         SubLat[k].sun_update_even_X_id = SubLat[k].GPU0->kernel_init("update_even_X",1,monte_global_size,NULL);
                 argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_update_even_X_id,SubLat[k].sublattice_table);
                 argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_update_even_X_id,SubLat[k].sublattice_parameters);
-                argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_update_even_X_id,SubLat[k].PRNG0->PRNG_randoms_id);
+                argument_id = SubLat[k].PRNG0->kernel_init_prns(SubLat[k].sun_update_even_X_id);
+                argument_id = SubLat[k].PRNG0->kernel_init_demand(SubLat[k].sun_update_even_X_id);
 
         SubLat[k].sun_update_odd_Y_id = SubLat[k].GPU0->kernel_init("update_odd_Y",1,monte_global_size,NULL);
                 argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_update_odd_Y_id,SubLat[k].sublattice_table);
                 argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_update_odd_Y_id,SubLat[k].sublattice_parameters);
-                argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_update_odd_Y_id,SubLat[k].PRNG0->PRNG_randoms_id);
+                argument_id = SubLat[k].PRNG0->kernel_init_prns(SubLat[k].sun_update_odd_Y_id);
+                argument_id = SubLat[k].PRNG0->kernel_init_demand(SubLat[k].sun_update_odd_Y_id);
 
         SubLat[k].sun_update_even_Y_id = SubLat[k].GPU0->kernel_init("update_even_Y",1,monte_global_size,NULL);
                 argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_update_even_Y_id,SubLat[k].sublattice_table);
                 argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_update_even_Y_id,SubLat[k].sublattice_parameters);
-                argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_update_even_Y_id,SubLat[k].PRNG0->PRNG_randoms_id);
+                argument_id = SubLat[k].PRNG0->kernel_init_prns(SubLat[k].sun_update_even_Y_id);
+                argument_id = SubLat[k].PRNG0->kernel_init_demand(SubLat[k].sun_update_even_Y_id);
 
         SubLat[k].sun_update_odd_Z_id = SubLat[k].GPU0->kernel_init("update_odd_Z",1,monte_global_size,NULL);
                 argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_update_odd_Z_id,SubLat[k].sublattice_table);
                 argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_update_odd_Z_id,SubLat[k].sublattice_parameters);
-                argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_update_odd_Z_id,SubLat[k].PRNG0->PRNG_randoms_id);
+                argument_id = SubLat[k].PRNG0->kernel_init_prns(SubLat[k].sun_update_odd_Z_id);
+                argument_id = SubLat[k].PRNG0->kernel_init_demand(SubLat[k].sun_update_odd_Z_id);
 
         SubLat[k].sun_update_even_Z_id = SubLat[k].GPU0->kernel_init("update_even_Z",1,monte_global_size,NULL);
                 argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_update_even_Z_id,SubLat[k].sublattice_table);
                 argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_update_even_Z_id,SubLat[k].sublattice_parameters);
-                argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_update_even_Z_id,SubLat[k].PRNG0->PRNG_randoms_id);
+                argument_id = SubLat[k].PRNG0->kernel_init_prns(SubLat[k].sun_update_even_Z_id);
+                argument_id = SubLat[k].PRNG0->kernel_init_demand(SubLat[k].sun_update_even_Z_id);
 
         SubLat[k].sun_update_odd_T_id = SubLat[k].GPU0->kernel_init("update_odd_T",1,monte_global_size,NULL);
                 argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_update_odd_T_id,SubLat[k].sublattice_table);
                 argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_update_odd_T_id,SubLat[k].sublattice_parameters);
-                argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_update_odd_T_id,SubLat[k].PRNG0->PRNG_randoms_id);
+                argument_id = SubLat[k].PRNG0->kernel_init_prns(SubLat[k].sun_update_odd_T_id);
+                argument_id = SubLat[k].PRNG0->kernel_init_demand(SubLat[k].sun_update_odd_T_id);
 
         SubLat[k].sun_update_even_T_id = SubLat[k].GPU0->kernel_init("update_even_T",1,monte_global_size,NULL);
                 argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_update_even_T_id,SubLat[k].sublattice_table);
                 argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_update_even_T_id,SubLat[k].sublattice_parameters);
-                argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_update_even_T_id,SubLat[k].PRNG0->PRNG_randoms_id);
+                argument_id = SubLat[k].PRNG0->kernel_init_prns(SubLat[k].sun_update_even_T_id);
+                argument_id = SubLat[k].PRNG0->kernel_init_demand(SubLat[k].sun_update_even_T_id);
     }
 }
 
@@ -2587,6 +2977,9 @@ void    model::lattice_mp_Meas(void)
             options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D GID_UPD");
         options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D SUN=%u",         lattice_group);
         options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D ND=%u",          lattice_nd);
+#ifdef INDEX64
+        options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D INDEX64");      // 64-bit lattice indices
+#endif
         if (!((PHI==0.0)&&(OMEGA==0.0))) options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D TBC");     // turn on TBC
         options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D PRECISION=%u", precision);   
     
@@ -2685,7 +3078,7 @@ void    model::lattice_kern_init_Plq(void)
         reduce_local_size[2] = 1;
 
         if ((get_plaquettes_avr)||(get_Fmunu)||(get_F0mu)) {
-            SubLat[k].sun_measurement_plq_id = SubLat[k].GPU0->kernel_init("lattice_measurement_plq",1,measurement3_global_size,local_size_lattice_measurement);
+            SubLat[k].sun_measurement_plq_id = SubLat[k].GPU0->kernel_init("lattice_measurement_plq",1,measurement3_global_size,local_size_lattice_measurement, false);
             offset_reduce_measurement_plq_double2 = SubLat[k].GPU0->buffer_size_align((unsigned int) ceil((double) SubLat[k].sublattice_table_row_size / SubLat[k].GPU0->kernel_get_worksize(SubLat[k].sun_measurement_plq_id)),SubLat[k].GPU0->kernel_get_worksize(SubLat[k].sun_measurement_plq_id));
             argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_measurement_plq_id,SubLat[k].sublattice_table);
             argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_measurement_plq_id,SubLat[k].sublattice_measurement);
@@ -2749,7 +3142,7 @@ void    model::lattice_kern_init_Action(void)
         reduce_local_size[2] = 1;
 
         if (get_actions_avr) {
-            SubLat[k].sun_measurement_id = SubLat[k].GPU0->kernel_init("lattice_measurement",1,measurement3_global_size,local_size_lattice_measurement);
+            SubLat[k].sun_measurement_id = SubLat[k].GPU0->kernel_init("lattice_measurement",1,measurement3_global_size,local_size_lattice_measurement, false);
            argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_measurement_id,SubLat[k].sublattice_table);
            argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_measurement_id,SubLat[k].sublattice_measurement);
            argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_measurement_id,SubLat[k].sublattice_parameters);
@@ -2798,7 +3191,7 @@ void    model::lattice_kern_init_Action_diff(void){
         measurement3_global_size[1] = 1;
         measurement3_global_size[2] = 1;
 
-    SubLat[k].sun_action_diff_x_id = SubLat[k].GPU0->kernel_init("lattice_action_diff_x", 1, measurement3_global_size, local_size_lattice_measurement);
+    SubLat[k].sun_action_diff_x_id = SubLat[k].GPU0->kernel_init("lattice_action_diff_x", 1, measurement3_global_size, local_size_lattice_measurement, false);
            argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_action_diff_x_id, SubLat[k].sublattice_table);
            argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_action_diff_x_id, SubLat[k].sublattice_measurement_diff);
            argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_action_diff_x_id, SubLat[k].sublattice_parameters);	
@@ -2820,7 +3213,7 @@ void    model::lattice_kern_init_Action_diff(void){
         measurement3_global_size[1] = 1;
         measurement3_global_size[2] = 1;
 
-        SubLat[k].sun_action_diff_y_id = SubLat[k].GPU0->kernel_init("lattice_action_diff_y", 1, measurement3_global_size, local_size_lattice_measurement);
+        SubLat[k].sun_action_diff_y_id = SubLat[k].GPU0->kernel_init("lattice_action_diff_y", 1, measurement3_global_size, local_size_lattice_measurement, false);
            argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_action_diff_y_id, SubLat[k].sublattice_table);
            argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_action_diff_y_id, SubLat[k].sublattice_measurement_diff);
            argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_action_diff_y_id, SubLat[k].sublattice_parameters);	
@@ -2842,7 +3235,7 @@ void    model::lattice_kern_init_Action_diff(void){
         measurement3_global_size[1] = 1;
         measurement3_global_size[2] = 1;
 
-        SubLat[k].sun_action_diff_z_id = SubLat[k].GPU0->kernel_init("lattice_action_diff_z", 1, measurement3_global_size, local_size_lattice_measurement);
+        SubLat[k].sun_action_diff_z_id = SubLat[k].GPU0->kernel_init("lattice_action_diff_z", 1, measurement3_global_size, local_size_lattice_measurement, false);
            argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_action_diff_z_id, SubLat[k].sublattice_table);
            argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_action_diff_z_id, SubLat[k].sublattice_measurement_diff);
            argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_action_diff_z_id, SubLat[k].sublattice_parameters);	
@@ -2883,6 +3276,9 @@ void    model::lattice_mp_PL(void)
             options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D GID_UPD");
         options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D SUN=%u",         lattice_group);
         options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D ND=%u",          lattice_nd);
+#ifdef INDEX64
+        options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D INDEX64");      // 64-bit lattice indices
+#endif
         if (!((PHI==0.0)&&(OMEGA==0.0))) options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D TBC");     // turn on TBC
         options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D PRECISION=%u", precision);   
     
@@ -2961,7 +3357,7 @@ void    model::lattice_kern_init_PL(void)
         reduce_local_size[1] = 1;
         reduce_local_size[2] = 1;
 
-        SubLat[k].sun_polyakov_id = SubLat[k].GPU0->kernel_init("lattice_polyakov", 1, polyakov3_global_size, local_size_lattice_polyakov);
+        SubLat[k].sun_polyakov_id = SubLat[k].GPU0->kernel_init("lattice_polyakov", 1, polyakov3_global_size, local_size_lattice_polyakov, false);
         offset_reduce_polyakov_double2 = SubLat[k].GPU0->buffer_size_align((unsigned int) ceil((double) SubLat[k].sublattice_polyakov_size / SubLat[k].GPU0->kernel_get_worksize(SubLat[k].sun_polyakov_id)), SubLat[k].GPU0->kernel_get_worksize(SubLat[k].sun_polyakov_id));
             argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_polyakov_id, SubLat[k].sublattice_table);
             argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_polyakov_id, SubLat[k].sublattice_measurement);
@@ -2987,7 +3383,7 @@ void    model::lattice_kern_init_PL(void)
             polyakov3_global_size[1] = 1;
             polyakov3_global_size[2] = 1;
 
-            SubLat[k].sun_polyakov_diff_x_id = SubLat[k].GPU0->kernel_init("lattice_polyakov_diff_x", 1, polyakov3_global_size, local_size_lattice_polyakov);
+            SubLat[k].sun_polyakov_diff_x_id = SubLat[k].GPU0->kernel_init("lattice_polyakov_diff_x", 1, polyakov3_global_size, local_size_lattice_polyakov, false);
             offset_reduce_polyakov_diff_double2 = SubLat[k].GPU0->buffer_size_align((unsigned int) ceil((double) SubLat[k].sublattice_polyakov_x_size / SubLat[k].GPU0->kernel_get_worksize(SubLat[k].sun_polyakov_diff_x_id)),SubLat[k].GPU0->kernel_get_worksize(SubLat[k].sun_polyakov_diff_x_id));
             argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_polyakov_diff_x_id, SubLat[k].sublattice_table);
             argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_polyakov_diff_x_id, SubLat[k].sublattice_measurement_diff);
@@ -3011,7 +3407,7 @@ void    model::lattice_kern_init_PL(void)
             polyakov3_global_size[1] = 1;
             polyakov3_global_size[2] = 1;
 
-        SubLat[k].sun_polyakov_diff_y_id = SubLat[k].GPU0->kernel_init("lattice_polyakov_diff_y", 1, polyakov3_global_size, local_size_lattice_polyakov);
+        SubLat[k].sun_polyakov_diff_y_id = SubLat[k].GPU0->kernel_init("lattice_polyakov_diff_y", 1, polyakov3_global_size, local_size_lattice_polyakov, false);
         offset_reduce_polyakov_diff_double2 = 0;
             argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_polyakov_diff_y_id, SubLat[k].sublattice_table);
             argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_polyakov_diff_y_id, SubLat[k].sublattice_measurement_diff);
@@ -3035,7 +3431,7 @@ void    model::lattice_kern_init_PL(void)
             polyakov3_global_size[1] = 1;
             polyakov3_global_size[2] = 1;
 
-            SubLat[k].sun_polyakov_diff_z_id = SubLat[k].GPU0->kernel_init("lattice_polyakov_diff_z", 1, polyakov3_global_size, local_size_lattice_polyakov);
+            SubLat[k].sun_polyakov_diff_z_id = SubLat[k].GPU0->kernel_init("lattice_polyakov_diff_z", 1, polyakov3_global_size, local_size_lattice_polyakov, false);
             offset_reduce_polyakov_diff_double2 = SubLat[k].GPU0->buffer_size_align((unsigned int) ceil((double) SubLat[k].sublattice_polyakov_z_size / SubLat[k].GPU0->kernel_get_worksize(SubLat[k].sun_polyakov_diff_z_id)), SubLat[k].GPU0->kernel_get_worksize(SubLat[k].sun_polyakov_diff_z_id));
             argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_polyakov_diff_z_id, SubLat[k].sublattice_table);
             argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_polyakov_diff_z_id, SubLat[k].sublattice_measurement_diff);
@@ -3080,6 +3476,9 @@ void    model::lattice_mp_WL(void)
             options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D GID_UPD");
         options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D SUN=%u",         lattice_group);
         options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D ND=%u",          lattice_nd);
+#ifdef INDEX64
+        options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D INDEX64");      // 64-bit lattice indices
+#endif
         if (!((PHI==0.0)&&(OMEGA==0.0))) options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D TBC");     // turn on TBC
         options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D PRECISION=%u", precision);   
     
@@ -3218,7 +3617,7 @@ void    model::lattice_kern_init_WL(void)
         argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_measurement_WLx4_id, SubLat[k].sublattice_lds);
 
         SubLat[k].sun_measurement_wilson_id = 0;
-        SubLat[k].sun_measurement_wilson_id = SubLat[k].GPU0->kernel_init("lattice_measurement_wilson", 1, measurement3_wl_global_size, local_size_lattice_measurement);
+        SubLat[k].sun_measurement_wilson_id = SubLat[k].GPU0->kernel_init("lattice_measurement_wilson", 1, measurement3_wl_global_size, local_size_lattice_measurement, false);
         argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_measurement_wilson_id, SubLat[k].sublattice_table);
         argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_measurement_wilson_id, SubLat[k].sublattice_wlx);
         argument_id = SubLat[k].GPU0->kernel_init_buffer(SubLat[k].sun_measurement_wilson_id, SubLat[k].sublattice_measurement);
@@ -3271,6 +3670,12 @@ void        model::lattice_make_programs(void)
     polyakov_index    = 0;
     measurement_index = 0;
 
+    update_program_id         = 0;
+    measurements_program_id   = 0;
+    wilson_program_id         = 0;
+    polyakov_program_id       = 0;
+    measurement_kernels_ready = false;
+
     char options_common[1024];
     int options_length_common  = sprintf_s(options_common,sizeof(options_common),"-Werror");
     if (GPU0->GPU_info.device_vendor == GPU_CL::GPU::GPU_vendor_Intel)
@@ -3279,6 +3684,9 @@ void        model::lattice_make_programs(void)
         options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D GID_UPD");
     options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D SUN=%u",         lattice_group);
     options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D ND=%u",          lattice_nd);
+#ifdef INDEX64
+    options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D INDEX64");      // 64-bit lattice indices
+#endif
     options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D N1=%u",          lattice_domain_n1);
     options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D N2=%u",          lattice_domain_size[1]);
     options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D N3=%u",          lattice_domain_size[2]);
@@ -3286,10 +3694,16 @@ void        model::lattice_make_programs(void)
     if (!((PHI==0.0)&&(OMEGA==0.0))) options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D TBC");     // turn on TBC
     options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -I %s%s",           GPU0->cl_root_path,path_suncl);
     options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -I %s%s",           GPU0->cl_root_path,path_kernel);
-    options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D ROWSIZE=%u",     lattice_table_row_size);
+    options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D ROWSIZE=" LATTICE_INDEX_CL_FMT,     lattice_table_row_size);
     options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D PRECISION=%u",   precision);
     
     options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D PLK=%u",   getK(lattice_domain_n1, lattice_domain_size[1], GPU0->GPU_limit_max_workgroup_size));
+    if (action_c1 != 0.0)
+        options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D RECT_ACTION -D ACTION_C1=%.16e", action_c1);  // improved gauge action
+    if (update_tiled)
+        options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D TILED_UPDATE");
+    if (link_storage == model_link_storage_8)
+        options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D SU3_COMPRESS8");
 
     if (PRNG0->PRNG_precision == PRNG_CL::PRNG::PRNG_precision_double)
         options_length_common += sprintf_s(options_common + options_length_common,sizeof(options_common)-options_length_common," -D PRNG_PRECISION=2");
@@ -3298,14 +3712,69 @@ void        model::lattice_make_programs(void)
     int options_length  = sprintf_s(options,sizeof(options),"%s",options_common);
         options_length += sprintf_s(options + options_length,sizeof(options)-options_length," -D NHIT=%u",        NHIT);
         options_length += sprintf_s(options + options_length,sizeof(options)-options_length," -D NHITPar=%u",     NHITPar);
-        options_length += sprintf_s(options + options_length,sizeof(options)-options_length," -D PRNGSTEP=%u",    lattice_table_row_size_half);
+        options_length += sprintf_s(options + options_length,sizeof(options)-options_length," -D PRNGSTEP=" LATTICE_INDEX_CL_FMT,    lattice_table_row_size_half);
+    if (PRNG0->PRNG_in_kernels)
+        options_length += sprintf_s(options + options_length,sizeof(options)-options_length," -D PRNG_PHILOX -I %srandom",           GPU0->cl_root_path);
+    if (PRNG0->PRNG_adaptive)
+        options_length += sprintf_s(options + options_length,sizeof(options)-options_length," -D PRNG_DEMAND -D PRNG_DEMAND_BINS=%u -I %srandom", PRNG_DEMAND_BINS, GPU0->cl_root_path);
+    if (heatbath_KP)
+        options_length += sprintf_s(options + options_length,sizeof(options)-options_length," -D HEATBATH_KP -D PRNG_SLICE=%u -I %srandom",  (lattice_group == 3) ? 3 * NHITPar * (NHIT + 1) : NHIT + 1, GPU0->cl_root_path);
+    if (get_heatbath_stats)
+        options_length += sprintf_s(options + options_length,sizeof(options)-options_length," -D HEATBATH_STATS");
 
     char buffer_update_cl[FNAME_MAX_LENGTH];
         j = sprintf_s(buffer_update_cl  ,FNAME_MAX_LENGTH,  "%s",GPU0->cl_root_path);
         j+= sprintf_s(buffer_update_cl+j,FNAME_MAX_LENGTH-j,"%s",SOURCE_UPDATE);
     char* update_source       = GPU0->source_read(buffer_update_cl);
-                                GPU0->program_create(update_source,options);
+          update_program_id   = GPU0->program_create(update_source,options);
 
+    // programs for measurements are built in background, their kernels are created by lattice_make_measurement_kernels
+    // for all measurements _____________________________________________________________________________________________________________________________________
+    char options_measurements[1024];
+    int options_measurement_length  = sprintf_s(options_measurements,sizeof(options_measurements),"%s",options_common);
+
+    if (get_Fmunu) options_measurement_length += sprintf_s(options_measurements + options_measurement_length,sizeof(options_measurements)-options_measurement_length," -D FMUNU");   // calculate tensor Fmunu for H field
+    if (get_F0mu)  options_measurement_length += sprintf_s(options_measurements + options_measurement_length,sizeof(options_measurements)-options_measurement_length," -D F0MU");   // calculate tensor Fmunu for E field
+    if (get_heatbath_stats) options_measurement_length += sprintf_s(options_measurements + options_measurement_length,sizeof(options_measurements)-options_measurement_length," -D HEATBATH_STATS");   // reduce heatbath counters at measurements
+
+    if ((get_Fmunu)||(get_F0mu)) {
+        if (get_Fmunu1) options_measurement_length += sprintf_s(options_measurements + options_measurement_length,sizeof(options_measurements)-options_measurement_length," -D FMUNU1");   // calculate tensor Fmunu for lambda1 matrix
+        if (get_Fmunu2) options_measurement_length += sprintf_s(options_measurements + options_measurement_length,sizeof(options_measurements)-options_measurement_length," -D FMUNU2");   // calculate tensor Fmunu for lambda2 matrix
+        if (get_Fmunu4) options_measurement_length += sprintf_s(options_measurements + options_measurement_length,sizeof(options_measurements)-options_measurement_length," -D FMUNU4");   // calculate tensor Fmunu for lambda4 matrix
+        if (get_Fmunu5) options_measurement_length += sprintf_s(options_measurements + options_measurement_length,sizeof(options_measurements)-options_measurement_length," -D FMUNU5");   // calculate tensor Fmunu for lambda5 matrix
+        if (get_Fmunu6) options_measurement_length += sprintf_s(options_measurements + options_measurement_length,sizeof(options_measurements)-options_measurement_length," -D FMUNU6");   // calculate tensor Fmunu for lambda6 matrix
+        if (get_Fmunu7) options_measurement_length += sprintf_s(options_measurements + options_measurement_length,sizeof(options_measurements)-options_measurement_length," -D FMUNU7");   // calculate tensor Fmunu for lambda7 matrix
+    }
+    char buffer_measurements_cl[FNAME_MAX_LENGTH];
+        j = sprintf_s(buffer_measurements_cl  ,FNAME_MAX_LENGTH,  "%s",GPU0->cl_root_path);
+        j+= sprintf_s(buffer_measurements_cl+j,FNAME_MAX_LENGTH-j,"%s",SOURCE_MEASUREMENTS);
+    char* measurements_source       = GPU0->source_read(buffer_measurements_cl);
+    measurements_program_id         = GPU0->program_create(measurements_source,options_measurements);
+
+    // for Wilson loop measurements _____________________________________________________________________________________________________________________________
+    char options_wilson[1024];
+    sprintf_s(options_wilson,sizeof(options_wilson),"%s",options_common);
+
+    if (get_wilson_loop) {
+    char buffer_wilson_cl[FNAME_MAX_LENGTH];
+        j = sprintf_s(buffer_wilson_cl  ,FNAME_MAX_LENGTH,  "%s",GPU0->cl_root_path);
+        j+= sprintf_s(buffer_wilson_cl+j,FNAME_MAX_LENGTH-j,"%s",SOURCE_WILSON_LOOP);
+    char* wilson_source       = GPU0->source_read(buffer_wilson_cl);
+          wilson_program_id   = GPU0->program_create(wilson_source,options_wilson);
+    }
+
+    // for Polyakov loop measurements ___________________________________________________________________________________________________________________________
+    char options_polyakov[1024];
+    int options_length_polyakov  = sprintf_s(options_polyakov,sizeof(options_polyakov),"%s",options_common);
+        options_length_polyakov += sprintf_s(options_polyakov + options_length_polyakov,sizeof(options_polyakov)-options_length_polyakov," -D PL=%u",          PL_level);
+
+    if (PL_level > 0) {
+    char buffer_polyakov_cl[FNAME_MAX_LENGTH];
+        j = sprintf_s(buffer_polyakov_cl  ,FNAME_MAX_LENGTH,  "%s",GPU0->cl_root_path);
+        j+= sprintf_s(buffer_polyakov_cl+j,FNAME_MAX_LENGTH-j,"%s",SOURCE_POLYAKOV);
+    char* polyakov_source       = GPU0->source_read(buffer_polyakov_cl);
+          polyakov_program_id   = GPU0->program_create(polyakov_source,options_polyakov);
+    }
 
     // SU(3)__________________________________________________________________________________
 
@@ -3313,18 +3782,7 @@ void        model::lattice_make_programs(void)
     const size_t init_hot_global_size[]           = {lattice_group_elements[lattice_group-1]*lattice_table_row_size};
     const size_t monte_global_size[]              = {lattice_table_exact_row_size_half};
 
-    const size_t measurement3_global_size[]       = {lattice_action_size};
-    const size_t polyakov3_global_size[]          = {lattice_polyakov_size};
-    const size_t clear_measurement_global_size[]  = {lattice_measurement_size_F};
-
-    const size_t reduce_measurement_global_size[] = {GPU0->GPU_info.max_workgroup_size};
-    const size_t reduce_polyakov_global_size[]    = {GPU0->GPU_info.max_workgroup_size};
-    const size_t reduce_local_size[3]             = {GPU0->GPU_info.max_workgroup_size};
-
-    const size_t local_size_lattice_measurement[] = {GPU0->GPU_info.max_workgroup_size};
-    const size_t local_size_lattice_polyakov[]    = {GPU0->GPU_info.max_workgroup_size};
-    const size_t local_size_lattice_wilson[]      = {GPU0->GPU_info.max_workgroup_size};
-
+    GPU0->program_set_active(update_program_id);
 
     if (ints==model_start_gid) {            // gid init
                 sun_init_id = GPU0->kernel_init("lattice_init_gid",1,init_global_size,NULL);
@@ -3335,16 +3793,16 @@ void        model::lattice_make_programs(void)
     } else {                                // hot init
                 sun_init_X_id = GPU0->kernel_init("lattice_init_hot_X",1,init_hot_global_size,NULL);
                 argument_id = GPU0->kernel_init_buffer(sun_init_X_id,lattice_table);
-                argument_id = GPU0->kernel_init_buffer(sun_init_X_id,PRNG0->PRNG_randoms_id);
+                argument_id = PRNG0->kernel_init_prns(sun_init_X_id);
                 sun_init_Y_id = GPU0->kernel_init("lattice_init_hot_Y",1,init_hot_global_size,NULL);
                 argument_id = GPU0->kernel_init_buffer(sun_init_Y_id,lattice_table);
-                argument_id = GPU0->kernel_init_buffer(sun_init_Y_id,PRNG0->PRNG_randoms_id);
+                argument_id = PRNG0->kernel_init_prns(sun_init_Y_id);
                 sun_init_Z_id = GPU0->kernel_init("lattice_init_hot_Z",1,init_hot_global_size,NULL);
                 argument_id = GPU0->kernel_init_buffer(sun_init_Z_id,lattice_table);
-                argument_id = GPU0->kernel_init_buffer(sun_init_Z_id,PRNG0->PRNG_randoms_id);
+                argument_id = PRNG0->kernel_init_prns(sun_init_Z_id);
                 sun_init_T_id = GPU0->kernel_init("lattice_init_hot_T",1,init_hot_global_size,NULL);
                 argument_id = GPU0->kernel_init_buffer(sun_init_T_id,lattice_table);
-                argument_id = GPU0->kernel_init_buffer(sun_init_T_id,PRNG0->PRNG_randoms_id);
+                argument_id = PRNG0->kernel_init_prns(sun_init_T_id);
     }
 
     sun_GramSchmidt_id = GPU0->kernel_init("lattice_GramSchmidt",1,init_global_size,NULL); 
@@ -3354,63 +3812,364 @@ void        model::lattice_make_programs(void)
     sun_update_odd_X_id = GPU0->kernel_init("update_odd_X",1,monte_global_size,NULL);
             argument_id = GPU0->kernel_init_buffer(sun_update_odd_X_id,lattice_table);
             argument_id = GPU0->kernel_init_buffer(sun_update_odd_X_id,lattice_parameters);
-            argument_id = GPU0->kernel_init_buffer(sun_update_odd_X_id,PRNG0->PRNG_randoms_id);
+            argument_id = PRNG0->kernel_init_prns(sun_update_odd_X_id);
+            argument_id = PRNG0->kernel_init_demand(sun_update_odd_X_id);
+            if (get_heatbath_stats) argument_id = GPU0->kernel_init_buffer(sun_update_odd_X_id,lattice_heatbath_stats);
 
     sun_update_even_X_id = GPU0->kernel_init("update_even_X",1,monte_global_size,NULL);
              argument_id = GPU0->kernel_init_buffer(sun_update_even_X_id,lattice_table);
              argument_id = GPU0->kernel_init_buffer(sun_update_even_X_id,lattice_parameters);
-             argument_id = GPU0->kernel_init_buffer(sun_update_even_X_id,PRNG0->PRNG_randoms_id);
+             argument_id = PRNG0->kernel_init_prns(sun_update_even_X_id);
+             argument_id = PRNG0->kernel_init_demand(sun_update_even_X_id);
+             if (get_heatbath_stats) argument_id = GPU0->kernel_init_buffer(sun_update_even_X_id,lattice_heatbath_stats);
 
     sun_update_odd_Y_id = GPU0->kernel_init("update_odd_Y",1,monte_global_size,NULL);
             argument_id = GPU0->kernel_init_buffer(sun_update_odd_Y_id,lattice_table);
             argument_id = GPU0->kernel_init_buffer(sun_update_odd_Y_id,lattice_parameters);
-            argument_id = GPU0->kernel_init_buffer(sun_update_odd_Y_id,PRNG0->PRNG_randoms_id);
+            argument_id = PRNG0->kernel_init_prns(sun_update_odd_Y_id);
+            argument_id = PRNG0->kernel_init_demand(sun_update_odd_Y_id);
+            if (get_heatbath_stats) argument_id = GPU0->kernel_init_buffer(sun_update_odd_Y_id,lattice_heatbath_stats);
 
     sun_update_even_Y_id = GPU0->kernel_init("update_even_Y",1,monte_global_size,NULL);
              argument_id = GPU0->kernel_init_buffer(sun_update_even_Y_id,lattice_table);
              argument_id = GPU0->kernel_init_buffer(sun_update_even_Y_id,lattice_parameters);
-             argument_id = GPU0->kernel_init_buffer(sun_update_even_Y_id,PRNG0->PRNG_randoms_id);
+             argument_id = PRNG0->kernel_init_prns(sun_update_even_Y_id);
+             argument_id = PRNG0->kernel_init_demand(sun_update_even_Y_id);
+             if (get_heatbath_stats) argument_id = GPU0->kernel_init_buffer(sun_update_even_Y_id,lattice_heatbath_stats);
 
     sun_update_odd_Z_id = GPU0->kernel_init("update_odd_Z",1,monte_global_size,NULL);
             argument_id = GPU0->kernel_init_buffer(sun_update_odd_Z_id,lattice_table);
             argument_id = GPU0->kernel_init_buffer(sun_update_odd_Z_id,lattice_parameters);
-            argument_id = GPU0->kernel_init_buffer(sun_update_odd_Z_id,PRNG0->PRNG_randoms_id);
+            argument_id = PRNG0->kernel_init_prns(sun_update_odd_Z_id);
+            argument_id = PRNG0->kernel_init_demand(sun_update_odd_Z_id);
+            if (get_heatbath_stats) argument_id = GPU0->kernel_init_buffer(sun_update_odd_Z_id,lattice_heatbath_stats);
 
     sun_update_even_Z_id = GPU0->kernel_init("update_even_Z",1,monte_global_size,NULL);
              argument_id = GPU0->kernel_init_buffer(sun_update_even_Z_id,lattice_table);
              argument_id = GPU0->kernel_init_buffer(sun_update_even_Z_id,lattice_parameters);
-             argument_id = GPU0->kernel_init_buffer(sun_update_even_Z_id,PRNG0->PRNG_randoms_id);
+             argument_id = PRNG0->kernel_init_prns(sun_update_even_Z_id);
+             argument_id = PRNG0->kernel_init_demand(sun_update_even_Z_id);
+             if (get_heatbath_stats) argument_id = GPU0->kernel_init_buffer(sun_update_even_Z_id,lattice_heatbath_stats);
 
     sun_update_odd_T_id = GPU0->kernel_init("update_odd_T",1,monte_global_size,NULL);
             argument_id = GPU0->kernel_init_buffer(sun_update_odd_T_id,lattice_table);
             argument_id = GPU0->kernel_init_buffer(sun_update_odd_T_id,lattice_parameters);
-            argument_id = GPU0->kernel_init_buffer(sun_update_odd_T_id,PRNG0->PRNG_randoms_id);
+            argument_id = PRNG0->kernel_init_prns(sun_update_odd_T_id);
+            argument_id = PRNG0->kernel_init_demand(sun_update_odd_T_id);
+            if (get_heatbath_stats) argument_id = GPU0->kernel_init_buffer(sun_update_odd_T_id,lattice_heatbath_stats);
 
     sun_update_even_T_id = GPU0->kernel_init("update_even_T",1,monte_global_size,NULL);
              argument_id = GPU0->kernel_init_buffer(sun_update_even_T_id,lattice_table);
              argument_id = GPU0->kernel_init_buffer(sun_update_even_T_id,lattice_parameters);
-             argument_id = GPU0->kernel_init_buffer(sun_update_even_T_id,PRNG0->PRNG_randoms_id);
+             argument_id = PRNG0->kernel_init_prns(sun_update_even_T_id);
+             argument_id = PRNG0->kernel_init_demand(sun_update_even_T_id);
+             if (get_heatbath_stats) argument_id = GPU0->kernel_init_buffer(sun_update_even_T_id,lattice_heatbath_stats);
+
+    if (update_tiled) {
+        // work-group of 16 work-items per tile, tiles of one colour (1/8 of tiles) are updated by one launch
+        int tile_colour = 0;
+        const size_t tile_global_size[] = {(size_t) (lattice_domain_exact_site / 8)};
+        const size_t tile_local_size[]  = {16};
+        sun_update_tiled_id = GPU0->kernel_init("update_tiled",1,tile_global_size,tile_local_size,false);
+                argument_id  = GPU0->kernel_init_buffer(sun_update_tiled_id,lattice_table);
+                argument_id  = GPU0->kernel_init_buffer(sun_update_tiled_id,lattice_parameters);
+                argument_id  = PRNG0->kernel_init_prns(sun_update_tiled_id);
+                if (get_heatbath_stats) argument_id = GPU0->kernel_init_buffer(sun_update_tiled_id,lattice_heatbath_stats);
+                argument_id  = GPU0->kernel_init_buffer(sun_update_tiled_id,lattice_tile_lds);
+     argument_update_tiled_colour = GPU0->kernel_init_constant(sun_update_tiled_id,&tile_colour) - 1;
+    }
 
-    // for all measurements _____________________________________________________________________________________________________________________________________
-    char options_measurements[1024];
-    int options_measurement_length  = sprintf_s(options_measurements,sizeof(options_measurements),"%s",options_common);
+    if (action_c1 != 0.0) {
+        // links of one colour (1/8 of links of one direction) are updated by one launch
+        int rect_dir = 0;
+        const size_t rect_global_size[] = {GPU0->buffer_size_align(lattice_domain_exact_site / 8)};
+        sun_update_rect_id = GPU0->kernel_init("update_rect",1,rect_global_size,NULL);
+                argument_id  = GPU0->kernel_init_buffer(sun_update_rect_id,lattice_table);
+                argument_id  = GPU0->kernel_init_buffer(sun_update_rect_id,lattice_parameters);
+                argument_id  = PRNG0->kernel_init_prns(sun_update_rect_id);
+                if (get_heatbath_stats) argument_id = GPU0->kernel_init_buffer(sun_update_rect_id,lattice_heatbath_stats);
+         argument_update_rect_dir = GPU0->kernel_init_constant(sun_update_rect_id,&rect_dir) - 1;
+                argument_id  = GPU0->kernel_init_constant(sun_update_rect_id,&rect_dir);   // colour
+        if (NOR > 0) {
+        sun_orelax_rect_id = GPU0->kernel_init("orelax_rect",1,rect_global_size,NULL);
+                argument_id  = GPU0->kernel_init_buffer(sun_orelax_rect_id,lattice_table);
+                argument_id  = GPU0->kernel_init_buffer(sun_orelax_rect_id,lattice_parameters);
+         argument_orelax_rect_dir = GPU0->kernel_init_constant(sun_orelax_rect_id,&rect_dir) - 1;
+                argument_id  = GPU0->kernel_init_constant(sun_orelax_rect_id,&rect_dir);   // colour
+        }
+    }
 
-    if (get_Fmunu) options_measurement_length += sprintf_s(options_measurements + options_measurement_length,sizeof(options_measurements)-options_measurement_length," -D FMUNU");   // calculate tensor Fmunu for H field
-    if (get_F0mu)  options_measurement_length += sprintf_s(options_measurements + options_measurement_length,sizeof(options_measurements)-options_measurement_length," -D F0MU");   // calculate tensor Fmunu for E field
+    if (NOR > 0) {
+        sun_orelax_odd_X_id  = GPU0->kernel_init("orelax_odd_X", 1,monte_global_size,NULL);
+                argument_id  = GPU0->kernel_init_buffer(sun_orelax_odd_X_id,lattice_table);
+                argument_id  = GPU0->kernel_init_buffer(sun_orelax_odd_X_id,lattice_parameters);
+        sun_orelax_even_X_id = GPU0->kernel_init("orelax_even_X",1,monte_global_size,NULL);
+                argument_id  = GPU0->kernel_init_buffer(sun_orelax_even_X_id,lattice_table);
+                argument_id  = GPU0->kernel_init_buffer(sun_orelax_even_X_id,lattice_parameters);
+        sun_orelax_odd_Y_id  = GPU0->kernel_init("orelax_odd_Y", 1,monte_global_size,NULL);
+                argument_id  = GPU0->kernel_init_buffer(sun_orelax_odd_Y_id,lattice_table);
+                argument_id  = GPU0->kernel_init_buffer(sun_orelax_odd_Y_id,lattice_parameters);
+        sun_orelax_even_Y_id = GPU0->kernel_init("orelax_even_Y",1,monte_global_size,NULL);
+                argument_id  = GPU0->kernel_init_buffer(sun_orelax_even_Y_id,lattice_table);
+                argument_id  = GPU0->kernel_init_buffer(sun_orelax_even_Y_id,lattice_parameters);
+        sun_orelax_odd_Z_id  = GPU0->kernel_init("orelax_odd_Z", 1,monte_global_size,NULL);
+                argument_id  = GPU0->kernel_init_buffer(sun_orelax_odd_Z_id,lattice_table);
+                argument_id  = GPU0->kernel_init_buffer(sun_orelax_odd_Z_id,lattice_parameters);
+        sun_orelax_even_Z_id = GPU0->kernel_init("orelax_even_Z",1,monte_global_size,NULL);
+                argument_id  = GPU0->kernel_init_buffer(sun_orelax_even_Z_id,lattice_table);
+                argument_id  = GPU0->kernel_init_buffer(sun_orelax_even_Z_id,lattice_parameters);
+        sun_orelax_odd_T_id  = GPU0->kernel_init("orelax_odd_T", 1,monte_global_size,NULL);
+                argument_id  = GPU0->kernel_init_buffer(sun_orelax_odd_T_id,lattice_table);
+                argument_id  = GPU0->kernel_init_buffer(sun_orelax_odd_T_id,lattice_parameters);
+        sun_orelax_even_T_id = GPU0->kernel_init("orelax_even_T",1,monte_global_size,NULL);
+                argument_id  = GPU0->kernel_init_buffer(sun_orelax_even_T_id,lattice_table);
+                argument_id  = GPU0->kernel_init_buffer(sun_orelax_even_T_id,lattice_parameters);
+    }
 
-    if ((get_Fmunu)||(get_F0mu)) {
-        if (get_Fmunu1) options_measurement_length += sprintf_s(options_measurements + options_measurement_length,sizeof(options_measurements)-options_measurement_length," -D FMUNU1");   // calculate tensor Fmunu for lambda1 matrix
-        if (get_Fmunu2) options_measurement_length += sprintf_s(options_measurements + options_measurement_length,sizeof(options_measurements)-options_measurement_length," -D FMUNU2");   // calculate tensor Fmunu for lambda2 matrix
-        if (get_Fmunu4) options_measurement_length += sprintf_s(options_measurements + options_measurement_length,sizeof(options_measurements)-options_measurement_length," -D FMUNU4");   // calculate tensor Fmunu for lambda4 matrix
-        if (get_Fmunu5) options_measurement_length += sprintf_s(options_measurements + options_measurement_length,sizeof(options_measurements)-options_measurement_length," -D FMUNU5");   // calculate tensor Fmunu for lambda5 matrix
-        if (get_Fmunu6) options_measurement_length += sprintf_s(options_measurements + options_measurement_length,sizeof(options_measurements)-options_measurement_length," -D FMUNU6");   // calculate tensor Fmunu for lambda6 matrix
-        if (get_Fmunu7) options_measurement_length += sprintf_s(options_measurements + options_measurement_length,sizeof(options_measurements)-options_measurement_length," -D FMUNU7");   // calculate tensor Fmunu for lambda7 matrix
+    if (update_engine == model_update_hmc) {
+        int    hmc_dir        = 0;
+        float  hmc_eps_float  = 0.0f;
+        double hmc_eps_double = 0.0;
+        const size_t hmc_global_size[] = {lattice_table_exact_row_size};
+        sun_hmc_momenta_id = GPU0->kernel_init("hmc_momenta",1,hmc_global_size,NULL);
+                argument_id  = GPU0->kernel_init_buffer(sun_hmc_momenta_id,lattice_hmc_momenta);
+                argument_id  = PRNG0->kernel_init_prns(sun_hmc_momenta_id);
+         argument_hmc_dir    = GPU0->kernel_init_constant(sun_hmc_momenta_id,&hmc_dir) - 1;
+        sun_hmc_force_id   = GPU0->kernel_init("hmc_force",1,hmc_global_size,NULL);
+                argument_id  = GPU0->kernel_init_buffer(sun_hmc_force_id,lattice_table);
+                argument_id  = GPU0->kernel_init_buffer(sun_hmc_force_id,lattice_parameters);
+                argument_id  = GPU0->kernel_init_buffer(sun_hmc_force_id,lattice_hmc_momenta);
+        sun_hmc_links_id   = GPU0->kernel_init("hmc_links",1,hmc_global_size,NULL);
+                argument_id  = GPU0->kernel_init_buffer(sun_hmc_links_id,lattice_table);
+                argument_id  = GPU0->kernel_init_buffer(sun_hmc_links_id,lattice_hmc_momenta);
+        if (precision == model_precision_double) {
+         argument_hmc_force_eps = GPU0->kernel_init_constant(sun_hmc_force_id,&hmc_eps_double) - 1;
+         argument_hmc_links_eps = GPU0->kernel_init_constant(sun_hmc_links_id,&hmc_eps_double) - 1;
+        } else {
+         argument_hmc_force_eps = GPU0->kernel_init_constant(sun_hmc_force_id,&hmc_eps_float) - 1;
+         argument_hmc_links_eps = GPU0->kernel_init_constant(sun_hmc_links_id,&hmc_eps_float) - 1;
+        }
+        // energy is summed over work groups of fixed size, then on device into lattice_hmc_total
+        const size_t hmc_local_size[]  = {GPU0->GPU_info.max_workgroup_size};
+        const size_t reduce_hmc_global_size[] = {GPU0->GPU_info.max_workgroup_size};
+        sun_hmc_energy_id  = GPU0->kernel_init("hmc_energy",1,hmc_global_size,hmc_local_size,false);
+                argument_id  = GPU0->kernel_init_buffer(sun_hmc_energy_id,lattice_table);
+                argument_id  = GPU0->kernel_init_buffer(sun_hmc_energy_id,lattice_parameters);
+                argument_id  = GPU0->kernel_init_buffer(sun_hmc_energy_id,lattice_hmc_momenta);
+                argument_id  = GPU0->kernel_init_buffer(sun_hmc_energy_id,lattice_hmc_energy);
+                argument_id  = GPU0->kernel_init_buffer(sun_hmc_energy_id,lattice_lds);
+        int size_reduce_hmc_energy_double2 = (int) ceil((double) lattice_table_exact_row_size / GPU0->kernel_get_worksize(sun_hmc_energy_id));
+        sun_hmc_energy_reduce_id = GPU0->kernel_init("reduce_hmc_energy_double2",1,reduce_hmc_global_size,hmc_local_size);
+                argument_id  = GPU0->kernel_init_buffer(sun_hmc_energy_reduce_id,lattice_hmc_energy);
+                argument_id  = GPU0->kernel_init_buffer(sun_hmc_energy_reduce_id,lattice_hmc_total);
+                argument_id  = GPU0->kernel_init_buffer(sun_hmc_energy_reduce_id,lattice_lds);
+                argument_id  = GPU0->kernel_init_constant(sun_hmc_energy_reduce_id,&size_reduce_hmc_energy_double2);
     }
-    char buffer_measurements_cl[FNAME_MAX_LENGTH];
-        j = sprintf_s(buffer_measurements_cl  ,FNAME_MAX_LENGTH,  "%s",GPU0->cl_root_path);
-        j+= sprintf_s(buffer_measurements_cl+j,FNAME_MAX_LENGTH-j,"%s",SOURCE_MEASUREMENTS);
-    char* measurements_source       = GPU0->source_read(buffer_measurements_cl);
-                                GPU0->program_create(measurements_source,options_measurements);
+}
+
+void        model::lattice_overrelaxation(void)
+{
+    // microcanonical sweeps keep the action, so they decorrelate configurations without PRNs
+    if (action_c1 != 0.0) {
+        for (int k=0; k<NOR; k++)
+            for (int parity = 0; parity < 2; parity++)
+                for (int dir = 0; dir < lattice_nd; dir++){
+                    GPU0->kernel_init_constant_reset(sun_orelax_rect_id,&dir,argument_orelax_rect_dir);
+                    for (int colour = 4 * parity; colour < 4 * parity + 4; colour++){
+                        GPU0->kernel_init_constant_reset(sun_orelax_rect_id,&colour,argument_orelax_rect_dir + 1);
+                        GPU0->kernel_run(sun_orelax_rect_id);   // Overrelax links of one colour
+                    }
+                }
+        return;
+    }
+    for (int k=0; k<NOR; k++){
+        GPU0->kernel_run(sun_orelax_odd_X_id);      // Overrelax odd X links
+        GPU0->kernel_run(sun_orelax_odd_Y_id);      // Overrelax odd Y links
+        GPU0->kernel_run(sun_orelax_odd_Z_id);      // Overrelax odd Z links
+        GPU0->kernel_run(sun_orelax_odd_T_id);      // Overrelax odd T links
+
+        GPU0->kernel_run(sun_orelax_even_X_id);     // Overrelax even X links
+        GPU0->kernel_run(sun_orelax_even_Y_id);     // Overrelax even Y links
+        GPU0->kernel_run(sun_orelax_even_Z_id);     // Overrelax even Z links
+        GPU0->kernel_run(sun_orelax_even_T_id);     // Overrelax even T links
+    }
+}
+
+void        model::lattice_update(void)
+{
+    if (update_engine == model_update_hmc) {
+        if (!turnoff_updates) lattice_hmc_trajectory();         // HMC trajectory
+        return;
+    }
+    if (action_c1 != 0.0) {
+        // rectangle staples reach next-to-nearest links, so each parity of x_dir is split into 4 colours sharing one PRNs production
+        for (int parity = 0; parity < 2; parity++)
+            for (int dir = 0; dir < lattice_nd; dir++){
+                   if (!turnoff_prns) PRNG0->produce();
+                if (turnoff_updates) continue;
+                GPU0->kernel_init_constant_reset(sun_update_rect_id,&dir,argument_update_rect_dir);
+                for (int colour = 4 * parity; colour < 4 * parity + 4; colour++){
+                    GPU0->kernel_init_constant_reset(sun_update_rect_id,&colour,argument_update_rect_dir + 1);
+                    GPU0->kernel_run(sun_update_rect_id);       // Update links of one colour
+                }
+            }
+        if (!turnoff_updates) lattice_overrelaxation();         // Overrelaxation sweeps
+        return;
+    }
+    if (update_tiled) {
+        // each launch makes the whole odd/even sweep of tiles of one colour
+        for (int colour = 0; colour < 8; colour++){
+               if (!turnoff_prns) PRNG0->produce();
+            if (turnoff_updates) continue;
+            GPU0->kernel_init_constant_reset(sun_update_tiled_id,&colour,argument_update_tiled_colour);
+            GPU0->kernel_run(sun_update_tiled_id);              // Update links of tiles of one colour
+        }
+        if (!turnoff_updates) lattice_overrelaxation();         // Overrelaxation sweeps
+        return;
+    }
+       if (!turnoff_prns) PRNG0->produce();
+    if (!turnoff_updates) GPU0->kernel_run(sun_update_odd_X_id);     // Update odd X links
+       if (!turnoff_prns) PRNG0->produce();
+    if (!turnoff_updates) GPU0->kernel_run(sun_update_odd_Y_id);     // Update odd Y links
+       if (!turnoff_prns) PRNG0->produce();
+    if (!turnoff_updates) GPU0->kernel_run(sun_update_odd_Z_id);     // Update odd Z links
+       if (!turnoff_prns) PRNG0->produce();
+    if (!turnoff_updates) GPU0->kernel_run(sun_update_odd_T_id);     // Update odd T links
+
+       if (!turnoff_prns) PRNG0->produce();
+    if (!turnoff_updates) GPU0->kernel_run(sun_update_even_X_id);    // Update even X links
+       if (!turnoff_prns) PRNG0->produce();
+    if (!turnoff_updates) GPU0->kernel_run(sun_update_even_Y_id);    // Update even Y links
+       if (!turnoff_prns) PRNG0->produce();
+    if (!turnoff_updates) GPU0->kernel_run(sun_update_even_Z_id);    // Update even Z links
+       if (!turnoff_prns) PRNG0->produce();
+    if (!turnoff_updates) GPU0->kernel_run(sun_update_even_T_id);    // Update even T links
+    if (!turnoff_updates) lattice_overrelaxation();                  // Overrelaxation sweeps
+}
+
+void        model::lattice_hmc_force(double eps)
+{
+    if (precision == model_precision_double) {
+        double eps_double = eps;
+        GPU0->kernel_init_constant_reset(sun_hmc_force_id,&eps_double,argument_hmc_force_eps);
+    } else {
+        float eps_float = (float) eps;
+        GPU0->kernel_init_constant_reset(sun_hmc_force_id,&eps_float,argument_hmc_force_eps);
+    }
+    GPU0->kernel_run(sun_hmc_force_id);
+}
+
+void        model::lattice_hmc_evolve(double eps)
+{
+    if (precision == model_precision_double) {
+        double eps_double = eps;
+        GPU0->kernel_init_constant_reset(sun_hmc_links_id,&eps_double,argument_hmc_links_eps);
+    } else {
+        float eps_float = (float) eps;
+        GPU0->kernel_init_constant_reset(sun_hmc_links_id,&eps_float,argument_hmc_links_eps);
+    }
+    GPU0->kernel_run(sun_hmc_links_id);
+}
+
+double      model::lattice_hmc_hamiltonian(void)
+{
+    // H = sum p^2/2 + S, S = -beta/N * sum over loops c_i Re Tr(U_loop); kernel divides out multiple counting of loops
+    GPU0->kernel_run(sun_hmc_energy_id);
+    GPU0->kernel_run(sun_hmc_energy_reduce_id);
+    GPU0->buffer_read_async(lattice_hmc_total);
+    cl_double2 energy = ((cl_double2*) GPU0->buffer_read_wait(lattice_hmc_total))[0];
+    GPU0->buffer_read_release(lattice_hmc_total);
+    return energy.s[0] - BETA / lattice_group * energy.s[1];
+}
+
+void        model::lattice_hmc_trajectory(void)
+{
+    const double lambda = 0.1931833275037836;   // Omelyan 2MN parameter
+    double eps = HMC_tau / HMC_steps;
+
+    GPU0->buffer_copy(lattice_table_hmc,lattice_table);        // links are restored from copy if trajectory is rejected
+    for (int dir = 0; dir < lattice_nd; dir++){
+        int hmc_dir = dir;
+           if (!turnoff_prns) PRNG0->produce();
+        GPU0->kernel_init_constant_reset(sun_hmc_momenta_id,&hmc_dir,argument_hmc_dir);
+        GPU0->kernel_run(sun_hmc_momenta_id);                   // Gaussian momenta of dir links
+    }
+    double H0 = lattice_hmc_hamiltonian();
+
+    // adjacent momenta updates of successive steps are merged
+    if (HMC_integrator == model_integrator_omelyan) {
+        lattice_hmc_force(lambda * eps);
+        for (int k = 0; k < HMC_steps; k++){
+            lattice_hmc_evolve(0.5 * eps);
+            lattice_hmc_force((1.0 - 2.0 * lambda) * eps);
+            lattice_hmc_evolve(0.5 * eps);
+            lattice_hmc_force(((k == HMC_steps - 1) ? 1.0 : 2.0) * lambda * eps);
+        }
+    } else {
+        lattice_hmc_force(0.5 * eps);
+        for (int k = 0; k < HMC_steps; k++){
+            lattice_hmc_evolve(eps);
+            lattice_hmc_force(((k == HMC_steps - 1) ? 0.5 : 1.0) * eps);
+        }
+    }
+
+    double dH = lattice_hmc_hamiltonian() - H0;
+    float  prn[4];
+    PRNG_hmc->produce_CPU(prn,4);
+    bool accept = ((dH <= 0.0) || (prn[0] < exp(-dH)));
+    if (!accept) GPU0->buffer_copy(lattice_table,lattice_table_hmc);
+
+    HMC_trajectories++;
+    if (accept) HMC_accepted++;
+    HMC_dH     += dH;
+    HMC_exp_dH += exp(-dH);
+}
+
+void        model::lattice_heatbath_statistics(void)
+{
+    // counters of update work-items are reduced on device at each measurement of working cycles (thermalization is dropped)
+    double updates = 0.0, tries = 0.0, failures = 0.0;
+    GPU0->buffer_read_async(lattice_heatbath_measurements);
+    cl_double2* stats = (cl_double2*) GPU0->buffer_read_wait(lattice_heatbath_measurements);
+    for (unsigned int i = 0; i < lattice_polyakov_loop_size; i++){
+        updates  += stats[i].s[0];
+        tries    += stats[i].s[1];
+        failures += stats[lattice_polyakov_loop_size + i].s[0];
+    }
+    GPU0->buffer_read_release(lattice_heatbath_measurements);
+    heatbath_tries    = (updates > 0.0) ? tries    / updates : 0.0;
+    heatbath_failures = (updates > 0.0) ? failures / updates : 0.0;
+}
+
+void        model::lattice_make_measurement_kernels(void)
+{
+    // kernels for measurements are created at first measurement (program_wait finishes background builds)
+    if (measurement_kernels_ready) return;
+    measurement_kernels_ready = true;
+
+    int argument_id;
+
+    // measurements read snapshot of lattice_table in overlap mode, so updates of the next configuration may proceed
+    unsigned int lattice_table_measured = lattice_table;
+    lattice_table_snapshot = 0;
+    if (GPU0->GPU_debug.overlap_measurements) {
+        lattice_table_snapshot = GPU0->buffer_snapshot_init(lattice_table);
+        lattice_table_measured = lattice_table_snapshot;
+    }
+
+    const size_t measurement3_global_size[]       = {lattice_action_size};
+    const size_t polyakov3_global_size[]          = {lattice_polyakov_size};
+    const size_t clear_measurement_global_size[]  = {lattice_measurement_size_F};
+
+    const size_t reduce_measurement_global_size[] = {GPU0->GPU_info.max_workgroup_size};
+    const size_t reduce_polyakov_global_size[]    = {GPU0->GPU_info.max_workgroup_size};
+    const size_t reduce_local_size[3]             = {GPU0->GPU_info.max_workgroup_size};
+
+    const size_t local_size_lattice_measurement[] = {GPU0->GPU_info.max_workgroup_size};
+    const size_t local_size_lattice_polyakov[]    = {GPU0->GPU_info.max_workgroup_size};
+    const size_t local_size_lattice_wilson[]      = {GPU0->GPU_info.max_workgroup_size};
+
+    GPU0->program_set_active(measurements_program_id);
 
     int size_reduce_measurement_plq_double2   = 0;
     int offset_reduce_measurement_plq_double2 = 0;
@@ -3422,8 +4181,9 @@ void        model::lattice_make_programs(void)
     sun_clear_measurement_id = GPU0->kernel_init("clear_measurement",1,clear_measurement_global_size,NULL);
                  argument_id = GPU0->kernel_init_buffer(sun_clear_measurement_id,lattice_measurement);
 
-    sun_measurement_id = GPU0->kernel_init("lattice_measurement",1,measurement3_global_size,local_size_lattice_measurement);
-           argument_id = GPU0->kernel_init_buffer(sun_measurement_id,lattice_table);
+    // measurement kernels write one result per work group into lattice_measurement, which is sized for the local size set here (no autotune)
+    sun_measurement_id = GPU0->kernel_init("lattice_measurement",1,measurement3_global_size,local_size_lattice_measurement, false);
+           argument_id = GPU0->kernel_init_buffer(sun_measurement_id,lattice_table_measured);
            argument_id = GPU0->kernel_init_buffer(sun_measurement_id,lattice_measurement);
            argument_id = GPU0->kernel_init_buffer(sun_measurement_id,lattice_parameters);
            argument_id = GPU0->kernel_init_buffer(sun_measurement_id,lattice_lds);
@@ -3445,8 +4205,8 @@ void        model::lattice_make_programs(void)
     Sparam.s[2] = 0;
     Sparam.s[3] = 0;
       
-    sun_action_diff_x_id = GPU0->kernel_init("lattice_action_diff_x",1,measurement3_global_size,local_size_lattice_measurement);
-           argument_id = GPU0->kernel_init_buffer(sun_action_diff_x_id,lattice_table);
+    sun_action_diff_x_id = GPU0->kernel_init("lattice_action_diff_x",1,measurement3_global_size,local_size_lattice_measurement, false);
+           argument_id = GPU0->kernel_init_buffer(sun_action_diff_x_id,lattice_table_measured);
            argument_id = GPU0->kernel_init_buffer(sun_action_diff_x_id,lattice_measurement);
            argument_id = GPU0->kernel_init_buffer(sun_action_diff_x_id,lattice_parameters);	
            argument_id = GPU0->kernel_init_buffer(sun_action_diff_x_id,lattice_lds);
@@ -3458,8 +4218,8 @@ void        model::lattice_make_programs(void)
            argument_id = GPU0->kernel_init_buffer(sun_action_diff_x_reduce_id,lattice_lds);
            argument_action_diff_x_index = GPU0->kernel_init_constant(sun_action_diff_x_reduce_id,&Sparam);
        
-    sun_action_diff_y_id = GPU0->kernel_init("lattice_action_diff_y",1,measurement3_global_size,local_size_lattice_measurement);
-           argument_id = GPU0->kernel_init_buffer(sun_action_diff_y_id,lattice_table);
+    sun_action_diff_y_id = GPU0->kernel_init("lattice_action_diff_y",1,measurement3_global_size,local_size_lattice_measurement, false);
+           argument_id = GPU0->kernel_init_buffer(sun_action_diff_y_id,lattice_table_measured);
            argument_id = GPU0->kernel_init_buffer(sun_action_diff_y_id,lattice_measurement);
            argument_id = GPU0->kernel_init_buffer(sun_action_diff_y_id,lattice_parameters);	
            argument_id = GPU0->kernel_init_buffer(sun_action_diff_y_id,lattice_lds);
@@ -3471,8 +4231,8 @@ void        model::lattice_make_programs(void)
            argument_id = GPU0->kernel_init_buffer(sun_action_diff_y_reduce_id,lattice_lds);
            argument_action_diff_y_index = GPU0->kernel_init_constant(sun_action_diff_y_reduce_id,&Sparam);
        
-    sun_action_diff_z_id = GPU0->kernel_init("lattice_action_diff_z",1,measurement3_global_size,local_size_lattice_measurement);
-           argument_id = GPU0->kernel_init_buffer(sun_action_diff_z_id,lattice_table);
+    sun_action_diff_z_id = GPU0->kernel_init("lattice_action_diff_z",1,measurement3_global_size,local_size_lattice_measurement, false);
+           argument_id = GPU0->kernel_init_buffer(sun_action_diff_z_id,lattice_table_measured);
            argument_id = GPU0->kernel_init_buffer(sun_action_diff_z_id,lattice_measurement);
            argument_id = GPU0->kernel_init_buffer(sun_action_diff_z_id,lattice_parameters);	
            argument_id = GPU0->kernel_init_buffer(sun_action_diff_z_id,lattice_lds);
@@ -3488,9 +4248,9 @@ void        model::lattice_make_programs(void)
     // for mean averaged plaquettes measurements
     cl_uint4 mesurement_plq_param;
     if ((get_plaquettes_avr)||(get_Fmunu)||(get_F0mu)) {
-        sun_measurement_plq_id = GPU0->kernel_init("lattice_measurement_plq",1,measurement3_global_size,local_size_lattice_measurement);
+        sun_measurement_plq_id = GPU0->kernel_init("lattice_measurement_plq",1,measurement3_global_size,local_size_lattice_measurement, false);
                    offset_reduce_measurement_plq_double2 = GPU0->buffer_size_align((unsigned int) ceil((double) lattice_table_exact_row_size / GPU0->kernel_get_worksize(sun_measurement_plq_id)),GPU0->kernel_get_worksize(sun_measurement_plq_id));
-                   argument_id = GPU0->kernel_init_buffer(sun_measurement_plq_id,lattice_table);
+                   argument_id = GPU0->kernel_init_buffer(sun_measurement_plq_id,lattice_table_measured);
                    argument_id = GPU0->kernel_init_buffer(sun_measurement_plq_id,lattice_measurement);
                    argument_id = GPU0->kernel_init_buffer(sun_measurement_plq_id,lattice_parameters);
                    argument_id = GPU0->kernel_init_buffer(sun_measurement_plq_id,lattice_lds);
@@ -3507,6 +4267,35 @@ void        model::lattice_make_programs(void)
             mesurement_plq_param.s[3] = 0;
                           argument_plq_index = GPU0->kernel_init_constant(sun_measurement_plq_reduce_id,&mesurement_plq_param);
     }
+
+    // heatbath counters of update work-items are reduced and reset at each measurement, in main queue next to update kernels
+    sun_heatbath_stats_id        = 0;
+    sun_heatbath_stats_reduce_id = 0;
+    cl_uint4 heatbath_stats_param;
+    if (get_heatbath_stats) {
+        const size_t heatbath_stats_global_size[] = {lattice_table_row_size_half};
+        sun_heatbath_stats_id = GPU0->kernel_init("lattice_heatbath_stats",1,heatbath_stats_global_size,local_size_lattice_measurement, false);
+            int size_reduce_heatbath_stats_double2   = (int) ceil((double) lattice_table_row_size_half / GPU0->kernel_get_worksize(sun_heatbath_stats_id));
+            int offset_reduce_heatbath_stats_double2 = GPU0->buffer_size_align((unsigned int) size_reduce_heatbath_stats_double2,GPU0->kernel_get_worksize(sun_heatbath_stats_id));
+            heatbath_stats_param.s[0] = lattice_table_row_size_half;
+            heatbath_stats_param.s[1] = offset_reduce_heatbath_stats_double2;
+            heatbath_stats_param.s[2] = 0;
+            heatbath_stats_param.s[3] = 0;
+                          argument_id = GPU0->kernel_init_buffer(sun_heatbath_stats_id,lattice_heatbath_stats);
+                          argument_id = GPU0->kernel_init_buffer(sun_heatbath_stats_id,lattice_heatbath_reduce);
+                          argument_id = GPU0->kernel_init_buffer(sun_heatbath_stats_id,lattice_lds);
+                          argument_id = GPU0->kernel_init_constant(sun_heatbath_stats_id,&heatbath_stats_param);
+
+        sun_heatbath_stats_reduce_id = GPU0->kernel_init("reduce_heatbath_stats_double2",1,reduce_measurement_global_size,reduce_local_size);
+                          argument_id = GPU0->kernel_init_buffer(sun_heatbath_stats_reduce_id,lattice_heatbath_reduce);
+                          argument_id = GPU0->kernel_init_buffer(sun_heatbath_stats_reduce_id,lattice_heatbath_measurements);
+                          argument_id = GPU0->kernel_init_buffer(sun_heatbath_stats_reduce_id,lattice_lds);
+            heatbath_stats_param.s[0] = size_reduce_heatbath_stats_double2;
+            heatbath_stats_param.s[1] = offset_reduce_heatbath_stats_double2;
+            heatbath_stats_param.s[2] = lattice_polyakov_loop_size;
+            heatbath_stats_param.s[3] = 0;
+                          argument_heatbath_stats_index = GPU0->kernel_init_constant(sun_heatbath_stats_reduce_id,&heatbath_stats_param);
+    }
     
     int lattice_measurement_size_correction = max(size_reduce_measurement_double2,size_reduce_measurement_plq_double2);
     if (lattice_measurement_size_F<(unsigned int) lattice_measurement_size_correction){
@@ -3514,23 +4303,14 @@ void        model::lattice_make_programs(void)
         _getch();
     }
 
-    // for Wilson loop measurements _____________________________________________________________________________________________________________________________
-    char options_wilson[1024];
-    sprintf_s(options_wilson,sizeof(options_wilson),"%s",options_common);
-
-    char buffer_wilson_cl[FNAME_MAX_LENGTH];
-        j = sprintf_s(buffer_wilson_cl  ,FNAME_MAX_LENGTH,  "%s",GPU0->cl_root_path);
-        j+= sprintf_s(buffer_wilson_cl+j,FNAME_MAX_LENGTH-j,"%s",SOURCE_WILSON_LOOP);
-    char* wilson_source       = GPU0->source_read(buffer_wilson_cl);
-                                GPU0->program_create(wilson_source,options_wilson);
-
     int size_reduce_wilson_double2 = 0;
 
     sun_measurement_wilson_id  = 0;
     sun_wilson_loop_reduce_id  = 0;
     if (get_wilson_loop) {
-        sun_measurement_wilson_id = GPU0->kernel_init("lattice_measurement_wilson",1,measurement3_global_size,local_size_lattice_wilson);
-                      argument_id = GPU0->kernel_init_buffer(sun_measurement_wilson_id,lattice_table);
+        GPU0->program_set_active(wilson_program_id);
+        sun_measurement_wilson_id = GPU0->kernel_init("lattice_measurement_wilson",1,measurement3_global_size,local_size_lattice_wilson, false);
+                      argument_id = GPU0->kernel_init_buffer(sun_measurement_wilson_id,lattice_table_measured);
                       argument_id = GPU0->kernel_init_buffer(sun_measurement_wilson_id,lattice_measurement);
                       argument_id = GPU0->kernel_init_buffer(sun_measurement_wilson_id,lattice_parameters);
                       argument_id = GPU0->kernel_init_buffer(sun_measurement_wilson_id,lattice_lds);
@@ -3544,16 +4324,6 @@ void        model::lattice_make_programs(void)
                       // setup index for wilson loop is before kernel run
     }
 
-    // for Polyakov loop measurements ___________________________________________________________________________________________________________________________
-    char options_polyakov[1024];
-    int options_length_polyakov  = sprintf_s(options_polyakov,sizeof(options_polyakov),"%s",options_common);
-        options_length_polyakov += sprintf_s(options_polyakov + options_length_polyakov,sizeof(options_polyakov)-options_length_polyakov," -D PL=%u",          PL_level);
-
-    char buffer_polyakov_cl[FNAME_MAX_LENGTH];
-        j = sprintf_s(buffer_polyakov_cl  ,FNAME_MAX_LENGTH,  "%s",GPU0->cl_root_path);
-        j+= sprintf_s(buffer_polyakov_cl+j,FNAME_MAX_LENGTH-j,"%s",SOURCE_POLYAKOV);
-    char* polyakov_source       = GPU0->source_read(buffer_polyakov_cl);
-                                  GPU0->program_create(polyakov_source,options_polyakov);
     int size_reduce_polyakov_double2   = 0;
     int offset_reduce_polyakov_double2 = 0;
     int size_reduce_polyakov_diff_double2   = 0;
@@ -3568,9 +4338,10 @@ void        model::lattice_make_programs(void)
     sun_polyakov_diff_z_reduce_id = 0;
     cl_uint4 polyakov_param;
     if (PL_level > 0) {
-        sun_polyakov_id = GPU0->kernel_init("lattice_polyakov",1,polyakov3_global_size,local_size_lattice_polyakov);
+        GPU0->program_set_active(polyakov_program_id);
+        sun_polyakov_id = GPU0->kernel_init("lattice_polyakov",1,polyakov3_global_size,local_size_lattice_polyakov, false);
         offset_reduce_polyakov_double2 = GPU0->buffer_size_align((unsigned int) ceil((double) lattice_polyakov_size / GPU0->kernel_get_worksize(sun_polyakov_id)),GPU0->kernel_get_worksize(sun_polyakov_id));
-            argument_id = GPU0->kernel_init_buffer(sun_polyakov_id,lattice_table);
+            argument_id = GPU0->kernel_init_buffer(sun_polyakov_id,lattice_table_measured);
             argument_id = GPU0->kernel_init_buffer(sun_polyakov_id,lattice_measurement);
             argument_id = GPU0->kernel_init_buffer(sun_polyakov_id,lattice_parameters);
             argument_id = GPU0->kernel_init_buffer(sun_polyakov_id,lattice_lds);
@@ -3588,9 +4359,9 @@ void        model::lattice_make_programs(void)
             argument_polyakov_index = GPU0->kernel_init_constant(sun_polyakov_reduce_id,&polyakov_param);
     }
     if (PL_level > 2) {
-        sun_polyakov_diff_x_id = GPU0->kernel_init("lattice_polyakov_diff_x",1,polyakov3_global_size,local_size_lattice_polyakov);
+        sun_polyakov_diff_x_id = GPU0->kernel_init("lattice_polyakov_diff_x",1,polyakov3_global_size,local_size_lattice_polyakov, false);
         offset_reduce_polyakov_diff_double2 = GPU0->buffer_size_align((unsigned int) ceil((double) lattice_polyakov_size / GPU0->kernel_get_worksize(sun_polyakov_diff_x_id)),GPU0->kernel_get_worksize(sun_polyakov_diff_x_id));
-            argument_id = GPU0->kernel_init_buffer(sun_polyakov_diff_x_id,lattice_table);
+            argument_id = GPU0->kernel_init_buffer(sun_polyakov_diff_x_id,lattice_table_measured);
             argument_id = GPU0->kernel_init_buffer(sun_polyakov_diff_x_id,lattice_measurement);
             argument_id = GPU0->kernel_init_buffer(sun_polyakov_diff_x_id,lattice_parameters);
             argument_id = GPU0->kernel_init_buffer(sun_polyakov_diff_x_id,lattice_lds);
@@ -3607,9 +4378,9 @@ void        model::lattice_make_programs(void)
             polyakov_param.s[3] = 0;
             argument_polyakov_diff_x_index = GPU0->kernel_init_constant(sun_polyakov_diff_x_reduce_id,&polyakov_param);
             
-        sun_polyakov_diff_y_id = GPU0->kernel_init("lattice_polyakov_diff_y",1,polyakov3_global_size,local_size_lattice_polyakov);
+        sun_polyakov_diff_y_id = GPU0->kernel_init("lattice_polyakov_diff_y",1,polyakov3_global_size,local_size_lattice_polyakov, false);
         offset_reduce_polyakov_diff_double2 = GPU0->buffer_size_align((unsigned int) ceil((double) lattice_polyakov_size / GPU0->kernel_get_worksize(sun_polyakov_diff_y_id)),GPU0->kernel_get_worksize(sun_polyakov_diff_y_id));
-            argument_id = GPU0->kernel_init_buffer(sun_polyakov_diff_y_id,lattice_table);
+            argument_id = GPU0->kernel_init_buffer(sun_polyakov_diff_y_id,lattice_table_measured);
             argument_id = GPU0->kernel_init_buffer(sun_polyakov_diff_y_id,lattice_measurement);
             argument_id = GPU0->kernel_init_buffer(sun_polyakov_diff_y_id,lattice_parameters);
             argument_id = GPU0->kernel_init_buffer(sun_polyakov_diff_y_id,lattice_lds);
@@ -3626,9 +4397,9 @@ void        model::lattice_make_programs(void)
             polyakov_param.s[3] = 0;
             argument_polyakov_diff_y_index = GPU0->kernel_init_constant(sun_polyakov_diff_y_reduce_id,&polyakov_param);
         
-    sun_polyakov_diff_z_id = GPU0->kernel_init("lattice_polyakov_diff_z",1,polyakov3_global_size,local_size_lattice_polyakov);
+    sun_polyakov_diff_z_id = GPU0->kernel_init("lattice_polyakov_diff_z",1,polyakov3_global_size,local_size_lattice_polyakov, false);
         offset_reduce_polyakov_diff_double2 = GPU0->buffer_size_align((unsigned int) ceil((double) lattice_polyakov_size / GPU0->kernel_get_worksize(sun_polyakov_diff_z_id)),GPU0->kernel_get_worksize(sun_polyakov_diff_z_id));
-            argument_id = GPU0->kernel_init_buffer(sun_polyakov_diff_z_id,lattice_table);
+            argument_id = GPU0->kernel_init_buffer(sun_polyakov_diff_z_id,lattice_table_measured);
             argument_id = GPU0->kernel_init_buffer(sun_polyakov_diff_z_id,lattice_measurement);
             argument_id = GPU0->kernel_init_buffer(sun_polyakov_diff_z_id,lattice_parameters);
             argument_id = GPU0->kernel_init_buffer(sun_polyakov_diff_z_id,lattice_lds);
@@ -3645,6 +4416,61 @@ void        model::lattice_make_programs(void)
             polyakov_param.s[3] = 0;
             argument_polyakov_diff_z_index = GPU0->kernel_init_constant(sun_polyakov_diff_z_reduce_id,&polyakov_param);
     }
+
+    lattice_set_kernel_costs();
+}
+
+void        model::lattice_set_kernel_costs(void)
+{
+    // estimated global memory traffic and floating-point operations per work item for roofline report
+    // (init, PRNG, GramSchmidt and reduction kernels use traffic derived from their argument buffers)
+    double link_bytes = (double) (lattice_group_elements[lattice_group-1] / 4) * ((precision == model_precision_double) ? sizeof(cl_double4) : sizeof(cl_float4));
+    double prn_bytes  = (PRNG0->PRNG_precision == PRNG_CL::PRNG::PRNG_precision_double) ? sizeof(cl_double4) : sizeof(cl_float4);
+    if (PRNG0->PRNG_in_kernels) prn_bytes = 0.0;    // counter-based PRNs are not read from memory
+    double mult_flops        = (lattice_group == 3) ? 198.0 : 56.0;   // matrix multiplication
+    double reconstruct_flops = (lattice_group == 3) ?  42.0 :  0.0;   // third row reconstruction
+    if (link_storage == model_link_storage_8) reconstruct_flops += 60.0; // 8-parameter links are decompressed on load
+    double add_flops         = (lattice_group == 3) ?  18.0 :  8.0;   // matrix addition
+    double trace_flops       = (lattice_group == 3) ?   2.0 :  1.0;
+
+    // update: 6 staples (3 links each), updated link read and write, heatbath in SU(2) subgroups
+    double subgroups   = (lattice_group == 3) ? 3.0 : 1.0;
+    double update_bytes = 20.0 * link_bytes + 2.0 * subgroups * NHITPar * prn_bytes;
+    double update_flops = 19.0 * reconstruct_flops + 12.0 * mult_flops + 5.0 * add_flops + subgroups * NHITPar * (2.0 * mult_flops + reconstruct_flops + 60.0);
+    int update_kernels[8] = {sun_update_odd_X_id, sun_update_even_X_id, sun_update_odd_Y_id, sun_update_even_Y_id,
+                             sun_update_odd_Z_id, sun_update_even_Z_id, sun_update_odd_T_id, sun_update_even_T_id};
+    for (int i=0; i<8; i++) GPU0->kernel_set_cost(update_kernels[i],update_bytes,update_flops);
+
+    // overrelaxation: as update without PRNs, one reflection in each SU(2) subgroup
+    if (NOR > 0) {
+        double orelax_bytes = 20.0 * link_bytes;
+        double orelax_flops = 19.0 * reconstruct_flops + 12.0 * mult_flops + 5.0 * add_flops + subgroups * (2.0 * mult_flops + reconstruct_flops + 20.0);
+        int orelax_kernels[8] = {sun_orelax_odd_X_id, sun_orelax_even_X_id, sun_orelax_odd_Y_id, sun_orelax_even_Y_id,
+                                 sun_orelax_odd_Z_id, sun_orelax_even_Z_id, sun_orelax_odd_T_id, sun_orelax_even_T_id};
+        for (int i=0; i<8; i++) GPU0->kernel_set_cost(orelax_kernels[i],orelax_bytes,orelax_flops);
+    }
+
+    // plaquettes: 6 planes with 4 links each
+    double plaquette_bytes = 24.0 * link_bytes;
+    double plaquette_flops = 6.0 * (4.0 * reconstruct_flops + 3.0 * mult_flops + trace_flops);
+    GPU0->kernel_set_cost(sun_measurement_id,    plaquette_bytes,plaquette_flops);
+    GPU0->kernel_set_cost(sun_measurement_plq_id,plaquette_bytes,plaquette_flops);
+    GPU0->kernel_set_cost(sun_action_diff_x_id,  plaquette_bytes,plaquette_flops);
+    GPU0->kernel_set_cost(sun_action_diff_y_id,  plaquette_bytes,plaquette_flops);
+    GPU0->kernel_set_cost(sun_action_diff_z_id,  plaquette_bytes,plaquette_flops);
+
+    // Polyakov loop: product of temporal links
+    double NT = (double) lattice_domain_size[lattice_nd-1];
+    double polyakov_bytes = NT * link_bytes;
+    double polyakov_flops = NT * reconstruct_flops + (NT - 1.0) * mult_flops + trace_flops;
+    GPU0->kernel_set_cost(sun_polyakov_id,       polyakov_bytes,polyakov_flops);
+    GPU0->kernel_set_cost(sun_polyakov_diff_x_id,polyakov_bytes,polyakov_flops);
+    GPU0->kernel_set_cost(sun_polyakov_diff_y_id,polyakov_bytes,polyakov_flops);
+    GPU0->kernel_set_cost(sun_polyakov_diff_z_id,polyakov_bytes,polyakov_flops);
+
+    // Wilson loop: perimeter of R x T loop
+    double perimeter = 2.0 * (double) (wilson_R + wilson_T);
+    GPU0->kernel_set_cost(sun_measurement_wilson_id,perimeter * link_bytes,perimeter * reconstruct_flops + (perimeter - 1.0) * mult_flops + trace_flops);
 }
 #endif
 
@@ -3969,24 +4795,51 @@ int fc2 = 1;
     }
     lattice_measurement         = GPU0->buffer_init(GPU0->buffer_type_IO, size_lattice_measurement,      plattice_measurement,       sizeof(cl_double2)); // Lattice measurement
     lattice_lds                 = GPU0->buffer_init(GPU0->buffer_type_LDS,lds_size,                      NULL ,                          sizeof(cl_double2)); // LDS for reduction
-    lattice_energies            = GPU0->buffer_init(GPU0->buffer_type_IO, size_lattice_energies,         plattice_energies,          sizeof(cl_double2)); // Lattice energies
+    lattice_energies            = GPU0->buffer_init(GPU0->buffer_type_Pinned,size_lattice_energies,     plattice_energies,          sizeof(cl_double2)); // Lattice energies
     if(get_actions_diff)
     {
-         lattice_action_diff_x      = GPU0->buffer_init(GPU0->buffer_type_IO, size_lattice_energies,         plattice_action_diff_x,          sizeof(cl_double2));
-     lattice_action_diff_y      = GPU0->buffer_init(GPU0->buffer_type_IO, size_lattice_energies,         plattice_action_diff_y,          sizeof(cl_double2));
-     lattice_action_diff_z      = GPU0->buffer_init(GPU0->buffer_type_IO, size_lattice_energies,         plattice_action_diff_z,          sizeof(cl_double2));
+         lattice_action_diff_x      = GPU0->buffer_init(GPU0->buffer_type_Pinned, size_lattice_energies,         plattice_action_diff_x,          sizeof(cl_double2));
+     lattice_action_diff_y      = GPU0->buffer_init(GPU0->buffer_type_Pinned, size_lattice_energies,         plattice_action_diff_y,          sizeof(cl_double2));
+     lattice_action_diff_z      = GPU0->buffer_init(GPU0->buffer_type_Pinned, size_lattice_energies,         plattice_action_diff_z,          sizeof(cl_double2));
     }
     if ((get_plaquettes_avr) || (get_Fmunu) || (get_F0mu))
-        lattice_energies_plq    = GPU0->buffer_init(GPU0->buffer_type_IO, size_lattice_energies_plq,     plattice_energies_plq,      sizeof(cl_double2)); // Lattice energies (plaquettes)
+        lattice_energies_plq    = GPU0->buffer_init(GPU0->buffer_type_Pinned, size_lattice_energies_plq,     plattice_energies_plq,      sizeof(cl_double2)); // Lattice energies (plaquettes)
     if (get_wilson_loop)
-        lattice_wilson_loop     = GPU0->buffer_init(GPU0->buffer_type_IO, size_lattice_wilson_loop,      plattice_wilson_loop,       sizeof(cl_double));  // Wilson loop
+        lattice_wilson_loop     = GPU0->buffer_init(GPU0->buffer_type_Pinned, size_lattice_wilson_loop,      plattice_wilson_loop,       sizeof(cl_double));  // Wilson loop
     if (PL_level > 0)
-        lattice_polyakov_loop   = GPU0->buffer_init(GPU0->buffer_type_IO, size_lattice_polyakov_loop,    plattice_polyakov_loop, sizeof(cl_double2)); // Polyakov loops
+        lattice_polyakov_loop   = GPU0->buffer_init(GPU0->buffer_type_Pinned, size_lattice_polyakov_loop,    plattice_polyakov_loop, sizeof(cl_double2)); // Polyakov loops
     if (PL_level > 2)
     {
-        lattice_polyakov_loop_diff_x   = GPU0->buffer_init(GPU0->buffer_type_IO, size_lattice_polyakov_loop,    plattice_polyakov_loop_diff_x, sizeof(cl_double2));
-        lattice_polyakov_loop_diff_y   = GPU0->buffer_init(GPU0->buffer_type_IO, size_lattice_polyakov_loop,    plattice_polyakov_loop_diff_y, sizeof(cl_double2));
-        lattice_polyakov_loop_diff_z   = GPU0->buffer_init(GPU0->buffer_type_IO, size_lattice_polyakov_loop,    plattice_polyakov_loop_diff_z, sizeof(cl_double2));
+        lattice_polyakov_loop_diff_x   = GPU0->buffer_init(GPU0->buffer_type_Pinned, size_lattice_polyakov_loop,    plattice_polyakov_loop_diff_x, sizeof(cl_double2));
+        lattice_polyakov_loop_diff_y   = GPU0->buffer_init(GPU0->buffer_type_Pinned, size_lattice_polyakov_loop,    plattice_polyakov_loop_diff_y, sizeof(cl_double2));
+        lattice_polyakov_loop_diff_z   = GPU0->buffer_init(GPU0->buffer_type_Pinned, size_lattice_polyakov_loop,    plattice_polyakov_loop_diff_z, sizeof(cl_double2));
+    }
+    plattice_heatbath_stats        = NULL;
+    plattice_heatbath_measurements = NULL;
+    if (get_heatbath_stats) {
+        plattice_heatbath_stats = (cl_uint4*) calloc(lattice_table_row_size_half, sizeof(cl_uint4));
+        lattice_heatbath_stats  = GPU0->buffer_init(GPU0->buffer_type_IO, lattice_table_row_size_half, plattice_heatbath_stats, sizeof(cl_uint4)); // heatbath tries and failures
+        lattice_heatbath_reduce = GPU0->buffer_init(GPU0->buffer_type_Pinned, size_lattice_heatbath_reduce, NULL, sizeof(cl_double2)); // first step reduction of heatbath counters
+        plattice_heatbath_measurements = (cl_double2*) calloc(2 * lattice_polyakov_loop_size, sizeof(cl_double2));
+        lattice_heatbath_measurements  = GPU0->buffer_init(GPU0->buffer_type_Pinned, 2 * lattice_polyakov_loop_size, plattice_heatbath_measurements, sizeof(cl_double2)); // (updates, tries), failures of measurements
+    }
+    if (update_tiled)
+        lattice_tile_lds        = GPU0->buffer_init(GPU0->buffer_type_LDS, 128 * lattice_nd * ((lattice_group == 3) ? 12 : lattice_group_elements[lattice_group-1]) / 4, NULL, (precision == model_precision_single) ? sizeof(cl_float4) : sizeof(cl_double4)); // tile and halo links
+    plattice_hmc_momenta = NULL;
+    plattice_hmc_energy  = NULL;
+    plattice_hmc_total   = NULL;
+    if (update_engine == model_update_hmc) {
+        // su(3) momenta take 8 components (two rows per direction), su(2) momenta take 3 components (one row)
+        lattice_index size_hmc_momenta = lattice_table_row_size * lattice_nd * ((lattice_group == 3) ? 2 : 1);
+        int size_of_hmc_momenta = (precision == model_precision_double) ? sizeof(cl_double4) : sizeof(cl_float4);
+        plattice_hmc_momenta = calloc(size_hmc_momenta, size_of_hmc_momenta);
+        lattice_index size_hmc_energy = GPU0->buffer_size_align((lattice_index) ceil((double) lattice_table_exact_row_size / GPU0->GPU_info.max_workgroup_size));
+        plattice_hmc_energy  = (cl_double2*) calloc(size_hmc_energy, sizeof(cl_double2));
+        plattice_hmc_total   = (cl_double2*) calloc(1, sizeof(cl_double2));
+        lattice_hmc_momenta  = GPU0->buffer_init(GPU0->buffer_type_IO, size_hmc_momenta,       plattice_hmc_momenta, size_of_hmc_momenta);  // HMC momenta
+        lattice_hmc_energy   = GPU0->buffer_init(GPU0->buffer_type_IO, size_hmc_energy,        plattice_hmc_energy,  sizeof(cl_double2));  // HMC energy per work group
+        lattice_hmc_total    = GPU0->buffer_init(GPU0->buffer_type_Pinned, 1,                  plattice_hmc_total,   sizeof(cl_double2));  // HMC kinetic energy and action of lattice
+        lattice_table_hmc    = GPU0->buffer_snapshot_init(lattice_table);                                                                // links at start of trajectory
     }
 }
 #endif
@@ -4015,6 +4868,9 @@ void        model::UpdateEdges(int dir)
     size_t offset_k, offset_k_next;
     size_t size = 4 * 2 * n1n2n3 * ((precision == model_precision_single) ? sizeof(float) : sizeof(double));
 
+    for (k = 0; k < lattice_Nparts; k++)
+        SubLat[k].GPU0->device_synchronize();   // halo exchange: wait for asynchronously dispatched kernels
+
 #ifdef USE_OPENMP
     omp_set_num_threads(Ndevices);
 #pragma omp parallel private(ptr_rf, ptr_lf, ptr_rd, ptr_ld, k, k_next, offset_k, offset_k_next)
@@ -4076,6 +4932,9 @@ void        model::UpdateEdges(int dir)
     
     int tid;
 
+    for (k = 0; k < lattice_Nparts; k++)
+        SubLat[k].GPU0->device_synchronize();   // halo exchange: wait for asynchronously dispatched kernels
+
     for (k = 0; k < lattice_Nparts; k++){
         k_next = (k + 1) % lattice_Nparts;
 #ifdef USE_OPENMP
@@ -4563,6 +5422,7 @@ void        model::lattice_simulate(void)
 
             // perform thermalization
             for (int i=NAV_start; i<NAV; i++){
+                for (int k = 0; k < lattice_Nparts; k++) SubLat[k].GPU0->trace_set_iteration(NAV_counter + ITER_counter);
 #ifdef USE_OPENMP
 #pragma omp parallel for
                 for (int f = 0; f < Ndevices; f++)
@@ -4678,6 +5538,7 @@ void        model::lattice_simulate(void)
             // perform working cycles
             int q;
             for (int i=ITER_start; i<ITER; i++){ // zero measurement - on initial configuration!
+                for (int k = 0; k < lattice_Nparts; k++) SubLat[k].GPU0->trace_set_iteration(NAV_counter + ITER_counter);
                 for (int j=0; j<NITER; j++){
 //#ifdef USE_OPENMP
                     for (int kk = 0; kk < devParts[0]; kk++){
@@ -4771,6 +5632,10 @@ void        model::lattice_simulate(void)
                     }
 
             //-----------------------------------------
+            for (int k = 0; k < lattice_Nparts; k++) {
+                SubLat[k].GPU0->device_synchronize();   // wait for asynchronously dispatched kernels
+                SubLat[k].PRNG0->demand_collect();
+            }
             time(&timer2);
             printf("\nSIMULATION TIME: %f sec\n", difftime(timer2, timer1));
 
@@ -4908,6 +5773,7 @@ void        model::lattice_simulate(void)
 
         // perform thermalization
         for (int i=NAV_start; i<NAV; i++){
+            for (int k = 0; k < lattice_Nparts; k++) SubLat[k].GPU0->trace_set_iteration(NAV_counter + ITER_counter);
 #ifdef USE_OPENMP
 #pragma omp parallel for
             for (int f = 0; f < Ndevices; f++)
@@ -5023,6 +5889,7 @@ void        model::lattice_simulate(void)
         // perform working cycles
         int q;
         for (int i=ITER_start; i<ITER; i++){ // zero measurement - on initial configuration!
+            for (int k = 0; k < lattice_Nparts; k++) SubLat[k].GPU0->trace_set_iteration(NAV_counter + ITER_counter);
             for (int j=0; j<NITER; j++){
 #ifdef USE_OPENMP
 #pragma omp parallel for
@@ -5177,6 +6044,10 @@ void        model::lattice_simulate(void)
         }
 
     //-----------------------------------------
+    for (int k = 0; k < lattice_Nparts; k++) {
+        SubLat[k].GPU0->device_synchronize();   // wait for asynchronously dispatched kernels
+        SubLat[k].PRNG0->demand_collect();
+    }
     time(&timer2);
     printf("\nSIMULATION TIME: %f sec\n", difftime(timer2, timer1));
 
@@ -5209,6 +6080,101 @@ void        model::lattice_simulate(void)
 }
 #endif
 #else
+void        model::lattice_measure_initial(int index)
+{
+    // measurements of initial configuration (stored with index)
+    if (GPU0->GPU_debug.overlap_measurements) {
+        GPU0->buffer_snapshot(lattice_table_snapshot,lattice_table);
+        GPU0->queue_set_active(GPU0->queue_type_measurement);
+    }
+
+    if ((get_plaquettes_avr)||(get_Fmunu)||(get_F0mu)) {
+        GPU0->kernel_run(sun_measurement_plq_id);          // Lattice measurement (plaquettes)
+        GPU0->print_stage("measurement done (plaquettes)");
+//         GPU0->buffer_map(lattice_measurement);
+//         GPU0->print_mapped_buffer_double2(lattice_measurement,5);
+            plq_index = index;
+            GPU0->kernel_init_constant_reset(sun_measurement_plq_reduce_id,&plq_index,argument_plq_index);
+        GPU0->kernel_run(sun_measurement_plq_reduce_id);    // Lattice measurement reduction (plaquettes)
+        GPU0->print_stage("measurement reduce done (plaquettes)");
+    }
+
+    if (get_wilson_loop) {
+        GPU0->kernel_run(sun_measurement_wilson_id);       // Lattice Wilson loop measurement
+        GPU0->print_stage("Wilson loop measurement done");
+            wilson_index = index;
+            GPU0->kernel_init_constant_reset(sun_wilson_loop_reduce_id,&wilson_index,argument_wilson_index);
+        GPU0->kernel_run(sun_wilson_loop_reduce_id);       // Lattice Wilson loop measurement reduction
+        GPU0->print_stage("Wilson loop measurement reduce done");
+    }
+
+    if (get_actions_avr) {
+        GPU0->kernel_run(sun_measurement_id);                  // Lattice measurement
+        GPU0->print_stage("measurement done");
+            measurement_index = index;
+            GPU0->kernel_init_constant_reset(sun_measurement_reduce_id,&measurement_index,argument_measurement_index);
+        GPU0->kernel_run(sun_measurement_reduce_id);           // Lattice measurement reduction
+        GPU0->print_stage("measurement reduce done");
+    }
+
+    if(get_actions_diff)
+{
+    GPU0->kernel_run(sun_action_diff_x_id);
+    GPU0->print_stage("measurement S diff done");
+            action_diff_index = index;
+            GPU0->kernel_init_constant_reset(sun_action_diff_x_reduce_id,&action_diff_index,argument_action_diff_x_index);
+        GPU0->kernel_run(sun_action_diff_x_reduce_id);
+        GPU0->print_stage("measurement action diff reduce done");
+    
+    GPU0->kernel_run(sun_action_diff_y_id);
+    GPU0->print_stage("measurement S diff done");
+            action_diff_index = index;
+            GPU0->kernel_init_constant_reset(sun_action_diff_y_reduce_id,&action_diff_index,argument_action_diff_y_index);
+        GPU0->kernel_run(sun_action_diff_y_reduce_id);
+        GPU0->print_stage("measurement action diff reduce done");
+    
+    GPU0->kernel_run(sun_action_diff_z_id);
+    GPU0->print_stage("measurement S diff done");
+            action_diff_index = index;
+            GPU0->kernel_init_constant_reset(sun_action_diff_z_reduce_id,&action_diff_index,argument_action_diff_z_index);
+        GPU0->kernel_run(sun_action_diff_z_reduce_id);
+        GPU0->print_stage("measurement action diff reduce done");
+}
+    
+    if (PL_level > 0) {
+        GPU0->kernel_run(sun_polyakov_id);                     // Lattice Polyakov loop measurement
+        GPU0->print_stage("Polyakov loop measurement done");
+            polyakov_index = index;
+            GPU0->kernel_init_constant_reset(sun_polyakov_reduce_id,&polyakov_index,argument_polyakov_index);
+        GPU0->kernel_run(sun_polyakov_reduce_id);              // Lattice Polyakov loop measurement reduction
+        GPU0->print_stage("Polyakov loop reduce done");
+    }
+    
+    if (PL_level > 2) {
+        GPU0->kernel_run(sun_polyakov_diff_x_id);                     // Lattice Polyakov loop measurement
+        GPU0->print_stage("Polyakov loop diff measurement done");
+            polyakov_diff_index = index;
+            GPU0->kernel_init_constant_reset(sun_polyakov_diff_x_reduce_id,&polyakov_diff_index,argument_polyakov_diff_x_index);
+        GPU0->kernel_run(sun_polyakov_diff_x_reduce_id);              // Lattice Polyakov loop measurement reduction
+        GPU0->print_stage("Polyakov loop diff reduce done");
+    
+    GPU0->kernel_run(sun_polyakov_diff_y_id);                     // Lattice Polyakov loop measurement
+        GPU0->print_stage("Polyakov loop diff measurement done");
+            polyakov_diff_index = index;
+            GPU0->kernel_init_constant_reset(sun_polyakov_diff_y_reduce_id,&polyakov_diff_index,argument_polyakov_diff_y_index);
+        GPU0->kernel_run(sun_polyakov_diff_y_reduce_id);              // Lattice Polyakov loop measurement reduction
+        GPU0->print_stage("Polyakov loop diff reduce done");
+    
+    GPU0->kernel_run(sun_polyakov_diff_z_id);                     // Lattice Polyakov loop measurement
+        GPU0->print_stage("Polyakov loop diff measurement done");
+            polyakov_diff_index = index;
+            GPU0->kernel_init_constant_reset(sun_polyakov_diff_z_reduce_id,&polyakov_diff_index,argument_polyakov_diff_z_index);
+        GPU0->kernel_run(sun_polyakov_diff_z_reduce_id);              // Lattice Polyakov loop measurement reduction
+        GPU0->print_stage("Polyakov loop diff reduce done");
+    }
+    GPU0->queue_set_active(GPU0->queue_type_main);
+}
+
 void        model::lattice_simulate(void)
 {
     lattice_create_buffers();
@@ -5239,7 +6205,6 @@ void        model::lattice_simulate(void)
     int ITER_start = 0;
 
     if (INIT!=0) {
-
         if (ints==model_start_hot) {
             GPU0->kernel_run(sun_init_X_id);        // Lattice initialization
             if (!turnoff_prns) PRNG0->produce();
@@ -5252,91 +6217,9 @@ void        model::lattice_simulate(void)
             GPU0->kernel_run(sun_init_id);          // Lattice initialization
         GPU0->print_stage("lattice initialized");
 
-        if ((get_plaquettes_avr)||(get_Fmunu)||(get_F0mu)) {
-            GPU0->kernel_run(sun_measurement_plq_id);          // Lattice measurement (plaquettes)
-            GPU0->print_stage("measurement done (plaquettes)");
-//         GPU0->buffer_map(lattice_measurement);
-//         GPU0->print_mapped_buffer_double2(lattice_measurement,5);
-                plq_index = ITER_counter;
-                GPU0->kernel_init_constant_reset(sun_measurement_plq_reduce_id,&plq_index,argument_plq_index);
-            GPU0->kernel_run(sun_measurement_plq_reduce_id);    // Lattice measurement reduction (plaquettes)
-            GPU0->print_stage("measurement reduce done (plaquettes)");
-        }
-    
-        if (get_wilson_loop) {
-            GPU0->kernel_run(sun_measurement_wilson_id);       // Lattice Wilson loop measurement
-            GPU0->print_stage("Wilson loop measurement done");
-                wilson_index = ITER_counter;
-                GPU0->kernel_init_constant_reset(sun_wilson_loop_reduce_id,&wilson_index,argument_wilson_index);
-            GPU0->kernel_run(sun_wilson_loop_reduce_id);       // Lattice Wilson loop measurement reduction
-            GPU0->print_stage("Wilson loop measurement reduce done");
-        }
-
-        if (get_actions_avr) {
-            GPU0->kernel_run(sun_measurement_id);                  // Lattice measurement
-            GPU0->print_stage("measurement done");
-                measurement_index = ITER_counter;
-                GPU0->kernel_init_constant_reset(sun_measurement_reduce_id,&measurement_index,argument_measurement_index);
-            GPU0->kernel_run(sun_measurement_reduce_id);           // Lattice measurement reduction
-            GPU0->print_stage("measurement reduce done");
-        }
-
-        if(get_actions_diff)
-    {
-        GPU0->kernel_run(sun_action_diff_x_id);
-        GPU0->print_stage("measurement S diff done");
-                action_diff_index = ITER_counter;
-                GPU0->kernel_init_constant_reset(sun_action_diff_x_reduce_id,&action_diff_index,argument_action_diff_x_index);
-            GPU0->kernel_run(sun_action_diff_x_reduce_id);
-            GPU0->print_stage("measurement action diff reduce done");
-        
-        GPU0->kernel_run(sun_action_diff_y_id);
-        GPU0->print_stage("measurement S diff done");
-                action_diff_index = ITER_counter;
-                GPU0->kernel_init_constant_reset(sun_action_diff_y_reduce_id,&action_diff_index,argument_action_diff_y_index);
-            GPU0->kernel_run(sun_action_diff_y_reduce_id);
-            GPU0->print_stage("measurement action diff reduce done");
-        
-        GPU0->kernel_run(sun_action_diff_z_id);
-        GPU0->print_stage("measurement S diff done");
-                action_diff_index = ITER_counter;
-                GPU0->kernel_init_constant_reset(sun_action_diff_z_reduce_id,&action_diff_index,argument_action_diff_z_index);
-            GPU0->kernel_run(sun_action_diff_z_reduce_id);
-            GPU0->print_stage("measurement action diff reduce done");
-    }
-        
-        if (PL_level > 0) {
-            GPU0->kernel_run(sun_polyakov_id);                     // Lattice Polyakov loop measurement
-            GPU0->print_stage("Polyakov loop measurement done");
-                polyakov_index = ITER_counter;
-                GPU0->kernel_init_constant_reset(sun_polyakov_reduce_id,&polyakov_index,argument_polyakov_index);
-            GPU0->kernel_run(sun_polyakov_reduce_id);              // Lattice Polyakov loop measurement reduction
-            GPU0->print_stage("Polyakov loop reduce done");
-        }
-        
-        if (PL_level > 2) {
-            GPU0->kernel_run(sun_polyakov_diff_x_id);                     // Lattice Polyakov loop measurement
-            GPU0->print_stage("Polyakov loop diff measurement done");
-                polyakov_diff_index = ITER_counter;
-                GPU0->kernel_init_constant_reset(sun_polyakov_diff_x_reduce_id,&polyakov_diff_index,argument_polyakov_diff_x_index);
-            GPU0->kernel_run(sun_polyakov_diff_x_reduce_id);              // Lattice Polyakov loop measurement reduction
-            GPU0->print_stage("Polyakov loop diff reduce done");
-        
-        GPU0->kernel_run(sun_polyakov_diff_y_id);                     // Lattice Polyakov loop measurement
-            GPU0->print_stage("Polyakov loop diff measurement done");
-                polyakov_diff_index = ITER_counter;
-                GPU0->kernel_init_constant_reset(sun_polyakov_diff_y_reduce_id,&polyakov_diff_index,argument_polyakov_diff_y_index);
-            GPU0->kernel_run(sun_polyakov_diff_y_reduce_id);              // Lattice Polyakov loop measurement reduction
-            GPU0->print_stage("Polyakov loop diff reduce done");
-        
-        GPU0->kernel_run(sun_polyakov_diff_z_id);                     // Lattice Polyakov loop measurement
-            GPU0->print_stage("Polyakov loop diff measurement done");
-                polyakov_diff_index = ITER_counter;
-                GPU0->kernel_init_constant_reset(sun_polyakov_diff_z_reduce_id,&polyakov_diff_index,argument_polyakov_diff_z_index);
-            GPU0->kernel_run(sun_polyakov_diff_z_reduce_id);              // Lattice Polyakov loop measurement reduction
-            GPU0->print_stage("Polyakov loop diff reduce done");
-        }
-
+        // initial configuration is measured before thermalization, so a saved state always holds its measurement
+        lattice_make_measurement_kernels();                              // waits for background build of measurement programs
+        lattice_measure_initial(ITER_counter);
         ITER_counter++;
 
         if (!turnoff_config_save) lattice_save_state();
@@ -5355,23 +6238,8 @@ void        model::lattice_simulate(void)
 
     // perform thermalization
     for (int i=NAV_start; i<NAV; i++){
-           if (!turnoff_prns) PRNG0->produce();
-        if (!turnoff_updates) GPU0->kernel_run(sun_update_odd_X_id);     // Update odd X links
-           if (!turnoff_prns) PRNG0->produce();
-        if (!turnoff_updates) GPU0->kernel_run(sun_update_odd_Y_id);     // Update odd Y links
-           if (!turnoff_prns) PRNG0->produce();
-        if (!turnoff_updates) GPU0->kernel_run(sun_update_odd_Z_id);     // Update odd Z links
-           if (!turnoff_prns) PRNG0->produce();
-        if (!turnoff_updates) GPU0->kernel_run(sun_update_odd_T_id);     // Update odd T links
-
-           if (!turnoff_prns) PRNG0->produce();
-        if (!turnoff_updates) GPU0->kernel_run(sun_update_even_X_id);    // Update even X links
-           if (!turnoff_prns) PRNG0->produce();
-        if (!turnoff_updates) GPU0->kernel_run(sun_update_even_Y_id);    // Update even Y links
-           if (!turnoff_prns) PRNG0->produce();
-        if (!turnoff_updates) GPU0->kernel_run(sun_update_even_Z_id);    // Update even Z links
-           if (!turnoff_prns) PRNG0->produce();
-        if (!turnoff_updates) GPU0->kernel_run(sun_update_even_T_id);    // Update even T links
+        GPU0->trace_set_iteration(NAV_counter + ITER_counter);
+        lattice_update();                                                // Update all links
 
             if (!turnoff_gramschmidt)
                 GPU0->kernel_run(sun_GramSchmidt_id);          // Lattice reunitarization
@@ -5388,25 +6256,18 @@ void        model::lattice_simulate(void)
     }
 
     // perform working cycles
+    lattice_make_measurement_kernels();                                  // waits for background build of measurement programs (INIT == 0)
+    if (get_heatbath_stats) GPU0->kernel_run(sun_heatbath_stats_id);     // reset heatbath counters of thermalization
+    if ((update_engine == model_update_hmc)&&(HMC_trajectories > 0)&&(HMC_accepted == 0))
+        printf("\nHMC warning: no trajectory of thermalization accepted (mean dH = %f), decrease step size HMCTAU/HMCSTEPS\n",HMC_dH / HMC_trajectories);
+    HMC_trajectories = 0;   // HMC statistics of thermalized configurations only
+    HMC_accepted     = 0;
+    HMC_dH           = 0.0;
+    HMC_exp_dH       = 0.0;
     for (int i=ITER_start; i<ITER; i++){ // zero measurement - on initial configuration!
+        GPU0->trace_set_iteration(NAV_counter + ITER_counter);
         for (int j=0; j<NITER; j++){
-               if (!turnoff_prns) PRNG0->produce();
-            if (!turnoff_updates) GPU0->kernel_run(sun_update_odd_X_id);     // Lattice measurement staples
-               if (!turnoff_prns) PRNG0->produce();
-            if (!turnoff_updates) GPU0->kernel_run(sun_update_odd_Y_id);     // Lattice measurement staples
-               if (!turnoff_prns) PRNG0->produce();
-            if (!turnoff_updates) GPU0->kernel_run(sun_update_odd_Z_id);     // Lattice measurement staples
-               if (!turnoff_prns) PRNG0->produce();
-            if (!turnoff_updates) GPU0->kernel_run(sun_update_odd_T_id);     // Lattice measurement staples
-
-               if (!turnoff_prns) PRNG0->produce();
-            if (!turnoff_updates) GPU0->kernel_run(sun_update_even_X_id);    // Lattice measurement staples
-               if (!turnoff_prns) PRNG0->produce();
-            if (!turnoff_updates) GPU0->kernel_run(sun_update_even_Y_id);    // Lattice measurement staples
-               if (!turnoff_prns) PRNG0->produce();
-            if (!turnoff_updates) GPU0->kernel_run(sun_update_even_Z_id);    // Lattice measurement staples
-               if (!turnoff_prns) PRNG0->produce();
-            if (!turnoff_updates) GPU0->kernel_run(sun_update_even_T_id);    // Lattice measurement staples
+            lattice_update();                                            // Update all links
             
             if (!turnoff_gramschmidt)
                 GPU0->kernel_run(sun_GramSchmidt_id);           // Lattice reunitarization
@@ -5414,6 +6275,20 @@ void        model::lattice_simulate(void)
             if (i % 10 == 0) printf("\rGPU working iteration [%u]",i);
         }
 
+        // heatbath counters since previous measurement are reduced in main queue, in order with update kernels
+        if (get_heatbath_stats) {
+            GPU0->kernel_run(sun_heatbath_stats_id);
+                heatbath_stats_index = ITER_counter;
+                GPU0->kernel_init_constant_reset(sun_heatbath_stats_reduce_id,&heatbath_stats_index,argument_heatbath_stats_index);
+            GPU0->kernel_run(sun_heatbath_stats_reduce_id);
+        }
+
+        // measurements of configuration snapshot run in separate queue, while the next configuration is updated
+        if (GPU0->GPU_debug.overlap_measurements) {
+            GPU0->buffer_snapshot(lattice_table_snapshot,lattice_table);
+            GPU0->queue_set_active(GPU0->queue_type_measurement);
+        }
+
         if (get_wilson_loop) {
             GPU0->kernel_run(sun_measurement_wilson_id);        // Lattice Wilson loop measurement
                 wilson_index = ITER_counter;
@@ -5481,6 +6356,7 @@ GPU0->kernel_run(sun_clear_measurement_id);
                 GPU0->kernel_init_constant_reset(sun_measurement_plq_reduce_id,&plq_index,argument_plq_index);
             GPU0->kernel_run(sun_measurement_plq_reduce_id);    // Lattice measurement reduction (plaquettes)
         }
+        GPU0->queue_set_active(GPU0->queue_type_main);
 
         ITER_counter++;
 
@@ -5491,16 +6367,16 @@ GPU0->kernel_run(sun_clear_measurement_id);
             GPU0->start_timer_CPU(TIMER_FOR_SAVE);      // restart timer for lattice_state save
         } 
     }
+    GPU0->device_synchronize();     // wait for asynchronously dispatched kernels before measurement readback
+    if (get_heatbath_stats) lattice_heatbath_statistics();
+    PRNG0->demand_collect();
     printf("\rGPU simulations are done (%f seconds)\n",GPU0->get_timer_CPU(1));
     time(&ltimeend);
     timeend   = GPU0->get_current_datetime();
 
-    if (!turnoff_config_save) {
-        lattice_save_state();
-        lattice_pointer_last = lattice_pointer_save;
-    } else {
-        lattice_pointer_last = GPU0->buffer_map(lattice_table);
-    }
+    if (!turnoff_config_save) lattice_save_state();
+    lattice_pointer_last = GPU0->buffer_map(lattice_table);
+    PRNG0->fill();                  // PRNs of the last update for CPU verification
     prng_pointer = GPU0->buffer_map_float4(PRNG0->PRNG_randoms_id);
 }
 #endif
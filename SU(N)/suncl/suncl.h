@@ -67,12 +67,34 @@ class model {
                 model_start_gid                    // fill the lattice with GIDs (for testing purposes)
             } model_starts;
 
+            typedef enum enum_model_updates{
+                model_update_heatbath,             // heatbath half-sweeps (+ overrelaxation)
+                model_update_hmc                   // Hybrid Monte Carlo trajectories
+            } model_updates;
+
+            typedef enum enum_model_integrators{
+                model_integrator_leapfrog,         // leapfrog
+                model_integrator_omelyan           // Omelyan second order minimal norm (2MN)
+            } model_integrators;
+
+            typedef enum enum_model_actions{
+                model_action_wilson,               // Wilson plaquette action
+                model_action_symanzik,             // tree-level Symanzik (c1 = -1/12)
+                model_action_iwasaki,              // Iwasaki (c1 = -0.331)
+                model_action_dbw2                  // DBW2 (c1 = -1.4088)
+            } model_actions;
+
             typedef enum enum_model_precision{
                 model_precision_single,            // float (32 bit)
                 model_precision_double,            // double (64 bit)
                 model_precision_mixed              // mixed precision (32 bit + 32 bit)
             } model_precision;
 
+            typedef enum enum_model_link_storage{
+                model_link_storage_12,             // SU(3) link as two rows (12 reals)
+                model_link_storage_8               // SU(3) link as 8 parameters, reconstructed in registers
+            } model_link_storage;
+
                       char*    version;            // version of MC programm
                       char*    path;               // path for output files
                       char*    finishpath;         // path for files start.txt and finish.txt
@@ -105,9 +127,10 @@ class model {
                        int     lattice_group;         // Lattice group
 #ifdef CPU_RUN
                        int     lattice_sites;
+                       int     CPU_threads;           // number of worker threads of CPU run (0 - all available)
 #endif
                        
-        unsigned int     lattice_full_site;     // Total number of lattice sites
+              lattice_index    lattice_full_site;     // Total number of lattice sites
                        int     lattice_full_n1n2;     // n1 * n2
                        int     lattice_full_n2n3;     // n2 * n3
                        int     lattice_full_n1n2n3;   // n1 * n2 * n3
@@ -117,9 +140,9 @@ class model {
                        int     lattice_domain_n2n3;   // n2 * n3
                        int     lattice_domain_n1n2n3; // (n1+B.C.) * n2 * n3
                        int     lattice_domain_n2n3n4; // n2 * n3 * n4
-              unsigned int     lattice_domain_site;   // Total number of lattice sites in simulation domain
+              lattice_index    lattice_domain_site;   // Total number of lattice sites in simulation domain
                        int     lattice_domain_exact_n1n2n3; // exact n1 * n2 * n3
-              unsigned int     lattice_domain_exact_site;   // Total number of lattice sites in simulation domain (exact, without boundary links)
+              lattice_index    lattice_domain_exact_site;   // Total number of lattice sites in simulation domain (exact, without boundary links)
 
 
                        // calculational flags
@@ -157,11 +180,30 @@ class model {
               unsigned int*    lattice_data;       // Lattice data
                        int     NHIT;               // parameter for multihit
                        int     NHITPar;               // parameter for multihit Parisi
+                       int     NOR;                // number of overrelaxation sweeps per heatbath sweep
+                      bool     heatbath_KP;        // Kennedy-Pendleton heatbath: tries until acceptance, not bounded by NHIT
+                      bool     update_tiled;       // heatbath sweep by 2x2x2x2 tiles held in local memory
+                      bool     get_heatbath_stats; // count heatbath tries and failures on device
+                    double     heatbath_tries;     // mean number of tries per SU(2) heatbath update
+                    double     heatbath_failures;  // fraction of SU(2) heatbath updates without acceptance
+             model_updates     update_engine;      // update algorithm
+         model_integrators     HMC_integrator;     // HMC molecular dynamics integrator
+                       int     HMC_steps;          // HMC molecular dynamics steps per trajectory
+                    double     HMC_tau;            // HMC trajectory length
+                       int     HMC_trajectories;   // number of HMC trajectories
+                       int     HMC_accepted;       // number of accepted HMC trajectories
+                    double     HMC_dH;             // sum of dH over HMC trajectories
+                    double     HMC_exp_dH;         // sum of exp(-dH) over HMC trajectories (mean is 1 for correct integrator)
+             model_actions     gauge_action;       // gauge action
+                    double     action_c0;          // weight of plaquettes in gauge action (c0 + 8 c1 = 1)
+                    double     action_c1;          // weight of 1x2 rectangles in gauge action
+                    double     action_c1_custom;   // c1 set explicitly (overrides gauge_action if nonzero)
                     double     BETA;               // beta
                        int     NAV;                // number of thermalization cycles
                        int     wilson_R;           // R size for Wilson loop
                        int     wilson_T;           // T size for Wilson loop
            model_precision     precision;          // precision to be used
+        model_link_storage     link_storage;       // storage format of SU(3) links in lattice_table
               unsigned int     PL_level;           // level for calculation Polyakov loops (0 - do not calculate PL, 1 - PL only, 2 - PL, PL^2, PL^4)
                     double     PHI;                // phi angle (lambda_3)
                     double     OMEGA;              // omega angle (lambda_8)
@@ -170,28 +212,32 @@ class model {
 
               // runtime counters
               unsigned int     PRNG_counter;       // counter runs of subroutine PRNG_produce (for load_state purposes)
+              unsigned int     PRNG_state_size;    // size of PRNG state in state file (0 - PRNG is adjusted by PRNG_counter)
+              unsigned int     PRNG_hmc_state_size;// size of HMC PRNG state in state file (0 - no HMC PRNG state)
               unsigned int     NAV_counter;        // number of performed thermalization cycles
               unsigned int     ITER_counter;       // number of performed working cycles
               unsigned int     LOAD_state;         // current load state
 
               // additional recalculating data
-              unsigned int     lattice_table_size;      // Length of lattice table
+              lattice_index    lattice_table_size;      // Length of lattice table
+              lattice_index    lattice_state_table_size;// Length of lattice table in state file (12-real SU(3) links)
               unsigned int     lattice_boundary_size;   // Length of lattice boundary
-              unsigned int     rowsize;                 // Length of row in lattice
-              unsigned int     rowsize4;                // Length of row in lattice (*4)
-              unsigned int     halfrowsize;             // Length of half row in lattice
-              unsigned int     halfrowsize4;            // Length of half row in lattice (*4)
-              unsigned int     lattice_table_row_size;
-              unsigned int     lattice_table_exact_row_size;
-
-              unsigned int     size_lattice_table;          // size of buffer lattice_table
-              unsigned int     size_lattice_measurement;    // size of buffer lattice_measurement
+              lattice_index    rowsize;                 // Length of row in lattice
+              lattice_index    rowsize4;                // Length of row in lattice (*4)
+              lattice_index    halfrowsize;             // Length of half row in lattice
+              lattice_index    halfrowsize4;            // Length of half row in lattice (*4)
+              lattice_index    lattice_table_row_size;
+              lattice_index    lattice_table_exact_row_size;
+
+              lattice_index    size_lattice_table;          // size of buffer lattice_table
+              lattice_index    size_lattice_measurement;    // size of buffer lattice_measurement
               unsigned int     size_lattice_energies;       // size of buffer lattice_energies
               unsigned int     size_lattice_wilson_loop;    // size of buffer lattice_wilson_loop
               unsigned int     size_lattice_energies_plq;   // size of buffer lattice_energies_plq
               unsigned int     size_lattice_polyakov_loop;  // size of buffer lattice_polyakov_loop
               unsigned int     size_lattice_boundary;       // size of buffer lattice_boundary
               unsigned int     size_lattice_parameters;     // size of buffer lattice_parameters
+              lattice_index    size_lattice_heatbath_reduce; // size of buffer lattice_heatbath_reduce
 
               // additional recalculating data
               unsigned int     lattice_boundary_exact_size;
@@ -202,9 +248,8 @@ class model {
               unsigned int     lattice_polyakov_loop_offset;
               unsigned int*    lattice_pointer_initial;
               unsigned int*    lattice_pointer_last;
-              unsigned int*    lattice_pointer_save;
               unsigned int*    lattice_pointer_measurements;
-              unsigned int     lattice_measurement_size;
+              lattice_index    lattice_measurement_size;
               unsigned int     lattice_measurement_offset;
               unsigned int     lattice_measurement_size_F;
                  cl_float4*    prng_pointer;
@@ -304,6 +349,22 @@ analysis_CL::analysis::data_analysis*   Analysis_S_Z;
              int    sun_update_even_Y_id;
              int    sun_update_even_Z_id;
              int    sun_update_even_T_id;
+             int    sun_orelax_odd_X_id;
+             int    sun_orelax_odd_Y_id;
+             int    sun_orelax_odd_Z_id;
+             int    sun_orelax_odd_T_id;
+             int    sun_orelax_even_X_id;
+             int    sun_orelax_even_Y_id;
+             int    sun_orelax_even_Z_id;
+             int    sun_orelax_even_T_id;
+             int    sun_hmc_momenta_id;
+             int    sun_hmc_force_id;
+             int    sun_hmc_links_id;
+             int    sun_hmc_energy_id;
+             int    sun_hmc_energy_reduce_id;
+             int    sun_update_rect_id;
+             int    sun_orelax_rect_id;
+             int    sun_update_tiled_id;
              int    sun_clear_measurement_id;
              int    sun_get_boundary_low_id;
              int    sun_put_boundary_low_id;
@@ -327,8 +388,16 @@ analysis_CL::analysis::data_analysis*   Analysis_S_Z;
 	     int    sun_polyakov_diff_x_reduce_id;
 	     int    sun_polyakov_diff_y_reduce_id;
 	     int    sun_polyakov_diff_z_reduce_id;
+             int    sun_heatbath_stats_id;
+             int    sun_heatbath_stats_reduce_id;
              int    sun_update_indices_id;
 
+             int    update_program_id;          // program ids, programs are built in background
+             int    measurements_program_id;
+             int    wilson_program_id;
+             int    polyakov_program_id;
+            bool    measurement_kernels_ready;  // kernels for measurements are created
+
              int    argument_wilson_index;
              int    argument_plq_index;
              int    argument_polyakov_index;
@@ -336,18 +405,27 @@ analysis_CL::analysis::data_analysis*   Analysis_S_Z;
 	     int    argument_polyakov_diff_y_index;
 	     int    argument_polyakov_diff_z_index;
              int    argument_measurement_index;
+             int    argument_hmc_dir;
+             int    argument_hmc_force_eps;
+             int    argument_hmc_links_eps;
+             int    argument_update_rect_dir;
+             int    argument_orelax_rect_dir;
+             int    argument_update_tiled_colour;
 	     int    argument_action_diff_x_index;
 	     int    argument_action_diff_y_index;
 	     int    argument_action_diff_z_index;
+             int    argument_heatbath_stats_index;
              int    wilson_index;
              int    plq_index;
              int    polyakov_index;
 	     int    polyakov_diff_index;
              int    measurement_index;
 	     int    action_diff_index;
+             int    heatbath_stats_index;
 
             // identificators for buffers
     unsigned int    lattice_table;
+    unsigned int    lattice_table_snapshot;     // copy of lattice_table for measurements (overlap_measurements)
     unsigned int    lattice_boundary;
     unsigned int    lattice_parameters;
     unsigned int    lattice_measurement;
@@ -362,6 +440,14 @@ analysis_CL::analysis::data_analysis*   Analysis_S_Z;
     unsigned int    lattice_action_diff_x;
     unsigned int    lattice_action_diff_y;
     unsigned int    lattice_action_diff_z;
+    unsigned int    lattice_heatbath_stats;     // heatbath counters of update work-items (get_heatbath_stats)
+    unsigned int    lattice_heatbath_reduce;    // first step reduction of heatbath counters (main queue, apart from lattice_measurement)
+    unsigned int    lattice_heatbath_measurements; // heatbath counters reduced at each measurement
+    unsigned int    lattice_tile_lds;           // local memory for tile and halo links (update_tiled)
+    unsigned int    lattice_hmc_momenta;        // HMC momenta
+    unsigned int    lattice_hmc_energy;         // HMC kinetic energy and action per work group
+    unsigned int    lattice_hmc_total;          // HMC kinetic energy and action of lattice
+    unsigned int    lattice_table_hmc;          // copy of lattice_table at start of HMC trajectory
 
             // pointers for buffers
     cl_float4*      plattice_table_float;
@@ -379,6 +465,12 @@ analysis_CL::analysis::data_analysis*   Analysis_S_Z;
     cl_double2*     plattice_action_diff_x;
     cl_double2*     plattice_action_diff_y;
     cl_double2*     plattice_action_diff_z;
+    cl_uint4*       plattice_heatbath_stats;
+    cl_double2*     plattice_heatbath_measurements;
+    void*           plattice_hmc_momenta;
+    cl_double2*     plattice_hmc_energy;
+    cl_double2*     plattice_hmc_total;
+   PRNG_CL::PRNG*   PRNG_hmc;                   // CPU stream for Metropolis step of HMC
 #endif
 
             // functions
@@ -396,7 +488,26 @@ analysis_CL::analysis::data_analysis*   Analysis_S_Z;
     unsigned int*   lattice_make_bin_header(void);
             bool    lattice_load_bin_header(unsigned int* head);
              int    model_make_header(char* header,int header_size);
+            void    lattice_action_init(void);          // resolve weights c0, c1 of gauge action
+            void    lattice_tiled_init(void);           // check that tiled update fits lattice and device
+            void    lattice_links_init(void);           // check that compressed SU(3) links are supported
+            void*   lattice_table_expand(void* table);  // copy of compressed lattice table with 12-real links
+            void    lattice_table_compress(void* table,void* table_full);   // 12-real links of state file -> compressed lattice table
+     static void    lattice_link_compress_3(const double* m,double* c);     // 12 reals (rows uv1, uv2, uv3) -> 8 parameters
+     static void    lattice_link_decompress_3(const double* c,double* m);   // 8 parameters -> 12 reals (rows uv1, uv2, uv3)
             void    lattice_make_programs(void);
+#ifndef BIGLAT
+            void    lattice_make_measurement_kernels(void);
+            void    lattice_measure_initial(int index);
+            void    lattice_set_kernel_costs(void);
+            void    lattice_overrelaxation(void);       // NOR overrelaxation sweeps (no PRNs are consumed)
+            void    lattice_heatbath_statistics(void);  // reduce heatbath counters of measurements
+            void    lattice_update(void);               // one update of all links: heatbath sweep or HMC trajectory
+            void    lattice_hmc_trajectory(void);       // HMC trajectory with Metropolis step
+            void    lattice_hmc_force(double eps);      // HMC P -> P + eps F(U)
+            void    lattice_hmc_evolve(double eps);     // HMC U -> exp(eps P) U
+          double    lattice_hmc_hamiltonian(void);      // HMC Hamiltonian (reduced on device in double precision)
+#endif
 #ifdef BIGLAT
             void    lattice_set_devParts(void);
             void    lattice_mp_Sim(void);
@@ -449,14 +560,14 @@ analysis_CL::analysis::data_analysis*   Analysis_S_Z;
            static char path_suncl[FILENAME_MAX];            // Relative path to SUNCL kernels
            static char path_kernel[FILENAME_MAX];           // Relative path to KERNELS kernels
 
-           int lattice_full_link;
-           int lattice_domain_link;
-           int lattice_domain_exact_link;
-           unsigned int lattice_table_row_size_half;
-           unsigned int lattice_table_exact_row_size_half;
-           unsigned int lattice_table_group;
-           unsigned int lattice_table_exact_group;
-           unsigned int lattice_polyakov_size;
+           lattice_index lattice_full_link;
+           lattice_index lattice_domain_link;
+           lattice_index lattice_domain_exact_link;
+           lattice_index lattice_table_row_size_half;
+           lattice_index lattice_table_exact_row_size_half;
+           lattice_index lattice_table_group;
+           lattice_index lattice_table_exact_group;
+           lattice_index lattice_polyakov_size;
            unsigned int lattice_parameters_size;
 	   
 	   unsigned int lattice_action_size;
@@ -60,12 +60,12 @@ lattice_measurement_wilson(__global hgpu_float4  * lattice_table,
 #if SUN == 2
     hgpu_double out  = 0.0;
     hgpu_double out2 = 0.0;
-    uint gdi = GID;
+    lattice_index gdi = GID;
     hgpu_double wilson_loop;
     coords_4 coord,  coord2;
     coords_4 coordX, coordX2;
     coords_4 coord_1,coord_2,coord_4;
-    uint gdi_1,gdi_2,gdi_4,gdiT;
+    lattice_index gdi_1,gdi_2,gdi_4,gdiT;
     gpu_su_2 u1;
     double_su_2 m1, m2, m3, m4, m5, w1;
 
@@ -260,12 +260,12 @@ lattice_measurement_wilson(__global hgpu_float4  * lattice_table,
 #if SUN == 3
     hgpu_double out  = 0.0;
     hgpu_double out2 = 0.0;
-    uint gdi = GID;
+    lattice_index gdi = GID;
     hgpu_double wilson_loop;
     coords_4 coord,  coord2;
     coords_4 coordX, coordX2;
     coords_4 coord_1,coord_2,coord_4;
-    uint gdi_1,gdi_2,gdi_4,gdiT;
+    lattice_index gdi_1,gdi_2,gdi_4,gdiT;
     gpu_su_3 u1;
     double_su_3 m1, m2, m3, m4, m5, w1;
 
@@ -43,15 +43,37 @@
 #include "../su2/algebra_su2.h"
 #include "../su3/algebra_su3.h"
 
+template <typename su_n>
+hgpu_double retrace_rectangles(modelCPU<su_n> *latCPU, coords_4 lsize, int gid, int mu, int nu){
+    // both 1x2 rectangles of plane mu-nu starting at p: 2mu x nu and mu x 2nu
+    su_n *U = latCPU->lattice_tableCPU;
+    int nd = latCPU->lattice_ndCPU;
+    
+    int gM  = lattice_neighbours_coords(lsize, gid, mu);    // p+M
+    int gN  = lattice_neighbours_coords(lsize, gid, nu);    // p+N
+    int gMM = lattice_neighbours_coords(lsize, gM, mu);     // p+2M
+    int gNN = lattice_neighbours_coords(lsize, gN, nu);     // p+2N
+    int gMN = lattice_neighbours_coords(lsize, gM, nu);     // p+M+N
+    
+    hgpu_double result = ReTr(U[gid * nd + mu] * U[gM * nd + mu] * U[gMM * nd + nu] * Herm(U[gMN * nd + mu]) * Herm(U[gN * nd + mu]) * Herm(U[gid * nd + nu]));
+    result += ReTr(U[gid * nd + mu] * U[gM * nd + nu] * U[gMN * nd + nu] * Herm(U[gNN * nd + mu]) * Herm(U[gN * nd + nu]) * Herm(U[gid * nd + nu]));
+    
+    return result;
+}
+
 template <typename su_n>
 hgpu_complex sConf(modelCPU<su_n> *latCPU, hgpu_double *pplq){
-    hgpu_complex result;
+    hgpu_complex result, rect;
     result.re = 0.0; //spat
     result.im = 0.0;//temp
+    rect.re = 0.0;  //rectangles (improved actions)
+    rect.im = 0.0;
     
     int nd = latCPU->lattice_ndCPU;
     int group = latCPU->lattice_group;
     hgpu_float bbeta = latCPU->beta;
+    hgpu_double c0 = latCPU->action_c0;
+    hgpu_double c1 = latCPU->action_c1;
     
     su_n m1, m2, m3, m4;
     int gid1;
@@ -74,6 +96,7 @@ hgpu_complex sConf(modelCPU<su_n> *latCPU, hgpu_double *pplq){
             m4 = Herm(latCPU->lattice_tableCPU[gid * nd + dir1]);
         
         result.re += ReTr(m1 * m2 * m3 * m4);
+        if (c1 != 0.0) rect.re += retrace_rectangles(latCPU, lsize, gid, dir, dir1);
     }
     //--- temp ---------------------------------------------------------------------
     for (int dir = 0; dir < nd - 1; dir++){
@@ -85,16 +108,23 @@ hgpu_complex sConf(modelCPU<su_n> *latCPU, hgpu_double *pplq){
         m4 = Herm(latCPU->lattice_tableCPU[gid * nd + nd - 1]);
         
         result.im += ReTr(m1 * m2 * m3 * m4);
+        if (c1 != 0.0) rect.im += retrace_rectangles(latCPU, lsize, gid, dir, nd - 1);
     }
     //-------------------------------------------------------------------------------
     }
     
+    // S = beta * [c0 (1 - Re Tr U_P / N) + 2 c1 (1 - Re Tr U_R / N)] per plaquette, two rectangles per plaquette
     *pplq = (result.re + result.im) / ((nd - 1) * nd / 2 * latCPU->lattice_sitesCPU);
     *pplq = bbeta * (1 - (*pplq) / group);
     result.re /= ((nd - 2) * (nd - 1) / 2 * latCPU->lattice_sitesCPU);
     result.im /= ((nd - 1)* latCPU->lattice_sitesCPU);
     result.re = bbeta * (1 - result.re / group);
     result.im = bbeta * (1 - result.im / group);
+    if (c1 != 0.0) {
+        *pplq = c0 * (*pplq) + 2.0 * c1 * bbeta * (1 - (rect.re + rect.im) / (2 * (nd - 1) * nd / 2 * latCPU->lattice_sitesCPU) / group);
+        result.re = c0 * result.re + 2.0 * c1 * bbeta * (1 - rect.re / (2 * (nd - 2) * (nd - 1) / 2 * latCPU->lattice_sitesCPU) / group);
+        result.im = c0 * result.im + 2.0 * c1 * bbeta * (1 - rect.im / (2 * (nd - 1) * latCPU->lattice_sitesCPU) / group);
+    }
     return result;
 }
 #endif
@@ -40,8 +40,55 @@
 
 #include "../sunh.h"
 
+template <typename su_n>
+su_n staple_rectangle(modelCPU<su_n> *latCPU, int gid, int dir){
+    // sum of six 1x2 rectangle staples of link [p,D] in every plane D-N; [p,D] * staple closes the loop
+    su_n stap;
+    lattice_zero(&stap);
+    
+    coords_4 lsize;
+    lsize.x = latCPU->lattice_size[0];
+    lsize.y = latCPU->lattice_size[1];
+    lsize.z = latCPU->lattice_size[2];
+    lsize.t = latCPU->lattice_size[3];
+    
+    su_n *U = latCPU->lattice_tableCPU;
+    int nd = latCPU->lattice_ndCPU;
+    
+    int gD  = lattice_neighbours_coords(lsize, gid, dir);           // p+D
+    int gDD = lattice_neighbours_coords(lsize, gD, dir);            // p+2D
+    int gDm = lattice_neighbours_coords_backward(lsize, gid, dir);  // p-D
+    
+    for (int nu = 0; nu < nd; nu++)
+        if(nu != dir){
+            int gN    = lattice_neighbours_coords(lsize, gid, nu);           // p+N
+            int gNN   = lattice_neighbours_coords(lsize, gN, nu);            // p+2N
+            int gNm   = lattice_neighbours_coords_backward(lsize, gid, nu);  // p-N
+            int gNmm  = lattice_neighbours_coords_backward(lsize, gNm, nu);  // p-2N
+            int gDN   = lattice_neighbours_coords(lsize, gD, nu);            // p+D+N
+            int gDNm  = lattice_neighbours_coords_backward(lsize, gD, nu);   // p+D-N
+            int gDNmm = lattice_neighbours_coords_backward(lsize, gDNm, nu); // p+D-2N
+            int gDmN  = lattice_neighbours_coords(lsize, gDm, nu);           // p-D+N
+            int gDmNm = lattice_neighbours_coords_backward(lsize, gDm, nu);  // p-D-N
+            int gDDNm = lattice_neighbours_coords_backward(lsize, gDD, nu);  // p+2D-N
+            
+            // 2D x N, forward and backward
+            stap = stap + (U[gD * nd + dir] * U[gDD * nd + nu] * Herm(U[gDN * nd + dir]) * Herm(U[gN * nd + dir]) * Herm(U[gid * nd + nu]));
+            stap = stap + (U[gD * nd + dir] * Herm(U[gDDNm * nd + nu]) * Herm(U[gDNm * nd + dir]) * Herm(U[gNm * nd + dir]) * U[gNm * nd + nu]);
+            // -D+D x N, forward and backward
+            stap = stap + (U[gD * nd + nu] * Herm(U[gN * nd + dir]) * Herm(U[gDmN * nd + dir]) * Herm(U[gDm * nd + nu]) * U[gDm * nd + dir]);
+            stap = stap + (Herm(U[gDNm * nd + nu]) * Herm(U[gNm * nd + dir]) * Herm(U[gDmNm * nd + dir]) * U[gDmNm * nd + nu] * U[gDm * nd + dir]);
+            // D x 2N, forward and backward
+            stap = stap + (U[gD * nd + nu] * U[gDN * nd + nu] * Herm(U[gNN * nd + dir]) * Herm(U[gN * nd + nu]) * Herm(U[gid * nd + nu]));
+            stap = stap + (Herm(U[gDNm * nd + nu]) * Herm(U[gDNmm * nd + nu]) * Herm(U[gNmm * nd + dir]) * U[gNmm * nd + nu] * U[gNm * nd + nu]);
+        }
+    
+    return stap;
+}
+
 template <typename su_n>
 su_n staple(modelCPU<su_n> *latCPU, int gid, int dir){
+    // staple of gauge action: plaquettes (Wilson) or c0 * plaquettes + c1 * rectangles (improved actions)
     su_n stap, stap1;
     lattice_zero(&stap);
     
@@ -73,47 +120,119 @@ su_n staple(modelCPU<su_n> *latCPU, int gid, int dir){
             stap = stap + (m1 * m2 * m3);
         }
     
+    if (latCPU->action_c1 != 0.0)
+        stap = latCPU->action_c0 * stap + latCPU->action_c1 * staple_rectangle(latCPU, gid, dir);
+    
     return stap;
 }
 
 template <typename su_n>
-void lattice_update_even(modelCPU<su_n> *latCPU, int dir, PRNG_CL::PRNG *prngCPU){
-    su_n stap, U;
-    int gid;
-    
+void lattice_update_even(modelCPU<su_n> *latCPU, int dir, PRNG_CL::PRNG **prngCPU){
     coords_4 lsize;
     lsize.x = latCPU->lattice_size[0];
     lsize.y = latCPU->lattice_size[1];
     lsize.z = latCPU->lattice_size[2];
     lsize.t = latCPU->lattice_size[3];
     
-    for (int i = 0; i < latCPU->lattice_sitesCPU / 2; i++){
-        gid = lattice_even_gid(lsize, i);
-        stap = staple(latCPU, gid, dir);
-        U = latCPU->lattice_tableCPU[gid * latCPU->lattice_ndCPU + dir];
-        update_link(&U, stap, (latCPU->beta / latCPU->lattice_group), latCPU->nhit, gid, (latCPU->ints == 2), latCPU->lattice_sitesCPU, 1, prngCPU);
-        latCPU->lattice_tableCPU[gid * latCPU->lattice_ndCPU + dir] = U;
+    // staples of even links in direction dir contain no such links, so chunks are updated concurrently
+    int half = latCPU->lattice_sitesCPU / 2;
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static, 1) num_threads(latCPU->threads)
+#endif
+    for (int k = 0; k < latCPU->threads; k++){
+        su_n stap, U;
+        int gid;
+        for (int i = (int) ((long long) half * k / latCPU->threads); i < (int) ((long long) half * (k + 1) / latCPU->threads); i++){
+            gid = lattice_even_gid(lsize, i);
+            stap = staple(latCPU, gid, dir);
+            U = latCPU->lattice_tableCPU[gid * latCPU->lattice_ndCPU + dir];
+            update_link(&U, stap, (latCPU->beta / latCPU->lattice_group), latCPU->nhit, gid, (latCPU->ints == 2), latCPU->lattice_sitesCPU, 1, prngCPU[k]);
+            latCPU->lattice_tableCPU[gid * latCPU->lattice_ndCPU + dir] = U;
+        }
     }
 }
 
 template <typename su_n>
-void lattice_update_odd(modelCPU<su_n> *latCPU, int dir, PRNG_CL::PRNG *prngCPU){
-    su_n stap, U;
-    int gid;
+void lattice_update_odd(modelCPU<su_n> *latCPU, int dir, PRNG_CL::PRNG **prngCPU){
+    coords_4 lsize;
+    lsize.x = latCPU->lattice_size[0];
+    lsize.y = latCPU->lattice_size[1];
+    lsize.z = latCPU->lattice_size[2];
+    lsize.t = latCPU->lattice_size[3];
     
+    // staples of odd links in direction dir contain no such links, so chunks are updated concurrently
+    int half = latCPU->lattice_sitesCPU / 2;
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static, 1) num_threads(latCPU->threads)
+#endif
+    for (int k = 0; k < latCPU->threads; k++){
+        su_n stap, U;
+        int gid;
+        for (int i = (int) ((long long) half * k / latCPU->threads); i < (int) ((long long) half * (k + 1) / latCPU->threads); i++){
+            gid = lattice_odd_gid(lsize, i);
+            stap = staple(latCPU, gid, dir);
+            U = latCPU->lattice_tableCPU[gid * latCPU->lattice_ndCPU + dir];
+            update_link(&U, stap, (latCPU->beta / latCPU->lattice_group), latCPU->nhit, gid, (latCPU->ints == 2), latCPU->lattice_sitesCPU, 1, prngCPU[k]);
+            latCPU->lattice_tableCPU[gid * latCPU->lattice_ndCPU + dir] = U;
+        }
+    }
+}
+
+template <typename su_n>
+int lattice_colour(modelCPU<su_n> *latCPU, int gid, int dir){
+    // colour = 4 * (x_dir & 1) + ((sum of other coordinates) & 3), as on device: links [p,dir] of one colour
+    // do not enter into rectangle staples of each other (all lattice extents are multiples of 4)
     coords_4 lsize;
     lsize.x = latCPU->lattice_size[0];
     lsize.y = latCPU->lattice_size[1];
     lsize.z = latCPU->lattice_size[2];
     lsize.t = latCPU->lattice_size[3];
     
-    for (int i = 0; i < latCPU->lattice_sitesCPU / 2; i++){
-        gid = lattice_odd_gid(lsize, i);
-        stap = staple(latCPU, gid, dir);
-        U = latCPU->lattice_tableCPU[gid * latCPU->lattice_ndCPU + dir];
-        update_link(&U, stap, (latCPU->beta / latCPU->lattice_group), latCPU->nhit, gid, (latCPU->ints == 2), latCPU->lattice_sitesCPU, 1, prngCPU);
-        latCPU->lattice_tableCPU[gid * latCPU->lattice_ndCPU + dir] = U;
+    coords_4 coord = lattice_gid_to_coords(lsize, gid);
+    int c[4] = {coord.x, coord.y, coord.z, coord.t};
+    int sum = 0;
+    for (int i = 0; i < 4; i++) if (i != dir) sum += c[i];
+    
+    return 4 * (c[dir] & 1) + (sum & 3);
+}
+
+template <typename su_n>
+void lattice_update_colour(modelCPU<su_n> *latCPU, int dir, int colour, PRNG_CL::PRNG **prngCPU){
+    // links [p,dir] of one colour are updated concurrently (improved actions)
+    int sites = latCPU->lattice_sitesCPU;
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static, 1) num_threads(latCPU->threads)
+#endif
+    for (int k = 0; k < latCPU->threads; k++){
+        su_n stap, U;
+        for (int gid = (int) ((long long) sites * k / latCPU->threads); gid < (int) ((long long) sites * (k + 1) / latCPU->threads); gid++){
+            if (lattice_colour(latCPU, gid, dir) != colour) continue;
+            stap = staple(latCPU, gid, dir);
+            U = latCPU->lattice_tableCPU[gid * latCPU->lattice_ndCPU + dir];
+            update_link(&U, stap, (latCPU->beta / latCPU->lattice_group), latCPU->nhit, gid, (latCPU->ints == 2), latCPU->lattice_sitesCPU, 1, prngCPU[k]);
+            latCPU->lattice_tableCPU[gid * latCPU->lattice_ndCPU + dir] = U;
+        }
     }
 }
 
+template <typename su_n>
+void lattice_update_sweep(modelCPU<su_n> *latCPU, PRNG_CL::PRNG **prngCPU){
+    // one update of all links: odd and even half-sweeps (Wilson action) or 8 colours per direction (improved actions)
+    if (latCPU->action_c1 != 0.0) {
+        for (int dir = X; dir <= T; dir++)
+            for (int colour = 0; colour < 8; colour++)
+                lattice_update_colour(latCPU, dir, colour, prngCPU);
+        return;
+    }
+    lattice_update_odd(latCPU, X, prngCPU);
+    lattice_update_odd(latCPU, Y, prngCPU);
+    lattice_update_odd(latCPU, Z, prngCPU);
+    lattice_update_odd(latCPU, T, prngCPU);
+    
+    lattice_update_even(latCPU, X, prngCPU);
+    lattice_update_even(latCPU, Y, prngCPU);
+    lattice_update_even(latCPU, Z, prngCPU);
+    lattice_update_even(latCPU, T, prngCPU);
+}
+
 #endif
@@ -101,6 +101,18 @@ su_2 operator * (su_2 a, su_2 b){
     return c;
 }
 
+su_2 operator * (hgpu_double s, su_2 a){
+    su_2 c;
+    
+    c.u1.re = s * a.u1.re;    c.u1.im = s * a.u1.im;
+    c.u2.re = s * a.u2.re;    c.u2.im = s * a.u2.im;
+    
+    c.v1.re = s * a.v1.re;    c.v1.im = s * a.v1.im;
+    c.v2.re = s * a.v2.re;    c.v2.im = s * a.v2.im;
+    
+    return c;
+}
+
 su_2 operator += (su_2 a, su_2 b){
     return a + b;
 }
@@ -55,6 +55,7 @@ typedef struct su_2 {
     su_2 operator + (su_2 a, su_2 b);
     su_2 operator - (su_2 a, su_2 b);
     su_2 operator * (su_2 a, su_2 b);
+    su_2 operator * (hgpu_double s, su_2 a);
     su_2 operator += (su_2 a, su_2 b);
     su_2 Herm(su_2 a);
     hgpu_complex Tr(su_2 a);
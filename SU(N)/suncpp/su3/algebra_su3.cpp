@@ -142,6 +142,24 @@ su_3 operator * (su_3 a, su_3 b){
     return c;
 }
 
+su_3 operator * (hgpu_double s, su_3 a){
+    su_3 c;
+    
+    c.u1.re = s * a.u1.re;    c.u1.im = s * a.u1.im;
+    c.u2.re = s * a.u2.re;    c.u2.im = s * a.u2.im;
+    c.u3.re = s * a.u3.re;    c.u3.im = s * a.u3.im;
+    
+    c.v1.re = s * a.v1.re;    c.v1.im = s * a.v1.im;
+    c.v2.re = s * a.v2.re;    c.v2.im = s * a.v2.im;
+    c.v3.re = s * a.v3.re;    c.v3.im = s * a.v3.im;
+    
+    c.w1.re = s * a.w1.re;    c.w1.im = s * a.w1.im;
+    c.w2.re = s * a.w2.re;    c.w2.im = s * a.w2.im;
+    c.w3.re = s * a.w3.re;    c.w3.im = s * a.w3.im;
+    
+    return c;
+}
+
 su_3 Herm(su_3 a){
     su_3 result;
     
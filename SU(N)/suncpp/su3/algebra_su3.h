@@ -60,6 +60,7 @@ typedef struct su_3 {
     su_3 operator + (su_3 a, su_3 b);
     su_3 operator - (su_3 a, su_3 b);
     su_3 operator * (su_3 a, su_3 b);
+    su_3 operator * (hgpu_double s, su_3 a);
     su_3 Herm(su_3 a);
     hgpu_complex Tr(su_3 a);
     hgpu_double ReTr(su_3 a);
@@ -5,7 +5,7 @@
  * @version  1.6
  *
  * @brief    [QCDGPU]
- *           Defines sequential simulation procedure on CPU
+ *           Defines simulation procedure on CPU (multithreaded with USE_OPENMP)
  *
  * @section  LICENSE
  *
@@ -82,10 +82,19 @@ void lattice_simulateCPU(model_CL::model *lat, su_n *smth){
         latCPU->nhit = (int)lat->NHIT;
         latCPU->beta = (hgpu_float)lat->BETA;
         latCPU->lattice_group = (int)lat->lattice_group;
+        lat->lattice_action_init();
+        latCPU->action_c0 = (hgpu_double)lat->action_c0;
+        latCPU->action_c1 = (hgpu_double)lat->action_c1;
         latCPU->nav = (int)lat->NAV;
         latCPU->iter = (int)lat->ITER;
         latCPU->niter = (int)lat->NITER;
         
+        // CPU simulation measures plaquettes and actions only
+        lat->PL_level        = 0;
+        lat->get_wilson_loop = false;
+        lat->get_Fmunu       = false;
+        lat->get_F0mu        = false;
+
         int nmeas = 0;
         Measurements *meas = new(Measurements);
         meas->iter = (int)lat->ITER;
@@ -108,12 +117,25 @@ void lattice_simulateCPU(model_CL::model *lat, su_n *smth){
         for (int i = 1; i < latCPU->lattice_ndCPU; i++)
             latCPU->lattice_sitesCPU *= latCPU->lattice_size[i];
         
-        PRNG_CL::PRNG *prngCPU = new(PRNG_CL::PRNG);
-        prngCPU->PRNG_generator = lat->PRNG0->PRNG_generator;
-        prngCPU->PRNG_randseries = lat->PRNG0->PRNG_randseries;
-        prngCPU->PRNG_precision = lat->PRNG0->PRNG_precision;
-        prngCPU->initialize_CPU();
+#ifdef USE_OPENMP
+        if (lat->CPU_threads <= 0) lat->CPU_threads = omp_get_max_threads();
+#else
+        lat->CPU_threads = 1;
+#endif
+        latCPU->threads = lat->CPU_threads;
+        
+        // thread 0 takes the model PRNG, other threads take independent streams derived from PRNG_randseries
         lat->PRNG0->initialize_CPU();
+        PRNG_CL::PRNG **prngCPU = (PRNG_CL::PRNG**)calloc(latCPU->threads, sizeof(PRNG_CL::PRNG*));
+        prngCPU[0] = lat->PRNG0;
+        for(int k = 1; k < latCPU->threads; k++){
+            prngCPU[k] = new(PRNG_CL::PRNG);
+            prngCPU[k]->PRNG_generator = lat->PRNG0->PRNG_generator;
+            prngCPU[k]->PRNG_randseries = lat->PRNG0->PRNG_randseries;
+            prngCPU[k]->PRNG_precision = lat->PRNG0->PRNG_precision;
+            prngCPU[k]->PRNG_stream = lat->PRNG0->PRNG_stream;
+            prngCPU[k]->initialize_CPU(k);
+        }
         
         char* header = lat->lattice_make_header();
         printf("%s\n",header);
@@ -130,31 +152,14 @@ void lattice_simulateCPU(model_CL::model *lat, su_n *smth){
             meas->cs[0] = sConf(latCPU, &meas->ts[0]);
         
         for(int n = 0; n < latCPU->nav; n++){
-            lattice_update_odd(latCPU, X, lat->PRNG0);
-            lattice_update_odd(latCPU, Y, lat->PRNG0);
-            lattice_update_odd(latCPU, Z, lat->PRNG0);
-            lattice_update_odd(latCPU, T, lat->PRNG0);
-            
-            lattice_update_even(latCPU, X, lat->PRNG0);
-            lattice_update_even(latCPU, Y, lat->PRNG0);
-            lattice_update_even(latCPU, Z, lat->PRNG0);
-            lattice_update_even(latCPU, T, lat->PRNG0);
+            lattice_update_sweep(latCPU, prngCPU);
             
             if (n % 10 == 0) printf("\rCPU thermalization [%i]", n);
         }
         
         for(int i = 1; i < latCPU->iter; i++){
-            for(int n = 0; n < latCPU->niter; n++){
-                lattice_update_odd(latCPU, X, lat->PRNG0);
-                lattice_update_odd(latCPU, Y, lat->PRNG0);
-                lattice_update_odd(latCPU, Z, lat->PRNG0);
-                lattice_update_odd(latCPU, T, lat->PRNG0);
-                
-                lattice_update_even(latCPU, X, lat->PRNG0);
-                lattice_update_even(latCPU, Y, lat->PRNG0);
-                lattice_update_even(latCPU, Z, lat->PRNG0);
-                lattice_update_even(latCPU, T, lat->PRNG0);
-            }
+            for(int n = 0; n < latCPU->niter; n++)
+                lattice_update_sweep(latCPU, prngCPU);
             
             if(lat->get_plaquettes_avr)
                 meas->cplq[i] = plqConf(latCPU, &meas->tplq[i]);
@@ -218,7 +223,9 @@ void lattice_simulateCPU(model_CL::model *lat, su_n *smth){
             ii += 3;
         }
 
-        delete (prngCPU);
+        for(int k = 1; k < latCPU->threads; k++)
+            delete (prngCPU[k]);
+        free(prngCPU);
         
         free(Analysis);
         
@@ -44,6 +44,10 @@
 
 #include "coord_work/coord_work.h"
 
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
 #include "su2/algebra_su2.h"
 #include "su2/update_su2.h"
 #include "su3/algebra_su3.h"
@@ -65,9 +69,12 @@ public:
     int     nhit;
     hgpu_float beta;
     int     lattice_group;
+    hgpu_double action_c0;  // weight of plaquettes in gauge action
+    hgpu_double action_c1;  // weight of 1x2 rectangles in gauge action (0 for Wilson action)
     int nav;
     int iter;
     int niter;
+    int threads;        // worker threads: thread k updates k-th chunk of each half-sweep with its own PRNG
     
     unsigned int lattice_sitesCPU;
     